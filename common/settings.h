@@ -37,7 +37,7 @@ class FrameTiming {
       kVsyncStart,  kBuildStart,   kBuildFinish,
       kRasterStart, kRasterFinish, kRasterFinishWallTime};
 
-  static constexpr int kStatisticsCount = kCount + 5;
+  static constexpr int kStatisticsCount = kCount + 7;
 
   fml::TimePoint Get(Phase phase) const { return data_[phase]; }
   fml::TimePoint Set(Phase phase, fml::TimePoint value) {
@@ -59,6 +59,13 @@ class FrameTiming {
     picture_cache_count_ = picture_cache_count;
     picture_cache_bytes_ = picture_cache_bytes;
   }
+  uint64_t GetRasterCacheHitCount() const { return raster_cache_hit_count_; }
+  uint64_t GetRasterCacheMissCount() const { return raster_cache_miss_count_; }
+  void SetRasterCacheHitStatistics(size_t raster_cache_hit_count,
+                                   size_t raster_cache_miss_count) {
+    raster_cache_hit_count_ = raster_cache_hit_count;
+    raster_cache_miss_count_ = raster_cache_miss_count;
+  }
 
  private:
   fml::TimePoint data_[kCount];
@@ -67,6 +74,8 @@ class FrameTiming {
   size_t layer_cache_bytes_;
   size_t picture_cache_count_;
   size_t picture_cache_bytes_;
+  size_t raster_cache_hit_count_;
+  size_t raster_cache_miss_count_;
 };
 
 using TaskObserverAdd =
@@ -242,6 +251,34 @@ struct Settings {
   // calls in this callback will cause applications to jank.
   LogMessageCallback log_message_callback;
   bool enable_software_rendering = false;
+  // Spread the rasterization of DisplayLists across the concurrent worker
+  // threads by splitting frames into tiles. Only applies to surfaces that
+  // are rendered by the Skia software backend.
+  bool enable_tiled_software_rendering = false;
+  // The maximum number of bytes that the images in the raster cache may
+  // take. Images that were not used recently are evicted to stay within
+  // the limit. A value of 0 selects the default limit of the raster cache.
+  size_t raster_cache_max_bytes = 0;
+  // The relative difference in scale at which the raster cache still draws
+  // an image that was rasterized at another scale, or 0 to only draw images
+  // at the scale they were rasterized at. Unset selects the default
+  // tolerance of the raster cache.
+  std::optional<float> raster_cache_scale_tolerance;
+  // Rasterize the images of the raster cache on the concurrent worker
+  // threads instead of on the raster thread. The content is drawn directly
+  // until its image is ready. Only used by the software backend.
+  bool enable_background_raster_cache = false;
+  // Diff each layer tree against the previous one and only repaint the part
+  // of the frame that changed, on surfaces that keep the content of their
+  // framebuffer between frames.
+  bool enable_partial_repaint = false;
+  // Preroll the children of container layers with many children on the
+  // concurrent worker threads as well as on the raster thread.
+  bool enable_concurrent_preroll = false;
+  // Let the concurrent workers steal the tasks of each other instead of
+  // waiting on a single queue. See
+  // |fml::ConcurrentMessageLoop::Scheduling::kWorkStealing|.
+  bool enable_work_stealing_workers = false;
   bool skia_deterministic_rendering_on_cpu = false;
   bool verbose_logging = false;
   std::string log_tag = "flutter";
@@ -5,6 +5,7 @@
 #include "flutter/flow/compositor_context.h"
 
 #include "flutter/flow/layers/layer_tree.h"
+#include "flutter/fml/trace_event.h"
 #include "third_party/skia/include/core/SkCanvas.h"
 
 namespace flutter {
@@ -69,7 +70,8 @@ CompositorContext::ScopedFrame::~ScopedFrame() {
 
 RasterStatus CompositorContext::ScopedFrame::Raster(
     flutter::LayerTree& layer_tree,
-    bool ignore_raster_cache) {
+    bool ignore_raster_cache,
+    FrameDamage* frame_damage) {
   TRACE_EVENT0("flutter", "CompositorContext::ScopedFrame::Raster");
   bool root_needs_readback = layer_tree.Preroll(*this, ignore_raster_cache);
   bool needs_save_layer = root_needs_readback && !surface_supports_readback();
@@ -85,6 +87,20 @@ RasterStatus CompositorContext::ScopedFrame::Raster(
   if (post_preroll_result == PostPrerollResult::kSkipAndRetryFrame) {
     return RasterStatus::kSkipAndRetry;
   }
+  // Embedders that provide the root canvas know the state of its target only
+  // once the platform views of the frame have been prerolled.
+  if (frame_damage && view_embedder_ && canvas() &&
+      canvas() == view_embedder_->GetRootCanvas()) {
+    frame_damage->SetExistingDamage(view_embedder_->GetExistingDamage());
+  }
+  SkAutoCanvasRestore auto_restore(canvas(), true);
+  if (frame_damage) {
+    SkRect clip_rect = frame_damage->ComputeClipRect(layer_tree);
+    if (canvas()) {
+      canvas()->clipRect(clip_rect);
+    }
+  }
+
   // Clearing canvas after preroll reduces one render target switch when preroll
   // paints some raster cache.
   if (canvas()) {
@@ -104,6 +120,65 @@ RasterStatus CompositorContext::ScopedFrame::Raster(
   return RasterStatus::kSuccess;
 }
 
+SkRect FrameDamage::ComputeClipRect(flutter::LayerTree& layer_tree) {
+  TRACE_EVENT0("flutter", "FrameDamage::ComputeClipRect");
+  frame_size_ = layer_tree.frame_size();
+  damage_ = std::nullopt;
+  if (!layer_tree.root_layer()) {
+    return kGiantRect;
+  }
+
+  // The paint regions of a layer tree can't be diffed against themselves,
+  // which happens when the last layer tree is drawn again.
+  const LayerTree* prev_layer_tree = prev_layer_tree_;
+  if (prev_layer_tree &&
+      (prev_layer_tree == &layer_tree || !prev_layer_tree->root_layer() ||
+       prev_layer_tree->frame_size() != frame_size_)) {
+    prev_layer_tree = nullptr;
+  }
+
+  const SkIRect frame_rect = SkIRect::MakeSize(frame_size_);
+  PaintRegionMap empty_paint_region_map;
+  DiffContext context(frame_size_, layer_tree.device_pixel_ratio(),
+                      layer_tree.paint_region_map(),
+                      prev_layer_tree ? prev_layer_tree->paint_region_map()
+                                      : empty_paint_region_map);
+  context.PushCullRect(SkRect::Make(frame_rect));
+  {
+    DiffContext::AutoSubtreeRestore subtree(&context);
+    if (!prev_layer_tree) {
+      context.MarkSubtreeDirty();
+    }
+    layer_tree.root_layer()->Diff(
+        &context, prev_layer_tree ? prev_layer_tree->root_layer() : nullptr);
+  }
+  context.statistics().LogStatistics();
+
+  // The framebuffer has to be painted completely if its content is unknown
+  // or doesn't match the previous layer tree.
+  damage_ = context.ComputeDamage(prev_layer_tree && existing_damage_
+                                      ? *existing_damage_
+                                      : frame_rect);
+  if (!prev_layer_tree) {
+    damage_->frame_damage = frame_rect;
+  }
+  return SkRect::Make(damage_->buffer_damage);
+}
+
+std::optional<SkIRect> FrameDamage::GetFrameDamage() const {
+  if (!damage_ || damage_->frame_damage == SkIRect::MakeSize(frame_size_)) {
+    return std::nullopt;
+  }
+  return damage_->frame_damage;
+}
+
+std::optional<SkIRect> FrameDamage::GetBufferDamage() const {
+  if (!damage_ || damage_->buffer_damage == SkIRect::MakeSize(frame_size_)) {
+    return std::nullopt;
+  }
+  return damage_->buffer_damage;
+}
+
 void CompositorContext::OnGrContextCreated() {
   texture_registry_.OnGrContextCreated();
   raster_cache_.Clear();
@@ -6,12 +6,15 @@
 #define FLUTTER_FLOW_COMPOSITOR_CONTEXT_H_
 
 #include <memory>
+#include <optional>
 #include <string>
 
 #include "flutter/common/graphics/texture.h"
+#include "flutter/flow/diff_context.h"
 #include "flutter/flow/embedded_views.h"
 #include "flutter/flow/instrumentation.h"
 #include "flutter/flow/raster_cache.h"
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/macros.h"
 #include "flutter/fml/raster_thread_merger.h"
 #include "third_party/skia/include/core/SkCanvas.h"
@@ -54,6 +57,45 @@ enum class RasterStatus {
   kYielded,
 };
 
+// Computes the damage of a frame by diffing its layer tree against the layer
+// tree of the previous frame, which lets the rasterizer only repaint the part
+// of the framebuffer that changed.
+class FrameDamage {
+ public:
+  // Sets the layer tree of the last frame that was painted into the
+  // framebuffer. If unset, the whole frame is damaged.
+  void SetPreviousLayerTree(const LayerTree* prev_layer_tree) {
+    prev_layer_tree_ = prev_layer_tree;
+  }
+
+  // Sets the area of the framebuffer whose content differs from the previous
+  // layer tree, as reported by the surface. If unset, the content of the
+  // framebuffer is unknown and the whole framebuffer must be painted.
+  void SetExistingDamage(const std::optional<SkIRect>& existing_damage) {
+    existing_damage_ = existing_damage;
+  }
+
+  // Diffs |layer_tree| against the previous layer tree and returns the rect
+  // that painting must be clipped to. This also records the paint regions of
+  // the layers of |layer_tree|, which the next frame is diffed against.
+  SkRect ComputeClipRect(LayerTree& layer_tree);
+
+  // The area of the frame that changed since the previous frame. Unset if
+  // |ComputeClipRect| has not been called or the whole frame changed.
+  std::optional<SkIRect> GetFrameDamage() const;
+
+  // The area of the framebuffer that was painted. Unset if
+  // |ComputeClipRect| has not been called or the whole framebuffer was
+  // painted.
+  std::optional<SkIRect> GetBufferDamage() const;
+
+ private:
+  const LayerTree* prev_layer_tree_ = nullptr;
+  std::optional<SkIRect> existing_damage_;
+  SkISize frame_size_ = SkISize::MakeEmpty();
+  std::optional<Damage> damage_;
+};
+
 class CompositorContext {
  public:
   class ScopedFrame {
@@ -83,8 +125,11 @@ class CompositorContext {
 
     GrDirectContext* gr_context() const { return gr_context_; }
 
+    // Prerolls and paints |layer_tree|. If |frame_damage| is not null,
+    // painting is clipped to the damage of the frame.
     virtual RasterStatus Raster(LayerTree& layer_tree,
-                                bool ignore_raster_cache);
+                                bool ignore_raster_cache,
+                                FrameDamage* frame_damage = nullptr);
 
    private:
     CompositorContext& context_;
@@ -126,12 +171,40 @@ class CompositorContext {
 
   Stopwatch& ui_time() { return ui_time_; }
 
+  // The task runner used to rasterize DisplayLists in tiles when a frame
+  // is painted into a surface without a GrContext. May be null, in which
+  // case all painting happens on the raster thread.
+  const std::shared_ptr<fml::ConcurrentTaskRunner>& tiled_raster_task_runner()
+      const {
+    return tiled_raster_task_runner_;
+  }
+
+  void set_tiled_raster_task_runner(
+      std::shared_ptr<fml::ConcurrentTaskRunner> runner) {
+    tiled_raster_task_runner_ = std::move(runner);
+  }
+
+  // The task runner used to preroll the children of container layers
+  // concurrently. May be null, in which case the whole layer tree is
+  // prerolled on the raster thread.
+  const std::shared_ptr<fml::ConcurrentTaskRunner>& preroll_task_runner()
+      const {
+    return preroll_task_runner_;
+  }
+
+  void set_preroll_task_runner(
+      std::shared_ptr<fml::ConcurrentTaskRunner> runner) {
+    preroll_task_runner_ = std::move(runner);
+  }
+
  private:
   RasterCache raster_cache_;
   TextureRegistry texture_registry_;
   Counter frame_count_;
   Stopwatch raster_time_;
   Stopwatch ui_time_;
+  std::shared_ptr<fml::ConcurrentTaskRunner> tiled_raster_task_runner_;
+  std::shared_ptr<fml::ConcurrentTaskRunner> preroll_task_runner_;
 
   void BeginFrame(ScopedFrame& frame, bool enable_instrumentation);
 
@@ -0,0 +1,125 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/compositor_context.h"
+
+#include "flutter/flow/layers/layer_tree.h"
+#include "flutter/flow/testing/diff_context_test.h"
+#include "gtest/gtest.h"
+
+namespace flutter {
+namespace testing {
+
+class FrameDamageTest : public DiffContextTest {
+ public:
+  // Builds a layer tree with a layer for each of |layers|.
+  std::unique_ptr<LayerTree> CreateLayerTree(
+      std::initializer_list<std::shared_ptr<Layer>> layers) {
+    auto layer_tree = std::make_unique<LayerTree>(kFrameSize, 1.0f);
+    layer_tree->set_root_layer(CreateContainerLayer(layers));
+    return layer_tree;
+  }
+
+  static constexpr SkISize kFrameSize = SkISize::Make(500, 500);
+};
+
+TEST_F(FrameDamageTest, FirstFrameIsFullyDamaged) {
+  auto layer = CreateDisplayListLayer(
+      CreateDisplayList(SkRect::MakeXYWH(10, 10, 50, 50), SK_ColorRED));
+  auto layer_tree = CreateLayerTree({layer});
+
+  FrameDamage damage;
+  damage.SetExistingDamage(SkIRect::MakeEmpty());
+  EXPECT_EQ(damage.ComputeClipRect(*layer_tree), SkRect::Make(kFrameSize));
+  EXPECT_EQ(damage.GetFrameDamage(), std::nullopt);
+  EXPECT_EQ(damage.GetBufferDamage(), std::nullopt);
+}
+
+TEST_F(FrameDamageTest, RetainedLayersAreNotDamaged) {
+  auto layer = CreateDisplayListLayer(
+      CreateDisplayList(SkRect::MakeXYWH(10, 10, 50, 50), SK_ColorRED));
+  auto layer_tree_1 = CreateLayerTree({layer});
+  FrameDamage damage_1;
+  damage_1.ComputeClipRect(*layer_tree_1);
+
+  auto layer_tree_2 = CreateLayerTree({layer});
+  FrameDamage damage_2;
+  damage_2.SetPreviousLayerTree(layer_tree_1.get());
+  damage_2.SetExistingDamage(SkIRect::MakeEmpty());
+  EXPECT_TRUE(damage_2.ComputeClipRect(*layer_tree_2).isEmpty());
+  EXPECT_EQ(damage_2.GetFrameDamage(), SkIRect::MakeEmpty());
+  EXPECT_EQ(damage_2.GetBufferDamage(), SkIRect::MakeEmpty());
+}
+
+TEST_F(FrameDamageTest, ChangedLayersAreDamaged) {
+  auto cursor = CreateDisplayListLayer(
+      CreateDisplayList(SkRect::MakeXYWH(100, 100, 2, 20), SK_ColorBLACK));
+  auto text = CreateDisplayListLayer(
+      CreateDisplayList(SkRect::MakeXYWH(0, 0, 300, 50), SK_ColorBLUE));
+  auto layer_tree_1 = CreateLayerTree({text, cursor});
+  FrameDamage damage_1;
+  damage_1.ComputeClipRect(*layer_tree_1);
+
+  // The cursor blinks off.
+  auto layer_tree_2 = CreateLayerTree({text});
+  FrameDamage damage_2;
+  damage_2.SetPreviousLayerTree(layer_tree_1.get());
+  damage_2.SetExistingDamage(SkIRect::MakeEmpty());
+  EXPECT_EQ(damage_2.ComputeClipRect(*layer_tree_2),
+            SkRect::MakeXYWH(100, 100, 2, 20));
+  EXPECT_EQ(damage_2.GetFrameDamage(), SkIRect::MakeXYWH(100, 100, 2, 20));
+  EXPECT_EQ(damage_2.GetBufferDamage(), SkIRect::MakeXYWH(100, 100, 2, 20));
+}
+
+TEST_F(FrameDamageTest, ExistingDamageIsRepainted) {
+  auto layer = CreateDisplayListLayer(
+      CreateDisplayList(SkRect::MakeXYWH(10, 10, 50, 50), SK_ColorRED));
+  auto layer_tree_1 = CreateLayerTree({layer});
+  FrameDamage damage_1;
+  damage_1.ComputeClipRect(*layer_tree_1);
+
+  auto layer_tree_2 = CreateLayerTree({layer});
+  FrameDamage damage_2;
+  damage_2.SetPreviousLayerTree(layer_tree_1.get());
+  damage_2.SetExistingDamage(SkIRect::MakeXYWH(200, 200, 10, 10));
+  EXPECT_EQ(damage_2.ComputeClipRect(*layer_tree_2),
+            SkRect::MakeXYWH(200, 200, 10, 10));
+  EXPECT_EQ(damage_2.GetFrameDamage(), SkIRect::MakeEmpty());
+  EXPECT_EQ(damage_2.GetBufferDamage(), SkIRect::MakeXYWH(200, 200, 10, 10));
+}
+
+TEST_F(FrameDamageTest, UnknownFramebufferIsFullyPainted) {
+  auto layer = CreateDisplayListLayer(
+      CreateDisplayList(SkRect::MakeXYWH(10, 10, 50, 50), SK_ColorRED));
+  auto layer_tree_1 = CreateLayerTree({layer});
+  FrameDamage damage_1;
+  damage_1.ComputeClipRect(*layer_tree_1);
+
+  auto layer_tree_2 = CreateLayerTree({layer});
+  FrameDamage damage_2;
+  damage_2.SetPreviousLayerTree(layer_tree_1.get());
+  EXPECT_EQ(damage_2.ComputeClipRect(*layer_tree_2), SkRect::Make(kFrameSize));
+  EXPECT_EQ(damage_2.GetFrameDamage(), SkIRect::MakeEmpty());
+  EXPECT_EQ(damage_2.GetBufferDamage(), std::nullopt);
+}
+
+TEST_F(FrameDamageTest, ResizedFrameIsFullyDamaged) {
+  auto layer = CreateDisplayListLayer(
+      CreateDisplayList(SkRect::MakeXYWH(10, 10, 50, 50), SK_ColorRED));
+  auto layer_tree_1 = std::make_unique<LayerTree>(SkISize::Make(400, 400), 1);
+  layer_tree_1->set_root_layer(CreateContainerLayer(layer));
+  FrameDamage damage_1;
+  damage_1.ComputeClipRect(*layer_tree_1);
+
+  auto layer_tree_2 = CreateLayerTree({layer});
+  FrameDamage damage_2;
+  damage_2.SetPreviousLayerTree(layer_tree_1.get());
+  damage_2.SetExistingDamage(SkIRect::MakeEmpty());
+  EXPECT_EQ(damage_2.ComputeClipRect(*layer_tree_2), SkRect::Make(kFrameSize));
+  EXPECT_EQ(damage_2.GetFrameDamage(), std::nullopt);
+  EXPECT_EQ(damage_2.GetBufferDamage(), std::nullopt);
+}
+
+}  // namespace testing
+}  // namespace flutter
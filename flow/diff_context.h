@@ -15,8 +15,6 @@
 
 namespace flutter {
 
-#ifdef FLUTTER_ENABLE_DIFF_CONTEXT
-
 class Layer;
 
 // Represents area that needs to be updated in front buffer (frame_damage) and
@@ -205,8 +203,6 @@ class DiffContext {
   Statistics statistics_;
 };
 
-#endif  // FLUTTER_ENABLE_DIFF_CONTEXT
-
 }  // namespace flutter
 
 #endif  // FLUTTER_FLOW_DIFF_CONTEXT_H_
@@ -2,11 +2,14 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <algorithm>
+#include <cstring>
 #include <type_traits>
 
 #include "flutter/flow/display_list.h"
 #include "flutter/flow/display_list_canvas.h"
 #include "flutter/flow/display_list_utils.h"
+#include "flutter/flow/rtree.h"
 #include "flutter/fml/logging.h"
 
 #include "third_party/skia/include/core/SkImageFilter.h"
@@ -48,6 +51,84 @@ enum class DisplayListCompare {
   kEqual,
 };
 
+// Accumulates the content hash of a DisplayList, see
+// DisplayList::content_hash().
+//
+// The hash follows the same rules as the comparison above. Most Ops
+// are hashed as a block of bytes, which includes the addresses of the
+// objects that they hold through sk_sp<> references. An Op that
+// overrides DLOp::equals() to perform a deep compare must also override
+// DLOp::hash() to hash the same values that it compares so that Ops
+// which compare as equal also produce the same hash.
+class DisplayListHasher {
+ public:
+  void Add(uint32_t value) { hash_ = (hash_ ^ value) * kPrime; }
+  void Add(SkScalar value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    Add(bits);
+  }
+
+  void AddBytes(const void* bytes, size_t length) {
+    const uint8_t* ptr = static_cast<const uint8_t*>(bytes);
+    const uint8_t* end = ptr + length;
+    for (; ptr + sizeof(uint32_t) <= end; ptr += sizeof(uint32_t)) {
+      uint32_t word;
+      memcpy(&word, ptr, sizeof(word));
+      Add(word);
+    }
+    for (; ptr < end; ptr++) {
+      Add(static_cast<uint32_t>(*ptr));
+    }
+  }
+
+  void AddPath(const SkPath& path) {
+    Add(static_cast<uint32_t>(path.getFillType()));
+    SkPath::RawIter iter(path);
+    SkPoint points[4];
+    SkPath::Verb verb;
+    while ((verb = iter.next(points)) != SkPath::kDone_Verb) {
+      Add(static_cast<uint32_t>(verb));
+      int count = 0;
+      switch (verb) {
+        case SkPath::kMove_Verb:
+          count = 1;
+          break;
+        case SkPath::kLine_Verb:
+          count = 2;
+          break;
+        case SkPath::kQuad_Verb:
+          count = 3;
+          break;
+        case SkPath::kConic_Verb:
+          count = 3;
+          Add(iter.conicWeight());
+          break;
+        case SkPath::kCubic_Verb:
+          count = 4;
+          break;
+        default:
+          break;
+      }
+      // Every verb other than a move repeats the last point of the
+      // previous verb as its first point.
+      for (int i = verb == SkPath::kMove_Verb ? 0 : 1; i < count; i++) {
+        Add(points[i].fX);
+        Add(points[i].fY);
+      }
+    }
+  }
+
+  uint64_t hash() const { return hash_; }
+
+ private:
+  // The 64-bit FNV parameters, applied to 32-bit words.
+  static constexpr uint64_t kOffsetBasis = 0xcbf29ce484222325ull;
+  static constexpr uint64_t kPrime = 0x100000001b3ull;
+
+  uint64_t hash_ = kOffsetBasis;
+};
+
 #pragma pack(push, DLOp_Alignment, 8)
 
 // Assuming a 64-bit platform (most of our platforms at this time?)
@@ -67,6 +148,9 @@ struct DLOp {
   DisplayListCompare equals(const DLOp* other) const {
     return DisplayListCompare::kUseBulkCompare;
   }
+
+  // Returns false if the Op should be hashed as a block of bytes.
+  bool hash(DisplayListHasher& hasher) const { return false; }
 };
 
 // 4 byte header + 4 byte payload packs into minimum 8 bytes
@@ -78,7 +162,8 @@ struct DLOp {
                                                              \
     const bool value;                                        \
                                                              \
-    void dispatch(Dispatcher& dispatcher) const {            \
+    template <typename D>                                    \
+    void dispatch(D& dispatcher) const {                     \
       dispatcher.set##name(value);                           \
     }                                                        \
   };
@@ -96,7 +181,8 @@ DEFINE_SET_BOOL_OP(InvertColors)
                                                                    \
     const SkPaint::name value;                                     \
                                                                    \
-    void dispatch(Dispatcher& dispatcher) const {                  \
+    template <typename D>                                          \
+    void dispatch(D& dispatcher) const {                           \
       dispatcher.setStroke##name(value);                           \
     }                                                              \
   };
@@ -112,7 +198,8 @@ struct SetStyleOp final : DLOp {
 
   const SkPaint::Style style;
 
-  void dispatch(Dispatcher& dispatcher) const { dispatcher.setStyle(style); }
+  template <typename D>
+  void dispatch(D& dispatcher) const { dispatcher.setStyle(style); }
 };
 // 4 byte header + 4 byte payload packs into minimum 8 bytes
 struct SetStrokeWidthOp final : DLOp {
@@ -122,7 +209,8 @@ struct SetStrokeWidthOp final : DLOp {
 
   const SkScalar width;
 
-  void dispatch(Dispatcher& dispatcher) const {
+  template <typename D>
+  void dispatch(D& dispatcher) const {
     dispatcher.setStrokeWidth(width);
   }
 };
@@ -134,7 +222,8 @@ struct SetStrokeMiterOp final : DLOp {
 
   const SkScalar limit;
 
-  void dispatch(Dispatcher& dispatcher) const {
+  template <typename D>
+  void dispatch(D& dispatcher) const {
     dispatcher.setStrokeMiter(limit);
   }
 };
@@ -147,7 +236,8 @@ struct SetColorOp final : DLOp {
 
   const SkColor color;
 
-  void dispatch(Dispatcher& dispatcher) const { dispatcher.setColor(color); }
+  template <typename D>
+  void dispatch(D& dispatcher) const { dispatcher.setColor(color); }
 };
 // 4 byte header + 4 byte payload packs into minimum 8 bytes
 struct SetBlendModeOp final : DLOp {
@@ -157,7 +247,8 @@ struct SetBlendModeOp final : DLOp {
 
   const SkBlendMode mode;
 
-  void dispatch(Dispatcher& dispatcher) const { dispatcher.setBlendMode(mode); }
+  template <typename D>
+  void dispatch(D& dispatcher) const { dispatcher.setBlendMode(mode); }
 };
 
 // Clear: 4 byte header + unused 4 byte payload uses 8 bytes
@@ -171,7 +262,8 @@ struct SetBlendModeOp final : DLOp {
                                                                       \
     Clear##name##Op() {}                                              \
                                                                       \
-    void dispatch(Dispatcher& dispatcher) const {                     \
+    template <typename D>                                             \
+    void dispatch(D& dispatcher) const {                              \
       dispatcher.set##name(nullptr);                                  \
     }                                                                 \
   };                                                                  \
@@ -182,7 +274,8 @@ struct SetBlendModeOp final : DLOp {
                                                                       \
     sk_sp<Sk##name> field;                                            \
                                                                       \
-    void dispatch(Dispatcher& dispatcher) const {                     \
+    template <typename D>                                             \
+    void dispatch(D& dispatcher) const {                              \
       dispatcher.set##name(field);                                    \
     }                                                                 \
   };
@@ -205,7 +298,8 @@ DEFINE_SET_CLEAR_SKREF_OP(PathEffect, effect)
                                                                            \
     SkScalar sigma;                                                        \
                                                                            \
-    void dispatch(Dispatcher& dispatcher) const {                          \
+    template <typename D>                                                  \
+    void dispatch(D& dispatcher) const {                                   \
       dispatcher.setMaskBlurFilter(style, sigma);                          \
     }                                                                      \
   };
@@ -221,7 +315,8 @@ struct SaveOp final : DLOp {
 
   SaveOp() {}
 
-  void dispatch(Dispatcher& dispatcher) const { dispatcher.save(); }
+  template <typename D>
+  void dispatch(D& dispatcher) const { dispatcher.save(); }
 };
 // 4 byte header + 4 byte payload packs into minimum 8 bytes
 struct SaveLayerOp final : DLOp {
@@ -231,7 +326,8 @@ struct SaveLayerOp final : DLOp {
 
   bool with_paint;
 
-  void dispatch(Dispatcher& dispatcher) const {
+  template <typename D>
+  void dispatch(D& dispatcher) const {
     dispatcher.saveLayer(nullptr, with_paint);
   }
 };
@@ -245,7 +341,8 @@ struct SaveLayerBoundsOp final : DLOp {
   bool with_paint;
   const SkRect rect;
 
-  void dispatch(Dispatcher& dispatcher) const {
+  template <typename D>
+  void dispatch(D& dispatcher) const {
     dispatcher.saveLayer(&rect, with_paint);
   }
 };
@@ -255,7 +352,8 @@ struct RestoreOp final : DLOp {
 
   RestoreOp() {}
 
-  void dispatch(Dispatcher& dispatcher) const { dispatcher.restore(); }
+  template <typename D>
+  void dispatch(D& dispatcher) const { dispatcher.restore(); }
 };
 
 // 4 byte header + 8 byte payload uses 12 bytes but is rounded up to 16 bytes
@@ -268,7 +366,8 @@ struct TranslateOp final : DLOp {
   const SkScalar tx;
   const SkScalar ty;
 
-  void dispatch(Dispatcher& dispatcher) const { dispatcher.translate(tx, ty); }
+  template <typename D>
+  void dispatch(D& dispatcher) const { dispatcher.translate(tx, ty); }
 };
 // 4 byte header + 8 byte payload uses 12 bytes but is rounded up to 16 bytes
 // (4 bytes unused)
@@ -280,7 +379,8 @@ struct ScaleOp final : DLOp {
   const SkScalar sx;
   const SkScalar sy;
 
-  void dispatch(Dispatcher& dispatcher) const { dispatcher.scale(sx, sy); }
+  template <typename D>
+  void dispatch(D& dispatcher) const { dispatcher.scale(sx, sy); }
 };
 // 4 byte header + 4 byte payload packs into minimum 8 bytes
 struct RotateOp final : DLOp {
@@ -290,7 +390,8 @@ struct RotateOp final : DLOp {
 
   const SkScalar degrees;
 
-  void dispatch(Dispatcher& dispatcher) const { dispatcher.rotate(degrees); }
+  template <typename D>
+  void dispatch(D& dispatcher) const { dispatcher.rotate(degrees); }
 };
 // 4 byte header + 8 byte payload uses 12 bytes but is rounded up to 16 bytes
 // (4 bytes unused)
@@ -302,7 +403,8 @@ struct SkewOp final : DLOp {
   const SkScalar sx;
   const SkScalar sy;
 
-  void dispatch(Dispatcher& dispatcher) const { dispatcher.skew(sx, sy); }
+  template <typename D>
+  void dispatch(D& dispatcher) const { dispatcher.skew(sx, sy); }
 };
 // 4 byte header + 24 byte payload uses 28 bytes but is rounded up to 32 bytes
 // (4 bytes unused)
@@ -318,7 +420,8 @@ struct Transform2DAffineOp final : DLOp {
   const SkScalar mxx, mxy, mxt;
   const SkScalar myx, myy, myt;
 
-  void dispatch(Dispatcher& dispatcher) const {
+  template <typename D>
+  void dispatch(D& dispatcher) const {
     dispatcher.transform2DAffine(mxx, mxy, mxt,  //
                                  myx, myy, myt);
   }
@@ -345,7 +448,8 @@ struct TransformFullPerspectiveOp final : DLOp {
   const SkScalar mzx, mzy, mzz, mzt;
   const SkScalar mwx, mwy, mwz, mwt;
 
-  void dispatch(Dispatcher& dispatcher) const {
+  template <typename D>
+  void dispatch(D& dispatcher) const {
     dispatcher.transformFullPerspective(mxx, mxy, mxz, mxt,  //
                                         myx, myy, myz, myt,  //
                                         mzx, mzy, mzz, mzt,  //
@@ -373,7 +477,8 @@ struct TransformFullPerspectiveOp final : DLOp {
     const bool is_aa;                                                      \
     const Sk##shapetype shape;                                             \
                                                                            \
-    void dispatch(Dispatcher& dispatcher) const {                          \
+    template <typename D>                                                  \
+    void dispatch(D& dispatcher) const {                                   \
       dispatcher.clip##shapetype(shape, SkClipOp::k##clipop, is_aa);       \
     }                                                                      \
   };
@@ -393,7 +498,8 @@ DEFINE_CLIP_SHAPE_OP(RRect, Difference)
     const bool is_aa;                                                    \
     const SkPath path;                                                   \
                                                                          \
-    void dispatch(Dispatcher& dispatcher) const {                        \
+    template <typename D>                                                \
+    void dispatch(D& dispatcher) const {                                 \
       dispatcher.clipPath(path, SkClipOp::k##clipop, is_aa);             \
     }                                                                    \
                                                                          \
@@ -401,6 +507,13 @@ DEFINE_CLIP_SHAPE_OP(RRect, Difference)
       return is_aa == other->is_aa && path == other->path                \
                  ? DisplayListCompare::kEqual                            \
                  : DisplayListCompare::kNotEqual;                        \
+    }                                                                    \
+                                                                         \
+    bool hash(DisplayListHasher& hasher) const {                         \
+      hasher.Add(static_cast<uint32_t>(kType));                          \
+      hasher.Add(static_cast<uint32_t>(is_aa));                          \
+      hasher.AddPath(path);                                              \
+      return true;                                                       \
     }                                                                    \
   };
 DEFINE_CLIP_PATH_OP(Intersect)
@@ -413,7 +526,8 @@ struct DrawPaintOp final : DLOp {
 
   DrawPaintOp() {}
 
-  void dispatch(Dispatcher& dispatcher) const { dispatcher.drawPaint(); }
+  template <typename D>
+  void dispatch(D& dispatcher) const { dispatcher.drawPaint(); }
 };
 // 4 byte header + 8 byte payload uses 12 bytes but is rounded up to 16 bytes
 // (4 bytes unused)
@@ -425,7 +539,8 @@ struct DrawColorOp final : DLOp {
   const SkColor color;
   const SkBlendMode mode;
 
-  void dispatch(Dispatcher& dispatcher) const {
+  template <typename D>
+  void dispatch(D& dispatcher) const {
     dispatcher.drawColor(color, mode);
   }
 };
@@ -443,7 +558,8 @@ struct DrawColorOp final : DLOp {
                                                                  \
     const arg_type arg_name;                                     \
                                                                  \
-    void dispatch(Dispatcher& dispatcher) const {                \
+    template <typename D>                                        \
+    void dispatch(D& dispatcher) const {                         \
       dispatcher.draw##op_name(arg_name);                        \
     }                                                            \
   };
@@ -461,12 +577,19 @@ struct DrawPathOp final : DLOp {
 
   const SkPath path;
 
-  void dispatch(Dispatcher& dispatcher) const { dispatcher.drawPath(path); }
+  template <typename D>
+  void dispatch(D& dispatcher) const { dispatcher.drawPath(path); }
 
   DisplayListCompare equals(const DrawPathOp* other) const {
     return path == other->path ? DisplayListCompare::kEqual
                                : DisplayListCompare::kNotEqual;
   }
+
+  bool hash(DisplayListHasher& hasher) const {
+    hasher.Add(static_cast<uint32_t>(kType));
+    hasher.AddPath(path);
+    return true;
+  }
 };
 
 // The common data is a 4 byte header with an unused 4 bytes
@@ -485,7 +608,8 @@ struct DrawPathOp final : DLOp {
     const type1 name1;                                           \
     const type2 name2;                                           \
                                                                  \
-    void dispatch(Dispatcher& dispatcher) const {                \
+    template <typename D>                                        \
+    void dispatch(D& dispatcher) const {                         \
       dispatcher.draw##op_name(name1, name2);                    \
     }                                                            \
   };
@@ -506,7 +630,8 @@ struct DrawArcOp final : DLOp {
   const SkScalar sweep;
   const bool center;
 
-  void dispatch(Dispatcher& dispatcher) const {
+  template <typename D>
+  void dispatch(D& dispatcher) const {
     dispatcher.drawArc(bounds, start, sweep, center);
   }
 };
@@ -525,7 +650,8 @@ struct DrawArcOp final : DLOp {
                                                                        \
     const uint32_t count;                                              \
                                                                        \
-    void dispatch(Dispatcher& dispatcher) const {                      \
+    template <typename D>                                              \
+    void dispatch(D& dispatcher) const {                               \
       const SkPoint* pts = reinterpret_cast<const SkPoint*>(this + 1); \
       dispatcher.drawPoints(SkCanvas::PointMode::mode, count, pts);    \
     }                                                                  \
@@ -545,7 +671,8 @@ struct DrawVerticesOp final : DLOp {
   const SkBlendMode mode;
   const sk_sp<SkVertices> vertices;
 
-  void dispatch(Dispatcher& dispatcher) const {
+  template <typename D>
+  void dispatch(D& dispatcher) const {
     dispatcher.drawVertices(vertices, mode);
   }
 };
@@ -564,7 +691,8 @@ struct DrawVerticesOp final : DLOp {
     const SkSamplingOptions sampling;                                  \
     const sk_sp<SkImage> image;                                        \
                                                                        \
-    void dispatch(Dispatcher& dispatcher) const {                      \
+    template <typename D>                                              \
+    void dispatch(D& dispatcher) const {                               \
       dispatcher.drawImage(image, point, sampling, with_attributes);   \
     }                                                                  \
   };
@@ -596,7 +724,8 @@ struct DrawImageRectOp final : DLOp {
   const SkCanvas::SrcRectConstraint constraint;
   const sk_sp<SkImage> image;
 
-  void dispatch(Dispatcher& dispatcher) const {
+  template <typename D>
+  void dispatch(D& dispatcher) const {
     dispatcher.drawImageRect(image, src, dst, sampling, render_with_attributes,
                              constraint);
   }
@@ -618,7 +747,8 @@ struct DrawImageRectOp final : DLOp {
     const SkFilterMode filter;                                                 \
     const sk_sp<SkImage> image;                                                \
                                                                                \
-    void dispatch(Dispatcher& dispatcher) const {                              \
+    template <typename D>                                                      \
+    void dispatch(D& dispatcher) const {                                       \
       dispatcher.drawImageNine(image, center, dst, filter,                     \
                                render_with_attributes);                        \
     }                                                                          \
@@ -657,7 +787,8 @@ struct DrawImageLatticeOp final : DLOp {
   const SkRect dst;
   const sk_sp<SkImage> image;
 
-  void dispatch(Dispatcher& dispatcher) const {
+  template <typename D>
+  void dispatch(D& dispatcher) const {
     const int* xDivs = reinterpret_cast<const int*>(this + 1);
     const int* yDivs = reinterpret_cast<const int*>(xDivs + x_count);
     const SkColor* colors =
@@ -720,7 +851,8 @@ struct DrawAtlasOp final : DrawAtlasBaseOp {
                         has_colors,
                         render_with_attributes) {}
 
-  void dispatch(Dispatcher& dispatcher) const {
+  template <typename D>
+  void dispatch(D& dispatcher) const {
     const SkRSXform* xform = reinterpret_cast<const SkRSXform*>(this + 1);
     const SkRect* tex = reinterpret_cast<const SkRect*>(xform + count);
     const SkColor* colors =
@@ -755,7 +887,8 @@ struct DrawAtlasCulledOp final : DrawAtlasBaseOp {
 
   const SkRect cull_rect;
 
-  void dispatch(Dispatcher& dispatcher) const {
+  template <typename D>
+  void dispatch(D& dispatcher) const {
     const SkRSXform* xform = reinterpret_cast<const SkRSXform*>(this + 1);
     const SkRect* tex = reinterpret_cast<const SkRect*>(xform + count);
     const SkColor* colors =
@@ -777,7 +910,8 @@ struct DrawSkPictureOp final : DLOp {
   const bool render_with_attributes;
   const sk_sp<SkPicture> picture;
 
-  void dispatch(Dispatcher& dispatcher) const {
+  template <typename D>
+  void dispatch(D& dispatcher) const {
     dispatcher.drawPicture(picture, nullptr, render_with_attributes);
   }
 };
@@ -797,7 +931,8 @@ struct DrawSkPictureMatrixOp final : DLOp {
   const sk_sp<SkPicture> picture;
   const SkMatrix matrix;
 
-  void dispatch(Dispatcher& dispatcher) const {
+  template <typename D>
+  void dispatch(D& dispatcher) const {
     dispatcher.drawPicture(picture, &matrix, render_with_attributes);
   }
 };
@@ -812,7 +947,8 @@ struct DrawDisplayListOp final : DLOp {
 
   sk_sp<DisplayList> display_list;
 
-  void dispatch(Dispatcher& dispatcher) const {
+  template <typename D>
+  void dispatch(D& dispatcher) const {
     dispatcher.drawDisplayList(display_list);
   }
 };
@@ -829,7 +965,8 @@ struct DrawTextBlobOp final : DLOp {
   const SkScalar y;
   const sk_sp<SkTextBlob> blob;
 
-  void dispatch(Dispatcher& dispatcher) const {
+  template <typename D>
+  void dispatch(D& dispatcher) const {
     dispatcher.drawTextBlob(blob, x, y);
   }
 };
@@ -850,7 +987,8 @@ struct DrawTextBlobOp final : DLOp {
     const SkScalar dpr;                                                   \
     const SkPath path;                                                    \
                                                                           \
-    void dispatch(Dispatcher& dispatcher) const {                         \
+    template <typename D>                                                 \
+    void dispatch(D& dispatcher) const {                                  \
       dispatcher.drawShadow(path, color, elevation, transparent_occluder, \
                             dpr);                                         \
     }                                                                     \
@@ -861,15 +999,285 @@ DEFINE_DRAW_SHADOW_OP(ShadowTransparentOccluder, true)
 
 #pragma pack(pop, DLOp_Alignment)
 
-void DisplayList::ComputeBounds() {
-  DisplayListBoundsCalculator calculator(&bounds_cull_);
-  Dispatch(calculator);
-  bounds_ = calculator.bounds();
+static bool IsAttributeOp(DisplayListOpType type) {
+  return type < DisplayListOpType::kSave;
 }
 
-void DisplayList::Dispatch(Dispatcher& dispatcher,
-                           uint8_t* ptr,
-                           uint8_t* end) const {
+static bool IsRenderingOp(DisplayListOpType type) {
+  return type >= DisplayListOpType::kDrawPaint;
+}
+
+// The entries of the rtree are either a single rendering op or an
+// entire outermost saveLayer group, each recorded as a range of byte
+// offsets into the storage of the DisplayList. The rects inserted into
+// the rtree are indexed in the same order as the |entries|.
+struct DisplayList::RTreeData {
+  struct OpRange {
+    size_t start;
+    size_t end;
+  };
+
+  // A save/restore group outside of any saveLayer along with the
+  // indices of the |entries| that it encloses.
+  struct SaveRange {
+    size_t start;
+    size_t end;
+    int first_entry;
+    int end_entry;
+  };
+
+  sk_sp<RTree> rtree;
+  std::vector<OpRange> entries;
+  std::vector<SaveRange> saves;
+};
+
+// Tracks the bounds of the ops while they are recorded so that the
+// bounds of the DisplayList (and the spatial index used for culling) are
+// ready when it is built, without a second pass over the ops.
+class DisplayListBuilder::BoundsRecorder {
+ public:
+  BoundsRecorder(const SkRect& cull, bool prepare_rtree)
+      : cull_(cull), calculator_(&cull_) {
+    if (prepare_rtree) {
+      rtree_data_ = std::make_unique<DisplayList::RTreeData>();
+    }
+    calculator_.set_root_op_accumulator(&op_bounds_);
+  }
+
+  // Accumulates the bounds of the ops in the |end - ptr| bytes at |ptr|
+  // which start |offset| bytes into the storage of the builder.
+  void Record(uint8_t* ptr, uint8_t* end, size_t offset) {
+    if (!rtree_data_ && !can_apply_group_opacity_) {
+      // Nothing needs the bounds of the individual ops anymore.
+      DisplayList::DispatchOps(calculator_, ptr, end);
+      return;
+    }
+    while (ptr < end) {
+      auto op = (const DLOp*)ptr;
+      uint8_t* next = ptr + op->size;
+      size_t next_offset = offset + op->size;
+      op_bounds_ = BoundsAccumulator();
+      DisplayList::DispatchOps(calculator_, ptr, next);
+      if (can_apply_group_opacity_) {
+        CheckGroupOpacity(op);
+      }
+      if (rtree_data_) {
+        IndexOp(op->type, offset, next_offset);
+      }
+      ptr = next;
+      offset = next_offset;
+    }
+  }
+
+  SkRect bounds() const { return calculator_.bounds(); }
+
+  // See |DisplayList::can_apply_group_opacity|.
+  bool can_apply_group_opacity() const { return can_apply_group_opacity_; }
+
+  // Returns the spatial index over all recorded ops, or nullptr if the
+  // recorder was not asked to prepare one.
+  std::unique_ptr<DisplayList::RTreeData> TakeRTree() {
+    if (!rtree_data_) {
+      return nullptr;
+    }
+    FML_DCHECK(save_stack_.empty());
+    rtree_data_->rtree = sk_make_sp<RTree>();
+    rtree_data_->rtree->insert(rects_.data(), static_cast<int>(rects_.size()));
+    return std::move(rtree_data_);
+  }
+
+ private:
+  // One element per outstanding save or saveLayer. A plain save outside
+  // of any saveLayer records its index into |rtree_data_->saves|.
+  struct SaveInfo {
+    bool is_layer;
+    int save_index;
+  };
+
+  const SkRect cull_;
+  DisplayListBoundsCalculator calculator_;
+  BoundsAccumulator op_bounds_;
+  std::unique_ptr<DisplayList::RTreeData> rtree_data_;
+  std::vector<SkRect> rects_;
+  std::vector<SaveInfo> save_stack_;
+  int layer_depth_ = 0;
+  size_t layer_start_ = 0;
+
+  // The state used to decide whether a group opacity can be applied
+  // to the individual rendering ops.
+  bool can_apply_group_opacity_ = true;
+  SkRect rendered_bounds_ = SkRect::MakeEmpty();
+  bool blend_mode_is_src_over_ = true;
+  bool has_blender_ = false;
+  bool has_color_filter_ = false;
+  bool inverts_colors_ = false;
+  bool has_image_filter_ = false;
+
+  // Whether the current attributes render the same with a modulated
+  // alpha as they would inside a layer with that alpha.
+  bool AttributesCanApplyOpacity() const {
+    return blend_mode_is_src_over_ && !has_blender_ && !has_color_filter_ &&
+           !inverts_colors_ && !has_image_filter_;
+  }
+
+  // Clears |can_apply_group_opacity_| unless |op|, whose bounds were
+  // just accumulated into |op_bounds_|, can have its alpha modulated.
+  void CheckGroupOpacity(const DLOp* op) {
+    bool uses_attributes = true;
+    switch (op->type) {
+      case DisplayListOpType::kSetBlendMode:
+        blend_mode_is_src_over_ =
+            static_cast<const SetBlendModeOp*>(op)->mode ==
+            SkBlendMode::kSrcOver;
+        return;
+      case DisplayListOpType::kSetBlender:
+        has_blender_ = true;
+        return;
+      case DisplayListOpType::kClearBlender:
+        has_blender_ = false;
+        return;
+      case DisplayListOpType::kSetColorFilter:
+        has_color_filter_ = true;
+        return;
+      case DisplayListOpType::kClearColorFilter:
+        has_color_filter_ = false;
+        return;
+      case DisplayListOpType::kSetInvertColors:
+        inverts_colors_ = static_cast<const SetInvertColorsOp*>(op)->value;
+        return;
+      case DisplayListOpType::kSetImageFilter:
+        has_image_filter_ = true;
+        return;
+      case DisplayListOpType::kClearImageFilter:
+        has_image_filter_ = false;
+        return;
+
+      // The contents of a layer are blended with each other before the
+      // layer is blended with the ops around it.
+      case DisplayListOpType::kSaveLayer:
+      case DisplayListOpType::kSaveLayerBounds:
+      // These ops may overlap themselves, so modulating their alpha
+      // would let their overlapping parts show through each other. The
+      // glyphs of a text blob are blended one by one and may overlap
+      // through kerning, combining marks or emoji.
+      case DisplayListOpType::kDrawTextBlob:
+      case DisplayListOpType::kDrawPoints:
+      case DisplayListOpType::kDrawLines:
+      case DisplayListOpType::kDrawPolygon:
+      case DisplayListOpType::kDrawVertices:
+      case DisplayListOpType::kDrawAtlas:
+      case DisplayListOpType::kDrawAtlasCulled:
+      case DisplayListOpType::kDrawShadow:
+      case DisplayListOpType::kDrawShadowTransparentOccluder:
+        can_apply_group_opacity_ = false;
+        return;
+
+      case DisplayListOpType::kDrawColor:
+        if (static_cast<const DrawColorOp*>(op)->mode !=
+            SkBlendMode::kSrcOver) {
+          can_apply_group_opacity_ = false;
+          return;
+        }
+        uses_attributes = false;
+        break;
+      case DisplayListOpType::kDrawDisplayList:
+        if (!static_cast<const DrawDisplayListOp*>(op)
+                 ->display_list->can_apply_group_opacity()) {
+          can_apply_group_opacity_ = false;
+          return;
+        }
+        uses_attributes = false;
+        break;
+      case DisplayListOpType::kDrawImage:
+      case DisplayListOpType::kDrawImageNine:
+        uses_attributes = false;
+        break;
+      case DisplayListOpType::kDrawImageRect:
+        uses_attributes =
+            static_cast<const DrawImageRectOp*>(op)->render_with_attributes;
+        break;
+      case DisplayListOpType::kDrawImageLattice:
+        uses_attributes =
+            static_cast<const DrawImageLatticeOp*>(op)->with_paint;
+        break;
+      case DisplayListOpType::kDrawSkPicture:
+        uses_attributes =
+            static_cast<const DrawSkPictureOp*>(op)->render_with_attributes;
+        break;
+      case DisplayListOpType::kDrawSkPictureMatrix:
+        uses_attributes = static_cast<const DrawSkPictureMatrixOp*>(op)
+                              ->render_with_attributes;
+        break;
+
+      default:
+        if (!IsRenderingOp(op->type)) {
+          return;
+        }
+        break;
+    }
+    if ((uses_attributes && !AttributesCanApplyOpacity()) ||
+        calculator_.is_unbounded()) {
+      can_apply_group_opacity_ = false;
+      return;
+    }
+    SkRect op_bounds = op_bounds_.bounds();
+    if (SkRect::Intersects(rendered_bounds_, op_bounds)) {
+      can_apply_group_opacity_ = false;
+      return;
+    }
+    rendered_bounds_.join(op_bounds);
+  }
+
+  // Adds the op that spans from |offset| to |next_offset| to the index
+  // using the bounds that were just accumulated into |op_bounds_|.
+  void IndexOp(DisplayListOpType type, size_t offset, size_t next_offset) {
+    DisplayList::RTreeData* data = rtree_data_.get();
+    switch (type) {
+      case DisplayListOpType::kSave:
+        if (layer_depth_ == 0) {
+          save_stack_.push_back({false, static_cast<int>(data->saves.size())});
+          data->saves.push_back(
+              {offset, 0, static_cast<int>(data->entries.size()), 0});
+        } else {
+          save_stack_.push_back({false, -1});
+        }
+        break;
+      case DisplayListOpType::kSaveLayer:
+      case DisplayListOpType::kSaveLayerBounds:
+        if (layer_depth_++ == 0) {
+          layer_start_ = offset;
+        }
+        save_stack_.push_back({true, -1});
+        break;
+      case DisplayListOpType::kRestore: {
+        FML_DCHECK(!save_stack_.empty());
+        SaveInfo info = save_stack_.back();
+        save_stack_.pop_back();
+        if (info.is_layer) {
+          if (--layer_depth_ == 0) {
+            data->entries.push_back({layer_start_, next_offset});
+            rects_.push_back(op_bounds_.bounds());
+          }
+        } else if (info.save_index >= 0) {
+          DisplayList::RTreeData::SaveRange& save =
+              data->saves[info.save_index];
+          save.end = next_offset;
+          save.end_entry = static_cast<int>(data->entries.size());
+        }
+        break;
+      }
+      default:
+        if (layer_depth_ == 0 && IsRenderingOp(type)) {
+          data->entries.push_back({offset, next_offset});
+          rects_.push_back(op_bounds_.bounds());
+        }
+        break;
+    }
+  }
+};
+
+template <typename D>
+void DisplayList::DispatchOps(D& dispatcher, uint8_t* ptr, uint8_t* end) {
   while (ptr < end) {
     auto op = (const DLOp*)ptr;
     ptr += op->size;
@@ -891,6 +1299,96 @@ void DisplayList::Dispatch(Dispatcher& dispatcher,
   }
 }
 
+void DisplayList::Dispatch(Dispatcher& ctx) const {
+  DispatchT(ctx);
+}
+
+void DisplayList::Dispatch(Dispatcher& ctx, const SkRect& cull) const {
+  DispatchT(ctx, cull);
+}
+
+template <typename D>
+void DisplayList::DispatchT(D& ctx) const {
+  uint8_t* ptr = storage_.get();
+  DispatchOps(ctx, ptr, ptr + used_);
+}
+
+template <typename D>
+void DisplayList::DispatchT(D& ctx, const SkRect& cull) const {
+  uint8_t* start = storage_.get();
+  uint8_t* end = start + used_;
+  if (!rtree_) {
+    DispatchOps(ctx, start, end);
+    return;
+  }
+
+  std::vector<int> hits;
+  rtree_->rtree->search(cull, &hits);
+  std::sort(hits.begin(), hits.end());
+
+  const std::vector<RTreeData::OpRange>& entries = rtree_->entries;
+  const std::vector<RTreeData::SaveRange>& saves = rtree_->saves;
+  // |next_hit| always refers to the first hit that is not less than
+  // |entry| since both the entries and the hits are sorted by offset.
+  auto next_hit = hits.begin();
+  size_t entry = 0;
+  size_t save = 0;
+  uint8_t* ptr = start;
+  while (ptr < end) {
+    size_t offset = ptr - start;
+    if (save < saves.size() && saves[save].start == offset) {
+      const RTreeData::SaveRange& range = saves[save++];
+      FML_DCHECK(static_cast<int>(entry) == range.first_entry);
+      if (next_hit == hits.end() || *next_hit >= range.end_entry) {
+        // Nothing inside this save/restore group is visible.
+        DispatchAttributes(ctx, ptr, start + range.end);
+        ptr = start + range.end;
+        entry = range.end_entry;
+        while (save < saves.size() && saves[save].start < range.end) {
+          save++;
+        }
+        continue;
+      }
+    }
+    if (entry < entries.size() && entries[entry].start == offset) {
+      uint8_t* entry_end = start + entries[entry].end;
+      if (next_hit != hits.end() && *next_hit == static_cast<int>(entry)) {
+        DispatchOps(ctx, ptr, entry_end);
+        ++next_hit;
+      } else {
+        DispatchAttributes(ctx, ptr, entry_end);
+      }
+      ptr = entry_end;
+      entry++;
+      continue;
+    }
+    uint8_t* next = ptr + ((const DLOp*)ptr)->size;
+    DispatchOps(ctx, ptr, next);
+    ptr = next;
+  }
+}
+
+template <typename D>
+void DisplayList::DispatchAttributes(D& ctx, uint8_t* ptr, uint8_t* end) {
+  while (ptr < end) {
+    auto op = (const DLOp*)ptr;
+    uint8_t* next = ptr + op->size;
+    FML_DCHECK(next <= end);
+    if (IsAttributeOp(op->type)) {
+      DispatchOps(ctx, ptr, next);
+    }
+    ptr = next;
+  }
+}
+
+// The dispatchers supported by |DisplayList::DispatchT|.
+template void DisplayList::DispatchT(DisplayListCanvasDispatcher&) const;
+template void DisplayList::DispatchT(DisplayListCanvasDispatcher&,
+                                     const SkRect&) const;
+template void DisplayList::DispatchT(DisplayListBoundsCalculator&) const;
+template void DisplayList::DispatchT(DisplayListBoundsCalculator&,
+                                     const SkRect&) const;
+
 static void DisposeOps(uint8_t* ptr, uint8_t* end) {
   while (ptr < end) {
     auto op = (const DLOp*)ptr;
@@ -981,9 +1479,46 @@ static bool CompareOps(uint8_t* ptrA,
   return true;
 }
 
-void DisplayList::RenderTo(SkCanvas* canvas) const {
-  DisplayListCanvasDispatcher dispatcher(canvas);
-  Dispatch(dispatcher);
+static uint64_t HashOps(uint8_t* ptr, uint8_t* end) {
+  DisplayListHasher hasher;
+  while (ptr < end) {
+    auto op = (const DLOp*)ptr;
+    ptr += op->size;
+    FML_DCHECK(ptr <= end);
+    bool hashed;
+    switch (op->type) {
+#define DL_OP_HASH(name)                                     \
+  case DisplayListOpType::k##name:                           \
+    hashed = static_cast<const name##Op*>(op)->hash(hasher); \
+    break;
+
+      FOR_EACH_DISPLAY_LIST_OP(DL_OP_HASH)
+
+#undef DL_OP_HASH
+
+      default:
+        FML_DCHECK(false);
+        return 0;
+    }
+    if (!hashed) {
+      hasher.AddBytes(op, op->size);
+    }
+  }
+  return hasher.hash();
+}
+
+void DisplayList::RenderTo(SkCanvas* canvas, SkScalar opacity) const {
+  FML_DCHECK(opacity >= SK_Scalar1 || can_apply_group_opacity_);
+  DisplayListCanvasDispatcher dispatcher(canvas, opacity);
+  DispatchT(dispatcher);
+}
+
+void DisplayList::RenderTo(SkCanvas* canvas,
+                           const SkRect& cull,
+                           SkScalar opacity) const {
+  FML_DCHECK(opacity >= SK_Scalar1 || can_apply_group_opacity_);
+  DisplayListCanvasDispatcher dispatcher(canvas, opacity);
+  DispatchT(dispatcher, cull);
 }
 
 bool DisplayList::Equals(const DisplayList& other) const {
@@ -1001,21 +1536,29 @@ bool DisplayList::Equals(const DisplayList& other) const {
 DisplayList::DisplayList(uint8_t* ptr,
                          size_t used,
                          int op_count,
-                         const SkRect& cull)
+                         const SkRect& cull,
+                         std::shared_ptr<DisplayListStoragePool> storage_pool,
+                         size_t storage_size)
     : storage_(ptr),
       used_(used),
       op_count_(op_count),
+      storage_pool_(std::move(storage_pool)),
+      storage_size_(storage_size),
       bounds_({0, 0, -1, -1}),
       bounds_cull_(cull) {
   static std::atomic<uint32_t> nextID{1};
   do {
     unique_id_ = nextID.fetch_add(+1, std::memory_order_relaxed);
   } while (unique_id_ == 0);
+  content_hash_ = HashOps(ptr, ptr + used);
 }
 
 DisplayList::~DisplayList() {
   uint8_t* ptr = storage_.get();
   DisposeOps(ptr, ptr + used_);
+  if (storage_pool_ && storage_size_ > 0) {
+    storage_pool_->Release({storage_.release(), storage_size_});
+  }
 }
 
 #define DL_BUILDER_PAGE 4096
@@ -1034,16 +1577,11 @@ static void CopyV(void* dst, const S* src, int n, Rest&&... rest) {
 
 template <typename T, typename... Args>
 void* DisplayListBuilder::Push(size_t pod, int op_inc, Args&&... args) {
+  RecordBounds();
   size_t size = SkAlignPtr(sizeof(T) + pod);
   FML_DCHECK(size < (1 << 24));
   if (used_ + size > allocated_) {
-    static_assert(SkIsPow2(DL_BUILDER_PAGE),
-                  "This math needs updating for non-pow2.");
-    // Next greater multiple of DL_BUILDER_PAGE.
-    allocated_ = (used_ + size + DL_BUILDER_PAGE) & ~(DL_BUILDER_PAGE - 1);
-    storage_.realloc(allocated_);
-    FML_DCHECK(storage_.get());
-    memset(storage_.get() + used_, 0, allocated_ - used_);
+    Grow(used_ + size);
   }
   FML_DCHECK(used_ + size <= allocated_);
   auto op = (T*)(storage_.get() + used_);
@@ -1055,24 +1593,104 @@ void* DisplayListBuilder::Push(size_t pod, int op_inc, Args&&... args) {
   return op + 1;
 }
 
+void DisplayListBuilder::Grow(size_t size) {
+  if (storage_pool_) {
+    DisplayListStoragePool::Block block = storage_pool_->Acquire(size);
+    if (used_ > 0) {
+      memcpy(block.ptr, storage_.get(), used_);
+    }
+    storage_pool_->Release({storage_.release(), allocated_});
+    storage_.reset(block.ptr);
+    allocated_ = block.size;
+  } else {
+    static_assert(SkIsPow2(DL_BUILDER_PAGE),
+                  "This math needs updating for non-pow2.");
+    // Next greater multiple of DL_BUILDER_PAGE.
+    allocated_ = (size + DL_BUILDER_PAGE) & ~(DL_BUILDER_PAGE - 1);
+    void* storage = sk_realloc_throw(storage_.release(), allocated_);
+    storage_.reset(static_cast<uint8_t*>(storage));
+  }
+  FML_DCHECK(storage_.get());
+  memset(storage_.get() + used_, 0, allocated_ - used_);
+}
+
+void DisplayListBuilder::SetStoragePool(
+    std::shared_ptr<DisplayListStoragePool> pool,
+    size_t size_hint) {
+  FML_DCHECK(used_ == 0) << "The storage pool must be set before recording";
+  if (storage_) {
+    // Storage reserved by an earlier call goes back to its pool.
+    storage_pool_->Release({storage_.release(), allocated_});
+    allocated_ = 0;
+  }
+  storage_pool_ = std::move(pool);
+  if (storage_pool_ && size_hint > 0) {
+    Grow(size_hint);
+  }
+}
+
+void DisplayListBuilder::RecordBounds() {
+  if (bounds_offset_ < used_) {
+    uint8_t* ptr = storage_.get();
+    bounds_recorder_->Record(ptr + bounds_offset_, ptr + used_, bounds_offset_);
+    bounds_offset_ = used_;
+  }
+}
+
 sk_sp<DisplayList> DisplayListBuilder::Build() {
   while (save_level_ > 0) {
     restore();
   }
+  RecordBounds();
   size_t used = used_;
+  size_t allocated = allocated_;
   int count = op_count_;
   used_ = allocated_ = op_count_ = 0;
-  storage_.realloc(used);
-  return sk_sp<DisplayList>(
-      new DisplayList(storage_.release(), used, count, cull_));
+  bounds_offset_ = 0;
+  sk_sp<DisplayList> display_list;
+  if (storage_pool_ && used > allocated / 2) {
+    // The list adopts the pooled block as is, trading the unused tail of
+    // the block for not having to copy the ops.
+    display_list.reset(new DisplayList(storage_.release(), used, count, cull_,
+                                       storage_pool_, allocated));
+  } else if (storage_pool_) {
+    // A small list would pin a block that is mostly unused for as long as
+    // it is retained, so its ops move to storage of their own size and the
+    // block goes back to the pool.
+    uint8_t* storage = static_cast<uint8_t*>(sk_malloc_throw(used));
+    if (used > 0) {
+      memcpy(storage, storage_.get(), used);
+    }
+    storage_pool_->Release({storage_.release(), allocated});
+    display_list.reset(
+        new DisplayList(storage, used, count, cull_, storage_pool_, 0));
+  } else {
+    void* storage = sk_realloc_throw(storage_.release(), used);
+    storage_.reset(static_cast<uint8_t*>(storage));
+    display_list.reset(new DisplayList(storage_.release(), used, count, cull_));
+  }
+  display_list->bounds_ = bounds_recorder_->bounds();
+  display_list->can_apply_group_opacity_ =
+      bounds_recorder_->can_apply_group_opacity();
+  display_list->has_image_filters_ = has_image_filters_;
+  has_image_filters_ = false;
+  display_list->rtree_ = bounds_recorder_->TakeRTree();
+  bounds_recorder_ = std::make_unique<BoundsRecorder>(cull_, prepare_rtree_);
+  return display_list;
 }
 
-DisplayListBuilder::DisplayListBuilder(const SkRect& cull) : cull_(cull) {}
+DisplayListBuilder::DisplayListBuilder(const SkRect& cull, bool prepare_rtree)
+    : cull_(cull),
+      prepare_rtree_(prepare_rtree),
+      bounds_recorder_(std::make_unique<BoundsRecorder>(cull, prepare_rtree)) {}
 
 DisplayListBuilder::~DisplayListBuilder() {
   uint8_t* ptr = storage_.get();
   if (ptr) {
     DisposeOps(ptr, ptr + used_);
+    if (storage_pool_) {
+      storage_pool_->Release({storage_.release(), allocated_});
+    }
   }
 }
 
@@ -1117,6 +1735,9 @@ void DisplayListBuilder::setShader(sk_sp<SkShader> shader) {
       : Push<ClearShaderOp>(0, 0);
 }
 void DisplayListBuilder::setImageFilter(sk_sp<SkImageFilter> filter) {
+  if (filter) {
+    has_image_filters_ = true;
+  }
   filter  //
       ? Push<SetImageFilterOp>(0, 0, std::move(filter))
       : Push<ClearImageFilterOp>(0, 0);
@@ -1414,6 +2035,7 @@ void DisplayListBuilder::drawAtlas(const sk_sp<SkImage> atlas,
 void DisplayListBuilder::drawPicture(const sk_sp<SkPicture> picture,
                                      const SkMatrix* matrix,
                                      bool render_with_attributes) {
+  has_image_filters_ = true;
   matrix  //
       ? Push<DrawSkPictureMatrixOp>(0, 1, std::move(picture), *matrix,
                                     render_with_attributes)
@@ -1421,6 +2043,7 @@ void DisplayListBuilder::drawPicture(const sk_sp<SkPicture> picture,
 }
 void DisplayListBuilder::drawDisplayList(
     const sk_sp<DisplayList> display_list) {
+  has_image_filters_ |= display_list->has_image_filters();
   Push<DrawDisplayListOp>(0, 1, std::move(display_list));
 }
 void DisplayListBuilder::drawTextBlob(const sk_sp<SkTextBlob> blob,
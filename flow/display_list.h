@@ -5,6 +5,7 @@
 #ifndef FLUTTER_FLOW_DISPLAY_LIST_H_
 #define FLUTTER_FLOW_DISPLAY_LIST_H_
 
+#include "flutter/flow/display_list_storage_pool.h"
 #include "third_party/skia/include/core/SkBlender.h"
 #include "third_party/skia/include/core/SkBlurTypes.h"
 #include "third_party/skia/include/core/SkCanvas.h"
@@ -63,6 +64,9 @@
 
 namespace flutter {
 
+// The attribute ops must all precede |Save| and the rendering ops must
+// all follow |DrawPaint| as the culling dispatch classifies ops by
+// comparing their DisplayListOpType values.
 #define FOR_EACH_DISPLAY_LIST_OP(V) \
   V(SetAntiAlias)                   \
   V(SetDither)                      \
@@ -170,48 +174,133 @@ class DisplayList : public SkRefCnt {
       : used_(0),
         op_count_(0),
         unique_id_(0),
+        content_hash_(0),
         bounds_({0, 0, 0, 0}),
         bounds_cull_({0, 0, 0, 0}) {}
 
   ~DisplayList();
 
-  void Dispatch(Dispatcher& ctx) const {
-    uint8_t* ptr = storage_.get();
-    Dispatch(ctx, ptr, ptr + used_);
-  }
+  void Dispatch(Dispatcher& ctx) const;
 
-  void RenderTo(SkCanvas* canvas) const;
+  // Dispatch only the ops that might affect pixels inside |cull|, which
+  // is expressed in the coordinate space of the DisplayList.
+  //
+  // Rendering ops (and entire outermost saveLayer groups) whose bounds
+  // do not intersect |cull| are skipped along with any save/restore
+  // group outside of a saveLayer that contains no visible rendering ops.
+  // Attribute ops are always dispatched since their values persist
+  // beyond the restore() that ends the group that contains them.
+  //
+  // Culling requires the spatial index that is computed when the list
+  // is built by a DisplayListBuilder with |prepare_rtree| set. Without
+  // it this method dispatches every op, just like |Dispatch(ctx)|.
+  void Dispatch(Dispatcher& ctx, const SkRect& cull) const;
+
+  // Variants of |Dispatch| for a dispatcher whose type is known at
+  // compile time. When |D| is a final class every op is delivered with
+  // a direct (and possibly inlined) call rather than through the vtable
+  // of Dispatcher. They are only instantiated for the final dispatchers
+  // listed at the end of display_list.cc, any other dispatcher must use
+  // |Dispatch|.
+  template <typename D>
+  void DispatchT(D& ctx) const;
+  template <typename D>
+  void DispatchT(D& ctx, const SkRect& cull) const;
+
+  // Renders the list with the given |opacity| applied as if the list
+  // had been rendered inside a saveLayer with that alpha. An opacity
+  // less than 1 requires |can_apply_group_opacity|.
+  void RenderTo(SkCanvas* canvas, SkScalar opacity = SK_Scalar1) const;
+  void RenderTo(SkCanvas* canvas,
+                const SkRect& cull,
+                SkScalar opacity = SK_Scalar1) const;
 
   size_t bytes() const { return used_; }
   int op_count() const { return op_count_; }
   uint32_t unique_id() const { return unique_id_; }
 
-  const SkRect& bounds() {
-    if (bounds_.width() < 0.0) {
-      // ComputeBounds() will leave the variable with a
-      // non-negative width and height
-      ComputeBounds();
-    }
-    return bounds_;
+  // A hash of the ops in the list that is computed when the list is
+  // built. Lists that are |Equals| to each other have the same hash,
+  // even if they were recorded separately, so it can be used to find
+  // resources (like raster cache entries) that were produced for the
+  // same content in an earlier frame. Objects held by reference (such
+  // as images and shaders) contribute their identity rather than their
+  // contents, just like they do for |Equals|.
+  uint64_t content_hash() const { return content_hash_; }
+
+  // The cull rect that was supplied to the DisplayListBuilder. Nothing
+  // rendered outside of this rect is guaranteed to be visible.
+  const SkRect& cull_rect() const { return bounds_cull_; }
+
+  // Whether the list carries the spatial index used by the culling
+  // variant of |Dispatch|.
+  bool has_rtree() const { return rtree_ != nullptr; }
+
+  // The pool that the list was built with, or nullptr if it was built
+  // without a pool. Unless the list is small, its storage was acquired
+  // from the pool and is returned to it when the list is destroyed.
+  const std::shared_ptr<DisplayListStoragePool>& storage_pool() const {
+    return storage_pool_;
   }
 
+  // The bounds of the rendering ops, which are accumulated by the
+  // DisplayListBuilder while the ops are recorded.
+  const SkRect& bounds() const { return bounds_; }
+
+  // Whether a group opacity can be applied to the list by modulating
+  // the alpha of each of its rendering ops instead of rendering it into
+  // a saveLayer, see |RenderTo|. This is the case when no rendering op
+  // overlaps the bounds of the ops before it and every op blends with
+  // kSrcOver and without filters that would change the result of
+  // modulating its alpha.
+  bool can_apply_group_opacity() const { return can_apply_group_opacity_; }
+
+  // Whether the list may render with an image filter, either on a draw or
+  // when a saveLayer is restored. Image filters sample the pixels around
+  // the area that they render into, so the list cannot be rendered in
+  // parts that are clipped to a portion of the destination. Pictures are
+  // opaque to the builder and are assumed to have image filters.
+  bool has_image_filters() const { return has_image_filters_; }
+
   bool Equals(const DisplayList& other) const;
 
  private:
-  DisplayList(uint8_t* ptr, size_t used, int op_count, const SkRect& cull_rect);
+  DisplayList(uint8_t* ptr,
+              size_t used,
+              int op_count,
+              const SkRect& cull_rect,
+              std::shared_ptr<DisplayListStoragePool> storage_pool = nullptr,
+              size_t storage_size = 0);
 
   std::unique_ptr<uint8_t, SkFunctionWrapper<void(void*), sk_free>> storage_;
   size_t used_;
   int op_count_;
 
+  // The pool that the list was built with and the size of the block that
+  // |storage_| was acquired from it, or 0 if |storage_| was allocated for
+  // the list alone.
+  std::shared_ptr<DisplayListStoragePool> storage_pool_;
+  size_t storage_size_ = 0;
+
   uint32_t unique_id_;
+  uint64_t content_hash_;
   SkRect bounds_;
+  bool can_apply_group_opacity_ = false;
+  bool has_image_filters_ = false;
 
-  // Only used for drawPaint() and drawColor()
+  // Used for drawPaint() and drawColor() and as the culling bounds
+  // for the optimizer
   SkRect bounds_cull_;
 
-  void ComputeBounds();
-  void Dispatch(Dispatcher& ctx, uint8_t* ptr, uint8_t* end) const;
+  // The optional spatial index over the rendering ops, see
+  // |Dispatch(ctx, cull)|.
+  struct RTreeData;
+  std::unique_ptr<RTreeData> rtree_;
+
+  template <typename D>
+  static void DispatchOps(D& ctx, uint8_t* ptr, uint8_t* end);
+  template <typename D>
+  static void DispatchAttributes(D& ctx, uint8_t* ptr, uint8_t* end);
 
   friend class DisplayListBuilder;
 };
@@ -452,7 +541,12 @@ class Dispatcher {
 // the DisplayListCanvasRecorder class.
 class DisplayListBuilder final : public virtual Dispatcher, public SkRefCnt {
  public:
-  DisplayListBuilder(const SkRect& cull = kMaxCull_);
+  // If |prepare_rtree| is true then the DisplayList produced by |Build|
+  // will carry a spatial index of the bounds of its rendering ops so
+  // that it can be dispatched with culling, see
+  // |DisplayList::Dispatch(ctx, cull)|.
+  DisplayListBuilder(const SkRect& cull = kMaxCull_,
+                     bool prepare_rtree = false);
   ~DisplayListBuilder();
 
   void setAntiAlias(bool aa) override;
@@ -562,21 +656,45 @@ class DisplayListBuilder final : public virtual Dispatcher, public SkRefCnt {
                   bool transparent_occluder,
                   SkScalar dpr) override;
 
+  // Acquires the storage for the ops from |pool| instead of growing it
+  // with realloc, starting with a block of at least |size_hint| bytes.
+  // The lists built by this builder adopt the pooled block as is and
+  // return it to |pool| when they are destroyed. Must be called before
+  // any ops are recorded.
+  void SetStoragePool(std::shared_ptr<DisplayListStoragePool> pool,
+                      size_t size_hint = 0);
+
   sk_sp<DisplayList> Build();
 
  private:
-  SkAutoTMalloc<uint8_t> storage_;
+  std::unique_ptr<uint8_t, SkFunctionWrapper<void(void*), sk_free>> storage_;
   size_t used_ = 0;
   size_t allocated_ = 0;
+  std::shared_ptr<DisplayListStoragePool> storage_pool_;
   int op_count_ = 0;
   int save_level_ = 0;
+  bool has_image_filters_ = false;
 
   SkRect cull_;
+  bool prepare_rtree_;
   static constexpr SkRect kMaxCull_ =
       SkRect::MakeLTRB(-1E9F, -1E9F, 1E9F, 1E9F);
 
   template <typename T, typename... Args>
   void* Push(size_t extra, int op_inc, Args&&... args);
+
+  // Grows the storage to hold at least |size| bytes and zeroes the
+  // bytes past |used_|.
+  void Grow(size_t size);
+
+  // Accumulates the bounds of the ops as they are recorded. An op can
+  // only be measured once all of its data has been written after |Push|
+  // returns, so the ops from |bounds_offset_| on are measured by the
+  // next call to |Push| or |Build|.
+  class BoundsRecorder;
+  std::unique_ptr<BoundsRecorder> bounds_recorder_;
+  size_t bounds_offset_ = 0;
+  void RecordBounds();
 };
 
 }  // namespace flutter
@@ -0,0 +1,479 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "flutter/benchmarking/benchmarking.h"
+#include "flutter/flow/display_list.h"
+#include "flutter/flow/display_list_serialization.h"
+#include "flutter/flow/display_list_utils.h"
+#include "flutter/fml/file.h"
+#include "flutter/fml/logging.h"
+#include "flutter/fml/time/time_point.h"
+#include "third_party/skia/include/core/SkPictureRecorder.h"
+#include "third_party/skia/include/core/SkRRect.h"
+#include "third_party/skia/include/core/SkRSXform.h"
+#include "third_party/skia/include/core/SkSurface.h"
+#include "third_party/skia/include/core/SkTextBlob.h"
+#include "third_party/skia/include/core/SkVertices.h"
+#include "third_party/skia/include/effects/SkGradientShader.h"
+#include "third_party/skia/include/effects/SkImageFilters.h"
+
+// Benchmarks for recording, dispatching, comparing, measuring and
+// rendering DisplayLists.
+//
+// The synthetic workloads record a fixed number of units of each family
+// of ops in FOR_EACH_DISPLAY_LIST_OP. Additional workloads are created
+// for every DisplayList file (as written by DisplayListSerializer) in
+// the directory named by the FLOW_BENCHMARK_DISPLAY_LIST_DIR environment
+// variable, which makes it possible to replay captured frames.
+//
+// Besides the time per iteration every benchmark reports the average
+// time per op ("ns/op") and the average storage per op ("bytes/op").
+
+namespace flutter {
+namespace {
+
+constexpr int kUnitsPerList = 100;
+constexpr int kSurfaceSize = 512;
+constexpr char kFixtureDirVariable[] = "FLOW_BENCHMARK_DISPLAY_LIST_DIR";
+constexpr char kFixtureExtension[] = ".fldl";
+
+// A Dispatcher that ignores every call, for measuring the cost of the
+// dispatch mechanism itself.
+class NopDispatcher final : public virtual Dispatcher,
+                            public IgnoreAttributeDispatchHelper,
+                            public IgnoreClipDispatchHelper,
+                            public IgnoreTransformDispatchHelper {
+ public:
+  void save() override {}
+  void saveLayer(const SkRect* bounds, bool restore_with_paint) override {}
+  void restore() override {}
+  void drawPaint() override {}
+  void drawColor(SkColor color, SkBlendMode mode) override {}
+  void drawLine(const SkPoint& p0, const SkPoint& p1) override {}
+  void drawRect(const SkRect& rect) override {}
+  void drawOval(const SkRect& bounds) override {}
+  void drawCircle(const SkPoint& center, SkScalar radius) override {}
+  void drawRRect(const SkRRect& rrect) override {}
+  void drawDRRect(const SkRRect& outer, const SkRRect& inner) override {}
+  void drawPath(const SkPath& path) override {}
+  void drawArc(const SkRect& bounds,
+               SkScalar start,
+               SkScalar sweep,
+               bool use_center) override {}
+  void drawPoints(SkCanvas::PointMode mode,
+                  uint32_t count,
+                  const SkPoint pts[]) override {}
+  void drawVertices(const sk_sp<SkVertices> vertices,
+                    SkBlendMode mode) override {}
+  void drawImage(const sk_sp<SkImage> image,
+                 const SkPoint point,
+                 const SkSamplingOptions& sampling,
+                 bool render_with_attributes) override {}
+  void drawImageRect(const sk_sp<SkImage> image,
+                     const SkRect& src,
+                     const SkRect& dst,
+                     const SkSamplingOptions& sampling,
+                     bool render_with_attributes,
+                     SkCanvas::SrcRectConstraint constraint) override {}
+  void drawImageNine(const sk_sp<SkImage> image,
+                     const SkIRect& center,
+                     const SkRect& dst,
+                     SkFilterMode filter,
+                     bool render_with_attributes) override {}
+  void drawImageLattice(const sk_sp<SkImage> image,
+                        const SkCanvas::Lattice& lattice,
+                        const SkRect& dst,
+                        SkFilterMode filter,
+                        bool render_with_attributes) override {}
+  void drawAtlas(const sk_sp<SkImage> atlas,
+                 const SkRSXform xform[],
+                 const SkRect tex[],
+                 const SkColor colors[],
+                 int count,
+                 SkBlendMode mode,
+                 const SkSamplingOptions& sampling,
+                 const SkRect* cull_rect,
+                 bool render_with_attributes) override {}
+  void drawPicture(const sk_sp<SkPicture> picture,
+                   const SkMatrix* matrix,
+                   bool render_with_attributes) override {}
+  void drawDisplayList(const sk_sp<DisplayList> display_list) override {}
+  void drawTextBlob(const sk_sp<SkTextBlob> blob,
+                    SkScalar x,
+                    SkScalar y) override {}
+  void drawShadow(const SkPath& path,
+                  const SkColor color,
+                  const SkScalar elevation,
+                  bool transparent_occluder,
+                  SkScalar dpr) override {}
+};
+
+sk_sp<SkImage> MakeTestImage() {
+  sk_sp<SkSurface> surface = SkSurface::MakeRasterN32Premul(64, 64);
+  surface->getCanvas()->clear(SK_ColorMAGENTA);
+  return surface->makeImageSnapshot();
+}
+
+sk_sp<SkPicture> MakeTestPicture() {
+  SkPictureRecorder recorder;
+  SkCanvas* canvas = recorder.beginRecording(SkRect::MakeWH(32, 32));
+  canvas->drawColor(SK_ColorCYAN);
+  return recorder.finishRecordingAsPicture();
+}
+
+sk_sp<DisplayList> MakeNestedDisplayList() {
+  DisplayListBuilder builder(SkRect::MakeWH(32, 32));
+  builder.drawColor(SK_ColorYELLOW, SkBlendMode::kSrcOver);
+  return builder.Build();
+}
+
+// Each family records one unit of work at a position derived from |i|.
+using RecordUnit = std::function<void(DisplayListBuilder& builder, int i)>;
+
+struct OpFamily {
+  const char* name;
+  RecordUnit record;
+};
+
+SkPoint UnitOrigin(int i) {
+  return SkPoint::Make((i * 37) % (kSurfaceSize - 64),
+                       (i * 71) % (kSurfaceSize - 64));
+}
+
+SkRect UnitRect(int i) {
+  SkPoint origin = UnitOrigin(i);
+  return SkRect::MakeXYWH(origin.fX, origin.fY, 48, 48);
+}
+
+std::vector<OpFamily> CreateOpFamilies() {
+  sk_sp<SkImage> image = MakeTestImage();
+  sk_sp<SkPicture> picture = MakeTestPicture();
+  sk_sp<DisplayList> nested = MakeNestedDisplayList();
+  sk_sp<SkTextBlob> blob = SkTextBlob::MakeFromString("Benchmark", SkFont());
+  const SkPoint gradient_points[] = {{0, 0}, {48, 48}};
+  const SkColor gradient_colors[] = {SK_ColorRED, SK_ColorBLUE};
+  sk_sp<SkShader> shader = SkGradientShader::MakeLinear(
+      gradient_points, gradient_colors, nullptr, 2, SkTileMode::kClamp);
+  sk_sp<SkImageFilter> blur = SkImageFilters::Blur(2, 2, nullptr);
+  const SkPoint triangle[] = {{0, 0}, {48, 0}, {0, 48}};
+  sk_sp<SkVertices> vertices = SkVertices::MakeCopy(
+      SkVertices::kTriangles_VertexMode, 3, triangle, nullptr, nullptr);
+
+  return {
+      {"Attributes",
+       [shader](DisplayListBuilder& builder, int i) {
+         builder.setAntiAlias(i % 2);
+         builder.setDither(i % 3);
+         builder.setColor(0xff000000 | (i * 0x10204));
+         builder.setStyle(i % 2 ? SkPaint::kStroke_Style
+                                : SkPaint::kFill_Style);
+         builder.setStrokeWidth(i % 5);
+         builder.setStrokeCap(SkPaint::kRound_Cap);
+         builder.setBlendMode(i % 2 ? SkBlendMode::kSrcOver
+                                    : SkBlendMode::kMultiply);
+         builder.setShader(i % 2 ? shader : nullptr);
+         builder.setMaskBlurFilter(kNormal_SkBlurStyle, i % 4 + 1);
+         builder.drawRect(UnitRect(i));
+       }},
+      {"SaveRestore",
+       [blur](DisplayListBuilder& builder, int i) {
+         builder.save();
+         builder.drawRect(UnitRect(i));
+         builder.restore();
+         builder.setImageFilter(i % 4 ? nullptr : blur);
+         SkRect bounds = UnitRect(i);
+         builder.saveLayer(i % 2 ? &bounds : nullptr, i % 4 == 0);
+         builder.drawOval(UnitRect(i));
+         builder.restore();
+       }},
+      {"Transforms",
+       [](DisplayListBuilder& builder, int i) {
+         builder.save();
+         builder.translate(i, i);
+         builder.scale(1.01f, 0.99f);
+         builder.rotate(i % 360);
+         builder.skew(0.01f, 0.0f);
+         builder.transform2DAffine(1, 0, 1, 0, 1, 1);
+         builder.drawRect(UnitRect(i));
+         builder.restore();
+       }},
+      {"Clips",
+       [](DisplayListBuilder& builder, int i) {
+         SkRect rect = UnitRect(i);
+         builder.save();
+         builder.clipRect(rect, SkClipOp::kIntersect, true);
+         builder.clipRRect(SkRRect::MakeRectXY(rect, 8, 8),
+                           SkClipOp::kIntersect, true);
+         builder.clipPath(SkPath::Circle(rect.centerX(), rect.centerY(), 20),
+                          SkClipOp::kDifference, false);
+         builder.drawPaint();
+         builder.restore();
+       }},
+      {"Shapes",
+       [](DisplayListBuilder& builder, int i) {
+         SkRect rect = UnitRect(i);
+         builder.drawLine({rect.fLeft, rect.fTop}, {rect.fRight, rect.fBottom});
+         builder.drawRect(rect);
+         builder.drawOval(rect);
+         builder.drawCircle({rect.centerX(), rect.centerY()}, 20);
+         builder.drawRRect(SkRRect::MakeRectXY(rect, 8, 8));
+         builder.drawDRRect(SkRRect::MakeRectXY(rect, 8, 8),
+                            SkRRect::MakeRectXY(rect.makeInset(8, 8), 4, 4));
+         builder.drawArc(rect, 0, 270, i % 2);
+         builder.drawColor(0x10ffffff, SkBlendMode::kSrcOver);
+       }},
+      {"Paths",
+       [](DisplayListBuilder& builder, int i) {
+         SkRect rect = UnitRect(i);
+         SkPath path;
+         path.moveTo(rect.fLeft, rect.fTop);
+         path.quadTo(rect.fRight, rect.fTop, rect.fRight, rect.fBottom);
+         path.cubicTo(rect.centerX(), rect.fBottom, rect.fLeft,
+                      rect.centerY(), rect.fLeft, rect.fTop);
+         path.close();
+         builder.drawPath(path);
+       }},
+      {"Points",
+       [](DisplayListBuilder& builder, int i) {
+         SkPoint points[16];
+         for (int p = 0; p < 16; p++) {
+           points[p] = UnitOrigin(i + p);
+         }
+         builder.drawPoints(SkCanvas::kPoints_PointMode, 16, points);
+         builder.drawPoints(SkCanvas::kLines_PointMode, 16, points);
+         builder.drawPoints(SkCanvas::kPolygon_PointMode, 16, points);
+       }},
+      {"Vertices",
+       [vertices](DisplayListBuilder& builder, int i) {
+         builder.save();
+         builder.translate(UnitOrigin(i).fX, UnitOrigin(i).fY);
+         builder.drawVertices(vertices, SkBlendMode::kSrcOver);
+         builder.restore();
+       }},
+      {"Images",
+       [image](DisplayListBuilder& builder, int i) {
+         SkRect rect = UnitRect(i);
+         builder.drawImage(image, UnitOrigin(i), DisplayList::LinearSampling,
+                           i % 2);
+         builder.drawImageRect(image, SkRect::MakeWH(32, 32), rect,
+                               DisplayList::LinearSampling, false);
+         builder.drawImageNine(image, SkIRect::MakeLTRB(16, 16, 48, 48),
+                               rect, SkFilterMode::kLinear, false);
+       }},
+      {"Atlas",
+       [image](DisplayListBuilder& builder, int i) {
+         SkRSXform xforms[4];
+         SkRect tex[4];
+         for (int s = 0; s < 4; s++) {
+           SkPoint origin = UnitOrigin(i + s);
+           xforms[s] = SkRSXform::Make(1, 0, origin.fX, origin.fY);
+           tex[s] = SkRect::MakeXYWH(s * 16, 0, 16, 16);
+         }
+         builder.drawAtlas(image, xforms, tex, nullptr, 4,
+                           SkBlendMode::kSrcOver, DisplayList::NearestSampling,
+                           nullptr, false);
+       }},
+      {"Pictures",
+       [picture, nested](DisplayListBuilder& builder, int i) {
+         SkMatrix matrix = SkMatrix::Translate(UnitOrigin(i));
+         builder.drawPicture(picture, &matrix, false);
+         builder.save();
+         builder.translate(UnitOrigin(i).fX, UnitOrigin(i).fY);
+         builder.drawDisplayList(nested);
+         builder.restore();
+       }},
+      {"Text",
+       [blob](DisplayListBuilder& builder, int i) {
+         builder.drawTextBlob(blob, UnitOrigin(i).fX, UnitOrigin(i).fY + 20);
+       }},
+      {"Shadows",
+       [](DisplayListBuilder& builder, int i) {
+         SkRect rect = UnitRect(i);
+         builder.drawShadow(SkPath::Oval(rect), SK_ColorBLACK, 4, i % 2, 1);
+       }},
+  };
+}
+
+sk_sp<DisplayList> BuildList(const OpFamily& family) {
+  DisplayListBuilder builder(SkRect::MakeWH(kSurfaceSize, kSurfaceSize));
+  for (int i = 0; i < kUnitsPerList; i++) {
+    family.record(builder, i);
+  }
+  return builder.Build();
+}
+
+// Reports the per op averages of a benchmark that processed
+// |op_count| ops of |bytes| total storage in every iteration.
+class PerOpReporter {
+ public:
+  PerOpReporter(benchmark::State& state, int op_count, size_t bytes)
+      : state_(state),
+        op_count_(op_count),
+        bytes_(bytes),
+        start_(fml::TimePoint::Now()) {}
+
+  ~PerOpReporter() {
+    fml::TimeDelta elapsed = fml::TimePoint::Now() - start_;
+    int64_t ops = static_cast<int64_t>(state_.iterations()) * op_count_;
+    state_.SetItemsProcessed(ops);
+    state_.SetBytesProcessed(state_.iterations() * bytes_);
+    if (ops > 0) {
+      state_.counters["ns/op"] =
+          static_cast<double>(elapsed.ToNanoseconds()) / ops;
+      state_.counters["bytes/op"] = static_cast<double>(bytes_) / op_count_;
+    }
+  }
+
+ private:
+  benchmark::State& state_;
+  const int op_count_;
+  const size_t bytes_;
+  const fml::TimePoint start_;
+};
+
+void BM_Build(benchmark::State& state, const OpFamily& family) {
+  sk_sp<DisplayList> sample = BuildList(family);
+  PerOpReporter reporter(state, sample->op_count(), sample->bytes());
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(BuildList(family));
+  }
+}
+
+void BM_Dispatch(benchmark::State& state, sk_sp<DisplayList> display_list) {
+  NopDispatcher dispatcher;
+  PerOpReporter reporter(state, display_list->op_count(),
+                         display_list->bytes());
+  while (state.KeepRunning()) {
+    display_list->Dispatch(dispatcher);
+  }
+}
+
+void BM_Equals(benchmark::State& state,
+               sk_sp<DisplayList> display_list,
+               sk_sp<DisplayList> copy) {
+  PerOpReporter reporter(state, display_list->op_count(),
+                         display_list->bytes());
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(display_list->Equals(*copy));
+  }
+}
+
+// DisplayList::bounds() is computed while the list is recorded, so the
+// calculator is run directly to measure a replay of the ops. The
+// |devirtualized| variant uses DispatchT, the other one measures the
+// same work through the virtual Dispatcher calls.
+void BM_Bounds(benchmark::State& state,
+               sk_sp<DisplayList> display_list,
+               bool devirtualized) {
+  SkRect cull = display_list->cull_rect();
+  PerOpReporter reporter(state, display_list->op_count(),
+                         display_list->bytes());
+  while (state.KeepRunning()) {
+    DisplayListBoundsCalculator calculator(&cull);
+    if (devirtualized) {
+      display_list->DispatchT(calculator);
+    } else {
+      display_list->Dispatch(static_cast<Dispatcher&>(calculator));
+    }
+    benchmark::DoNotOptimize(calculator.bounds());
+  }
+}
+
+void BM_RenderTo(benchmark::State& state, sk_sp<DisplayList> display_list) {
+  sk_sp<SkSurface> surface =
+      SkSurface::MakeRasterN32Premul(kSurfaceSize, kSurfaceSize);
+  SkCanvas* canvas = surface->getCanvas();
+  PerOpReporter reporter(state, display_list->op_count(),
+                         display_list->bytes());
+  while (state.KeepRunning()) {
+    canvas->clear(SK_ColorWHITE);
+    display_list->RenderTo(canvas);
+  }
+}
+
+void BM_DispatchSerialized(benchmark::State& state,
+                           std::shared_ptr<SerializedDisplayList> loaded) {
+  NopDispatcher dispatcher;
+  PerOpReporter reporter(state, loaded->op_count(), loaded->bytes());
+  while (state.KeepRunning()) {
+    loaded->Dispatch(dispatcher);
+  }
+}
+
+void RegisterDisplayListBenchmarks(const std::string& name,
+                                   const sk_sp<DisplayList>& display_list,
+                                   const sk_sp<DisplayList>& copy) {
+  benchmark::RegisterBenchmark(("BM_Dispatch/" + name).c_str(), BM_Dispatch,
+                               display_list);
+  benchmark::RegisterBenchmark(("BM_Equals/" + name).c_str(), BM_Equals,
+                               display_list, copy);
+  benchmark::RegisterBenchmark(("BM_Bounds/" + name).c_str(), BM_Bounds,
+                               display_list, true);
+  benchmark::RegisterBenchmark(("BM_BoundsVirtual/" + name).c_str(),
+                               BM_Bounds, display_list, false);
+  benchmark::RegisterBenchmark(("BM_RenderTo/" + name).c_str(), BM_RenderTo,
+                               display_list);
+}
+
+void RegisterSyntheticBenchmarks() {
+  for (const OpFamily& family : CreateOpFamilies()) {
+    std::string name = family.name;
+    benchmark::RegisterBenchmark(("BM_Build/" + name).c_str(), BM_Build,
+                                 family);
+    // A separately built copy makes |Equals| compare all of the ops
+    // instead of returning early for identical storage.
+    RegisterDisplayListBenchmarks(name, BuildList(family), BuildList(family));
+  }
+}
+
+void RegisterFixtureBenchmarks() {
+  const char* fixture_dir = std::getenv(kFixtureDirVariable);
+  if (fixture_dir == nullptr) {
+    return;
+  }
+  fml::UniqueFD directory =
+      fml::OpenDirectory(fixture_dir, false, fml::FilePermission::kRead);
+  if (!directory.is_valid()) {
+    FML_LOG(ERROR) << "Could not open " << kFixtureDirVariable << " "
+                   << fixture_dir;
+    return;
+  }
+  fml::VisitFiles(directory, [](const fml::UniqueFD& directory,
+                                const std::string& filename) {
+    size_t extension_length = sizeof(kFixtureExtension) - 1;
+    if (filename.size() <= extension_length ||
+        filename.compare(filename.size() - extension_length, extension_length,
+                         kFixtureExtension) != 0) {
+      return true;
+    }
+    std::shared_ptr<SerializedDisplayList> loaded =
+        SerializedDisplayList::Load(
+            fml::FileMapping::CreateReadOnly(directory, filename));
+    if (!loaded) {
+      FML_LOG(ERROR) << "Could not load DisplayList fixture " << filename;
+      return true;
+    }
+    std::string name = "Fixture/" + filename;
+    benchmark::RegisterBenchmark(("BM_DispatchSerialized/" + name).c_str(),
+                                 BM_DispatchSerialized, loaded);
+    RegisterDisplayListBenchmarks(name, loaded->Build(), loaded->Build());
+    return true;
+  });
+}
+
+// The benchmarks are registered when the executable is loaded so that
+// they are known by the time that benchmarking::Main runs them.
+const bool kRegistered = [] {
+  RegisterSyntheticBenchmarks();
+  RegisterFixtureBenchmarks();
+  return true;
+}();
+
+}  // namespace
+}  // namespace flutter
@@ -79,7 +79,13 @@ void DisplayListCanvasDispatcher::drawPaint() {
   canvas_->drawPaint(paint());
 }
 void DisplayListCanvasDispatcher::drawColor(SkColor color, SkBlendMode mode) {
-  canvas_->drawColor(color, mode);
+  if (opacity() < SK_Scalar1) {
+    SkColor4f color4f = SkColor4f::FromColor(color);
+    color4f.fA *= opacity();
+    canvas_->drawColor(color4f, mode);
+  } else {
+    canvas_->drawColor(color, mode);
+  }
 }
 void DisplayListCanvasDispatcher::drawLine(const SkPoint& p0,
                                            const SkPoint& p1) {
@@ -125,7 +131,7 @@ void DisplayListCanvasDispatcher::drawImage(const sk_sp<SkImage> image,
                                             const SkSamplingOptions& sampling,
                                             bool render_with_attributes) {
   canvas_->drawImage(image, point.fX, point.fY, sampling,
-                     render_with_attributes ? &paint() : nullptr);
+                     safe_paint(render_with_attributes));
 }
 void DisplayListCanvasDispatcher::drawImageRect(
     const sk_sp<SkImage> image,
@@ -135,8 +141,7 @@ void DisplayListCanvasDispatcher::drawImageRect(
     bool render_with_attributes,
     SkCanvas::SrcRectConstraint constraint) {
   canvas_->drawImageRect(image, src, dst, sampling,
-                         render_with_attributes ? &paint() : nullptr,
-                         constraint);
+                         safe_paint(render_with_attributes), constraint);
 }
 void DisplayListCanvasDispatcher::drawImageNine(const sk_sp<SkImage> image,
                                                 const SkIRect& center,
@@ -144,7 +149,7 @@ void DisplayListCanvasDispatcher::drawImageNine(const sk_sp<SkImage> image,
                                                 SkFilterMode filter,
                                                 bool render_with_attributes) {
   canvas_->drawImageNine(image.get(), center, dst, filter,
-                         render_with_attributes ? &paint() : nullptr);
+                         safe_paint(render_with_attributes));
 }
 void DisplayListCanvasDispatcher::drawImageLattice(
     const sk_sp<SkImage> image,
@@ -153,7 +158,7 @@ void DisplayListCanvasDispatcher::drawImageLattice(
     SkFilterMode filter,
     bool render_with_attributes) {
   canvas_->drawImageLattice(image.get(), lattice, dst, filter,
-                            render_with_attributes ? &paint() : nullptr);
+                            safe_paint(render_with_attributes));
 }
 void DisplayListCanvasDispatcher::drawAtlas(const sk_sp<SkImage> atlas,
                                             const SkRSXform xform[],
@@ -165,20 +170,19 @@ void DisplayListCanvasDispatcher::drawAtlas(const sk_sp<SkImage> atlas,
                                             const SkRect* cullRect,
                                             bool render_with_attributes) {
   canvas_->drawAtlas(atlas.get(), xform, tex, colors, count, mode, sampling,
-                     cullRect, render_with_attributes ? &paint() : nullptr);
+                     cullRect, safe_paint(render_with_attributes));
 }
 void DisplayListCanvasDispatcher::drawPicture(const sk_sp<SkPicture> picture,
                                               const SkMatrix* matrix,
                                               bool render_with_attributes) {
-  canvas_->drawPicture(picture, matrix,
-                       render_with_attributes ? &paint() : nullptr);
+  canvas_->drawPicture(picture, matrix, safe_paint(render_with_attributes));
 }
 void DisplayListCanvasDispatcher::drawDisplayList(
     const sk_sp<DisplayList> display_list) {
   int save_count = canvas_->save();
   {
-    DisplayListCanvasDispatcher dispatcher(canvas_);
-    display_list->Dispatch(dispatcher);
+    DisplayListCanvasDispatcher dispatcher(canvas_, opacity());
+    display_list->DispatchT(dispatcher);
   }
   canvas_->restoreToCount(save_count);
 }
@@ -196,9 +200,10 @@ void DisplayListCanvasDispatcher::drawShadow(const SkPath& path,
                                           transparent_occluder, dpr);
 }
 
-DisplayListCanvasRecorder::DisplayListCanvasRecorder(const SkRect& bounds)
+DisplayListCanvasRecorder::DisplayListCanvasRecorder(const SkRect& bounds,
+                                                     bool prepare_rtree)
     : SkCanvasVirtualEnforcer(bounds.width(), bounds.height()),
-      builder_(sk_make_sp<DisplayListBuilder>(bounds)) {}
+      builder_(sk_make_sp<DisplayListBuilder>(bounds, prepare_rtree)) {}
 
 sk_sp<DisplayList> DisplayListCanvasRecorder::Build() {
   sk_sp<DisplayList> display_list = builder_->Build();
@@ -24,10 +24,14 @@
 namespace flutter {
 
 // Receives all methods on Dispatcher and sends them to an SkCanvas
-class DisplayListCanvasDispatcher : public virtual Dispatcher,
-                                    public SkPaintDispatchHelper {
+class DisplayListCanvasDispatcher final : public virtual Dispatcher,
+                                          public SkPaintDispatchHelper {
  public:
-  DisplayListCanvasDispatcher(SkCanvas* canvas) : canvas_(canvas) {}
+  // An |opacity| less than 1 may only be used to render lists whose
+  // |can_apply_group_opacity| is true, see |SkPaintDispatchHelper|.
+  explicit DisplayListCanvasDispatcher(SkCanvas* canvas,
+                                       SkScalar opacity = SK_Scalar1)
+      : SkPaintDispatchHelper(opacity), canvas_(canvas) {}
 
   void save() override;
   void restore() override;
@@ -122,7 +126,7 @@ class DisplayListCanvasRecorder
     : public SkCanvasVirtualEnforcer<SkNoDrawCanvas>,
       public SkRefCnt {
  public:
-  DisplayListCanvasRecorder(const SkRect& bounds);
+  DisplayListCanvasRecorder(const SkRect& bounds, bool prepare_rtree = false);
 
   const sk_sp<DisplayListBuilder> builder() { return builder_; }
 
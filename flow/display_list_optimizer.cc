@@ -0,0 +1,747 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/display_list_optimizer.h"
+
+#include <algorithm>
+
+#include "flutter/flow/layers/physical_shape_layer.h"
+#include "flutter/fml/logging.h"
+#include "flutter/fml/trace_event.h"
+
+#include "third_party/skia/include/core/SkMaskFilter.h"
+#include "third_party/skia/include/core/SkPath.h"
+#include "third_party/skia/include/core/SkRSXform.h"
+#include "third_party/skia/include/core/SkTextBlob.h"
+
+namespace flutter {
+
+sk_sp<DisplayList> DisplayListOptimizer::Optimize(
+    const sk_sp<DisplayList>& display_list,
+    Stats* stats) {
+  TRACE_EVENT0("flutter", "DisplayListOptimizer::Optimize");
+  DisplayListOptimizer optimizer(display_list->cull_rect(),
+                                 display_list->has_rtree());
+  if (display_list->storage_pool()) {
+    // The optimized list rarely needs more storage than the original.
+    optimizer.builder_.SetStoragePool(display_list->storage_pool(),
+                                      display_list->bytes());
+  }
+  display_list->Dispatch(optimizer);
+  int ops_received = optimizer.ops_received();
+  int ops_emitted = optimizer.ops_emitted();
+  sk_sp<DisplayList> optimized = optimizer.Build();
+
+  bool improved = optimized->bytes() < display_list->bytes();
+  if (stats) {
+    stats->original_op_count = ops_received;
+    stats->original_bytes = display_list->bytes();
+    stats->optimized_op_count = improved ? ops_emitted : ops_received;
+    stats->optimized_bytes =
+        improved ? optimized->bytes() : display_list->bytes();
+  }
+#if !FLUTTER_RELEASE
+  if (improved) {
+    FML_TRACE_COUNTER(
+        "flutter", "DisplayListOptimizer", 0,             //
+        "OpsSaved", ops_received - ops_emitted,           //
+        "BytesSaved", display_list->bytes() - optimized->bytes());
+  }
+#endif  // !FLUTTER_RELEASE
+  return improved ? optimized : display_list;
+}
+
+DisplayListOptimizer::DisplayListOptimizer(const SkRect& cull_rect,
+                                           bool prepare_rtree)
+    : ClipBoundsDispatchHelper(&cull_rect),
+      builder_(cull_rect, prepare_rtree) {
+  save_stack_.push_back({true, true, {}});
+}
+
+sk_sp<DisplayList> DisplayListOptimizer::Build() {
+  return builder_.Build();
+}
+
+void DisplayListOptimizer::setAntiAlias(bool aa) {
+  ops_received_++;
+  current_.anti_alias = aa;
+}
+void DisplayListOptimizer::setDither(bool dither) {
+  ops_received_++;
+  current_.dither = dither;
+}
+void DisplayListOptimizer::setInvertColors(bool invert) {
+  ops_received_++;
+  current_.invert_colors = invert;
+}
+void DisplayListOptimizer::setStrokeCap(SkPaint::Cap cap) {
+  ops_received_++;
+  current_.cap = cap;
+}
+void DisplayListOptimizer::setStrokeJoin(SkPaint::Join join) {
+  ops_received_++;
+  current_.join = join;
+}
+void DisplayListOptimizer::setStyle(SkPaint::Style style) {
+  ops_received_++;
+  current_.style = style;
+}
+void DisplayListOptimizer::setStrokeWidth(SkScalar width) {
+  ops_received_++;
+  current_.stroke_width = width;
+}
+void DisplayListOptimizer::setStrokeMiter(SkScalar limit) {
+  ops_received_++;
+  current_.stroke_miter = limit;
+}
+void DisplayListOptimizer::setColor(SkColor color) {
+  ops_received_++;
+  current_.color = color;
+}
+void DisplayListOptimizer::setBlendMode(SkBlendMode mode) {
+  ops_received_++;
+  current_.blend_mode = mode;
+  current_.blender = nullptr;
+}
+void DisplayListOptimizer::setBlender(sk_sp<SkBlender> blender) {
+  ops_received_++;
+  current_.blend_mode = SkBlendMode::kSrcOver;
+  current_.blender = std::move(blender);
+}
+void DisplayListOptimizer::setShader(sk_sp<SkShader> shader) {
+  ops_received_++;
+  current_.shader = std::move(shader);
+}
+void DisplayListOptimizer::setImageFilter(sk_sp<SkImageFilter> filter) {
+  ops_received_++;
+  current_.image_filter = std::move(filter);
+}
+void DisplayListOptimizer::setColorFilter(sk_sp<SkColorFilter> filter) {
+  ops_received_++;
+  current_.color_filter = std::move(filter);
+}
+void DisplayListOptimizer::setPathEffect(sk_sp<SkPathEffect> effect) {
+  ops_received_++;
+  current_.path_effect = std::move(effect);
+}
+void DisplayListOptimizer::setMaskFilter(sk_sp<SkMaskFilter> filter) {
+  ops_received_++;
+  current_.mask_filter = std::move(filter);
+  current_.has_mask_blur = false;
+}
+void DisplayListOptimizer::setMaskBlurFilter(SkBlurStyle style,
+                                             SkScalar sigma) {
+  ops_received_++;
+  current_.mask_filter = nullptr;
+  current_.has_mask_blur = true;
+  current_.mask_blur_style = style;
+  current_.mask_blur_sigma = sigma;
+}
+
+void DisplayListOptimizer::FlushAttributes() {
+  if (current_.anti_alias != emitted_.anti_alias) {
+    builder_.setAntiAlias(current_.anti_alias);
+    ops_emitted_++;
+  }
+  if (current_.dither != emitted_.dither) {
+    builder_.setDither(current_.dither);
+    ops_emitted_++;
+  }
+  if (current_.invert_colors != emitted_.invert_colors) {
+    builder_.setInvertColors(current_.invert_colors);
+    ops_emitted_++;
+  }
+  if (current_.cap != emitted_.cap) {
+    builder_.setStrokeCap(current_.cap);
+    ops_emitted_++;
+  }
+  if (current_.join != emitted_.join) {
+    builder_.setStrokeJoin(current_.join);
+    ops_emitted_++;
+  }
+  if (current_.style != emitted_.style) {
+    builder_.setStyle(current_.style);
+    ops_emitted_++;
+  }
+  if (current_.stroke_width != emitted_.stroke_width) {
+    builder_.setStrokeWidth(current_.stroke_width);
+    ops_emitted_++;
+  }
+  if (current_.stroke_miter != emitted_.stroke_miter) {
+    builder_.setStrokeMiter(current_.stroke_miter);
+    ops_emitted_++;
+  }
+  if (current_.color != emitted_.color) {
+    builder_.setColor(current_.color);
+    ops_emitted_++;
+  }
+  if (current_.blender != emitted_.blender ||
+      (!current_.blender && current_.blend_mode != emitted_.blend_mode)) {
+    current_.blender  //
+        ? builder_.setBlender(current_.blender)
+        : builder_.setBlendMode(current_.blend_mode);
+    ops_emitted_++;
+  }
+  if (current_.shader != emitted_.shader) {
+    builder_.setShader(current_.shader);
+    ops_emitted_++;
+  }
+  if (current_.color_filter != emitted_.color_filter) {
+    builder_.setColorFilter(current_.color_filter);
+    ops_emitted_++;
+  }
+  if (current_.image_filter != emitted_.image_filter) {
+    builder_.setImageFilter(current_.image_filter);
+    ops_emitted_++;
+  }
+  if (current_.path_effect != emitted_.path_effect) {
+    builder_.setPathEffect(current_.path_effect);
+    ops_emitted_++;
+  }
+  if (current_.mask_filter != emitted_.mask_filter ||
+      current_.has_mask_blur != emitted_.has_mask_blur ||
+      (current_.has_mask_blur &&
+       (current_.mask_blur_style != emitted_.mask_blur_style ||
+        current_.mask_blur_sigma != emitted_.mask_blur_sigma))) {
+    current_.has_mask_blur  //
+        ? builder_.setMaskBlurFilter(current_.mask_blur_style,
+                                     current_.mask_blur_sigma)
+        : builder_.setMaskFilter(current_.mask_filter);
+    ops_emitted_++;
+  }
+  emitted_ = current_;
+}
+
+void DisplayListOptimizer::save() {
+  ops_received_++;
+  SkMatrixDispatchHelper::save();
+  ClipBoundsDispatchHelper::save();
+  save_stack_.push_back({false, save_stack_.back().cull_enabled, {}});
+}
+void DisplayListOptimizer::saveLayer(const SkRect* bounds,
+                                     bool restore_with_paint) {
+  ops_received_++;
+  // The attributes are consumed at the time of the saveLayer call
+  // so we cannot defer it.
+  FlushState();
+  if (restore_with_paint) {
+    FlushAttributes();
+  }
+  builder_.saveLayer(bounds, restore_with_paint);
+  ops_emitted_++;
+  SkMatrixDispatchHelper::save();
+  ClipBoundsDispatchHelper::save();
+  // An image filter on the layer can move content from outside of the
+  // clip into view so nothing can be culled inside such a layer.
+  bool cull_enabled = save_stack_.back().cull_enabled &&
+                      !(restore_with_paint && current_.image_filter);
+  save_stack_.push_back({true, cull_enabled, {}});
+}
+void DisplayListOptimizer::restore() {
+  ops_received_++;
+  if (save_stack_.size() <= 1) {
+    return;
+  }
+  SkMatrixDispatchHelper::restore();
+  ClipBoundsDispatchHelper::restore();
+  // Any transforms or clips still pending in this save are undone by
+  // the restore and can simply be dropped.
+  bool emitted = save_stack_.back().emitted;
+  save_stack_.pop_back();
+  if (emitted) {
+    builder_.restore();
+    ops_emitted_++;
+  }
+}
+
+void DisplayListOptimizer::PushTransform(PendingOp::Type type,
+                                         const SkM44& matrix,
+                                         SkScalar arg0,
+                                         SkScalar arg1) {
+  std::vector<PendingOp>& pending = save_stack_.back().pending;
+  if (!pending.empty() && pending.back().is_transform()) {
+    pending.back().type = PendingOp::Type::kMatrix;
+    pending.back().matrix.preConcat(matrix);
+  } else {
+    PendingOp op;
+    op.type = type;
+    op.args[0] = arg0;
+    op.args[1] = arg1;
+    op.matrix = matrix;
+    pending.push_back(std::move(op));
+  }
+}
+
+void DisplayListOptimizer::translate(SkScalar tx, SkScalar ty) {
+  ops_received_++;
+  SkMatrixDispatchHelper::translate(tx, ty);
+  PushTransform(PendingOp::Type::kTranslate, SkM44::Translate(tx, ty), tx, ty);
+}
+void DisplayListOptimizer::scale(SkScalar sx, SkScalar sy) {
+  ops_received_++;
+  SkMatrixDispatchHelper::scale(sx, sy);
+  PushTransform(PendingOp::Type::kScale, SkM44::Scale(sx, sy), sx, sy);
+}
+void DisplayListOptimizer::rotate(SkScalar degrees) {
+  ops_received_++;
+  SkMatrixDispatchHelper::rotate(degrees);
+  PushTransform(PendingOp::Type::kRotate, SkM44(SkMatrix::RotateDeg(degrees)),
+                degrees);
+}
+void DisplayListOptimizer::skew(SkScalar sx, SkScalar sy) {
+  ops_received_++;
+  SkMatrixDispatchHelper::skew(sx, sy);
+  SkMatrix skew;
+  skew.setSkew(sx, sy);
+  PushTransform(PendingOp::Type::kSkew, SkM44(skew), sx, sy);
+}
+
+// clang-format off
+
+// 2x3 2D affine subset of a 4x4 transform in row major order
+void DisplayListOptimizer::transform2DAffine(
+    SkScalar mxx, SkScalar mxy, SkScalar mxt,
+    SkScalar myx, SkScalar myy, SkScalar myt) {
+  ops_received_++;
+  SkMatrixDispatchHelper::transform2DAffine(mxx, mxy, mxt,
+                                            myx, myy, myt);
+  PushTransform(PendingOp::Type::kMatrix,
+                SkM44(mxx, mxy, 0, mxt,
+                      myx, myy, 0, myt,
+                       0,   0,  1,  0,
+                       0,   0,  0,  1));
+}
+// full 4x4 transform in row major order
+void DisplayListOptimizer::transformFullPerspective(
+    SkScalar mxx, SkScalar mxy, SkScalar mxz, SkScalar mxt,
+    SkScalar myx, SkScalar myy, SkScalar myz, SkScalar myt,
+    SkScalar mzx, SkScalar mzy, SkScalar mzz, SkScalar mzt,
+    SkScalar mwx, SkScalar mwy, SkScalar mwz, SkScalar mwt) {
+  ops_received_++;
+  SkMatrixDispatchHelper::transformFullPerspective(mxx, mxy, mxz, mxt,
+                                                   myx, myy, myz, myt,
+                                                   mzx, mzy, mzz, mzt,
+                                                   mwx, mwy, mwz, mwt);
+  PushTransform(PendingOp::Type::kMatrix,
+                SkM44(mxx, mxy, mxz, mxt,
+                      myx, myy, myz, myt,
+                      mzx, mzy, mzz, mzt,
+                      mwx, mwy, mwz, mwt));
+}
+
+// clang-format on
+
+void DisplayListOptimizer::PushClip(PendingOp op) {
+  save_stack_.back().pending.push_back(std::move(op));
+}
+
+void DisplayListOptimizer::clipRect(const SkRect& rect,
+                                    SkClipOp clip_op,
+                                    bool is_aa) {
+  ops_received_++;
+  ClipBoundsDispatchHelper::clipRect(rect, clip_op, is_aa);
+  PendingOp op;
+  op.type = PendingOp::Type::kClipRect;
+  op.rect = rect;
+  op.clip_op = clip_op;
+  op.is_aa = is_aa;
+  PushClip(std::move(op));
+}
+void DisplayListOptimizer::clipRRect(const SkRRect& rrect,
+                                     SkClipOp clip_op,
+                                     bool is_aa) {
+  ops_received_++;
+  ClipBoundsDispatchHelper::clipRRect(rrect, clip_op, is_aa);
+  PendingOp op;
+  op.type = PendingOp::Type::kClipRRect;
+  op.rrect = rrect;
+  op.clip_op = clip_op;
+  op.is_aa = is_aa;
+  PushClip(std::move(op));
+}
+void DisplayListOptimizer::clipPath(const SkPath& path,
+                                    SkClipOp clip_op,
+                                    bool is_aa) {
+  ops_received_++;
+  ClipBoundsDispatchHelper::clipPath(path, clip_op, is_aa);
+  PendingOp op;
+  op.type = PendingOp::Type::kClipPath;
+  op.path = path;
+  op.clip_op = clip_op;
+  op.is_aa = is_aa;
+  PushClip(std::move(op));
+}
+
+void DisplayListOptimizer::EmitPendingOp(const PendingOp& op) {
+  switch (op.type) {
+    case PendingOp::Type::kTranslate:
+      if (op.args[0] == 0.0f && op.args[1] == 0.0f) {
+        return;
+      }
+      builder_.translate(op.args[0], op.args[1]);
+      break;
+    case PendingOp::Type::kScale:
+      if (op.args[0] == 1.0f && op.args[1] == 1.0f) {
+        return;
+      }
+      builder_.scale(op.args[0], op.args[1]);
+      break;
+    case PendingOp::Type::kRotate:
+      if (op.args[0] == 0.0f) {
+        return;
+      }
+      builder_.rotate(op.args[0]);
+      break;
+    case PendingOp::Type::kSkew:
+      if (op.args[0] == 0.0f && op.args[1] == 0.0f) {
+        return;
+      }
+      builder_.skew(op.args[0], op.args[1]);
+      break;
+    case PendingOp::Type::kMatrix: {
+      const SkM44& m = op.matrix;
+      // clang-format off
+      bool is_scale_translate =
+          m.rc(0, 1) == 0 && m.rc(0, 2) == 0 &&
+          m.rc(1, 0) == 0 && m.rc(1, 2) == 0 &&
+          m.rc(2, 0) == 0 && m.rc(2, 1) == 0 && m.rc(2, 2) == 1 &&
+          m.rc(2, 3) == 0 &&
+          m.rc(3, 0) == 0 && m.rc(3, 1) == 0 && m.rc(3, 2) == 0 &&
+          m.rc(3, 3) == 1;
+      // clang-format on
+      if (is_scale_translate) {
+        bool has_scale = m.rc(0, 0) != 1 || m.rc(1, 1) != 1;
+        bool has_translate = m.rc(0, 3) != 0 || m.rc(1, 3) != 0;
+        if (!has_scale && !has_translate) {
+          return;
+        }
+        // The dedicated ops are much smaller than a 2D affine op.
+        if (!has_scale) {
+          builder_.translate(m.rc(0, 3), m.rc(1, 3));
+          break;
+        }
+        if (!has_translate) {
+          builder_.scale(m.rc(0, 0), m.rc(1, 1));
+          break;
+        }
+      }
+      // The builder will further reduce this to a 2D affine op
+      // when there are no perspective or Z components.
+      builder_.transformFullPerspective(
+          m.rc(0, 0), m.rc(0, 1), m.rc(0, 2), m.rc(0, 3),  //
+          m.rc(1, 0), m.rc(1, 1), m.rc(1, 2), m.rc(1, 3),  //
+          m.rc(2, 0), m.rc(2, 1), m.rc(2, 2), m.rc(2, 3),  //
+          m.rc(3, 0), m.rc(3, 1), m.rc(3, 2), m.rc(3, 3));
+      break;
+    }
+    case PendingOp::Type::kClipRect:
+      builder_.clipRect(op.rect, op.clip_op, op.is_aa);
+      break;
+    case PendingOp::Type::kClipRRect:
+      builder_.clipRRect(op.rrect, op.clip_op, op.is_aa);
+      break;
+    case PendingOp::Type::kClipPath:
+      builder_.clipPath(op.path, op.clip_op, op.is_aa);
+      break;
+  }
+  ops_emitted_++;
+}
+
+void DisplayListOptimizer::FlushState() {
+  for (SaveInfo& info : save_stack_) {
+    if (!info.emitted) {
+      builder_.save();
+      ops_emitted_++;
+      info.emitted = true;
+    }
+    for (const PendingOp& op : info.pending) {
+      EmitPendingOp(op);
+    }
+    info.pending.clear();
+  }
+}
+
+bool DisplayListOptimizer::CullUnbounded(int flags) {
+  if (save_stack_.back().cull_enabled && has_clip() &&
+      clip_bounds().isEmpty()) {
+    return true;
+  }
+  FlushState();
+  if ((flags & kUsesAttributes) != 0) {
+    FlushAttributes();
+  }
+  return false;
+}
+
+bool DisplayListOptimizer::Cull(const SkRect& local_bounds, int flags) {
+  bool can_cull = save_stack_.back().cull_enabled && has_clip() &&
+                  !matrix().hasPerspective();
+  SkRect bounds = local_bounds;
+  if (can_cull && (flags & kUsesAttributes) != 0) {
+    if (current_.image_filter || current_.path_effect ||
+        current_.mask_filter) {
+      can_cull = false;
+    } else {
+      if ((flags & kIsStroked) != 0 ||
+          current_.style != SkPaint::kFill_Style) {
+        SkScalar pad = std::max(current_.stroke_width, 1.0f) * 0.5f;
+        pad *= std::max(current_.stroke_miter, SK_ScalarSqrt2);
+        bounds.outset(pad, pad);
+      }
+      if (current_.has_mask_blur) {
+        SkScalar pad = std::max(3.0f * current_.mask_blur_sigma, 0.0f);
+        bounds.outset(pad, pad);
+      }
+    }
+  }
+  if (can_cull) {
+    SkRect device_bounds = matrix().mapRect(bounds);
+    // Allow for hairlines and anti-aliasing bleeding into the
+    // neighboring pixels.
+    device_bounds.outset(1.0f, 1.0f);
+    if (!SkRect::Intersects(device_bounds, clip_bounds())) {
+      return true;
+    }
+  }
+  FlushState();
+  if ((flags & kUsesAttributes) != 0) {
+    FlushAttributes();
+  }
+  return false;
+}
+
+void DisplayListOptimizer::drawPaint() {
+  ops_received_++;
+  if (!CullUnbounded(kUsesAttributes)) {
+    builder_.drawPaint();
+    ops_emitted_++;
+  }
+}
+void DisplayListOptimizer::drawColor(SkColor color, SkBlendMode mode) {
+  ops_received_++;
+  if (!CullUnbounded(kIgnoresAttributes)) {
+    builder_.drawColor(color, mode);
+    ops_emitted_++;
+  }
+}
+void DisplayListOptimizer::drawLine(const SkPoint& p0, const SkPoint& p1) {
+  ops_received_++;
+  SkRect bounds = SkRect::MakeLTRB(p0.fX, p0.fY, p1.fX, p1.fY).makeSorted();
+  if (!Cull(bounds, kUsesAttributes | kIsStroked)) {
+    builder_.drawLine(p0, p1);
+    ops_emitted_++;
+  }
+}
+void DisplayListOptimizer::drawRect(const SkRect& rect) {
+  ops_received_++;
+  if (!Cull(rect.makeSorted(), kUsesAttributes)) {
+    builder_.drawRect(rect);
+    ops_emitted_++;
+  }
+}
+void DisplayListOptimizer::drawOval(const SkRect& bounds) {
+  ops_received_++;
+  if (!Cull(bounds.makeSorted(), kUsesAttributes)) {
+    builder_.drawOval(bounds);
+    ops_emitted_++;
+  }
+}
+void DisplayListOptimizer::drawCircle(const SkPoint& center, SkScalar radius) {
+  ops_received_++;
+  SkRect bounds = SkRect::MakeLTRB(center.fX - radius, center.fY - radius,
+                                   center.fX + radius, center.fY + radius);
+  if (!Cull(bounds.makeSorted(), kUsesAttributes)) {
+    builder_.drawCircle(center, radius);
+    ops_emitted_++;
+  }
+}
+void DisplayListOptimizer::drawRRect(const SkRRect& rrect) {
+  ops_received_++;
+  if (!Cull(rrect.getBounds(), kUsesAttributes)) {
+    builder_.drawRRect(rrect);
+    ops_emitted_++;
+  }
+}
+void DisplayListOptimizer::drawDRRect(const SkRRect& outer,
+                                      const SkRRect& inner) {
+  ops_received_++;
+  if (!Cull(outer.getBounds(), kUsesAttributes)) {
+    builder_.drawDRRect(outer, inner);
+    ops_emitted_++;
+  }
+}
+void DisplayListOptimizer::drawPath(const SkPath& path) {
+  ops_received_++;
+  bool culled = path.isInverseFillType()
+                    ? CullUnbounded(kUsesAttributes)
+                    : Cull(path.getBounds(), kUsesAttributes);
+  if (!culled) {
+    builder_.drawPath(path);
+    ops_emitted_++;
+  }
+}
+void DisplayListOptimizer::drawArc(const SkRect& bounds,
+                                   SkScalar start,
+                                   SkScalar sweep,
+                                   bool useCenter) {
+  ops_received_++;
+  if (!Cull(bounds.makeSorted(), kUsesAttributes)) {
+    builder_.drawArc(bounds, start, sweep, useCenter);
+    ops_emitted_++;
+  }
+}
+void DisplayListOptimizer::drawPoints(SkCanvas::PointMode mode,
+                                      uint32_t count,
+                                      const SkPoint pts[]) {
+  ops_received_++;
+  if (count == 0) {
+    return;
+  }
+  SkRect bounds;
+  bounds.setBounds(pts, count);
+  if (!Cull(bounds, kUsesAttributes | kIsStroked)) {
+    builder_.drawPoints(mode, count, pts);
+    ops_emitted_++;
+  }
+}
+void DisplayListOptimizer::drawVertices(const sk_sp<SkVertices> vertices,
+                                        SkBlendMode mode) {
+  ops_received_++;
+  if (!Cull(vertices->bounds(), kUsesAttributes)) {
+    builder_.drawVertices(vertices, mode);
+    ops_emitted_++;
+  }
+}
+void DisplayListOptimizer::drawImage(const sk_sp<SkImage> image,
+                                     const SkPoint point,
+                                     const SkSamplingOptions& sampling,
+                                     bool render_with_attributes) {
+  ops_received_++;
+  SkRect bounds = SkRect::MakeXYWH(point.fX, point.fY,  //
+                                   image->width(), image->height());
+  if (!Cull(bounds,
+            render_with_attributes ? kUsesAttributes : kIgnoresAttributes)) {
+    builder_.drawImage(image, point, sampling, render_with_attributes);
+    ops_emitted_++;
+  }
+}
+void DisplayListOptimizer::drawImageRect(
+    const sk_sp<SkImage> image,
+    const SkRect& src,
+    const SkRect& dst,
+    const SkSamplingOptions& sampling,
+    bool render_with_attributes,
+    SkCanvas::SrcRectConstraint constraint) {
+  ops_received_++;
+  if (!Cull(dst.makeSorted(),
+            render_with_attributes ? kUsesAttributes : kIgnoresAttributes)) {
+    builder_.drawImageRect(image, src, dst, sampling, render_with_attributes,
+                           constraint);
+    ops_emitted_++;
+  }
+}
+void DisplayListOptimizer::drawImageNine(const sk_sp<SkImage> image,
+                                         const SkIRect& center,
+                                         const SkRect& dst,
+                                         SkFilterMode filter,
+                                         bool render_with_attributes) {
+  ops_received_++;
+  if (!Cull(dst.makeSorted(),
+            render_with_attributes ? kUsesAttributes : kIgnoresAttributes)) {
+    builder_.drawImageNine(image, center, dst, filter, render_with_attributes);
+    ops_emitted_++;
+  }
+}
+void DisplayListOptimizer::drawImageLattice(const sk_sp<SkImage> image,
+                                            const SkCanvas::Lattice& lattice,
+                                            const SkRect& dst,
+                                            SkFilterMode filter,
+                                            bool render_with_attributes) {
+  ops_received_++;
+  if (!Cull(dst.makeSorted(),
+            render_with_attributes ? kUsesAttributes : kIgnoresAttributes)) {
+    builder_.drawImageLattice(image, lattice, dst, filter,
+                              render_with_attributes);
+    ops_emitted_++;
+  }
+}
+void DisplayListOptimizer::drawAtlas(const sk_sp<SkImage> atlas,
+                                     const SkRSXform xform[],
+                                     const SkRect tex[],
+                                     const SkColor colors[],
+                                     int count,
+                                     SkBlendMode mode,
+                                     const SkSamplingOptions& sampling,
+                                     const SkRect* cullRect,
+                                     bool render_with_attributes) {
+  ops_received_++;
+  int flags = render_with_attributes ? kUsesAttributes : kIgnoresAttributes;
+  bool culled;
+  if (cullRect) {
+    culled = Cull(cullRect->makeSorted(), flags);
+  } else {
+    SkPoint quad[4];
+    BoundsAccumulator atlas_bounds;
+    for (int i = 0; i < count; i++) {
+      const SkRect& src = tex[i];
+      xform[i].toQuad(src.width(), src.height(), quad);
+      for (int j = 0; j < 4; j++) {
+        atlas_bounds.accumulate(quad[j]);
+      }
+    }
+    culled = atlas_bounds.is_not_empty() ? Cull(atlas_bounds.bounds(), flags)
+                                         : CullUnbounded(flags);
+  }
+  if (!culled) {
+    builder_.drawAtlas(atlas, xform, tex, colors, count, mode, sampling,
+                       cullRect, render_with_attributes);
+    ops_emitted_++;
+  }
+}
+void DisplayListOptimizer::drawPicture(const sk_sp<SkPicture> picture,
+                                       const SkMatrix* matrix,
+                                       bool render_with_attributes) {
+  ops_received_++;
+  SkRect bounds = picture->cullRect();
+  if (matrix) {
+    matrix->mapRect(&bounds);
+  }
+  if (!Cull(bounds,
+            render_with_attributes ? kUsesAttributes : kIgnoresAttributes)) {
+    builder_.drawPicture(picture, matrix, render_with_attributes);
+    ops_emitted_++;
+  }
+}
+void DisplayListOptimizer::drawDisplayList(
+    const sk_sp<DisplayList> display_list) {
+  ops_received_++;
+  if (!Cull(display_list->bounds(), kIgnoresAttributes)) {
+    builder_.drawDisplayList(display_list);
+    ops_emitted_++;
+  }
+}
+void DisplayListOptimizer::drawTextBlob(const sk_sp<SkTextBlob> blob,
+                                        SkScalar x,
+                                        SkScalar y) {
+  ops_received_++;
+  if (!Cull(blob->bounds().makeOffset(x, y), kUsesAttributes)) {
+    builder_.drawTextBlob(blob, x, y);
+    ops_emitted_++;
+  }
+}
+void DisplayListOptimizer::drawShadow(const SkPath& path,
+                                      const SkColor color,
+                                      const SkScalar elevation,
+                                      bool transparent_occluder,
+                                      SkScalar dpr) {
+  ops_received_++;
+  SkRect bounds =
+      PhysicalShapeLayer::ComputeShadowBounds(path, elevation, dpr, matrix());
+  if (!Cull(bounds, kIgnoresAttributes)) {
+    builder_.drawShadow(path, color, elevation, transparent_occluder, dpr);
+    ops_emitted_++;
+  }
+}
+
+}  // namespace flutter
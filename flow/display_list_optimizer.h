@@ -0,0 +1,289 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FLOW_DISPLAY_LIST_OPTIMIZER_H_
+#define FLUTTER_FLOW_DISPLAY_LIST_OPTIMIZER_H_
+
+#include <vector>
+
+#include "flutter/flow/display_list.h"
+#include "flutter/flow/display_list_utils.h"
+#include "flutter/fml/macros.h"
+
+#include "third_party/skia/include/core/SkM44.h"
+
+namespace flutter {
+
+// A Dispatcher that re-records a DisplayList into a new, equivalent
+// DisplayList with fewer ops. It performs the following rewrites:
+//
+// - Attribute ops are deferred until a rendering op actually consumes
+//   them and are only emitted if they change the attribute value that
+//   was last emitted, so redundant sets and sets that are overwritten
+//   before they are used disappear.
+// - |save| calls are deferred until something inside the save is
+//   rendered, so empty save/restore pairs (including ones that only
+//   contain transforms and clips) are folded away.
+// - Adjacent transform ops are concatenated into a single op, and
+//   transforms which resolve to the identity are dropped.
+// - Rendering ops whose bounds fall entirely outside of the cull rect
+//   of the DisplayList (or the current clip) are removed.
+//
+// The optimizer is conservative. It will not cull an op whose bounds
+// cannot be trusted (image filters, path effects, non-blur mask filters,
+// perspective transforms or content inside a saveLayer that applies an
+// image filter).
+class DisplayListOptimizer final : public virtual Dispatcher,
+                                   public virtual SkMatrixDispatchHelper,
+                                   public virtual ClipBoundsDispatchHelper {
+ public:
+  struct Stats {
+    // The number of records (including attribute records) before and
+    // after the optimization pass.
+    int original_op_count = 0;
+    int optimized_op_count = 0;
+
+    // The storage bytes before and after the optimization pass.
+    size_t original_bytes = 0;
+    size_t optimized_bytes = 0;
+
+    int ops_saved() const { return original_op_count - optimized_op_count; }
+    size_t bytes_saved() const {
+      return original_bytes > optimized_bytes
+                 ? original_bytes - optimized_bytes
+                 : 0;
+    }
+  };
+
+  // Returns an optimized equivalent of |display_list|. If the pass
+  // did not manage to save any storage then the original |display_list|
+  // is returned so that its unique_id() is preserved. If |stats| is not
+  // null it is filled in with the savings of the pass.
+  static sk_sp<DisplayList> Optimize(const sk_sp<DisplayList>& display_list,
+                                     Stats* stats = nullptr);
+
+  // |prepare_rtree| is forwarded to the DisplayListBuilder that records
+  // the optimized list. |Optimize| preserves the setting of the source.
+  explicit DisplayListOptimizer(const SkRect& cull_rect,
+                                bool prepare_rtree = false);
+
+  void setAntiAlias(bool aa) override;
+  void setDither(bool dither) override;
+  void setInvertColors(bool invert) override;
+  void setStrokeCap(SkPaint::Cap cap) override;
+  void setStrokeJoin(SkPaint::Join join) override;
+  void setStyle(SkPaint::Style style) override;
+  void setStrokeWidth(SkScalar width) override;
+  void setStrokeMiter(SkScalar limit) override;
+  void setColor(SkColor color) override;
+  void setBlendMode(SkBlendMode mode) override;
+  void setBlender(sk_sp<SkBlender> blender) override;
+  void setShader(sk_sp<SkShader> shader) override;
+  void setImageFilter(sk_sp<SkImageFilter> filter) override;
+  void setColorFilter(sk_sp<SkColorFilter> filter) override;
+  void setPathEffect(sk_sp<SkPathEffect> effect) override;
+  void setMaskFilter(sk_sp<SkMaskFilter> filter) override;
+  void setMaskBlurFilter(SkBlurStyle style, SkScalar sigma) override;
+
+  void save() override;
+  void saveLayer(const SkRect* bounds, bool restore_with_paint) override;
+  void restore() override;
+
+  void translate(SkScalar tx, SkScalar ty) override;
+  void scale(SkScalar sx, SkScalar sy) override;
+  void rotate(SkScalar degrees) override;
+  void skew(SkScalar sx, SkScalar sy) override;
+
+  // clang-format off
+
+  // 2x3 2D affine subset of a 4x4 transform in row major order
+  void transform2DAffine(SkScalar mxx, SkScalar mxy, SkScalar mxt,
+                         SkScalar myx, SkScalar myy, SkScalar myt) override;
+  // full 4x4 transform in row major order
+  void transformFullPerspective(
+      SkScalar mxx, SkScalar mxy, SkScalar mxz, SkScalar mxt,
+      SkScalar myx, SkScalar myy, SkScalar myz, SkScalar myt,
+      SkScalar mzx, SkScalar mzy, SkScalar mzz, SkScalar mzt,
+      SkScalar mwx, SkScalar mwy, SkScalar mwz, SkScalar mwt) override;
+
+  // clang-format on
+
+  void clipRect(const SkRect& rect, SkClipOp clip_op, bool is_aa) override;
+  void clipRRect(const SkRRect& rrect, SkClipOp clip_op, bool is_aa) override;
+  void clipPath(const SkPath& path, SkClipOp clip_op, bool is_aa) override;
+
+  void drawPaint() override;
+  void drawColor(SkColor color, SkBlendMode mode) override;
+  void drawLine(const SkPoint& p0, const SkPoint& p1) override;
+  void drawRect(const SkRect& rect) override;
+  void drawOval(const SkRect& bounds) override;
+  void drawCircle(const SkPoint& center, SkScalar radius) override;
+  void drawRRect(const SkRRect& rrect) override;
+  void drawDRRect(const SkRRect& outer, const SkRRect& inner) override;
+  void drawPath(const SkPath& path) override;
+  void drawArc(const SkRect& bounds,
+               SkScalar start,
+               SkScalar sweep,
+               bool useCenter) override;
+  void drawPoints(SkCanvas::PointMode mode,
+                  uint32_t count,
+                  const SkPoint pts[]) override;
+  void drawVertices(const sk_sp<SkVertices> vertices,
+                    SkBlendMode mode) override;
+  void drawImage(const sk_sp<SkImage> image,
+                 const SkPoint point,
+                 const SkSamplingOptions& sampling,
+                 bool render_with_attributes) override;
+  void drawImageRect(const sk_sp<SkImage> image,
+                     const SkRect& src,
+                     const SkRect& dst,
+                     const SkSamplingOptions& sampling,
+                     bool render_with_attributes,
+                     SkCanvas::SrcRectConstraint constraint) override;
+  void drawImageNine(const sk_sp<SkImage> image,
+                     const SkIRect& center,
+                     const SkRect& dst,
+                     SkFilterMode filter,
+                     bool render_with_attributes) override;
+  void drawImageLattice(const sk_sp<SkImage> image,
+                        const SkCanvas::Lattice& lattice,
+                        const SkRect& dst,
+                        SkFilterMode filter,
+                        bool render_with_attributes) override;
+  void drawAtlas(const sk_sp<SkImage> atlas,
+                 const SkRSXform xform[],
+                 const SkRect tex[],
+                 const SkColor colors[],
+                 int count,
+                 SkBlendMode mode,
+                 const SkSamplingOptions& sampling,
+                 const SkRect* cullRect,
+                 bool render_with_attributes) override;
+  void drawPicture(const sk_sp<SkPicture> picture,
+                   const SkMatrix* matrix,
+                   bool render_with_attributes) override;
+  void drawDisplayList(const sk_sp<DisplayList> display_list) override;
+  void drawTextBlob(const sk_sp<SkTextBlob> blob,
+                    SkScalar x,
+                    SkScalar y) override;
+  void drawShadow(const SkPath& path,
+                  const SkColor color,
+                  const SkScalar elevation,
+                  bool transparent_occluder,
+                  SkScalar dpr) override;
+
+  sk_sp<DisplayList> Build();
+
+  // The number of records received and emitted so far.
+  int ops_received() const { return ops_received_; }
+  int ops_emitted() const { return ops_emitted_; }
+
+ private:
+  // The rendering attributes as they would be tracked by an SkPaint.
+  // One copy tracks the values requested by the source stream and
+  // another copy tracks the values last emitted into the builder.
+  struct Attributes {
+    bool anti_alias = false;
+    bool dither = false;
+    bool invert_colors = false;
+    SkPaint::Cap cap = SkPaint::kButt_Cap;
+    SkPaint::Join join = SkPaint::kMiter_Join;
+    SkPaint::Style style = SkPaint::kFill_Style;
+    SkScalar stroke_width = 0.0f;
+    SkScalar stroke_miter = 4.0f;
+    SkColor color = SK_ColorBLACK;
+    // A non-null blender overrides the blend_mode. Setting either
+    // of them resets the other, just like on an SkPaint.
+    SkBlendMode blend_mode = SkBlendMode::kSrcOver;
+    sk_sp<SkBlender> blender;
+    sk_sp<SkShader> shader;
+    sk_sp<SkColorFilter> color_filter;
+    sk_sp<SkImageFilter> image_filter;
+    sk_sp<SkPathEffect> path_effect;
+    // A mask filter is either an explicit object or the parameters
+    // for a blur mask filter, never both.
+    sk_sp<SkMaskFilter> mask_filter;
+    bool has_mask_blur = false;
+    SkBlurStyle mask_blur_style = kNormal_SkBlurStyle;
+    SkScalar mask_blur_sigma = 0.0f;
+  };
+
+  // A transform or clip that has been received but not yet emitted
+  // because nothing has been rendered under it yet.
+  struct PendingOp {
+    enum class Type {
+      kTranslate,
+      kScale,
+      kRotate,
+      kSkew,
+      kMatrix,
+      kClipRect,
+      kClipRRect,
+      kClipPath,
+    };
+
+    Type type;
+    // Only meaningful for the transform types, kMatrix accumulates
+    // any number of adjacent transforms.
+    SkScalar args[2] = {0.0f, 0.0f};
+    SkM44 matrix;
+    // Only meaningful for the clip types
+    SkRect rect;
+    SkRRect rrect;
+    SkPath path;
+    SkClipOp clip_op = SkClipOp::kIntersect;
+    bool is_aa = false;
+
+    bool is_transform() const { return type <= Type::kMatrix; }
+  };
+
+  // One entry per outstanding |save| or |saveLayer| plus a root entry
+  // for the top level of the DisplayList.
+  struct SaveInfo {
+    bool emitted;
+    bool cull_enabled;
+    std::vector<PendingOp> pending;
+  };
+
+  DisplayListBuilder builder_;
+  std::vector<SaveInfo> save_stack_;
+  Attributes current_;
+  Attributes emitted_;
+
+  int ops_received_ = 0;
+  int ops_emitted_ = 0;
+
+  // Flags describing how an op interacts with the rendering attributes
+  // for the purpose of computing its bounds for culling.
+  static constexpr int kIgnoresAttributes = 0x00;
+  static constexpr int kUsesAttributes = 0x01;
+  static constexpr int kIsStroked = 0x02;
+
+  void PushTransform(PendingOp::Type type,
+                     const SkM44& matrix,
+                     SkScalar arg0 = 0.0f,
+                     SkScalar arg1 = 0.0f);
+  void PushClip(PendingOp op);
+
+  // Emits all deferred saves, transforms and clips so that the next
+  // rendering op will execute under the correct state.
+  void FlushState();
+  void FlushAttributes();
+  void EmitPendingOp(const PendingOp& op);
+
+  // Returns true if an op with the indicated local bounds can be
+  // dropped because it cannot touch any pixel inside the current
+  // clip (which always includes the cull rect of the DisplayList).
+  // Performs all of the flushing required before the op is emitted
+  // if it returns false.
+  bool Cull(const SkRect& local_bounds, int flags);
+  // For unbounded ops such as |drawPaint| and |drawColor|.
+  bool CullUnbounded(int flags);
+
+  FML_DISALLOW_COPY_AND_ASSIGN(DisplayListOptimizer);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_FLOW_DISPLAY_LIST_OPTIMIZER_H_
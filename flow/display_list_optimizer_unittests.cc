@@ -0,0 +1,234 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/display_list_optimizer.h"
+
+#include "third_party/skia/include/core/SkPixmap.h"
+#include "third_party/skia/include/core/SkSurface.h"
+#include "third_party/skia/include/effects/SkImageFilters.h"
+
+#include "gtest/gtest.h"
+
+namespace flutter {
+namespace testing {
+
+static const SkRect kTestCull = SkRect::MakeLTRB(0, 0, 100, 100);
+static const SkRect kOnscreenRect = SkRect::MakeLTRB(10, 10, 20, 20);
+static const SkRect kOffscreenRect = SkRect::MakeLTRB(200, 200, 300, 300);
+
+static void ExpectOptimizesTo(const sk_sp<DisplayList>& display_list,
+                              const sk_sp<DisplayList>& expected) {
+  sk_sp<DisplayList> optimized = DisplayListOptimizer::Optimize(display_list);
+  EXPECT_EQ(optimized->op_count(), expected->op_count());
+  EXPECT_EQ(optimized->bytes(), expected->bytes());
+  EXPECT_TRUE(optimized->Equals(*expected));
+}
+
+TEST(DisplayListOptimizer, RedundantAttributesAreDropped) {
+  DisplayListBuilder builder(kTestCull);
+  builder.setAntiAlias(false);
+  builder.setColor(SK_ColorRED);
+  builder.setColor(SK_ColorBLUE);
+  builder.setColor(SK_ColorRED);
+  builder.drawRect(kOnscreenRect);
+  builder.setColor(SK_ColorRED);
+  builder.drawOval(kOnscreenRect);
+  builder.setColor(SK_ColorGREEN);
+  sk_sp<DisplayList> display_list = builder.Build();
+
+  DisplayListBuilder expected(kTestCull);
+  expected.setColor(SK_ColorRED);
+  expected.drawRect(kOnscreenRect);
+  expected.drawOval(kOnscreenRect);
+
+  ExpectOptimizesTo(display_list, expected.Build());
+
+  DisplayListOptimizer::Stats stats;
+  DisplayListOptimizer::Optimize(display_list, &stats);
+  EXPECT_EQ(stats.original_op_count, 8);
+  EXPECT_EQ(stats.optimized_op_count, 3);
+  EXPECT_EQ(stats.ops_saved(), 5);
+  EXPECT_EQ(stats.original_bytes, display_list->bytes());
+  EXPECT_EQ(stats.bytes_saved(), 5u * 8u);
+}
+
+TEST(DisplayListOptimizer, AttributesForSaveLayerAreKept) {
+  DisplayListBuilder builder(kTestCull);
+  builder.setColor(SK_ColorRED);
+  builder.saveLayer(nullptr, true);
+  builder.setColor(SK_ColorBLUE);
+  builder.drawRect(kOnscreenRect);
+  builder.restore();
+  sk_sp<DisplayList> display_list = builder.Build();
+
+  sk_sp<DisplayList> optimized = DisplayListOptimizer::Optimize(display_list);
+  EXPECT_EQ(optimized.get(), display_list.get());
+}
+
+TEST(DisplayListOptimizer, EmptySaveRestoreIsFolded) {
+  DisplayListBuilder builder(kTestCull);
+  builder.save();
+  builder.translate(10, 10);
+  builder.clipRect(kOnscreenRect, SkClipOp::kIntersect, false);
+  builder.restore();
+  builder.drawRect(kOnscreenRect);
+  sk_sp<DisplayList> display_list = builder.Build();
+
+  DisplayListBuilder expected(kTestCull);
+  expected.drawRect(kOnscreenRect);
+
+  ExpectOptimizesTo(display_list, expected.Build());
+}
+
+TEST(DisplayListOptimizer, NonEmptySaveRestoreIsKept) {
+  DisplayListBuilder builder(kTestCull);
+  builder.save();
+  builder.clipRect(kOnscreenRect, SkClipOp::kIntersect, false);
+  builder.drawRect(kOnscreenRect);
+  builder.restore();
+  builder.drawOval(kOnscreenRect);
+  sk_sp<DisplayList> display_list = builder.Build();
+
+  sk_sp<DisplayList> optimized = DisplayListOptimizer::Optimize(display_list);
+  EXPECT_EQ(optimized.get(), display_list.get());
+}
+
+TEST(DisplayListOptimizer, AdjacentTransformsAreFolded) {
+  DisplayListBuilder builder(kTestCull);
+  builder.translate(10, 10);
+  builder.translate(5, 5);
+  builder.drawRect(kOnscreenRect);
+  sk_sp<DisplayList> display_list = builder.Build();
+
+  DisplayListBuilder expected(kTestCull);
+  expected.translate(15, 15);
+  expected.drawRect(kOnscreenRect);
+
+  ExpectOptimizesTo(display_list, expected.Build());
+}
+
+TEST(DisplayListOptimizer, IdentityTransformsAreDropped) {
+  DisplayListBuilder builder(kTestCull);
+  builder.translate(10, 0);
+  builder.translate(-10, 0);
+  builder.scale(1, 1);
+  builder.drawRect(kOnscreenRect);
+  sk_sp<DisplayList> display_list = builder.Build();
+
+  DisplayListBuilder expected(kTestCull);
+  expected.drawRect(kOnscreenRect);
+
+  ExpectOptimizesTo(display_list, expected.Build());
+}
+
+TEST(DisplayListOptimizer, DrawsOutsideCullRectAreRemoved) {
+  DisplayListBuilder builder(kTestCull);
+  builder.drawRect(kOffscreenRect);
+  builder.drawRect(kOnscreenRect);
+  builder.save();
+  builder.translate(200, 200);
+  builder.drawOval(kOnscreenRect);
+  builder.restore();
+  sk_sp<DisplayList> display_list = builder.Build();
+
+  DisplayListBuilder expected(kTestCull);
+  expected.drawRect(kOnscreenRect);
+
+  ExpectOptimizesTo(display_list, expected.Build());
+}
+
+TEST(DisplayListOptimizer, DrawsOutsideClipAreRemoved) {
+  DisplayListBuilder builder(kTestCull);
+  builder.save();
+  builder.clipRect(kOnscreenRect, SkClipOp::kIntersect, false);
+  builder.drawRect(SkRect::MakeLTRB(50, 50, 60, 60));
+  builder.restore();
+  sk_sp<DisplayList> display_list = builder.Build();
+
+  ExpectOptimizesTo(display_list, DisplayListBuilder(kTestCull).Build());
+}
+
+TEST(DisplayListOptimizer, StrokedDrawsNearCullRectAreKept) {
+  DisplayListBuilder builder(kTestCull);
+  builder.setStyle(SkPaint::kStroke_Style);
+  builder.setStrokeWidth(20);
+  builder.drawRect(SkRect::MakeLTRB(105, 105, 120, 120));
+  sk_sp<DisplayList> display_list = builder.Build();
+
+  sk_sp<DisplayList> optimized = DisplayListOptimizer::Optimize(display_list);
+  EXPECT_EQ(optimized.get(), display_list.get());
+}
+
+TEST(DisplayListOptimizer, DrawsInsideImageFilterLayerAreKept) {
+  DisplayListBuilder builder(kTestCull);
+  builder.setImageFilter(SkImageFilters::Offset(-150, -150, nullptr));
+  builder.saveLayer(nullptr, true);
+  builder.setImageFilter(nullptr);
+  builder.drawRect(kOffscreenRect);
+  builder.restore();
+  sk_sp<DisplayList> display_list = builder.Build();
+
+  sk_sp<DisplayList> optimized = DisplayListOptimizer::Optimize(display_list);
+  EXPECT_EQ(optimized.get(), display_list.get());
+}
+
+TEST(DisplayListOptimizer, OptimizedListRendersIdentically) {
+  DisplayListBuilder builder(kTestCull);
+  builder.setAntiAlias(true);
+  builder.setColor(SK_ColorRED);
+  builder.save();
+  builder.translate(5, 5);
+  builder.translate(5, 5);
+  builder.clipRect(SkRect::MakeLTRB(0, 0, 50, 50), SkClipOp::kIntersect,
+                   true);
+  builder.setColor(SK_ColorBLUE);
+  builder.drawCircle({20, 20}, 15);
+  builder.drawRect(kOffscreenRect);
+  builder.restore();
+  builder.save();
+  builder.restore();
+  builder.setColor(SK_ColorGREEN);
+  builder.setColor(SK_ColorGREEN);
+  builder.setStyle(SkPaint::kStroke_Style);
+  builder.setStrokeWidth(4);
+  builder.drawLine({0, 90}, {90, 90});
+  sk_sp<DisplayList> display_list = builder.Build();
+
+  DisplayListOptimizer::Stats stats;
+  sk_sp<DisplayList> optimized =
+      DisplayListOptimizer::Optimize(display_list, &stats);
+  ASSERT_NE(optimized.get(), display_list.get());
+  EXPECT_GT(stats.ops_saved(), 0);
+  EXPECT_GT(stats.bytes_saved(), 0u);
+
+  sk_sp<SkSurface> expected_surface = SkSurface::MakeRasterN32Premul(100, 100);
+  sk_sp<SkSurface> actual_surface = SkSurface::MakeRasterN32Premul(100, 100);
+  display_list->RenderTo(expected_surface->getCanvas());
+  optimized->RenderTo(actual_surface->getCanvas());
+  SkPixmap expected_pixels;
+  SkPixmap actual_pixels;
+  ASSERT_TRUE(expected_surface->peekPixels(&expected_pixels));
+  ASSERT_TRUE(actual_surface->peekPixels(&actual_pixels));
+  for (int y = 0; y < 100; y++) {
+    for (int x = 0; x < 100; x++) {
+      ASSERT_EQ(*expected_pixels.addr32(x, y), *actual_pixels.addr32(x, y))
+          << "at " << x << ", " << y;
+    }
+  }
+}
+
+TEST(DisplayListOptimizer, OptimizedListKeepsRTree) {
+  DisplayListBuilder builder(kTestCull, true);
+  builder.setColor(SK_ColorRED);
+  builder.setColor(SK_ColorBLUE);
+  builder.drawRect(kOnscreenRect);
+  sk_sp<DisplayList> display_list = builder.Build();
+
+  sk_sp<DisplayList> optimized = DisplayListOptimizer::Optimize(display_list);
+  ASSERT_NE(optimized.get(), display_list.get());
+  EXPECT_TRUE(optimized->has_rtree());
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -0,0 +1,1474 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/display_list_serialization.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <unordered_map>
+
+#include "flutter/flow/display_list_canvas.h"
+#include "flutter/fml/logging.h"
+#include "third_party/skia/include/core/SkColorSpace.h"
+#include "third_party/skia/include/core/SkFlattenable.h"
+#include "third_party/skia/include/core/SkMaskFilter.h"
+#include "third_party/skia/include/core/SkPixmap.h"
+#include "third_party/skia/include/core/SkRRect.h"
+#include "third_party/skia/include/core/SkRSXform.h"
+
+namespace flutter {
+
+namespace {
+
+using ObjectType = DisplayListSerializer::ObjectType;
+
+struct FileHeader {
+  uint32_t magic;
+  uint32_t version;
+  SkRect cull_rect;
+  uint32_t op_count;
+  uint32_t object_count;
+  uint64_t objects_size;
+  uint64_t ops_size;
+};
+static_assert(sizeof(FileHeader) == 48, "The header must be 8 byte aligned");
+
+// Every op record and every entry of the object table starts with this
+// header. The size includes the header itself and the padding at the
+// end of the record, which aligns op records to 4 bytes and objects to
+// 8 bytes.
+struct RecordHeader {
+  uint32_t type;
+  uint32_t size;
+};
+
+constexpr size_t kRecordAlignment = 4;
+constexpr size_t kObjectAlignment = 8;
+
+constexpr auto kLastOpType = DisplayListOpType::kDrawShadowTransparentOccluder;
+constexpr auto kLastObjectType = ObjectType::kBlender;
+
+size_t AlignTo(size_t offset, size_t alignment) {
+  return (offset + alignment - 1) & ~(alignment - 1);
+}
+
+class ByteWriter {
+ public:
+  size_t size() const { return bytes_.size(); }
+  const uint8_t* data() const { return bytes_.data(); }
+
+  void WriteBytes(const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    bytes_.insert(bytes_.end(), bytes, bytes + size);
+  }
+
+  template <typename T>
+  void Write(const T& value) {
+    WriteArray(&value, 1);
+  }
+
+  template <typename T>
+  void WriteArray(const T* values, size_t count) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    static_assert(alignof(T) <= kRecordAlignment);
+    WriteBytes(values, sizeof(T) * count);
+    Align(kRecordAlignment);
+  }
+
+  // Writes a length prefixed block of bytes. The bytes are 8 byte
+  // aligned so that they can hold a nested serialized DisplayList.
+  void WriteData(const void* data, size_t size) {
+    FML_DCHECK(size <= std::numeric_limits<uint32_t>::max());
+    Write(static_cast<uint32_t>(size));
+    Align(kObjectAlignment);
+    WriteBytes(data, size);
+    Align(kRecordAlignment);
+  }
+
+  void Align(size_t alignment) {
+    bytes_.resize(AlignTo(bytes_.size(), alignment), 0);
+  }
+
+  size_t BeginRecord(uint32_t type) {
+    size_t offset = size();
+    Write(RecordHeader{type, 0});
+    return offset;
+  }
+
+  void EndRecord(size_t offset, size_t alignment) {
+    Align(alignment);
+    uint32_t size = static_cast<uint32_t>(bytes_.size() - offset);
+    memcpy(&bytes_[offset + offsetof(RecordHeader, size)], &size,
+           sizeof(size));
+  }
+
+ private:
+  std::vector<uint8_t> bytes_;
+};
+
+// Records the calls of a DisplayList dispatch in the serialized format.
+class DisplayListWriter final : public virtual Dispatcher {
+ public:
+  sk_sp<SkData> Finish(const SkRect& cull_rect) {
+    EndRecord();
+    if (!ok_) {
+      return nullptr;
+    }
+    FileHeader header = {
+        DisplayListSerializer::kMagic,
+        DisplayListSerializer::kVersion,
+        cull_rect,
+        op_count_,
+        object_count_,
+        objects_.size(),
+        ops_.size(),
+    };
+    sk_sp<SkData> data =
+        SkData::MakeUninitialized(sizeof(header) + header.objects_size +
+                                  header.ops_size);
+    uint8_t* ptr = static_cast<uint8_t*>(data->writable_data());
+    memcpy(ptr, &header, sizeof(header));
+    ptr += sizeof(header);
+    memcpy(ptr, objects_.data(), objects_.size());
+    ptr += objects_.size();
+    memcpy(ptr, ops_.data(), ops_.size());
+    return data;
+  }
+
+  void setAntiAlias(bool aa) override {
+    Begin(DisplayListOpType::kSetAntiAlias);
+    WriteBool(aa);
+  }
+  void setDither(bool dither) override {
+    Begin(DisplayListOpType::kSetDither);
+    WriteBool(dither);
+  }
+  void setInvertColors(bool invert) override {
+    Begin(DisplayListOpType::kSetInvertColors);
+    WriteBool(invert);
+  }
+  void setStrokeCap(SkPaint::Cap cap) override {
+    Begin(DisplayListOpType::kSetStrokeCap);
+    WriteEnum(cap);
+  }
+  void setStrokeJoin(SkPaint::Join join) override {
+    Begin(DisplayListOpType::kSetStrokeJoin);
+    WriteEnum(join);
+  }
+  void setStyle(SkPaint::Style style) override {
+    Begin(DisplayListOpType::kSetStyle);
+    WriteEnum(style);
+  }
+  void setStrokeWidth(SkScalar width) override {
+    Begin(DisplayListOpType::kSetStrokeWidth);
+    ops_.Write(width);
+  }
+  void setStrokeMiter(SkScalar limit) override {
+    Begin(DisplayListOpType::kSetStrokeMiter);
+    ops_.Write(limit);
+  }
+  void setColor(SkColor color) override {
+    Begin(DisplayListOpType::kSetColor);
+    ops_.Write(color);
+  }
+  void setBlendMode(SkBlendMode mode) override {
+    Begin(DisplayListOpType::kSetBlendMode);
+    WriteEnum(mode);
+  }
+  void setBlender(sk_sp<SkBlender> blender) override {
+    SetFlattenable(blender.get(), ObjectType::kBlender,
+                   DisplayListOpType::kSetBlender,
+                   DisplayListOpType::kClearBlender);
+  }
+  void setShader(sk_sp<SkShader> shader) override {
+    SetFlattenable(shader.get(), ObjectType::kShader,
+                   DisplayListOpType::kSetShader,
+                   DisplayListOpType::kClearShader);
+  }
+  void setImageFilter(sk_sp<SkImageFilter> filter) override {
+    SetFlattenable(filter.get(), ObjectType::kImageFilter,
+                   DisplayListOpType::kSetImageFilter,
+                   DisplayListOpType::kClearImageFilter);
+  }
+  void setColorFilter(sk_sp<SkColorFilter> filter) override {
+    SetFlattenable(filter.get(), ObjectType::kColorFilter,
+                   DisplayListOpType::kSetColorFilter,
+                   DisplayListOpType::kClearColorFilter);
+  }
+  void setPathEffect(sk_sp<SkPathEffect> effect) override {
+    SetFlattenable(effect.get(), ObjectType::kPathEffect,
+                   DisplayListOpType::kSetPathEffect,
+                   DisplayListOpType::kClearPathEffect);
+  }
+  void setMaskFilter(sk_sp<SkMaskFilter> filter) override {
+    SetFlattenable(filter.get(), ObjectType::kMaskFilter,
+                   DisplayListOpType::kSetMaskFilter,
+                   DisplayListOpType::kClearMaskFilter);
+  }
+  void setMaskBlurFilter(SkBlurStyle style, SkScalar sigma) override {
+    switch (style) {
+      case kNormal_SkBlurStyle:
+        Begin(DisplayListOpType::kSetMaskBlurFilterNormal);
+        break;
+      case kSolid_SkBlurStyle:
+        Begin(DisplayListOpType::kSetMaskBlurFilterSolid);
+        break;
+      case kOuter_SkBlurStyle:
+        Begin(DisplayListOpType::kSetMaskBlurFilterOuter);
+        break;
+      case kInner_SkBlurStyle:
+        Begin(DisplayListOpType::kSetMaskBlurFilterInner);
+        break;
+    }
+    ops_.Write(sigma);
+  }
+
+  void save() override { Begin(DisplayListOpType::kSave); }
+  void saveLayer(const SkRect* bounds, bool restore_with_paint) override {
+    if (bounds) {
+      Begin(DisplayListOpType::kSaveLayerBounds);
+      ops_.Write(*bounds);
+    } else {
+      Begin(DisplayListOpType::kSaveLayer);
+    }
+    WriteBool(restore_with_paint);
+  }
+  void restore() override { Begin(DisplayListOpType::kRestore); }
+
+  void translate(SkScalar tx, SkScalar ty) override {
+    Begin(DisplayListOpType::kTranslate);
+    ops_.Write(SkPoint::Make(tx, ty));
+  }
+  void scale(SkScalar sx, SkScalar sy) override {
+    Begin(DisplayListOpType::kScale);
+    ops_.Write(SkPoint::Make(sx, sy));
+  }
+  void rotate(SkScalar degrees) override {
+    Begin(DisplayListOpType::kRotate);
+    ops_.Write(degrees);
+  }
+  void skew(SkScalar sx, SkScalar sy) override {
+    Begin(DisplayListOpType::kSkew);
+    ops_.Write(SkPoint::Make(sx, sy));
+  }
+
+  // clang-format off
+
+  void transform2DAffine(SkScalar mxx, SkScalar mxy, SkScalar mxt,
+                         SkScalar myx, SkScalar myy, SkScalar myt) override {
+    Begin(DisplayListOpType::kTransform2DAffine);
+    const SkScalar values[] = {mxx, mxy, mxt, myx, myy, myt};
+    ops_.WriteArray(values, 6);
+  }
+  void transformFullPerspective(
+      SkScalar mxx, SkScalar mxy, SkScalar mxz, SkScalar mxt,
+      SkScalar myx, SkScalar myy, SkScalar myz, SkScalar myt,
+      SkScalar mzx, SkScalar mzy, SkScalar mzz, SkScalar mzt,
+      SkScalar mwx, SkScalar mwy, SkScalar mwz, SkScalar mwt) override {
+    Begin(DisplayListOpType::kTransformFullPerspective);
+    const SkScalar values[] = {mxx, mxy, mxz, mxt,
+                               myx, myy, myz, myt,
+                               mzx, mzy, mzz, mzt,
+                               mwx, mwy, mwz, mwt};
+    ops_.WriteArray(values, 16);
+  }
+
+  // clang-format on
+
+  void clipRect(const SkRect& rect, SkClipOp clip_op, bool is_aa) override {
+    Begin(clip_op == SkClipOp::kIntersect
+              ? DisplayListOpType::kClipIntersectRect
+              : DisplayListOpType::kClipDifferenceRect);
+    ops_.Write(rect);
+    WriteBool(is_aa);
+  }
+  void clipRRect(const SkRRect& rrect,
+                 SkClipOp clip_op,
+                 bool is_aa) override {
+    Begin(clip_op == SkClipOp::kIntersect
+              ? DisplayListOpType::kClipIntersectRRect
+              : DisplayListOpType::kClipDifferenceRRect);
+    WriteRRect(rrect);
+    WriteBool(is_aa);
+  }
+  void clipPath(const SkPath& path, SkClipOp clip_op, bool is_aa) override {
+    Begin(clip_op == SkClipOp::kIntersect
+              ? DisplayListOpType::kClipIntersectPath
+              : DisplayListOpType::kClipDifferencePath);
+    WritePath(path);
+    WriteBool(is_aa);
+  }
+
+  void drawPaint() override { Begin(DisplayListOpType::kDrawPaint); }
+  void drawColor(SkColor color, SkBlendMode mode) override {
+    Begin(DisplayListOpType::kDrawColor);
+    ops_.Write(color);
+    WriteEnum(mode);
+  }
+  void drawLine(const SkPoint& p0, const SkPoint& p1) override {
+    Begin(DisplayListOpType::kDrawLine);
+    ops_.Write(p0);
+    ops_.Write(p1);
+  }
+  void drawRect(const SkRect& rect) override {
+    Begin(DisplayListOpType::kDrawRect);
+    ops_.Write(rect);
+  }
+  void drawOval(const SkRect& bounds) override {
+    Begin(DisplayListOpType::kDrawOval);
+    ops_.Write(bounds);
+  }
+  void drawCircle(const SkPoint& center, SkScalar radius) override {
+    Begin(DisplayListOpType::kDrawCircle);
+    ops_.Write(center);
+    ops_.Write(radius);
+  }
+  void drawRRect(const SkRRect& rrect) override {
+    Begin(DisplayListOpType::kDrawRRect);
+    WriteRRect(rrect);
+  }
+  void drawDRRect(const SkRRect& outer, const SkRRect& inner) override {
+    Begin(DisplayListOpType::kDrawDRRect);
+    WriteRRect(outer);
+    WriteRRect(inner);
+  }
+  void drawPath(const SkPath& path) override {
+    Begin(DisplayListOpType::kDrawPath);
+    WritePath(path);
+  }
+  void drawArc(const SkRect& bounds,
+               SkScalar start,
+               SkScalar sweep,
+               bool use_center) override {
+    Begin(DisplayListOpType::kDrawArc);
+    ops_.Write(bounds);
+    ops_.Write(start);
+    ops_.Write(sweep);
+    WriteBool(use_center);
+  }
+  void drawPoints(SkCanvas::PointMode mode,
+                  uint32_t count,
+                  const SkPoint pts[]) override {
+    switch (mode) {
+      case SkCanvas::PointMode::kPoints_PointMode:
+        Begin(DisplayListOpType::kDrawPoints);
+        break;
+      case SkCanvas::PointMode::kLines_PointMode:
+        Begin(DisplayListOpType::kDrawLines);
+        break;
+      case SkCanvas::PointMode::kPolygon_PointMode:
+        Begin(DisplayListOpType::kDrawPolygon);
+        break;
+    }
+    ops_.Write(count);
+    ops_.WriteArray(pts, count);
+  }
+  void drawVertices(const sk_sp<SkVertices> vertices,
+                    SkBlendMode mode) override {
+    // Skia does not expose the contents of SkVertices.
+    Begin(DisplayListOpType::kDrawVertices);
+    ok_ = false;
+  }
+  void drawImage(const sk_sp<SkImage> image,
+                 const SkPoint point,
+                 const SkSamplingOptions& sampling,
+                 bool render_with_attributes) override {
+    Begin(render_with_attributes ? DisplayListOpType::kDrawImageWithAttr
+                                 : DisplayListOpType::kDrawImage);
+    WriteImage(image);
+    ops_.Write(point);
+    WriteSampling(sampling);
+  }
+  void drawImageRect(const sk_sp<SkImage> image,
+                     const SkRect& src,
+                     const SkRect& dst,
+                     const SkSamplingOptions& sampling,
+                     bool render_with_attributes,
+                     SkCanvas::SrcRectConstraint constraint) override {
+    Begin(DisplayListOpType::kDrawImageRect);
+    WriteImage(image);
+    ops_.Write(src);
+    ops_.Write(dst);
+    WriteSampling(sampling);
+    WriteBool(render_with_attributes);
+    WriteEnum(constraint);
+  }
+  void drawImageNine(const sk_sp<SkImage> image,
+                     const SkIRect& center,
+                     const SkRect& dst,
+                     SkFilterMode filter,
+                     bool render_with_attributes) override {
+    Begin(render_with_attributes ? DisplayListOpType::kDrawImageNineWithAttr
+                                 : DisplayListOpType::kDrawImageNine);
+    WriteImage(image);
+    ops_.Write(center);
+    ops_.Write(dst);
+    WriteEnum(filter);
+  }
+  void drawImageLattice(const sk_sp<SkImage> image,
+                        const SkCanvas::Lattice& lattice,
+                        const SkRect& dst,
+                        SkFilterMode filter,
+                        bool render_with_attributes) override {
+    Begin(DisplayListOpType::kDrawImageLattice);
+    WriteImage(image);
+    ops_.Write(dst);
+    WriteEnum(filter);
+    WriteBool(render_with_attributes);
+    int cell_count = lattice.fRectTypes && lattice.fColors
+                         ? (lattice.fXCount + 1) * (lattice.fYCount + 1)
+                         : 0;
+    ops_.Write(lattice.fXCount);
+    ops_.Write(lattice.fYCount);
+    ops_.Write(cell_count);
+    WriteBool(lattice.fBounds != nullptr);
+    ops_.Write(lattice.fBounds ? *lattice.fBounds : SkIRect::MakeEmpty());
+    ops_.WriteArray(lattice.fXDivs, lattice.fXCount);
+    ops_.WriteArray(lattice.fYDivs, lattice.fYCount);
+    ops_.WriteArray(lattice.fColors, cell_count);
+    ops_.WriteArray(lattice.fRectTypes, cell_count);
+  }
+  void drawAtlas(const sk_sp<SkImage> atlas,
+                 const SkRSXform xform[],
+                 const SkRect tex[],
+                 const SkColor colors[],
+                 int count,
+                 SkBlendMode mode,
+                 const SkSamplingOptions& sampling,
+                 const SkRect* cull_rect,
+                 bool render_with_attributes) override {
+    if (cull_rect) {
+      Begin(DisplayListOpType::kDrawAtlasCulled);
+      ops_.Write(*cull_rect);
+    } else {
+      Begin(DisplayListOpType::kDrawAtlas);
+    }
+    WriteImage(atlas);
+    WriteEnum(mode);
+    WriteSampling(sampling);
+    WriteBool(render_with_attributes);
+    WriteBool(colors != nullptr);
+    ops_.Write(count);
+    ops_.WriteArray(xform, count);
+    ops_.WriteArray(tex, count);
+    if (colors) {
+      ops_.WriteArray(colors, count);
+    }
+  }
+  void drawPicture(const sk_sp<SkPicture> picture,
+                   const SkMatrix* matrix,
+                   bool render_with_attributes) override {
+    if (matrix) {
+      Begin(DisplayListOpType::kDrawSkPictureMatrix);
+      SkScalar values[9];
+      matrix->get9(values);
+      ops_.WriteArray(values, 9);
+    } else {
+      Begin(DisplayListOpType::kDrawSkPicture);
+    }
+    WriteObject(picture.get(), ObjectType::kPicture, [&picture](auto& out) {
+      sk_sp<SkData> data = picture->serialize();
+      if (!data) {
+        return false;
+      }
+      out.WriteData(data->data(), data->size());
+      return true;
+    });
+    WriteBool(render_with_attributes);
+  }
+  void drawDisplayList(const sk_sp<DisplayList> display_list) override {
+    Begin(DisplayListOpType::kDrawDisplayList);
+    WriteObject(display_list.get(), ObjectType::kDisplayList,
+                [&display_list](auto& out) {
+                  sk_sp<SkData> data =
+                      DisplayListSerializer::Serialize(*display_list);
+                  if (!data) {
+                    return false;
+                  }
+                  out.WriteData(data->data(), data->size());
+                  return true;
+                });
+  }
+  void drawTextBlob(const sk_sp<SkTextBlob> blob,
+                    SkScalar x,
+                    SkScalar y) override {
+    Begin(DisplayListOpType::kDrawTextBlob);
+    WriteObject(blob.get(), ObjectType::kTextBlob, [&blob](auto& out) {
+      sk_sp<SkData> data = blob->serialize(SkSerialProcs());
+      if (!data) {
+        return false;
+      }
+      out.WriteData(data->data(), data->size());
+      return true;
+    });
+    ops_.Write(SkPoint::Make(x, y));
+  }
+  void drawShadow(const SkPath& path,
+                  const SkColor color,
+                  const SkScalar elevation,
+                  bool transparent_occluder,
+                  SkScalar dpr) override {
+    Begin(transparent_occluder
+              ? DisplayListOpType::kDrawShadowTransparentOccluder
+              : DisplayListOpType::kDrawShadow);
+    WritePath(path);
+    ops_.Write(color);
+    ops_.Write(elevation);
+    ops_.Write(dpr);
+  }
+
+ private:
+  ByteWriter ops_;
+  ByteWriter objects_;
+  uint32_t op_count_ = 0;
+  uint32_t object_count_ = 0;
+  bool ok_ = true;
+
+  bool in_record_ = false;
+  size_t record_offset_ = 0;
+
+  // Maps the objects that were already written to their index in the
+  // object table.
+  std::unordered_map<const void*, uint32_t> object_indices_;
+
+  void Begin(DisplayListOpType type) {
+    EndRecord();
+    record_offset_ = ops_.BeginRecord(static_cast<uint32_t>(type));
+    in_record_ = true;
+    op_count_++;
+  }
+
+  void EndRecord() {
+    if (in_record_) {
+      ops_.EndRecord(record_offset_, kRecordAlignment);
+      in_record_ = false;
+    }
+  }
+
+  void WriteBool(bool value) { ops_.Write<uint32_t>(value ? 1 : 0); }
+
+  template <typename T>
+  void WriteEnum(T value) {
+    ops_.Write(static_cast<uint32_t>(value));
+  }
+
+  void WriteRRect(const SkRRect& rrect) {
+    uint8_t buffer[SkRRect::kSizeInMemory];
+    rrect.writeToMemory(buffer);
+    ops_.WriteArray(buffer, sizeof(buffer));
+  }
+
+  void WriteSampling(const SkSamplingOptions& sampling) {
+    WriteBool(sampling.useCubic);
+    ops_.Write(sampling.cubic.B);
+    ops_.Write(sampling.cubic.C);
+    WriteEnum(sampling.filter);
+    WriteEnum(sampling.mipmap);
+  }
+
+  // Writes the index of the object table entry for |key| into the
+  // current record, adding the entry if it does not exist yet. The
+  // |write| function appends the contents of a new entry to the object
+  // table and returns false if the object cannot be serialized.
+  template <typename F>
+  void WriteObject(const void* key, ObjectType type, const F& write) {
+    auto it = key ? object_indices_.find(key) : object_indices_.end();
+    uint32_t index;
+    if (it != object_indices_.end()) {
+      index = it->second;
+    } else {
+      size_t offset = objects_.BeginRecord(static_cast<uint32_t>(type));
+      if (!write(objects_)) {
+        ok_ = false;
+      }
+      objects_.EndRecord(offset, kObjectAlignment);
+      index = object_count_++;
+      if (key) {
+        object_indices_[key] = index;
+      }
+    }
+    ops_.Write(index);
+  }
+
+  void WritePath(const SkPath& path) {
+    // Paths are values rather than references, so every path gets its
+    // own entry.
+    WriteObject(nullptr, ObjectType::kPath, [&path](auto& out) {
+      std::vector<uint8_t> buffer(path.writeToMemory(nullptr));
+      path.writeToMemory(buffer.data());
+      out.WriteData(buffer.data(), buffer.size());
+      return true;
+    });
+  }
+
+  void WriteImage(const sk_sp<SkImage>& image) {
+    WriteObject(image.get(), ObjectType::kImage, [&image](auto& out) {
+      sk_sp<SkImage> raster = image->makeRasterImage();
+      SkPixmap pixmap;
+      if (!raster || !raster->peekPixels(&pixmap) ||
+          pixmap.rowBytes() > std::numeric_limits<uint32_t>::max()) {
+        return false;
+      }
+      sk_sp<SkData> color_space =
+          pixmap.colorSpace() ? pixmap.colorSpace()->serialize() : nullptr;
+      out.Write(static_cast<uint32_t>(pixmap.width()));
+      out.Write(static_cast<uint32_t>(pixmap.height()));
+      out.Write(static_cast<uint32_t>(pixmap.colorType()));
+      out.Write(static_cast<uint32_t>(pixmap.alphaType()));
+      out.Write(static_cast<uint32_t>(pixmap.rowBytes()));
+      out.WriteData(color_space ? color_space->data() : nullptr,
+                    color_space ? color_space->size() : 0);
+      out.Align(kObjectAlignment);
+      out.WriteBytes(pixmap.addr(), pixmap.computeByteSize());
+      return true;
+    });
+  }
+
+  void SetFlattenable(SkFlattenable* flattenable,
+                      ObjectType type,
+                      DisplayListOpType set_type,
+                      DisplayListOpType clear_type) {
+    if (!flattenable) {
+      Begin(clear_type);
+      return;
+    }
+    Begin(set_type);
+    WriteObject(flattenable, type, [flattenable](auto& out) {
+      sk_sp<SkData> data = flattenable->serialize();
+      if (!data) {
+        return false;
+      }
+      out.WriteData(data->data(), data->size());
+      return true;
+    });
+  }
+};
+
+SkFlattenable::Type FlattenableType(ObjectType type) {
+  switch (type) {
+    case ObjectType::kShader:
+      return SkFlattenable::kSkShaderBase_Type;
+    case ObjectType::kColorFilter:
+      return SkFlattenable::kSkColorFilter_Type;
+    case ObjectType::kImageFilter:
+      return SkFlattenable::kSkImageFilter_Type;
+    case ObjectType::kPathEffect:
+      return SkFlattenable::kSkPathEffect_Type;
+    case ObjectType::kMaskFilter:
+      return SkFlattenable::kSkMaskFilter_Type;
+    case ObjectType::kBlender:
+      return SkFlattenable::kSkBlender_Type;
+    default:
+      FML_DCHECK(false);
+      return SkFlattenable::kSkShaderBase_Type;
+  }
+}
+
+template <typename T>
+sk_sp<T> AsEffect(const sk_sp<SkFlattenable>& flattenable) {
+  return sk_ref_sp(static_cast<T*>(flattenable.get()));
+}
+
+}  // namespace
+
+sk_sp<SkData> DisplayListSerializer::Serialize(
+    const DisplayList& display_list) {
+  DisplayListWriter writer;
+  display_list.Dispatch(writer);
+  return writer.Finish(display_list.cull_rect());
+}
+
+// Reads the parameters of a single op record or object table entry.
+// Every read is bounds checked and a failed read marks the reader as
+// failed and returns an empty value instead.
+class SerializedDisplayList::RecordReader {
+ public:
+  // |base| is the start of the serialized DisplayList, which is the
+  // reference for the alignment of the data.
+  RecordReader(const uint8_t* base, const uint8_t* ptr, const uint8_t* end)
+      : base_(base), ptr_(ptr), end_(end) {}
+
+  bool ok() const { return ok_; }
+  void Fail() { ok_ = false; }
+
+  template <typename T>
+  const T* ReadArray(size_t count) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    static_assert(alignof(T) <= kRecordAlignment);
+    if (!ok_ || count > static_cast<size_t>(end_ - ptr_) / sizeof(T)) {
+      ok_ = false;
+      return nullptr;
+    }
+    const T* values = reinterpret_cast<const T*>(ptr_);
+    ptr_ += sizeof(T) * count;
+    Align(kRecordAlignment);
+    return values;
+  }
+
+  template <typename T>
+  T Read() {
+    const T* value = ReadArray<T>(1);
+    return value ? *value : T();
+  }
+
+  bool ReadBool() { return Read<uint32_t>() != 0; }
+
+  template <typename T>
+  T ReadEnum(T last) {
+    uint32_t value = Read<uint32_t>();
+    if (value > static_cast<uint32_t>(last)) {
+      ok_ = false;
+      return T();
+    }
+    return static_cast<T>(value);
+  }
+
+  int ReadCount() {
+    uint32_t count = Read<uint32_t>();
+    if (count > static_cast<uint32_t>(std::numeric_limits<int>::max())) {
+      ok_ = false;
+      return 0;
+    }
+    return static_cast<int>(count);
+  }
+
+  const uint8_t* ReadData(size_t* size) {
+    *size = Read<uint32_t>();
+    Align(kObjectAlignment);
+    return ReadArray<uint8_t>(*size);
+  }
+
+  SkRRect ReadRRect() {
+    SkRRect rrect;
+    const uint8_t* data = ReadArray<uint8_t>(SkRRect::kSizeInMemory);
+    if (data && rrect.readFromMemory(data, SkRRect::kSizeInMemory) == 0) {
+      ok_ = false;
+    }
+    return rrect;
+  }
+
+  SkSamplingOptions ReadSampling() {
+    bool use_cubic = ReadBool();
+    SkScalar b = Read<SkScalar>();
+    SkScalar c = Read<SkScalar>();
+    SkFilterMode filter = ReadEnum(SkFilterMode::kLast);
+    SkMipmapMode mipmap = ReadEnum(SkMipmapMode::kLast);
+    return use_cubic ? SkSamplingOptions(SkCubicResampler{b, c})
+                     : SkSamplingOptions(filter, mipmap);
+  }
+
+  void Align(size_t alignment) {
+    size_t offset = AlignTo(ptr_ - base_, alignment);
+    ptr_ = offset < static_cast<size_t>(end_ - base_) ? base_ + offset : end_;
+  }
+
+ private:
+  const uint8_t* const base_;
+  const uint8_t* ptr_;
+  const uint8_t* const end_;
+  bool ok_ = true;
+};
+
+std::unique_ptr<SerializedDisplayList> SerializedDisplayList::Load(
+    std::shared_ptr<const fml::Mapping> mapping) {
+  if (!mapping || !mapping->GetMapping()) {
+    return nullptr;
+  }
+  const uint8_t* data = mapping->GetMapping();
+  size_t size = mapping->GetSize();
+  std::unique_ptr<SerializedDisplayList> display_list(
+      new SerializedDisplayList(std::move(mapping)));
+  if (!display_list->Parse(data, size)) {
+    return nullptr;
+  }
+  return display_list;
+}
+
+std::unique_ptr<SerializedDisplayList> SerializedDisplayList::LoadFromFile(
+    const std::string& path) {
+  std::shared_ptr<const fml::Mapping> mapping =
+      fml::FileMapping::CreateReadOnly(path);
+  if (!mapping) {
+    FML_LOG(ERROR) << "Could not map DisplayList file " << path;
+    return nullptr;
+  }
+  return Load(std::move(mapping));
+}
+
+SerializedDisplayList::SerializedDisplayList(
+    std::shared_ptr<const fml::Mapping> mapping)
+    : mapping_(std::move(mapping)) {}
+
+SerializedDisplayList::~SerializedDisplayList() = default;
+
+bool SerializedDisplayList::Parse(const uint8_t* data, size_t size) {
+  FileHeader header;
+  if (size < sizeof(header)) {
+    return false;
+  }
+  memcpy(&header, data, sizeof(header));
+  if (header.magic != DisplayListSerializer::kMagic) {
+    FML_LOG(ERROR) << "Not a serialized DisplayList";
+    return false;
+  }
+  if (header.version != DisplayListSerializer::kVersion) {
+    FML_LOG(ERROR) << "Unsupported serialized DisplayList version "
+                   << header.version;
+    return false;
+  }
+  size_t remaining = size - sizeof(header);
+  // The ops are read in place, so they must start at an aligned offset
+  // like the objects before them.
+  if (header.objects_size > remaining ||
+      header.objects_size % kObjectAlignment != 0 ||
+      header.ops_size != remaining - header.objects_size ||
+      header.op_count > std::numeric_limits<int>::max()) {
+    return false;
+  }
+
+  const uint8_t* ptr = data + sizeof(header);
+  const uint8_t* end = ptr + header.objects_size;
+  // Every object takes up at least the size of its record header.
+  objects_.reserve(std::min<size_t>(
+      header.object_count, header.objects_size / sizeof(RecordHeader)));
+  while (ptr < end) {
+    RecordHeader record;
+    if (static_cast<size_t>(end - ptr) < sizeof(record)) {
+      return false;
+    }
+    memcpy(&record, ptr, sizeof(record));
+    if (record.size < sizeof(record) ||
+        record.size > static_cast<size_t>(end - ptr) ||
+        record.size % kObjectAlignment != 0 ||
+        record.type > static_cast<uint32_t>(kLastObjectType)) {
+      return false;
+    }
+    Object object;
+    object.type = static_cast<ObjectType>(record.type);
+    RecordReader reader(data, ptr + sizeof(record), ptr + record.size);
+    if (!ParseObject(object.type, reader, object)) {
+      return false;
+    }
+    objects_.push_back(std::move(object));
+    ptr += record.size;
+  }
+  if (objects_.size() != header.object_count) {
+    return false;
+  }
+
+  ops_ = ptr;
+  ops_size_ = header.ops_size;
+  end = ptr + header.ops_size;
+  uint32_t op_count = 0;
+  while (ptr < end) {
+    RecordHeader record;
+    if (static_cast<size_t>(end - ptr) < sizeof(record)) {
+      return false;
+    }
+    memcpy(&record, ptr, sizeof(record));
+    if (record.size < sizeof(record) ||
+        record.size > static_cast<size_t>(end - ptr) ||
+        record.size % kRecordAlignment != 0 ||
+        record.type > static_cast<uint32_t>(kLastOpType)) {
+      return false;
+    }
+    ptr += record.size;
+    op_count++;
+  }
+  if (op_count != header.op_count) {
+    return false;
+  }
+  op_count_ = static_cast<int>(op_count);
+  cull_rect_ = header.cull_rect;
+  return true;
+}
+
+bool SerializedDisplayList::ParseObject(ObjectType type,
+                                        RecordReader& reader,
+                                        Object& object) {
+  size_t size;
+  switch (type) {
+    case ObjectType::kImage: {
+      uint32_t width = reader.Read<uint32_t>();
+      uint32_t height = reader.Read<uint32_t>();
+      SkColorType color_type = reader.ReadEnum(kLastEnum_SkColorType);
+      SkAlphaType alpha_type = reader.ReadEnum(kLastEnum_SkAlphaType);
+      size_t row_bytes = reader.Read<uint32_t>();
+      const uint8_t* color_space_data = reader.ReadData(&size);
+      sk_sp<SkColorSpace> color_space;
+      if (color_space_data && size > 0) {
+        color_space = SkColorSpace::Deserialize(color_space_data, size);
+        if (!color_space) {
+          return false;
+        }
+      }
+      if (!reader.ok() ||
+          width > static_cast<uint32_t>(std::numeric_limits<int>::max()) ||
+          height > static_cast<uint32_t>(std::numeric_limits<int>::max())) {
+        return false;
+      }
+      SkImageInfo info = SkImageInfo::Make(width, height, color_type,
+                                           alpha_type, std::move(color_space));
+      if (!info.validRowBytes(row_bytes)) {
+        return false;
+      }
+      reader.Align(kObjectAlignment);
+      size_t pixels_size = info.computeByteSize(row_bytes);
+      const uint8_t* pixels = reader.ReadArray<uint8_t>(pixels_size);
+      if (!pixels) {
+        return false;
+      }
+      // The pixels are used in place. The SkData keeps the mapping alive
+      // for as long as the image needs them.
+      sk_sp<SkData> pixel_data = SkData::MakeWithProc(
+          pixels, pixels_size,
+          [](const void* ptr, void* context) {
+            delete static_cast<std::shared_ptr<const fml::Mapping>*>(context);
+          },
+          new std::shared_ptr<const fml::Mapping>(mapping_));
+      object.image =
+          SkImage::MakeRasterData(info, std::move(pixel_data), row_bytes);
+      return object.image != nullptr;
+    }
+    case ObjectType::kPath: {
+      const uint8_t* data = reader.ReadData(&size);
+      return data && object.path.readFromMemory(data, size) != 0;
+    }
+    case ObjectType::kTextBlob: {
+      const uint8_t* data = reader.ReadData(&size);
+      if (data) {
+        object.text_blob = SkTextBlob::Deserialize(data, size, {});
+      }
+      return object.text_blob != nullptr;
+    }
+    case ObjectType::kPicture: {
+      const uint8_t* data = reader.ReadData(&size);
+      if (data) {
+        object.picture = SkPicture::MakeFromData(data, size);
+      }
+      return object.picture != nullptr;
+    }
+    case ObjectType::kDisplayList: {
+      const uint8_t* data = reader.ReadData(&size);
+      SerializedDisplayList nested(mapping_);
+      if (!data || !nested.Parse(data, size)) {
+        return false;
+      }
+      object.display_list = nested.Build();
+      return true;
+    }
+    case ObjectType::kShader:
+    case ObjectType::kColorFilter:
+    case ObjectType::kImageFilter:
+    case ObjectType::kPathEffect:
+    case ObjectType::kMaskFilter:
+    case ObjectType::kBlender: {
+      const uint8_t* data = reader.ReadData(&size);
+      if (data) {
+        object.flattenable =
+            SkFlattenable::Deserialize(FlattenableType(type), data, size);
+      }
+      return object.flattenable != nullptr;
+    }
+  }
+  return false;
+}
+
+const SerializedDisplayList::Object* SerializedDisplayList::ReadObject(
+    RecordReader& reader,
+    ObjectType type) const {
+  uint32_t index = reader.Read<uint32_t>();
+  if (!reader.ok() || index >= objects_.size() ||
+      objects_[index].type != type) {
+    reader.Fail();
+    return nullptr;
+  }
+  return &objects_[index];
+}
+
+void SerializedDisplayList::Dispatch(Dispatcher& dispatcher) const {
+  const uint8_t* ptr = ops_;
+  const uint8_t* end = ops_ + ops_size_;
+  while (ptr < end) {
+    // The record headers were validated by |Parse|.
+    RecordHeader record;
+    memcpy(&record, ptr, sizeof(record));
+    RecordReader reader(ptr, ptr + sizeof(record), ptr + record.size);
+    DispatchRecord(dispatcher, static_cast<DisplayListOpType>(record.type),
+                   reader);
+    ptr += record.size;
+  }
+}
+
+void SerializedDisplayList::RenderTo(SkCanvas* canvas) const {
+  DisplayListCanvasDispatcher dispatcher(canvas);
+  Dispatch(dispatcher);
+}
+
+sk_sp<DisplayList> SerializedDisplayList::Build() const {
+  DisplayListBuilder builder(cull_rect_);
+  Dispatch(builder);
+  return builder.Build();
+}
+
+void SerializedDisplayList::DispatchRecord(Dispatcher& dispatcher,
+                                           DisplayListOpType type,
+                                           RecordReader& reader) const {
+  // Each case reads all of the parameters of its record before it
+  // checks the reader, so a truncated or corrupt record is skipped
+  // as a whole.
+  switch (type) {
+    case DisplayListOpType::kSetAntiAlias: {
+      bool aa = reader.ReadBool();
+      if (reader.ok()) {
+        dispatcher.setAntiAlias(aa);
+      }
+      break;
+    }
+    case DisplayListOpType::kSetDither: {
+      bool dither = reader.ReadBool();
+      if (reader.ok()) {
+        dispatcher.setDither(dither);
+      }
+      break;
+    }
+    case DisplayListOpType::kSetInvertColors: {
+      bool invert = reader.ReadBool();
+      if (reader.ok()) {
+        dispatcher.setInvertColors(invert);
+      }
+      break;
+    }
+    case DisplayListOpType::kSetStrokeCap: {
+      SkPaint::Cap cap = reader.ReadEnum(SkPaint::kLast_Cap);
+      if (reader.ok()) {
+        dispatcher.setStrokeCap(cap);
+      }
+      break;
+    }
+    case DisplayListOpType::kSetStrokeJoin: {
+      SkPaint::Join join = reader.ReadEnum(SkPaint::kLast_Join);
+      if (reader.ok()) {
+        dispatcher.setStrokeJoin(join);
+      }
+      break;
+    }
+    case DisplayListOpType::kSetStyle: {
+      SkPaint::Style style = reader.ReadEnum(SkPaint::kStrokeAndFill_Style);
+      if (reader.ok()) {
+        dispatcher.setStyle(style);
+      }
+      break;
+    }
+    case DisplayListOpType::kSetStrokeWidth: {
+      SkScalar width = reader.Read<SkScalar>();
+      if (reader.ok()) {
+        dispatcher.setStrokeWidth(width);
+      }
+      break;
+    }
+    case DisplayListOpType::kSetStrokeMiter: {
+      SkScalar limit = reader.Read<SkScalar>();
+      if (reader.ok()) {
+        dispatcher.setStrokeMiter(limit);
+      }
+      break;
+    }
+    case DisplayListOpType::kSetColor: {
+      SkColor color = reader.Read<SkColor>();
+      if (reader.ok()) {
+        dispatcher.setColor(color);
+      }
+      break;
+    }
+    case DisplayListOpType::kSetBlendMode: {
+      SkBlendMode mode = reader.ReadEnum(SkBlendMode::kLastMode);
+      if (reader.ok()) {
+        dispatcher.setBlendMode(mode);
+      }
+      break;
+    }
+
+#define DL_SET_FLATTENABLE_CASES(name, type)                        \
+  case DisplayListOpType::kSet##name: {                             \
+    const Object* object = ReadObject(reader, ObjectType::k##name); \
+    if (reader.ok()) {                                              \
+      dispatcher.set##name(AsEffect<type>(object->flattenable));    \
+    }                                                               \
+    break;                                                          \
+  }                                                                 \
+  case DisplayListOpType::kClear##name:                             \
+    dispatcher.set##name(nullptr);                                  \
+    break;
+
+      DL_SET_FLATTENABLE_CASES(Blender, SkBlender)
+      DL_SET_FLATTENABLE_CASES(Shader, SkShader)
+      DL_SET_FLATTENABLE_CASES(ColorFilter, SkColorFilter)
+      DL_SET_FLATTENABLE_CASES(ImageFilter, SkImageFilter)
+      DL_SET_FLATTENABLE_CASES(PathEffect, SkPathEffect)
+      DL_SET_FLATTENABLE_CASES(MaskFilter, SkMaskFilter)
+
+#undef DL_SET_FLATTENABLE_CASES
+
+#define DL_SET_MASK_BLUR_CASE(style)                               \
+  case DisplayListOpType::kSetMaskBlurFilter##style: {             \
+    SkScalar sigma = reader.Read<SkScalar>();                      \
+    if (reader.ok()) {                                             \
+      dispatcher.setMaskBlurFilter(k##style##_SkBlurStyle, sigma); \
+    }                                                              \
+    break;                                                         \
+  }
+
+      DL_SET_MASK_BLUR_CASE(Normal)
+      DL_SET_MASK_BLUR_CASE(Solid)
+      DL_SET_MASK_BLUR_CASE(Outer)
+      DL_SET_MASK_BLUR_CASE(Inner)
+
+#undef DL_SET_MASK_BLUR_CASE
+
+    case DisplayListOpType::kSave:
+      dispatcher.save();
+      break;
+    case DisplayListOpType::kSaveLayer: {
+      bool restore_with_paint = reader.ReadBool();
+      if (reader.ok()) {
+        dispatcher.saveLayer(nullptr, restore_with_paint);
+      }
+      break;
+    }
+    case DisplayListOpType::kSaveLayerBounds: {
+      SkRect bounds = reader.Read<SkRect>();
+      bool restore_with_paint = reader.ReadBool();
+      if (reader.ok()) {
+        dispatcher.saveLayer(&bounds, restore_with_paint);
+      }
+      break;
+    }
+    case DisplayListOpType::kRestore:
+      dispatcher.restore();
+      break;
+
+    case DisplayListOpType::kTranslate: {
+      SkPoint t = reader.Read<SkPoint>();
+      if (reader.ok()) {
+        dispatcher.translate(t.fX, t.fY);
+      }
+      break;
+    }
+    case DisplayListOpType::kScale: {
+      SkPoint s = reader.Read<SkPoint>();
+      if (reader.ok()) {
+        dispatcher.scale(s.fX, s.fY);
+      }
+      break;
+    }
+    case DisplayListOpType::kRotate: {
+      SkScalar degrees = reader.Read<SkScalar>();
+      if (reader.ok()) {
+        dispatcher.rotate(degrees);
+      }
+      break;
+    }
+    case DisplayListOpType::kSkew: {
+      SkPoint s = reader.Read<SkPoint>();
+      if (reader.ok()) {
+        dispatcher.skew(s.fX, s.fY);
+      }
+      break;
+    }
+    case DisplayListOpType::kTransform2DAffine: {
+      const SkScalar* m = reader.ReadArray<SkScalar>(6);
+      if (reader.ok()) {
+        dispatcher.transform2DAffine(m[0], m[1], m[2], m[3], m[4], m[5]);
+      }
+      break;
+    }
+    case DisplayListOpType::kTransformFullPerspective: {
+      const SkScalar* m = reader.ReadArray<SkScalar>(16);
+      if (reader.ok()) {
+        dispatcher.transformFullPerspective(
+            m[0], m[1], m[2], m[3], m[4], m[5], m[6], m[7], m[8], m[9],
+            m[10], m[11], m[12], m[13], m[14], m[15]);
+      }
+      break;
+    }
+
+#define DL_CLIP_CASES(clipop)                                      \
+  case DisplayListOpType::kClip##clipop##Rect: {                   \
+    SkRect rect = reader.Read<SkRect>();                           \
+    bool is_aa = reader.ReadBool();                                \
+    if (reader.ok()) {                                             \
+      dispatcher.clipRect(rect, SkClipOp::k##clipop, is_aa);       \
+    }                                                              \
+    break;                                                         \
+  }                                                                \
+  case DisplayListOpType::kClip##clipop##RRect: {                  \
+    SkRRect rrect = reader.ReadRRect();                            \
+    bool is_aa = reader.ReadBool();                                \
+    if (reader.ok()) {                                             \
+      dispatcher.clipRRect(rrect, SkClipOp::k##clipop, is_aa);     \
+    }                                                              \
+    break;                                                         \
+  }                                                                \
+  case DisplayListOpType::kClip##clipop##Path: {                   \
+    const Object* path = ReadObject(reader, ObjectType::kPath);    \
+    bool is_aa = reader.ReadBool();                                \
+    if (reader.ok()) {                                             \
+      dispatcher.clipPath(path->path, SkClipOp::k##clipop, is_aa); \
+    }                                                              \
+    break;                                                         \
+  }
+
+      DL_CLIP_CASES(Intersect)
+      DL_CLIP_CASES(Difference)
+
+#undef DL_CLIP_CASES
+
+    case DisplayListOpType::kDrawPaint:
+      dispatcher.drawPaint();
+      break;
+    case DisplayListOpType::kDrawColor: {
+      SkColor color = reader.Read<SkColor>();
+      SkBlendMode mode = reader.ReadEnum(SkBlendMode::kLastMode);
+      if (reader.ok()) {
+        dispatcher.drawColor(color, mode);
+      }
+      break;
+    }
+    case DisplayListOpType::kDrawLine: {
+      SkPoint p0 = reader.Read<SkPoint>();
+      SkPoint p1 = reader.Read<SkPoint>();
+      if (reader.ok()) {
+        dispatcher.drawLine(p0, p1);
+      }
+      break;
+    }
+    case DisplayListOpType::kDrawRect: {
+      SkRect rect = reader.Read<SkRect>();
+      if (reader.ok()) {
+        dispatcher.drawRect(rect);
+      }
+      break;
+    }
+    case DisplayListOpType::kDrawOval: {
+      SkRect bounds = reader.Read<SkRect>();
+      if (reader.ok()) {
+        dispatcher.drawOval(bounds);
+      }
+      break;
+    }
+    case DisplayListOpType::kDrawCircle: {
+      SkPoint center = reader.Read<SkPoint>();
+      SkScalar radius = reader.Read<SkScalar>();
+      if (reader.ok()) {
+        dispatcher.drawCircle(center, radius);
+      }
+      break;
+    }
+    case DisplayListOpType::kDrawRRect: {
+      SkRRect rrect = reader.ReadRRect();
+      if (reader.ok()) {
+        dispatcher.drawRRect(rrect);
+      }
+      break;
+    }
+    case DisplayListOpType::kDrawDRRect: {
+      SkRRect outer = reader.ReadRRect();
+      SkRRect inner = reader.ReadRRect();
+      if (reader.ok()) {
+        dispatcher.drawDRRect(outer, inner);
+      }
+      break;
+    }
+    case DisplayListOpType::kDrawArc: {
+      SkRect bounds = reader.Read<SkRect>();
+      SkScalar start = reader.Read<SkScalar>();
+      SkScalar sweep = reader.Read<SkScalar>();
+      bool use_center = reader.ReadBool();
+      if (reader.ok()) {
+        dispatcher.drawArc(bounds, start, sweep, use_center);
+      }
+      break;
+    }
+    case DisplayListOpType::kDrawPath: {
+      const Object* path = ReadObject(reader, ObjectType::kPath);
+      if (reader.ok()) {
+        dispatcher.drawPath(path->path);
+      }
+      break;
+    }
+
+#define DL_DRAW_POINTS_CASE(name, mode)                                \
+  case DisplayListOpType::kDraw##name: {                               \
+    uint32_t count = reader.Read<uint32_t>();                          \
+    const SkPoint* points = reader.ReadArray<SkPoint>(count);          \
+    if (reader.ok()) {                                                 \
+      dispatcher.drawPoints(SkCanvas::PointMode::mode, count, points); \
+    }                                                                  \
+    break;                                                             \
+  }
+
+      DL_DRAW_POINTS_CASE(Points, kPoints_PointMode)
+      DL_DRAW_POINTS_CASE(Lines, kLines_PointMode)
+      DL_DRAW_POINTS_CASE(Polygon, kPolygon_PointMode)
+
+#undef DL_DRAW_POINTS_CASE
+
+    case DisplayListOpType::kDrawVertices:
+      // Never written, see DisplayListWriter::drawVertices.
+      break;
+
+    case DisplayListOpType::kDrawImage:
+    case DisplayListOpType::kDrawImageWithAttr: {
+      const Object* image = ReadObject(reader, ObjectType::kImage);
+      SkPoint point = reader.Read<SkPoint>();
+      SkSamplingOptions sampling = reader.ReadSampling();
+      if (reader.ok()) {
+        dispatcher.drawImage(image->image, point, sampling,
+                             type == DisplayListOpType::kDrawImageWithAttr);
+      }
+      break;
+    }
+    case DisplayListOpType::kDrawImageRect: {
+      const Object* image = ReadObject(reader, ObjectType::kImage);
+      SkRect src = reader.Read<SkRect>();
+      SkRect dst = reader.Read<SkRect>();
+      SkSamplingOptions sampling = reader.ReadSampling();
+      bool render_with_attributes = reader.ReadBool();
+      SkCanvas::SrcRectConstraint constraint =
+          reader.ReadEnum(SkCanvas::kFast_SrcRectConstraint);
+      if (reader.ok()) {
+        dispatcher.drawImageRect(image->image, src, dst, sampling,
+                                 render_with_attributes, constraint);
+      }
+      break;
+    }
+    case DisplayListOpType::kDrawImageNine:
+    case DisplayListOpType::kDrawImageNineWithAttr: {
+      const Object* image = ReadObject(reader, ObjectType::kImage);
+      SkIRect center = reader.Read<SkIRect>();
+      SkRect dst = reader.Read<SkRect>();
+      SkFilterMode filter = reader.ReadEnum(SkFilterMode::kLast);
+      if (reader.ok()) {
+        dispatcher.drawImageNine(
+            image->image, center, dst, filter,
+            type == DisplayListOpType::kDrawImageNineWithAttr);
+      }
+      break;
+    }
+    case DisplayListOpType::kDrawImageLattice: {
+      const Object* image = ReadObject(reader, ObjectType::kImage);
+      SkRect dst = reader.Read<SkRect>();
+      SkFilterMode filter = reader.ReadEnum(SkFilterMode::kLast);
+      bool render_with_attributes = reader.ReadBool();
+      int x_count = reader.ReadCount();
+      int y_count = reader.ReadCount();
+      int cell_count = reader.ReadCount();
+      bool has_bounds = reader.ReadBool();
+      SkIRect bounds = reader.Read<SkIRect>();
+      const int* x_divs = reader.ReadArray<int>(x_count);
+      const int* y_divs = reader.ReadArray<int>(y_count);
+      const SkColor* colors = reader.ReadArray<SkColor>(cell_count);
+      const SkCanvas::Lattice::RectType* rect_types =
+          reader.ReadArray<SkCanvas::Lattice::RectType>(cell_count);
+      for (int i = 0; reader.ok() && i < cell_count; i++) {
+        if (rect_types[i] > SkCanvas::Lattice::kFixedColor) {
+          reader.Fail();
+        }
+      }
+      if (reader.ok()) {
+        SkCanvas::Lattice lattice = {
+            x_divs,
+            y_divs,
+            cell_count ? rect_types : nullptr,
+            x_count,
+            y_count,
+            has_bounds ? &bounds : nullptr,
+            cell_count ? colors : nullptr,
+        };
+        dispatcher.drawImageLattice(image->image, lattice, dst, filter,
+                                    render_with_attributes);
+      }
+      break;
+    }
+    case DisplayListOpType::kDrawAtlas:
+    case DisplayListOpType::kDrawAtlasCulled: {
+      SkRect cull_rect;
+      if (type == DisplayListOpType::kDrawAtlasCulled) {
+        cull_rect = reader.Read<SkRect>();
+      }
+      const Object* atlas = ReadObject(reader, ObjectType::kImage);
+      SkBlendMode mode = reader.ReadEnum(SkBlendMode::kLastMode);
+      SkSamplingOptions sampling = reader.ReadSampling();
+      bool render_with_attributes = reader.ReadBool();
+      bool has_colors = reader.ReadBool();
+      int count = reader.ReadCount();
+      const SkRSXform* xforms = reader.ReadArray<SkRSXform>(count);
+      const SkRect* tex = reader.ReadArray<SkRect>(count);
+      const SkColor* colors =
+          has_colors ? reader.ReadArray<SkColor>(count) : nullptr;
+      if (reader.ok()) {
+        dispatcher.drawAtlas(
+            atlas->image, xforms, tex, colors, count, mode, sampling,
+            type == DisplayListOpType::kDrawAtlasCulled ? &cull_rect : nullptr,
+            render_with_attributes);
+      }
+      break;
+    }
+
+    case DisplayListOpType::kDrawSkPicture:
+    case DisplayListOpType::kDrawSkPictureMatrix: {
+      SkMatrix matrix;
+      if (type == DisplayListOpType::kDrawSkPictureMatrix) {
+        const SkScalar* values = reader.ReadArray<SkScalar>(9);
+        if (values) {
+          matrix.set9(values);
+        }
+      }
+      const Object* picture = ReadObject(reader, ObjectType::kPicture);
+      bool render_with_attributes = reader.ReadBool();
+      if (reader.ok()) {
+        dispatcher.drawPicture(
+            picture->picture,
+            type == DisplayListOpType::kDrawSkPictureMatrix ? &matrix
+                                                            : nullptr,
+            render_with_attributes);
+      }
+      break;
+    }
+    case DisplayListOpType::kDrawDisplayList: {
+      const Object* display_list =
+          ReadObject(reader, ObjectType::kDisplayList);
+      if (reader.ok()) {
+        dispatcher.drawDisplayList(display_list->display_list);
+      }
+      break;
+    }
+    case DisplayListOpType::kDrawTextBlob: {
+      const Object* blob = ReadObject(reader, ObjectType::kTextBlob);
+      SkPoint point = reader.Read<SkPoint>();
+      if (reader.ok()) {
+        dispatcher.drawTextBlob(blob->text_blob, point.fX, point.fY);
+      }
+      break;
+    }
+    case DisplayListOpType::kDrawShadow:
+    case DisplayListOpType::kDrawShadowTransparentOccluder: {
+      const Object* path = ReadObject(reader, ObjectType::kPath);
+      SkColor color = reader.Read<SkColor>();
+      SkScalar elevation = reader.Read<SkScalar>();
+      SkScalar dpr = reader.Read<SkScalar>();
+      if (reader.ok()) {
+        dispatcher.drawShadow(
+            path->path, color, elevation,
+            type == DisplayListOpType::kDrawShadowTransparentOccluder, dpr);
+      }
+      break;
+    }
+  }
+}
+
+}  // namespace flutter
@@ -0,0 +1,152 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FLOW_DISPLAY_LIST_SERIALIZATION_H_
+#define FLUTTER_FLOW_DISPLAY_LIST_SERIALIZATION_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "flutter/flow/display_list.h"
+#include "flutter/fml/macros.h"
+#include "flutter/fml/mapping.h"
+#include "third_party/skia/include/core/SkData.h"
+#include "third_party/skia/include/core/SkPath.h"
+#include "third_party/skia/include/core/SkTextBlob.h"
+
+// A compact binary format for DisplayLists that can be written to disk
+// and dispatched again directly from a memory mapping of the file.
+//
+// The format is position independent and consists of 3 sections, all of
+// which are 8 byte aligned:
+//
+// - A fixed size header holding a magic number (which also identifies
+//   the byte order of the writer), the format version, the cull rect
+//   and the sizes of the other two sections.
+// - An object table holding the images, paths, text blobs, pictures,
+//   nested DisplayLists and effect objects (shaders, filters, etc.)
+//   referenced by the ops. Every object is stored once, no matter how
+//   many ops reference it. Raster images are stored as uncompressed
+//   pixels which are wrapped by the loaded SkImage without copying.
+// - The op records. Each record has the same type tag as the matching
+//   DisplayListOpType followed by its parameters, with references to
+//   objects replaced by their index in the object table.
+//
+// Only the object table is decoded when the data is loaded. The op
+// records are read straight from the mapped bytes on every dispatch.
+//
+// The records mirror DisplayListOpType, so |kVersion| must be bumped
+// whenever the ops or the layout of any record change. Data written
+// with a different version (or by a writer with a different byte order)
+// is rejected by |SerializedDisplayList::Load|.
+
+namespace flutter {
+
+class DisplayListSerializer {
+ public:
+  // 'FLDL' when read in little endian byte order.
+  static constexpr uint32_t kMagic = 0x4c444c46;
+  static constexpr uint32_t kVersion = 1;
+
+  // The types of the entries in the object table.
+  enum class ObjectType : uint32_t {
+    kImage,
+    kPath,
+    kTextBlob,
+    kPicture,
+    kDisplayList,
+    kShader,
+    kColorFilter,
+    kImageFilter,
+    kPathEffect,
+    kMaskFilter,
+    kBlender,
+  };
+
+  // Returns the serialized form of |display_list|, or nullptr if it
+  // references an object that cannot be serialized. This is currently
+  // the case for SkVertices, whose contents are not exposed by Skia,
+  // and for texture backed images that cannot be read back.
+  static sk_sp<SkData> Serialize(const DisplayList& display_list);
+
+ private:
+  FML_DISALLOW_IMPLICIT_CONSTRUCTORS(DisplayListSerializer);
+};
+
+// A DisplayList loaded from the format written by |DisplayListSerializer|
+// that dispatches directly from the bytes of the mapping it was loaded
+// from.
+class SerializedDisplayList {
+ public:
+  // Returns nullptr if |mapping| does not contain a valid serialized
+  // DisplayList of the current version. The mapping is kept alive for
+  // as long as the returned object or any of the images loaded from it
+  // are in use.
+  static std::unique_ptr<SerializedDisplayList> Load(
+      std::shared_ptr<const fml::Mapping> mapping);
+
+  // Maps the file at |path| read-only and loads it, see |Load|.
+  static std::unique_ptr<SerializedDisplayList> LoadFromFile(
+      const std::string& path);
+
+  ~SerializedDisplayList();
+
+  const SkRect& cull_rect() const { return cull_rect_; }
+  int op_count() const { return op_count_; }
+  size_t bytes() const { return ops_size_; }
+
+  // Dispatches the ops in the same order and with the same parameters
+  // as the DisplayList that was serialized. Records that fail to decode
+  // are skipped.
+  void Dispatch(Dispatcher& dispatcher) const;
+
+  void RenderTo(SkCanvas* canvas) const;
+
+  // Copies the ops into a new DisplayList.
+  sk_sp<DisplayList> Build() const;
+
+ private:
+  using ObjectType = DisplayListSerializer::ObjectType;
+
+  struct Object {
+    ObjectType type;
+    sk_sp<SkImage> image;
+    SkPath path;
+    sk_sp<SkTextBlob> text_blob;
+    sk_sp<SkPicture> picture;
+    sk_sp<DisplayList> display_list;
+    sk_sp<SkFlattenable> flattenable;
+  };
+
+  class RecordReader;
+
+  std::shared_ptr<const fml::Mapping> mapping_;
+  const uint8_t* ops_ = nullptr;
+  size_t ops_size_ = 0;
+  int op_count_ = 0;
+  SkRect cull_rect_ = SkRect::MakeEmpty();
+  std::vector<Object> objects_;
+
+  explicit SerializedDisplayList(std::shared_ptr<const fml::Mapping> mapping);
+
+  // Parses the serialized DisplayList in the |size| bytes at |data|,
+  // which must be inside of |mapping_|.
+  bool Parse(const uint8_t* data, size_t size);
+  bool ParseObject(ObjectType type, RecordReader& reader, Object& object);
+
+  // Reads an object index from |reader| and returns the object if it
+  // has the indicated type. Otherwise the reader is marked as failed.
+  const Object* ReadObject(RecordReader& reader, ObjectType type) const;
+
+  void DispatchRecord(Dispatcher& dispatcher,
+                      DisplayListOpType type,
+                      RecordReader& reader) const;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(SerializedDisplayList);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_FLOW_DISPLAY_LIST_SERIALIZATION_H_
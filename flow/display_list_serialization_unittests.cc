@@ -0,0 +1,269 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/display_list_serialization.h"
+
+#include <cstring>
+
+#include "flutter/fml/file.h"
+#include "flutter/fml/paths.h"
+#include "third_party/skia/include/core/SkPixmap.h"
+#include "third_party/skia/include/core/SkRRect.h"
+#include "third_party/skia/include/core/SkRSXform.h"
+#include "third_party/skia/include/core/SkSurface.h"
+#include "third_party/skia/include/effects/SkGradientShader.h"
+#include "third_party/skia/include/effects/SkImageFilters.h"
+
+#include "gtest/gtest.h"
+
+namespace flutter {
+namespace testing {
+
+static constexpr int kTestSize = 100;
+
+static std::shared_ptr<const fml::Mapping> ToMapping(
+    const sk_sp<SkData>& data) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(data->data());
+  return std::make_shared<fml::DataMapping>(
+      std::vector<uint8_t>(bytes, bytes + data->size()));
+}
+
+static sk_sp<SkImage> MakeTestImage() {
+  sk_sp<SkSurface> surface = SkSurface::MakeRasterN32Premul(20, 20);
+  surface->getCanvas()->clear(SK_ColorYELLOW);
+  SkPaint paint;
+  paint.setColor(SK_ColorBLUE);
+  surface->getCanvas()->drawRect(SkRect::MakeLTRB(0, 0, 10, 10), paint);
+  return surface->makeImageSnapshot();
+}
+
+static sk_sp<DisplayList> MakeGeometryDisplayList() {
+  DisplayListBuilder builder(SkRect::MakeWH(kTestSize, kTestSize));
+  builder.setAntiAlias(true);
+  builder.setColor(SK_ColorRED);
+  builder.setStrokeWidth(3);
+  builder.setMaskBlurFilter(kNormal_SkBlurStyle, 2);
+  builder.save();
+  builder.translate(5, 5);
+  builder.clipRRect(SkRRect::MakeRectXY(SkRect::MakeWH(80, 80), 10, 10),
+                    SkClipOp::kIntersect, true);
+  builder.clipPath(SkPath::Circle(40, 40, 35), SkClipOp::kDifference, false);
+  builder.drawRect(SkRect::MakeLTRB(10, 10, 50, 50));
+  builder.restore();
+  builder.setMaskFilter(nullptr);
+  builder.saveLayer(nullptr, false);
+  builder.setStyle(SkPaint::kStroke_Style);
+  builder.drawArc(SkRect::MakeLTRB(20, 20, 80, 80), 0, 120, true);
+  builder.drawPath(SkPath::Circle(50, 50, 20));
+  const SkPoint points[] = {{10, 10}, {90, 10}, {90, 90}};
+  builder.drawPoints(SkCanvas::kPolygon_PointMode, 3, points);
+  builder.restore();
+  return builder.Build();
+}
+
+static sk_sp<DisplayList> MakeObjectDisplayList() {
+  sk_sp<SkImage> image = MakeTestImage();
+  DisplayListBuilder builder(SkRect::MakeWH(kTestSize, kTestSize));
+  builder.drawImage(image, {5, 5}, DisplayList::NearestSampling, false);
+  builder.drawImageRect(image, SkRect::MakeWH(10, 10),
+                        SkRect::MakeLTRB(30, 5, 60, 35),
+                        DisplayList::LinearSampling, false);
+  const SkRSXform xforms[] = {SkRSXform::Make(1, 0, 70, 5)};
+  const SkRect tex[] = {SkRect::MakeLTRB(5, 5, 15, 15)};
+  builder.drawAtlas(image, xforms, tex, nullptr, 1, SkBlendMode::kSrcOver,
+                    DisplayList::NearestSampling, nullptr, false);
+  const SkPoint gradient_points[] = {{0, 50}, {100, 100}};
+  const SkColor gradient_colors[] = {SK_ColorGREEN, SK_ColorMAGENTA};
+  builder.setShader(SkGradientShader::MakeLinear(
+      gradient_points, gradient_colors, nullptr, 2, SkTileMode::kClamp));
+  builder.drawRect(SkRect::MakeLTRB(5, 50, 95, 70));
+  builder.setShader(nullptr);
+  builder.setImageFilter(SkImageFilters::Blur(2, 2, nullptr));
+  builder.saveLayer(nullptr, true);
+  builder.setImageFilter(nullptr);
+  builder.drawCircle({50, 85}, 10);
+  builder.restore();
+  // Shadows compare their paths by reference so they are only expected
+  // to render the same.
+  builder.drawShadow(SkPath::Circle(30, 70, 10), SK_ColorBLACK, 4, false, 1);
+
+  DisplayListBuilder nested_builder(SkRect::MakeWH(20, 20));
+  nested_builder.setColor(SK_ColorCYAN);
+  nested_builder.drawOval(SkRect::MakeWH(20, 20));
+  builder.translate(75, 75);
+  builder.drawDisplayList(nested_builder.Build());
+  return builder.Build();
+}
+
+static void ExpectSameRendering(const DisplayList& expected,
+                                const SerializedDisplayList& actual) {
+  sk_sp<SkSurface> expected_surface =
+      SkSurface::MakeRasterN32Premul(kTestSize, kTestSize);
+  sk_sp<SkSurface> actual_surface =
+      SkSurface::MakeRasterN32Premul(kTestSize, kTestSize);
+  expected_surface->getCanvas()->clear(SK_ColorWHITE);
+  actual_surface->getCanvas()->clear(SK_ColorWHITE);
+  expected.RenderTo(expected_surface->getCanvas());
+  actual.RenderTo(actual_surface->getCanvas());
+
+  SkPixmap expected_pixels;
+  SkPixmap actual_pixels;
+  ASSERT_TRUE(expected_surface->peekPixels(&expected_pixels));
+  ASSERT_TRUE(actual_surface->peekPixels(&actual_pixels));
+  for (int y = 0; y < kTestSize; y++) {
+    for (int x = 0; x < kTestSize; x++) {
+      ASSERT_EQ(*expected_pixels.addr32(x, y), *actual_pixels.addr32(x, y))
+          << "at " << x << ", " << y;
+    }
+  }
+}
+
+TEST(DisplayListSerialization, GeometryRoundTripsToAnEqualDisplayList) {
+  sk_sp<DisplayList> display_list = MakeGeometryDisplayList();
+  sk_sp<SkData> data = DisplayListSerializer::Serialize(*display_list);
+  ASSERT_NE(data, nullptr);
+
+  auto loaded = SerializedDisplayList::Load(ToMapping(data));
+  ASSERT_NE(loaded, nullptr);
+  ASSERT_EQ(loaded->op_count(), display_list->op_count());
+  ASSERT_EQ(loaded->cull_rect(), display_list->cull_rect());
+
+  sk_sp<DisplayList> rebuilt = loaded->Build();
+  ASSERT_TRUE(rebuilt->Equals(*display_list));
+  ASSERT_EQ(rebuilt->content_hash(), display_list->content_hash());
+  ExpectSameRendering(*display_list, *loaded);
+}
+
+TEST(DisplayListSerialization, ObjectsRoundTripToTheSameRendering) {
+  sk_sp<DisplayList> display_list = MakeObjectDisplayList();
+  sk_sp<SkData> data = DisplayListSerializer::Serialize(*display_list);
+  ASSERT_NE(data, nullptr);
+
+  auto loaded = SerializedDisplayList::Load(ToMapping(data));
+  ASSERT_NE(loaded, nullptr);
+  ASSERT_EQ(loaded->op_count(), display_list->op_count());
+  ExpectSameRendering(*display_list, *loaded);
+}
+
+TEST(DisplayListSerialization, SharedObjectsAreStoredOnce) {
+  sk_sp<SkImage> image = MakeTestImage();
+  size_t image_bytes = image->imageInfo().computeMinByteSize();
+  DisplayListBuilder once_builder;
+  once_builder.drawImage(image, {0, 0}, DisplayList::NearestSampling, false);
+  DisplayListBuilder twice_builder;
+  twice_builder.drawImage(image, {0, 0}, DisplayList::NearestSampling, false);
+  twice_builder.drawImage(image, {5, 5}, DisplayList::NearestSampling, false);
+
+  sk_sp<SkData> once = DisplayListSerializer::Serialize(*once_builder.Build());
+  sk_sp<SkData> twice =
+      DisplayListSerializer::Serialize(*twice_builder.Build());
+  ASSERT_NE(once, nullptr);
+  ASSERT_NE(twice, nullptr);
+  ASSERT_GT(once->size(), image_bytes);
+  ASSERT_LT(twice->size(), once->size() + image_bytes);
+}
+
+TEST(DisplayListSerialization, LoadsFromAFile) {
+  sk_sp<DisplayList> display_list = MakeObjectDisplayList();
+  sk_sp<SkData> data = DisplayListSerializer::Serialize(*display_list);
+  ASSERT_NE(data, nullptr);
+
+  fml::ScopedTemporaryDirectory temp_dir;
+  ASSERT_TRUE(fml::WriteAtomically(temp_dir.fd(), "frame.fldl",
+                                   *ToMapping(data)));
+  auto loaded = SerializedDisplayList::LoadFromFile(
+      fml::paths::JoinPaths({temp_dir.path(), "frame.fldl"}));
+  ASSERT_NE(loaded, nullptr);
+
+  // The images wrap the mapped pixels and keep the file mapping alive
+  // after the SerializedDisplayList itself is gone.
+  sk_sp<DisplayList> rebuilt = loaded->Build();
+  loaded.reset();
+  ASSERT_EQ(rebuilt->op_count(), display_list->op_count());
+  sk_sp<SkSurface> surface =
+      SkSurface::MakeRasterN32Premul(kTestSize, kTestSize);
+  rebuilt->RenderTo(surface->getCanvas());
+}
+
+TEST(DisplayListSerialization, RejectsInvalidData) {
+  sk_sp<SkData> data =
+      DisplayListSerializer::Serialize(*MakeGeometryDisplayList());
+  ASSERT_NE(data, nullptr);
+  const uint8_t* bytes = static_cast<const uint8_t*>(data->data());
+  std::vector<uint8_t> valid(bytes, bytes + data->size());
+
+  std::vector<uint8_t> bad_magic = valid;
+  bad_magic[0] ^= 0xff;
+  EXPECT_EQ(SerializedDisplayList::Load(
+                std::make_shared<fml::DataMapping>(bad_magic)),
+            nullptr);
+
+  std::vector<uint8_t> bad_version = valid;
+  uint32_t version = DisplayListSerializer::kVersion + 1;
+  memcpy(&bad_version[sizeof(uint32_t)], &version, sizeof(version));
+  EXPECT_EQ(SerializedDisplayList::Load(
+                std::make_shared<fml::DataMapping>(bad_version)),
+            nullptr);
+
+  for (size_t size : {size_t(0), size_t(20), valid.size() - 4}) {
+    std::vector<uint8_t> truncated(valid.begin(), valid.begin() + size);
+    EXPECT_EQ(SerializedDisplayList::Load(
+                  std::make_shared<fml::DataMapping>(truncated)),
+              nullptr)
+        << "truncated to " << size;
+  }
+
+  EXPECT_NE(SerializedDisplayList::Load(
+                std::make_shared<fml::DataMapping>(valid)),
+            nullptr);
+}
+
+// Adds |padding| bytes to the end of the first object record of |valid|.
+static std::vector<uint8_t> PadFirstObject(const std::vector<uint8_t>& valid,
+                                           uint32_t padding) {
+  constexpr size_t kHeaderSize = 48;
+  constexpr size_t kObjectsSizeOffset = 32;
+  constexpr size_t kRecordSizeOffset = kHeaderSize + sizeof(uint32_t);
+  std::vector<uint8_t> padded = valid;
+  uint64_t objects_size;
+  memcpy(&objects_size, &padded[kObjectsSizeOffset], sizeof(objects_size));
+  uint32_t record_size;
+  memcpy(&record_size, &padded[kRecordSizeOffset], sizeof(record_size));
+  padded.insert(padded.begin() + kHeaderSize + record_size, padding, 0);
+  objects_size += padding;
+  record_size += padding;
+  memcpy(&padded[kObjectsSizeOffset], &objects_size, sizeof(objects_size));
+  memcpy(&padded[kRecordSizeOffset], &record_size, sizeof(record_size));
+  return padded;
+}
+
+TEST(DisplayListSerialization, RejectsMisalignedObjects) {
+  sk_sp<SkData> data =
+      DisplayListSerializer::Serialize(*MakeGeometryDisplayList());
+  ASSERT_NE(data, nullptr);
+  const uint8_t* bytes = static_cast<const uint8_t*>(data->data());
+  std::vector<uint8_t> valid(bytes, bytes + data->size());
+
+  // Objects may have more padding than they need.
+  EXPECT_NE(SerializedDisplayList::Load(
+                std::make_shared<fml::DataMapping>(PadFirstObject(valid, 8))),
+            nullptr);
+  // The objects after the padded one and the ops would be misaligned.
+  EXPECT_EQ(SerializedDisplayList::Load(
+                std::make_shared<fml::DataMapping>(PadFirstObject(valid, 4))),
+            nullptr);
+}
+
+TEST(DisplayListSerialization, RefusesVertices) {
+  const SkPoint positions[] = {{0, 0}, {10, 0}, {0, 10}};
+  DisplayListBuilder builder;
+  builder.drawVertices(
+      SkVertices::MakeCopy(SkVertices::kTriangles_VertexMode, 3, positions,
+                           nullptr, nullptr),
+      SkBlendMode::kSrcOver);
+  EXPECT_EQ(DisplayListSerializer::Serialize(*builder.Build()), nullptr);
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -0,0 +1,161 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/display_list_storage_pool.h"
+
+#include <algorithm>
+
+#include "flutter/fml/logging.h"
+#include "flutter/fml/thread_local.h"
+#include "third_party/skia/include/private/SkMalloc.h"
+
+namespace flutter {
+
+namespace {
+
+struct PoolHolder {
+  std::shared_ptr<DisplayListStoragePool> pool =
+      std::make_shared<DisplayListStoragePool>();
+};
+
+FML_THREAD_LOCAL fml::ThreadLocalUniquePtr<PoolHolder> tls_storage_pool;
+
+// The pools of all threads, which go away with their threads.
+struct ThreadPools {
+  std::mutex mutex;
+  std::vector<std::weak_ptr<DisplayListStoragePool>> pools;
+};
+
+ThreadPools& GetThreadPools() {
+  // Never destroyed, so that threads may still exit during shutdown.
+  static ThreadPools* thread_pools = new ThreadPools();
+  return *thread_pools;
+}
+
+// Returns the index of the smallest size class that holds |size| bytes.
+// |size| must not be larger than |kMaxBlockSize|.
+size_t SizeClass(size_t size) {
+  size_t size_class = 0;
+  while ((DisplayListStoragePool::kMinBlockSize << size_class) < size) {
+    size_class++;
+  }
+  return size_class;
+}
+
+}  // namespace
+
+std::shared_ptr<DisplayListStoragePool>
+DisplayListStoragePool::ForCurrentThread() {
+  if (tls_storage_pool.get() == nullptr) {
+    tls_storage_pool.reset(new PoolHolder());
+    ThreadPools& thread_pools = GetThreadPools();
+    std::scoped_lock lock(thread_pools.mutex);
+    thread_pools.pools.push_back(tls_storage_pool.get()->pool);
+  }
+  return tls_storage_pool.get()->pool;
+}
+
+void DisplayListStoragePool::PurgeAll() {
+  ThreadPools& thread_pools = GetThreadPools();
+  std::scoped_lock lock(thread_pools.mutex);
+  std::vector<std::weak_ptr<DisplayListStoragePool>>& pools =
+      thread_pools.pools;
+  pools.erase(
+      std::remove_if(pools.begin(), pools.end(),
+                     [](const std::weak_ptr<DisplayListStoragePool>& weak) {
+                       std::shared_ptr<DisplayListStoragePool> pool =
+                           weak.lock();
+                       if (!pool) {
+                         return true;
+                       }
+                       pool->Purge();
+                       return false;
+                     }),
+      pools.end());
+}
+
+DisplayListStoragePool::DisplayListStoragePool(size_t max_retained_bytes)
+    : max_retained_bytes_(max_retained_bytes) {}
+
+DisplayListStoragePool::~DisplayListStoragePool() {
+  Purge();
+}
+
+DisplayListStoragePool::Block DisplayListStoragePool::Acquire(
+    size_t min_size) {
+  if (min_size > kMaxBlockSize) {
+    return {static_cast<uint8_t*>(sk_malloc_throw(min_size)), min_size};
+  }
+  size_t size_class = SizeClass(min_size);
+  size_t size = kMinBlockSize << size_class;
+  {
+    std::scoped_lock lock(mutex_);
+    std::vector<uint8_t*>& free_blocks = free_blocks_[size_class];
+    if (!free_blocks.empty()) {
+      uint8_t* ptr = free_blocks.back();
+      free_blocks.pop_back();
+      retained_bytes_ -= size;
+      return {ptr, size};
+    }
+  }
+  return {static_cast<uint8_t*>(sk_malloc_throw(size)), size};
+}
+
+void DisplayListStoragePool::Release(Block block) {
+  if (block.ptr == nullptr) {
+    return;
+  }
+  if (block.size <= kMaxBlockSize) {
+    size_t size_class = SizeClass(block.size);
+    FML_DCHECK((kMinBlockSize << size_class) == block.size)
+        << "Block of size " << block.size << " was not acquired from a pool";
+    std::scoped_lock lock(mutex_);
+    if (retained_bytes_ + block.size <= max_retained_bytes_) {
+      free_blocks_[size_class].push_back(block.ptr);
+      retained_bytes_ += block.size;
+      return;
+    }
+  }
+  sk_free(block.ptr);
+}
+
+size_t DisplayListStoragePool::GetSizeHint() const {
+  std::array<size_t, kSizeHistoryLength> sizes;
+  size_t count;
+  {
+    std::scoped_lock lock(mutex_);
+    sizes = recent_sizes_;
+    count = std::min(recorded_size_count_, kSizeHistoryLength);
+  }
+  if (count == 0) {
+    return 0;
+  }
+  auto median = sizes.begin() + count / 2;
+  std::nth_element(sizes.begin(), median, sizes.begin() + count);
+  return *median;
+}
+
+void DisplayListStoragePool::RecordSize(size_t bytes) {
+  std::scoped_lock lock(mutex_);
+  recent_sizes_[recorded_size_count_ % kSizeHistoryLength] = bytes;
+  recorded_size_count_++;
+}
+
+void DisplayListStoragePool::Purge() {
+  std::scoped_lock lock(mutex_);
+  for (std::vector<uint8_t*>& free_blocks : free_blocks_) {
+    for (uint8_t* ptr : free_blocks) {
+      sk_free(ptr);
+    }
+    free_blocks.clear();
+  }
+  retained_bytes_ = 0;
+}
+
+size_t DisplayListStoragePool::retained_bytes() const {
+  std::scoped_lock lock(mutex_);
+  return retained_bytes_;
+}
+
+}  // namespace flutter
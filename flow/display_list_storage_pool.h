@@ -0,0 +1,104 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FLOW_DISPLAY_LIST_STORAGE_POOL_H_
+#define FLUTTER_FLOW_DISPLAY_LIST_STORAGE_POOL_H_
+
+#include <array>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "flutter/fml/macros.h"
+
+namespace flutter {
+
+// A pool of storage blocks for DisplayListBuilders and the DisplayLists
+// they build.
+//
+// Without a pool a builder grows its storage with a series of reallocs
+// and every DisplayList owns a fresh heap allocation. With a pool the
+// builder takes a block of power of 2 size from the pool, which the
+// DisplayList then adopts without copying. The block goes back to the
+// pool when the DisplayList is destroyed (usually when the unref queue
+// is drained) so that it can be reused for the next frame.
+//
+// The pool also remembers the sizes of the most recent DisplayLists so
+// that builders can reserve the storage that they are likely to need up
+// front, see |GetSizeHint|.
+//
+// Blocks are acquired on the thread that records the DisplayLists but
+// may be released on any thread, so all methods are thread safe.
+class DisplayListStoragePool {
+ public:
+  // The smallest block handed out by the pool.
+  static constexpr size_t kMinBlockSize = 4096;
+
+  // Blocks larger than this are allocated and freed individually.
+  static constexpr size_t kMaxBlockSize = kMinBlockSize << 12;  // 16MB
+
+  // The default limit on the bytes held in free blocks.
+  static constexpr size_t kDefaultMaxRetainedBytes = 32 * 1024 * 1024;
+
+  // The number of recent DisplayList sizes that the size hint is based on.
+  static constexpr size_t kSizeHistoryLength = 64;
+
+  struct Block {
+    uint8_t* ptr = nullptr;
+    size_t size = 0;
+  };
+
+  // Returns the pool shared by the builders on the current thread,
+  // creating it if necessary.
+  static std::shared_ptr<DisplayListStoragePool> ForCurrentThread();
+
+  // Frees the blocks that are not in use in the pools of all threads, for
+  // example when the system is low on memory.
+  static void PurgeAll();
+
+  explicit DisplayListStoragePool(
+      size_t max_retained_bytes = kDefaultMaxRetainedBytes);
+
+  ~DisplayListStoragePool();
+
+  // Returns a block of at least |min_size| bytes, reusing a free block
+  // of the same size class if there is one. The contents of the block
+  // are undefined.
+  Block Acquire(size_t min_size);
+
+  // Returns a block obtained from |Acquire| to the pool. The block is
+  // freed instead if it is too large to pool or if keeping it would
+  // exceed the retention limit.
+  void Release(Block block);
+
+  // Returns the median of the bytes used by the most recent DisplayLists
+  // whose sizes were recorded, or 0 if there are none. The recording API
+  // does not tell which layer a DisplayList belongs to, so the hint only
+  // follows the distribution of sizes rather than that of each layer.
+  size_t GetSizeHint() const;
+  void RecordSize(size_t bytes);
+
+  // Frees all of the blocks that are not in use.
+  void Purge();
+
+  size_t retained_bytes() const;
+
+ private:
+  static constexpr size_t kSizeClassCount = 13;
+  static_assert((kMinBlockSize << (kSizeClassCount - 1)) == kMaxBlockSize,
+                "The size classes must cover all pooled block sizes.");
+
+  const size_t max_retained_bytes_;
+  mutable std::mutex mutex_;
+  std::array<std::vector<uint8_t*>, kSizeClassCount> free_blocks_;
+  size_t retained_bytes_ = 0;
+  std::array<size_t, kSizeHistoryLength> recent_sizes_ = {};
+  size_t recorded_size_count_ = 0;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(DisplayListStoragePool);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_FLOW_DISPLAY_LIST_STORAGE_POOL_H_
@@ -0,0 +1,193 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/display_list_storage_pool.h"
+
+#include <thread>
+
+#include "flutter/flow/display_list.h"
+#include "flutter/flow/display_list_optimizer.h"
+
+#include "gtest/gtest.h"
+
+namespace flutter {
+namespace testing {
+
+static sk_sp<DisplayList> BuildTestList(DisplayListBuilder& builder,
+                                        int rect_count) {
+  builder.setColor(SK_ColorBLUE);
+  for (int i = 0; i < rect_count; i++) {
+    builder.drawRect(SkRect::MakeXYWH(i, i, 10, 10));
+  }
+  return builder.Build();
+}
+
+TEST(DisplayListStoragePool, AcquireRoundsUpToSizeClasses) {
+  DisplayListStoragePool pool;
+  DisplayListStoragePool::Block small = pool.Acquire(1);
+  DisplayListStoragePool::Block medium = pool.Acquire(5000);
+  DisplayListStoragePool::Block large =
+      pool.Acquire(DisplayListStoragePool::kMaxBlockSize + 1);
+  EXPECT_EQ(small.size, DisplayListStoragePool::kMinBlockSize);
+  EXPECT_EQ(medium.size, DisplayListStoragePool::kMinBlockSize * 2);
+  EXPECT_EQ(large.size, DisplayListStoragePool::kMaxBlockSize + 1);
+  pool.Release(small);
+  pool.Release(medium);
+  pool.Release(large);
+  // Blocks above the largest size class are not retained.
+  EXPECT_EQ(pool.retained_bytes(), DisplayListStoragePool::kMinBlockSize * 3);
+}
+
+TEST(DisplayListStoragePool, ReleasedBlocksAreReused) {
+  DisplayListStoragePool pool;
+  DisplayListStoragePool::Block first = pool.Acquire(3000);
+  pool.Release(first);
+  DisplayListStoragePool::Block second = pool.Acquire(4000);
+  EXPECT_EQ(second.ptr, first.ptr);
+  EXPECT_EQ(pool.retained_bytes(), 0u);
+  pool.Release(second);
+}
+
+TEST(DisplayListStoragePool, RetainedBytesAreLimited) {
+  DisplayListStoragePool pool(DisplayListStoragePool::kMinBlockSize);
+  DisplayListStoragePool::Block first = pool.Acquire(1);
+  DisplayListStoragePool::Block second = pool.Acquire(1);
+  pool.Release(first);
+  pool.Release(second);
+  EXPECT_EQ(pool.retained_bytes(), DisplayListStoragePool::kMinBlockSize);
+  pool.Purge();
+  EXPECT_EQ(pool.retained_bytes(), 0u);
+}
+
+TEST(DisplayListStoragePool, SizeHintIsTheMedianOfRecentSizes) {
+  DisplayListStoragePool pool;
+  EXPECT_EQ(pool.GetSizeHint(), 0u);
+  pool.RecordSize(100);
+  EXPECT_EQ(pool.GetSizeHint(), 100u);
+  pool.RecordSize(5000);
+  pool.RecordSize(200);
+  EXPECT_EQ(pool.GetSizeHint(), 200u);
+
+  // Only the most recent sizes count.
+  for (size_t i = 0; i < DisplayListStoragePool::kSizeHistoryLength; i++) {
+    pool.RecordSize(i % 2 ? 300 : 400);
+  }
+  EXPECT_EQ(pool.GetSizeHint(), 400u);
+}
+
+TEST(DisplayListStoragePool, PoolIsSharedPerThread) {
+  std::shared_ptr<DisplayListStoragePool> pool =
+      DisplayListStoragePool::ForCurrentThread();
+  EXPECT_EQ(pool, DisplayListStoragePool::ForCurrentThread());
+  std::shared_ptr<DisplayListStoragePool> other_pool;
+  std::thread thread([&other_pool]() {
+    other_pool = DisplayListStoragePool::ForCurrentThread();
+  });
+  thread.join();
+  EXPECT_NE(other_pool, nullptr);
+  EXPECT_NE(other_pool, pool);
+}
+
+TEST(DisplayListStoragePool, PurgeAllPurgesThePoolsOfAllThreads) {
+  std::shared_ptr<DisplayListStoragePool> pool =
+      DisplayListStoragePool::ForCurrentThread();
+  pool->Release(pool->Acquire(1));
+  std::shared_ptr<DisplayListStoragePool> other_pool;
+  std::thread thread([&other_pool]() {
+    other_pool = DisplayListStoragePool::ForCurrentThread();
+    other_pool->Release(other_pool->Acquire(1));
+  });
+  thread.join();
+  EXPECT_GT(pool->retained_bytes(), 0u);
+  EXPECT_GT(other_pool->retained_bytes(), 0u);
+
+  DisplayListStoragePool::PurgeAll();
+  EXPECT_EQ(pool->retained_bytes(), 0u);
+  EXPECT_EQ(other_pool->retained_bytes(), 0u);
+}
+
+TEST(DisplayListStoragePool, PooledListsMatchUnpooledLists) {
+  auto pool = std::make_shared<DisplayListStoragePool>();
+  DisplayListBuilder pooled_builder;
+  pooled_builder.SetStoragePool(pool);
+  // Enough ops to grow through several size classes.
+  sk_sp<DisplayList> pooled = BuildTestList(pooled_builder, 1000);
+  DisplayListBuilder builder;
+  sk_sp<DisplayList> unpooled = BuildTestList(builder, 1000);
+
+  EXPECT_EQ(pooled->storage_pool(), pool);
+  EXPECT_EQ(unpooled->storage_pool(), nullptr);
+  EXPECT_EQ(pooled->bytes(), unpooled->bytes());
+  EXPECT_EQ(pooled->op_count(), unpooled->op_count());
+  EXPECT_EQ(pooled->content_hash(), unpooled->content_hash());
+  EXPECT_TRUE(pooled->Equals(*unpooled));
+}
+
+TEST(DisplayListStoragePool, ListsReturnTheirStorageWhenDestroyed) {
+  auto pool = std::make_shared<DisplayListStoragePool>();
+  DisplayListBuilder builder;
+  builder.SetStoragePool(pool);
+  // Enough ops to fill most of the smallest block.
+  sk_sp<DisplayList> display_list = BuildTestList(builder, 150);
+  ASSERT_GT(display_list->bytes(), DisplayListStoragePool::kMinBlockSize / 2);
+  EXPECT_EQ(pool->retained_bytes(), 0u);
+  display_list.reset();
+  EXPECT_EQ(pool->retained_bytes(), DisplayListStoragePool::kMinBlockSize);
+
+  // The next builder picks the released block back up.
+  DisplayListBuilder next_builder;
+  next_builder.SetStoragePool(pool, 10);
+  EXPECT_EQ(pool->retained_bytes(), 0u);
+}
+
+TEST(DisplayListStoragePool, SmallListsReturnTheBlockWhenBuilt) {
+  auto pool = std::make_shared<DisplayListStoragePool>();
+  DisplayListBuilder builder;
+  builder.SetStoragePool(pool);
+  sk_sp<DisplayList> display_list = BuildTestList(builder, 10);
+  ASSERT_LT(display_list->bytes(), DisplayListStoragePool::kMinBlockSize / 2);
+  EXPECT_EQ(display_list->storage_pool(), pool);
+  EXPECT_EQ(pool->retained_bytes(), DisplayListStoragePool::kMinBlockSize);
+
+  DisplayListBuilder unpooled_builder;
+  EXPECT_TRUE(display_list->Equals(*BuildTestList(unpooled_builder, 10)));
+  display_list.reset();
+  EXPECT_EQ(pool->retained_bytes(), DisplayListStoragePool::kMinBlockSize);
+}
+
+TEST(DisplayListStoragePool, SizeHintReservesAllStorageUpFront) {
+  auto pool = std::make_shared<DisplayListStoragePool>();
+  DisplayListBuilder first_builder;
+  first_builder.SetStoragePool(pool);
+  size_t bytes = BuildTestList(first_builder, 1000)->bytes();
+  // Growing the first list left the smaller blocks in the pool.
+  size_t retained = pool->retained_bytes();
+  EXPECT_GT(retained, 0u);
+
+  pool->Purge();
+  DisplayListBuilder second_builder;
+  second_builder.SetStoragePool(pool, bytes);
+  sk_sp<DisplayList> second = BuildTestList(second_builder, 1000);
+  EXPECT_EQ(second->bytes(), bytes);
+  // No blocks were released while recording, so the list never grew.
+  EXPECT_EQ(pool->retained_bytes(), 0u);
+}
+
+TEST(DisplayListStoragePool, OptimizedListsUseThePoolOfTheSource) {
+  auto pool = std::make_shared<DisplayListStoragePool>();
+  DisplayListBuilder builder;
+  builder.SetStoragePool(pool);
+  builder.setColor(SK_ColorRED);
+  builder.setColor(SK_ColorBLUE);
+  builder.save();
+  builder.restore();
+  builder.drawRect(SkRect::MakeWH(10, 10));
+  sk_sp<DisplayList> display_list = builder.Build();
+  sk_sp<DisplayList> optimized = DisplayListOptimizer::Optimize(display_list);
+  ASSERT_NE(optimized, display_list);
+  EXPECT_EQ(optimized->storage_pool(), pool);
+}
+
+}  // namespace testing
+}  // namespace flutter
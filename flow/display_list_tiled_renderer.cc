@@ -0,0 +1,140 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/display_list_tiled_renderer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "flutter/fml/synchronization/count_down_latch.h"
+#include "flutter/fml/trace_event.h"
+#include "third_party/skia/include/core/SkM44.h"
+#include "third_party/skia/include/core/SkSurface.h"
+
+namespace flutter {
+
+namespace {
+
+struct Tile {
+  // The grid cell covered by the tile, clamped to the destination
+  // pixels, and the part of it that is inside of the canvas clip.
+  SkIRect cell;
+  SkIRect clip;
+};
+
+// The state shared by all of the threads that render the tiles of a
+// single DisplayList. Helper tasks that only get to run after all of
+// the tiles have been claimed may outlive the call to |Render|, which
+// is why this is reference counted and the helpers never touch the
+// destination pixels unless they claim a tile.
+struct TileJob {
+  explicit TileJob(std::vector<Tile> tiles)
+      : tiles(std::move(tiles)), done(this->tiles.size()) {}
+
+  sk_sp<DisplayList> display_list;
+  SkImageInfo info;
+  uint8_t* pixels;
+  size_t row_bytes;
+  SkIPoint origin;
+  SkSurfaceProps props;
+  SkM44 matrix;
+
+  const std::vector<Tile> tiles;
+  std::atomic_size_t next_tile = 0;
+  fml::CountDownLatch done;
+};
+
+void RenderTiles(TileJob& job) {
+  size_t index;
+  while ((index = job.next_tile.fetch_add(1)) < job.tiles.size()) {
+    const Tile& tile = job.tiles[index];
+    const SkIRect& cell = tile.cell;
+    uint8_t* cell_pixels = job.pixels + cell.y() * job.row_bytes +
+                           cell.x() * job.info.bytesPerPixel();
+    sk_sp<SkSurface> surface = SkSurface::MakeRasterDirect(
+        job.info.makeWH(cell.width(), cell.height()), cell_pixels,
+        job.row_bytes, &job.props);
+    if (surface) {
+      SkCanvas* canvas = surface->getCanvas();
+      SkIRect clip = tile.clip.makeOffset(-cell.x(), -cell.y());
+      canvas->clipRect(SkRect::Make(clip));
+      // The matrix of the canvas maps to device space which is offset
+      // from the pixels by the origin of the layer that owns them.
+      canvas->setMatrix(SkM44::Translate(-cell.x() - job.origin.x(),
+                                         -cell.y() - job.origin.y()) *
+                        job.matrix);
+      job.display_list->RenderTo(canvas, canvas->getLocalClipBounds());
+    }
+    job.done.CountDown();
+  }
+}
+
+}  // namespace
+
+bool DisplayListTiledRenderer::Render(const sk_sp<DisplayList>& display_list,
+                                      SkCanvas* canvas,
+                                      fml::BasicTaskRunner& runner,
+                                      int tile_size) {
+  FML_DCHECK(tile_size > 0);
+  if (display_list->has_image_filters()) {
+    return false;
+  }
+  SkImageInfo info;
+  size_t row_bytes;
+  SkIPoint origin;
+  void* pixels = canvas->accessTopLayerPixels(&info, &row_bytes, &origin);
+  if (!pixels || !canvas->isClipRect()) {
+    return false;
+  }
+  SkIRect clip = canvas->getDeviceClipBounds();
+  clip.offset(-origin.x(), -origin.y());
+  if (!clip.intersect(info.bounds())) {
+    return false;
+  }
+
+  std::vector<Tile> tiles;
+  for (int y = clip.top() - clip.top() % tile_size; y < clip.bottom();
+       y += tile_size) {
+    for (int x = clip.left() - clip.left() % tile_size; x < clip.right();
+         x += tile_size) {
+      SkIRect cell = SkIRect::MakeXYWH(x, y, tile_size, tile_size);
+      SkIRect cell_clip = cell;
+      if (cell.intersect(info.bounds()) && cell_clip.intersect(clip)) {
+        tiles.push_back({cell, cell_clip});
+      }
+    }
+  }
+  if (tiles.size() < 2) {
+    return false;
+  }
+
+  TRACE_EVENT1("flutter", "DisplayListTiledRenderer::Render", "tiles",
+               std::to_string(tiles.size()).c_str());
+
+  auto job = std::make_shared<TileJob>(std::move(tiles));
+  job->display_list = display_list;
+  job->info = info;
+  job->pixels = static_cast<uint8_t*>(pixels);
+  job->row_bytes = row_bytes;
+  job->origin = origin;
+  canvas->getProps(&job->props);
+  job->matrix = canvas->getLocalToDevice();
+
+  // The calling thread renders tiles as well, so it only needs help
+  // from as many workers as there are remaining cores.
+  size_t cores = std::max(std::thread::hardware_concurrency(), 1u);
+  size_t helpers = std::min(job->tiles.size(), cores) - 1;
+  for (size_t i = 0; i < helpers; i++) {
+    runner.PostTask([job]() { RenderTiles(*job); });
+  }
+  RenderTiles(*job);
+  job->done.Wait();
+  return true;
+}
+
+}  // namespace flutter
@@ -0,0 +1,52 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FLOW_DISPLAY_LIST_TILED_RENDERER_H_
+#define FLUTTER_FLOW_DISPLAY_LIST_TILED_RENDERER_H_
+
+#include "flutter/flow/display_list.h"
+#include "flutter/fml/macros.h"
+#include "flutter/fml/task_runner.h"
+
+namespace flutter {
+
+// Renders a DisplayList into a CPU backed SkCanvas by splitting the
+// visible area of the canvas into tiles which are rasterized in
+// parallel.
+//
+// Every tile is a separate raster SkSurface that wraps the pixels of
+// the destination directly, so the tiles need no compositing step.
+// Tiles are aligned to a grid in device space so that position
+// dependent effects such as dithering line up across tiles.
+// DisplayLists built with an rtree only dispatch the ops that are
+// visible in each tile.
+//
+// An image filter that is rendered into a tile only sees the pixels of
+// that tile, which would leave seams along the edges of the tiles, so
+// DisplayLists that |has_image_filters| are not tiled. Mask filters are
+// evaluated over the clip outset by their blur radius and do not need
+// to be avoided.
+class DisplayListTiledRenderer {
+ public:
+  static constexpr int kDefaultTileSize = 256;
+
+  // Renders |display_list| into |canvas| using the calling thread and
+  // the workers of |runner| and returns true. Returns false without
+  // rendering anything if the canvas cannot be tiled (it is not backed
+  // by CPU accessible pixels or its clip is not a device rect), if the
+  // DisplayList has image filters or if the visible area of the canvas
+  // fits in a single tile, in which case the caller should render the
+  // DisplayList directly.
+  static bool Render(const sk_sp<DisplayList>& display_list,
+                     SkCanvas* canvas,
+                     fml::BasicTaskRunner& runner,
+                     int tile_size = kDefaultTileSize);
+
+ private:
+  FML_DISALLOW_IMPLICIT_CONSTRUCTORS(DisplayListTiledRenderer);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_FLOW_DISPLAY_LIST_TILED_RENDERER_H_
@@ -0,0 +1,163 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/display_list_tiled_renderer.h"
+
+#include "flutter/fml/concurrent_message_loop.h"
+#include "third_party/skia/include/core/SkPictureRecorder.h"
+#include "third_party/skia/include/core/SkPixmap.h"
+#include "third_party/skia/include/core/SkSurface.h"
+#include "third_party/skia/include/effects/SkImageFilters.h"
+
+#include "gtest/gtest.h"
+
+namespace flutter {
+namespace testing {
+
+static constexpr int kTestSize = 200;
+static constexpr int kTestTileSize = 64;
+
+static sk_sp<DisplayList> MakeTestDisplayList(bool prepare_rtree) {
+  DisplayListBuilder builder(SkRect::MakeWH(kTestSize, kTestSize),
+                             prepare_rtree);
+  builder.setAntiAlias(true);
+  for (int i = 0; i < 10; i++) {
+    builder.setColor(i % 2 ? SK_ColorRED : SK_ColorBLUE);
+    builder.drawCircle({i * 20.0f + 10, i * 20.0f + 10}, 25);
+  }
+  builder.setStyle(SkPaint::kStroke_Style);
+  builder.setStrokeWidth(5);
+  builder.setColor(SK_ColorGREEN);
+  builder.drawLine({0, kTestSize}, {kTestSize, 0});
+  builder.setStyle(SkPaint::kFill_Style);
+  // The blur crosses the edges of the tiles.
+  builder.setMaskBlurFilter(kNormal_SkBlurStyle, 4);
+  builder.drawRect(SkRect::MakeLTRB(50, 120, 150, 140));
+  builder.drawPath(SkPath().addOval(SkRect::MakeLTRB(110, 40, 150, 80)));
+  builder.setMaskFilter(nullptr);
+  return builder.Build();
+}
+
+static sk_sp<DisplayList> MakeBlurredLayerDisplayList() {
+  DisplayListBuilder builder(SkRect::MakeWH(kTestSize, kTestSize));
+  builder.setImageFilter(SkImageFilters::Blur(4, 4, nullptr));
+  builder.saveLayer(nullptr, true);
+  builder.setImageFilter(nullptr);
+  builder.drawRect(SkRect::MakeLTRB(50, 120, 150, 140));
+  builder.restore();
+  return builder.Build();
+}
+
+static void ExpectSamePixels(SkSurface* expected, SkSurface* actual) {
+  SkPixmap expected_pixels;
+  SkPixmap actual_pixels;
+  ASSERT_TRUE(expected->peekPixels(&expected_pixels));
+  ASSERT_TRUE(actual->peekPixels(&actual_pixels));
+  for (int y = 0; y < kTestSize; y++) {
+    for (int x = 0; x < kTestSize; x++) {
+      ASSERT_EQ(*expected_pixels.addr32(x, y), *actual_pixels.addr32(x, y))
+          << "at " << x << ", " << y;
+    }
+  }
+}
+
+TEST(DisplayListTiledRenderer, RendersIdenticallyToDirectRendering) {
+  auto loop = fml::ConcurrentMessageLoop::Create(4);
+  for (bool prepare_rtree : {false, true}) {
+    sk_sp<DisplayList> display_list = MakeTestDisplayList(prepare_rtree);
+    sk_sp<SkSurface> expected =
+        SkSurface::MakeRasterN32Premul(kTestSize, kTestSize);
+    sk_sp<SkSurface> actual =
+        SkSurface::MakeRasterN32Premul(kTestSize, kTestSize);
+    for (SkSurface* surface : {expected.get(), actual.get()}) {
+      SkCanvas* canvas = surface->getCanvas();
+      canvas->clear(SK_ColorWHITE);
+      canvas->clipRect(SkRect::MakeLTRB(10, 10, 190, 180));
+      canvas->translate(5, 7);
+      canvas->scale(0.9, 0.9);
+    }
+
+    display_list->RenderTo(expected->getCanvas());
+    ASSERT_TRUE(DisplayListTiledRenderer::Render(
+        display_list, actual->getCanvas(), *loop->GetTaskRunner(),
+        kTestTileSize));
+    ExpectSamePixels(expected.get(), actual.get());
+  }
+}
+
+TEST(DisplayListTiledRenderer, RendersIdenticallyInsideSaveLayer) {
+  auto loop = fml::ConcurrentMessageLoop::Create(4);
+  sk_sp<DisplayList> display_list = MakeTestDisplayList(true);
+  sk_sp<SkSurface> expected =
+      SkSurface::MakeRasterN32Premul(kTestSize, kTestSize);
+  sk_sp<SkSurface> actual =
+      SkSurface::MakeRasterN32Premul(kTestSize, kTestSize);
+  SkRect layer_bounds = SkRect::MakeLTRB(30, 30, 170, 170);
+  expected->getCanvas()->saveLayer(&layer_bounds, nullptr);
+  display_list->RenderTo(expected->getCanvas());
+  expected->getCanvas()->restore();
+
+  actual->getCanvas()->saveLayer(&layer_bounds, nullptr);
+  ASSERT_TRUE(DisplayListTiledRenderer::Render(
+      display_list, actual->getCanvas(), *loop->GetTaskRunner(),
+      kTestTileSize));
+  actual->getCanvas()->restore();
+  ExpectSamePixels(expected.get(), actual.get());
+}
+
+TEST(DisplayListTiledRenderer, DeclinesImageFilters) {
+  auto loop = fml::ConcurrentMessageLoop::Create(4);
+  // A blur of a layer that crosses the edges of the tiles would only see
+  // the part of the layer inside of each tile.
+  sk_sp<DisplayList> blurred_layer = MakeBlurredLayerDisplayList();
+  DisplayListBuilder nested_builder(SkRect::MakeWH(kTestSize, kTestSize));
+  nested_builder.drawDisplayList(MakeTestDisplayList(false));
+  nested_builder.drawDisplayList(blurred_layer);
+  for (const sk_sp<DisplayList>& display_list :
+       {blurred_layer, nested_builder.Build()}) {
+    sk_sp<SkSurface> surface =
+        SkSurface::MakeRasterN32Premul(kTestSize, kTestSize);
+    surface->getCanvas()->clear(SK_ColorWHITE);
+    EXPECT_FALSE(DisplayListTiledRenderer::Render(
+        display_list, surface->getCanvas(), *loop->GetTaskRunner(),
+        kTestTileSize));
+    SkPixmap pixels;
+    ASSERT_TRUE(surface->peekPixels(&pixels));
+    EXPECT_EQ(pixels.getColor(100, 130), SK_ColorWHITE);
+  }
+}
+
+TEST(DisplayListTiledRenderer, DeclinesCanvasesWithoutPixels) {
+  auto loop = fml::ConcurrentMessageLoop::Create(4);
+  SkPictureRecorder recorder;
+  SkCanvas* canvas =
+      recorder.beginRecording(SkRect::MakeWH(kTestSize, kTestSize));
+  EXPECT_FALSE(DisplayListTiledRenderer::Render(MakeTestDisplayList(false),
+                                                canvas, *loop->GetTaskRunner(),
+                                                kTestTileSize));
+}
+
+TEST(DisplayListTiledRenderer, DeclinesComplexClips) {
+  auto loop = fml::ConcurrentMessageLoop::Create(4);
+  sk_sp<SkSurface> surface =
+      SkSurface::MakeRasterN32Premul(kTestSize, kTestSize);
+  surface->getCanvas()->clipRRect(
+      SkRRect::MakeRectXY(SkRect::MakeWH(kTestSize, kTestSize), 20, 20), true);
+  EXPECT_FALSE(DisplayListTiledRenderer::Render(
+      MakeTestDisplayList(false), surface->getCanvas(), *loop->GetTaskRunner(),
+      kTestTileSize));
+}
+
+TEST(DisplayListTiledRenderer, DeclinesAreasThatFitInOneTile) {
+  auto loop = fml::ConcurrentMessageLoop::Create(4);
+  sk_sp<SkSurface> surface =
+      SkSurface::MakeRasterN32Premul(kTestSize, kTestSize);
+  surface->getCanvas()->clipRect(SkRect::MakeLTRB(0, 0, 50, 50));
+  EXPECT_FALSE(DisplayListTiledRenderer::Render(
+      MakeTestDisplayList(false), surface->getCanvas(), *loop->GetTaskRunner(),
+      kTestTileSize));
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -9,6 +9,7 @@
 #include "third_party/skia/include/core/SkPath.h"
 #include "third_party/skia/include/core/SkPicture.h"
 #include "third_party/skia/include/core/SkPictureRecorder.h"
+#include "third_party/skia/include/core/SkPixmap.h"
 #include "third_party/skia/include/core/SkRRect.h"
 #include "third_party/skia/include/core/SkRSXform.h"
 #include "third_party/skia/include/core/SkSurface.h"
@@ -754,6 +755,7 @@ TEST(DisplayList, SingleOpDisplayListsRecapturedAreEqual) {
       ASSERT_EQ(copy->bounds(), dl->bounds()) << desc;
       ASSERT_TRUE(copy->Equals(*dl)) << desc;
       ASSERT_TRUE(dl->Equals(*copy)) << desc;
+      ASSERT_EQ(copy->content_hash(), dl->content_hash()) << desc;
     }
   }
 }
@@ -819,11 +821,13 @@ TEST(DisplayList, SingleOpDisplayListsCompareToEachOther) {
           ASSERT_EQ(listA->bounds(), listB->bounds()) << desc;
           ASSERT_TRUE(listA->Equals(*listB)) << desc;
           ASSERT_TRUE(listB->Equals(*listA)) << desc;
+          ASSERT_EQ(listA->content_hash(), listB->content_hash()) << desc;
         } else {
           // No assertion on op/byte counts or bounds
           // they may or may not be equal between variants
           ASSERT_FALSE(listA->Equals(*listB)) << desc;
           ASSERT_FALSE(listB->Equals(*listA)) << desc;
+          ASSERT_NE(listA->content_hash(), listB->content_hash()) << desc;
         }
       }
     }
@@ -894,6 +898,26 @@ TEST(DisplayList, DisplayListsWithVaryingOpComparisons) {
   }
 }
 
+TEST(DisplayList, ContentHashComparesPathsByValue) {
+  auto build = [](const SkPath& path) {
+    DisplayListBuilder builder;
+    builder.clipPath(path, SkClipOp::kIntersect, true);
+    builder.drawPath(path);
+    return builder.Build();
+  };
+  SkPath path_a = SkPath::Circle(50, 50, 20);
+  SkPath path_b = SkPath::Circle(50, 50, 20);
+  SkPath path_c = SkPath::Circle(50, 50, 21);
+  sk_sp<DisplayList> list_a = build(path_a);
+  sk_sp<DisplayList> list_b = build(path_b);
+  sk_sp<DisplayList> list_c = build(path_c);
+  ASSERT_TRUE(list_a->Equals(*list_b));
+  ASSERT_EQ(list_a->content_hash(), list_b->content_hash());
+  ASSERT_FALSE(list_a->Equals(*list_c));
+  ASSERT_NE(list_a->content_hash(), list_c->content_hash());
+  ASSERT_NE(list_a->content_hash(), DisplayList().content_hash());
+}
+
 TEST(DisplayList, DisplayListSaveLayerBoundsWithAlphaFilter) {
   SkRect build_bounds = SkRect::MakeLTRB(-100, -100, 200, 200);
   SkRect save_bounds = SkRect::MakeWH(100, 100);
@@ -1050,5 +1074,372 @@ TEST(DisplayList, DisplayListSaveLayerBoundsWithAlphaFilter) {
   }
 }
 
+static const SkRect kCullTestBounds = SkRect::MakeLTRB(0, 0, 100, 100);
+static const SkRect kCullTestQuery = SkRect::MakeLTRB(0, 0, 30, 30);
+static const SkRect kCullTestVisible = SkRect::MakeLTRB(10, 10, 20, 20);
+static const SkRect kCullTestInvisible = SkRect::MakeLTRB(60, 60, 70, 70);
+
+TEST(DisplayList, CulledDispatchWithoutRTreeDispatchesAllOps) {
+  DisplayListBuilder builder(kCullTestBounds);
+  builder.drawRect(kCullTestVisible);
+  builder.drawRect(kCullTestInvisible);
+  sk_sp<DisplayList> display_list = builder.Build();
+  ASSERT_FALSE(display_list->has_rtree());
+
+  DisplayListBuilder culled;
+  display_list->Dispatch(culled, kCullTestQuery);
+  ASSERT_TRUE(culled.Build()->Equals(*display_list));
+}
+
+TEST(DisplayList, CulledDispatchSkipsInvisibleOps) {
+  DisplayListBuilder builder(kCullTestBounds, true);
+  builder.setColor(SK_ColorRED);
+  builder.drawRect(kCullTestVisible);
+  builder.drawRect(kCullTestInvisible);
+  builder.save();
+  builder.translate(50, 0);
+  builder.setColor(SK_ColorBLUE);
+  builder.drawRect(kCullTestVisible);
+  builder.restore();
+  builder.drawOval(kCullTestVisible);
+  sk_sp<DisplayList> display_list = builder.Build();
+  ASSERT_TRUE(display_list->has_rtree());
+
+  // The invisible save/restore group is skipped, except for the
+  // attribute that is still in effect after it is restored.
+  DisplayListBuilder expected;
+  expected.setColor(SK_ColorRED);
+  expected.drawRect(kCullTestVisible);
+  expected.setColor(SK_ColorBLUE);
+  expected.drawOval(kCullTestVisible);
+
+  DisplayListBuilder culled;
+  display_list->Dispatch(culled, kCullTestQuery);
+  ASSERT_TRUE(culled.Build()->Equals(*expected.Build()));
+
+  DisplayListBuilder unculled;
+  display_list->Dispatch(unculled, kCullTestBounds);
+  ASSERT_TRUE(unculled.Build()->Equals(*display_list));
+}
+
+TEST(DisplayList, CulledDispatchTreatsSaveLayersAsAWhole) {
+  DisplayListBuilder builder(kCullTestBounds, true);
+  builder.saveLayer(nullptr, false);
+  builder.setColor(SK_ColorBLUE);
+  builder.drawRect(kCullTestVisible);
+  builder.drawRect(kCullTestInvisible);
+  builder.restore();
+  builder.saveLayer(nullptr, false);
+  builder.setColor(SK_ColorRED);
+  builder.drawRect(kCullTestInvisible);
+  builder.restore();
+  builder.drawRect(kCullTestVisible);
+  sk_sp<DisplayList> display_list = builder.Build();
+
+  DisplayListBuilder expected;
+  expected.saveLayer(nullptr, false);
+  expected.setColor(SK_ColorBLUE);
+  expected.drawRect(kCullTestVisible);
+  expected.drawRect(kCullTestInvisible);
+  expected.restore();
+  expected.setColor(SK_ColorRED);
+  expected.drawRect(kCullTestVisible);
+
+  DisplayListBuilder culled;
+  display_list->Dispatch(culled, kCullTestQuery);
+  ASSERT_TRUE(culled.Build()->Equals(*expected.Build()));
+}
+
+TEST(DisplayList, CulledRenderingMatchesFullRendering) {
+  DisplayListBuilder builder(kCullTestBounds, true);
+  builder.setAntiAlias(true);
+  for (int i = 0; i < 10; i++) {
+    builder.save();
+    builder.translate(0, i * 10.0f);
+    builder.clipRect(SkRect::MakeWH(100, 10), SkClipOp::kIntersect, false);
+    builder.setColor(i % 2 ? SK_ColorRED : SK_ColorBLUE);
+    builder.drawCircle({i * 10.0f + 5, 5}, 8);
+    builder.restore();
+  }
+  builder.setStyle(SkPaint::kStroke_Style);
+  builder.setStrokeWidth(10);
+  builder.drawRect(SkRect::MakeLTRB(32, 32, 60, 60));
+  sk_sp<DisplayList> display_list = builder.Build();
+
+  sk_sp<SkSurface> expected_surface = SkSurface::MakeRasterN32Premul(100, 100);
+  sk_sp<SkSurface> actual_surface = SkSurface::MakeRasterN32Premul(100, 100);
+  SkCanvas* expected_canvas = expected_surface->getCanvas();
+  SkCanvas* actual_canvas = actual_surface->getCanvas();
+  expected_canvas->clipRect(kCullTestQuery);
+  actual_canvas->clipRect(kCullTestQuery);
+  display_list->RenderTo(expected_canvas);
+  display_list->RenderTo(actual_canvas, actual_canvas->getLocalClipBounds());
+
+  SkPixmap expected_pixels;
+  SkPixmap actual_pixels;
+  ASSERT_TRUE(expected_surface->peekPixels(&expected_pixels));
+  ASSERT_TRUE(actual_surface->peekPixels(&actual_pixels));
+  for (int y = 0; y < 100; y++) {
+    for (int x = 0; x < 100; x++) {
+      ASSERT_EQ(*expected_pixels.addr32(x, y), *actual_pixels.addr32(x, y))
+          << "at " << x << ", " << y;
+    }
+  }
+}
+
+TEST(DisplayList, TemplatedDispatchMatchesVirtualDispatch) {
+  DisplayListBuilder builder(kCullTestBounds, true);
+  builder.setStyle(SkPaint::kStroke_Style);
+  builder.setStrokeWidth(4);
+  builder.drawRect(kCullTestVisible);
+  builder.save();
+  builder.translate(5, 5);
+  builder.scale(2, 2);
+  builder.clipRect(SkRect::MakeWH(20, 20), SkClipOp::kIntersect, false);
+  builder.drawOval(kCullTestInvisible);
+  builder.restore();
+  builder.drawCircle({70, 20}, 5);
+  sk_sp<DisplayList> display_list = builder.Build();
+
+  DisplayListBoundsCalculator virtual_calculator(&kCullTestBounds);
+  display_list->Dispatch(static_cast<Dispatcher&>(virtual_calculator));
+  DisplayListBoundsCalculator templated_calculator(&kCullTestBounds);
+  display_list->DispatchT(templated_calculator);
+  EXPECT_EQ(templated_calculator.bounds(), virtual_calculator.bounds());
+
+  DisplayListBoundsCalculator virtual_culled(&kCullTestBounds);
+  display_list->Dispatch(static_cast<Dispatcher&>(virtual_culled),
+                         kCullTestQuery);
+  DisplayListBoundsCalculator templated_culled(&kCullTestBounds);
+  display_list->DispatchT(templated_culled, kCullTestQuery);
+  EXPECT_EQ(templated_culled.bounds(), virtual_culled.bounds());
+  EXPECT_NE(templated_culled.bounds(), templated_calculator.bounds());
+}
+
+static SkRect ReplayBounds(const DisplayList& display_list) {
+  DisplayListBoundsCalculator calculator(&display_list.cull_rect());
+  display_list.Dispatch(calculator);
+  return calculator.bounds();
+}
+
+TEST(DisplayList, RecordedBoundsMatchReplayedBounds) {
+  DisplayListBuilder builder;
+  builder.setStrokeWidth(4);
+  builder.setStyle(SkPaint::kStroke_Style);
+  // The bounds of ops with trailing data like points can only be
+  // measured after the data has been copied behind the op.
+  const SkPoint points[] = {{10, 10}, {50, 20}, {30, 70}};
+  builder.drawPoints(SkCanvas::kPolygon_PointMode, 3, points);
+  builder.setImageFilter(SkImageFilters::Blur(5, 5, nullptr));
+  builder.saveLayer(nullptr, true);
+  builder.setImageFilter(nullptr);
+  builder.translate(100, 0);
+  builder.drawRect(SkRect::MakeLTRB(0, 0, 20, 20));
+  // An unbalanced saveLayer is restored by Build.
+  sk_sp<DisplayList> display_list = builder.Build();
+
+  EXPECT_EQ(display_list->bounds(), ReplayBounds(*display_list));
+  EXPECT_TRUE(display_list->bounds().contains(SkRect::MakeLTRB(8, 8, 52, 72)));
+  EXPECT_GT(display_list->bounds().fRight, 120);
+}
+
+TEST(DisplayList, NestedDisplayListBoundsCompose) {
+  DisplayListBuilder nested_builder;
+  nested_builder.drawRect(SkRect::MakeLTRB(10, 10, 20, 20));
+  sk_sp<DisplayList> nested = nested_builder.Build();
+  ASSERT_EQ(nested->bounds(), SkRect::MakeLTRB(10, 10, 20, 20));
+
+  DisplayListBuilder builder;
+  builder.translate(100, 50);
+  builder.scale(2, 2);
+  builder.drawDisplayList(nested);
+  sk_sp<DisplayList> display_list = builder.Build();
+  EXPECT_EQ(display_list->bounds(), SkRect::MakeLTRB(120, 70, 140, 90));
+  EXPECT_EQ(display_list->bounds(), ReplayBounds(*display_list));
+}
+
+TEST(DisplayList, BuilderCanBeReusedAfterBuild) {
+  DisplayListBuilder builder(kCullTestBounds, true);
+  builder.drawRect(kCullTestInvisible);
+  sk_sp<DisplayList> first = builder.Build();
+  builder.drawRect(kCullTestVisible);
+  sk_sp<DisplayList> second = builder.Build();
+  EXPECT_EQ(first->bounds(), kCullTestInvisible);
+  EXPECT_EQ(second->bounds(), kCullTestVisible);
+  ASSERT_TRUE(second->has_rtree());
+
+  DisplayListBuilder culled;
+  second->Dispatch(culled, kCullTestQuery);
+  EXPECT_EQ(culled.Build()->op_count(), 1);
+}
+
+TEST(DisplayList, NonOverlappingOpsCanApplyGroupOpacity) {
+  DisplayListBuilder builder;
+  builder.setColor(SK_ColorRED);
+  builder.drawRect(SkRect::MakeLTRB(0, 0, 10, 10));
+  builder.drawOval(SkRect::MakeLTRB(20, 0, 30, 10));
+  builder.translate(0, 20);
+  builder.drawRect(SkRect::MakeLTRB(0, 0, 10, 10));
+  EXPECT_TRUE(builder.Build()->can_apply_group_opacity());
+}
+
+TEST(DisplayList, OverlappingOpsCannotApplyGroupOpacity) {
+  DisplayListBuilder builder;
+  builder.drawRect(SkRect::MakeLTRB(0, 0, 10, 10));
+  builder.drawRect(SkRect::MakeLTRB(5, 5, 15, 15));
+  EXPECT_FALSE(builder.Build()->can_apply_group_opacity());
+}
+
+TEST(DisplayList, GroupOpacityRequiresCompatibleAttributes) {
+  DisplayListBuilder builder;
+  builder.setBlendMode(SkBlendMode::kSrc);
+  builder.drawRect(SkRect::MakeLTRB(0, 0, 10, 10));
+  EXPECT_FALSE(builder.Build()->can_apply_group_opacity());
+
+  builder.setBlendMode(SkBlendMode::kSrc);
+  builder.setBlendMode(SkBlendMode::kSrcOver);
+  builder.drawRect(SkRect::MakeLTRB(0, 0, 10, 10));
+  EXPECT_TRUE(builder.Build()->can_apply_group_opacity());
+
+  builder.setColorFilter(TestColorFilter1);
+  builder.drawRect(SkRect::MakeLTRB(0, 0, 10, 10));
+  EXPECT_FALSE(builder.Build()->can_apply_group_opacity());
+
+  // Images rendered without the attributes are not affected by them.
+  builder.setColorFilter(TestColorFilter1);
+  builder.drawImage(TestImage1, {0, 0}, DisplayList::NearestSampling, false);
+  EXPECT_TRUE(builder.Build()->can_apply_group_opacity());
+
+  builder.setImageFilter(TestImageFilter1);
+  builder.drawRect(SkRect::MakeLTRB(0, 0, 10, 10));
+  EXPECT_FALSE(builder.Build()->can_apply_group_opacity());
+}
+
+TEST(DisplayList, TextBlobsCannotApplyGroupOpacity) {
+  DisplayListBuilder builder;
+  builder.drawTextBlob(TestBlob1, 10, 10);
+  EXPECT_FALSE(builder.Build()->can_apply_group_opacity());
+}
+
+TEST(DisplayList, SaveLayersCannotApplyGroupOpacity) {
+  DisplayListBuilder builder;
+  builder.saveLayer(nullptr, false);
+  builder.drawRect(SkRect::MakeLTRB(0, 0, 10, 10));
+  builder.restore();
+  EXPECT_FALSE(builder.Build()->can_apply_group_opacity());
+}
+
+TEST(DisplayList, NestedDisplayListsCanApplyGroupOpacity) {
+  DisplayListBuilder nested_builder;
+  nested_builder.drawRect(SkRect::MakeLTRB(0, 0, 10, 10));
+  nested_builder.drawRect(SkRect::MakeLTRB(20, 0, 30, 10));
+  sk_sp<DisplayList> nested = nested_builder.Build();
+  ASSERT_TRUE(nested->can_apply_group_opacity());
+
+  DisplayListBuilder builder;
+  builder.drawDisplayList(nested);
+  builder.translate(0, 20);
+  builder.drawDisplayList(nested);
+  EXPECT_TRUE(builder.Build()->can_apply_group_opacity());
+
+  builder.drawDisplayList(nested);
+  builder.translate(5, 5);
+  builder.drawDisplayList(nested);
+  EXPECT_FALSE(builder.Build()->can_apply_group_opacity());
+}
+
+TEST(DisplayList, GroupOpacityRenderingMatchesSaveLayer) {
+  DisplayListBuilder nested_builder;
+  nested_builder.setColor(SK_ColorGREEN);
+  nested_builder.drawCircle({50, 55}, 5);
+  sk_sp<DisplayList> nested = nested_builder.Build();
+
+  const SkRRect rrect =
+      SkRRect::MakeRectXY(SkRect::MakeLTRB(10, 70, 90, 90), 5, 5);
+  DisplayListBuilder builder(kCullTestBounds);
+  builder.setAntiAlias(true);
+  builder.setColor(SK_ColorRED);
+  builder.drawRect(SkRect::MakeLTRB(10, 10, 30, 30));
+  builder.setColor(SkColorSetARGB(0x80, 0x00, 0x00, 0xff));
+  builder.drawRRect(rrect);
+  builder.drawColor(SkColorSetARGB(0x40, 0xff, 0x00, 0xff),
+                    SkBlendMode::kSrcOver);
+  builder.drawDisplayList(nested);
+  sk_sp<DisplayList> display_list = builder.Build();
+  // drawColor covers the whole cull rect, so the ops before it overlap it.
+  EXPECT_FALSE(display_list->can_apply_group_opacity());
+
+  builder.setAntiAlias(true);
+  builder.setColor(SK_ColorRED);
+  builder.drawRect(SkRect::MakeLTRB(10, 10, 30, 30));
+  builder.setColor(SkColorSetARGB(0x80, 0x00, 0x00, 0xff));
+  builder.drawRRect(rrect);
+  builder.drawImage(TestImage1, {60, 10}, DisplayList::NearestSampling, false);
+  builder.drawDisplayList(nested);
+  display_list = builder.Build();
+  ASSERT_TRUE(display_list->can_apply_group_opacity());
+
+  sk_sp<SkSurface> expected_surface = SkSurface::MakeRasterN32Premul(100, 100);
+  sk_sp<SkSurface> actual_surface = SkSurface::MakeRasterN32Premul(100, 100);
+  SkCanvas* expected_canvas = expected_surface->getCanvas();
+  SkCanvas* actual_canvas = actual_surface->getCanvas();
+  expected_canvas->clear(SK_ColorWHITE);
+  actual_canvas->clear(SK_ColorWHITE);
+  SkPaint layer_paint;
+  layer_paint.setAlphaf(0.5f);
+  expected_canvas->saveLayer(nullptr, &layer_paint);
+  display_list->RenderTo(expected_canvas);
+  expected_canvas->restore();
+  display_list->RenderTo(actual_canvas, 0.5f);
+
+  SkPixmap expected_pixels;
+  SkPixmap actual_pixels;
+  ASSERT_TRUE(expected_surface->peekPixels(&expected_pixels));
+  ASSERT_TRUE(actual_surface->peekPixels(&actual_pixels));
+  for (int y = 0; y < 100; y++) {
+    for (int x = 0; x < 100; x++) {
+      auto expected = static_cast<const uint8_t*>(expected_pixels.addr(x, y));
+      auto actual = static_cast<const uint8_t*>(actual_pixels.addr(x, y));
+      // The layer and the ops round their alpha differently.
+      for (int c = 0; c < 4; c++) {
+        ASSERT_NEAR(expected[c], actual[c], 1) << "at " << x << ", " << y;
+      }
+    }
+  }
+}
+
+TEST(DisplayList, ImageFiltersAreTracked) {
+  DisplayListBuilder plain_builder;
+  plain_builder.setColorFilter(TestColorFilter1);
+  plain_builder.setMaskBlurFilter(kNormal_SkBlurStyle, 3.0);
+  plain_builder.drawRect(SkRect::MakeLTRB(10, 10, 20, 20));
+  plain_builder.saveLayer(nullptr, true);
+  plain_builder.restore();
+  sk_sp<DisplayList> plain = plain_builder.Build();
+  EXPECT_FALSE(plain->has_image_filters());
+
+  DisplayListBuilder filter_builder;
+  filter_builder.setImageFilter(TestImageFilter1);
+  filter_builder.saveLayer(nullptr, true);
+  filter_builder.setImageFilter(nullptr);
+  filter_builder.drawRect(SkRect::MakeLTRB(10, 10, 20, 20));
+  filter_builder.restore();
+  sk_sp<DisplayList> filtered = filter_builder.Build();
+  EXPECT_TRUE(filtered->has_image_filters());
+
+  // The builder starts over with each list.
+  EXPECT_FALSE(filter_builder.Build()->has_image_filters());
+
+  DisplayListBuilder nested_builder;
+  nested_builder.drawDisplayList(plain);
+  EXPECT_FALSE(nested_builder.Build()->has_image_filters());
+  nested_builder.drawDisplayList(filtered);
+  EXPECT_TRUE(nested_builder.Build()->has_image_filters());
+
+  DisplayListBuilder picture_builder;
+  picture_builder.drawPicture(TestPicture1, nullptr, false);
+  EXPECT_TRUE(picture_builder.Build()->has_image_filters());
+}
+
 }  // namespace testing
 }  // namespace flutter
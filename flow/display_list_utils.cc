@@ -53,6 +53,9 @@ void SkPaintDispatchHelper::setStrokeMiter(SkScalar limit) {
 }
 void SkPaintDispatchHelper::setColor(SkColor color) {
   paint_.setColor(color);
+  if (opacity_ < SK_Scalar1) {
+    paint_.setAlphaf(paint_.getAlphaf() * opacity_);
+  }
 }
 void SkPaintDispatchHelper::setBlendMode(SkBlendMode mode) {
   paint_.setBlendMode(mode);
@@ -81,6 +84,13 @@ void SkPaintDispatchHelper::setMaskBlurFilter(SkBlurStyle style,
   paint_.setMaskFilter(SkMaskFilter::MakeBlur(style, sigma));
 }
 
+const SkPaint* SkPaintDispatchHelper::safe_paint(bool use_attributes) {
+  if (use_attributes) {
+    return &paint_;
+  }
+  return opacity_ < SK_Scalar1 ? &opacity_paint_ : nullptr;
+}
+
 sk_sp<SkColorFilter> SkPaintDispatchHelper::makeColorFilter() {
   if (!invert_colors_) {
     return color_filter_;
@@ -569,9 +579,16 @@ bool DisplayListBoundsCalculator::AdjustBoundsForPaint(SkRect& bounds,
   return ComputeFilteredBounds(bounds, image_filter_.get());
 }
 
+void DisplayListBoundsCalculator::Accumulate(const SkRect& bounds) {
+  accumulator_->accumulate(bounds);
+  if (root_op_accumulator_ &&
+      accumulator_ == layer_infos_.front()->layer_accumulator()) {
+    root_op_accumulator_->accumulate(bounds);
+  }
+}
 void DisplayListBoundsCalculator::AccumulateUnbounded() {
   if (has_clip()) {
-    accumulator_->accumulate(clip_bounds());
+    Accumulate(clip_bounds());
   } else {
     layer_infos_.back()->set_unbounded();
   }
@@ -580,7 +597,7 @@ void DisplayListBoundsCalculator::AccumulateRect(SkRect& rect, int flags) {
   if (AdjustBoundsForPaint(rect, flags)) {
     matrix().mapRect(&rect);
     if (!has_clip() || rect.intersect(clip_bounds())) {
-      accumulator_->accumulate(rect);
+      Accumulate(rect);
     }
   } else {
     AccumulateUnbounded();
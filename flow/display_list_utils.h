@@ -94,8 +94,20 @@ class IgnoreTransformDispatchHelper : public virtual Dispatcher {
 // A utility class that will monitor the Dispatcher methods relating
 // to the rendering attributes and accumulate them into an SkPaint
 // which can be accessed at any time via paint().
+//
+// An |opacity| less than 1 is applied to the alpha of every color that
+// is set so that the ops of a list whose |can_apply_group_opacity| is
+// true can be rendered with a group opacity without a saveLayer.
 class SkPaintDispatchHelper : public virtual Dispatcher {
  public:
+  explicit SkPaintDispatchHelper(SkScalar opacity = SK_Scalar1)
+      : opacity_(opacity) {
+    if (opacity < SK_Scalar1) {
+      paint_.setAlphaf(opacity);
+      opacity_paint_.setAlphaf(opacity);
+    }
+  }
+
   void setAntiAlias(bool aa) override;
   void setDither(bool dither) override;
   void setStyle(SkPaint::Style style) override;
@@ -116,8 +128,17 @@ class SkPaintDispatchHelper : public virtual Dispatcher {
 
   const SkPaint& paint() { return paint_; }
 
+  // The paint for an op that may or may not use the current attributes.
+  // Ops that ignore the attributes still need a paint to carry the
+  // opacity, if there is one.
+  const SkPaint* safe_paint(bool use_attributes);
+
+  SkScalar opacity() const { return opacity_; }
+
  private:
+  const SkScalar opacity_;
   SkPaint paint_;
+  SkPaint opacity_paint_;
   bool invert_colors_ = false;
   sk_sp<SkColorFilter> color_filter_;
 
@@ -379,10 +400,23 @@ class DisplayListBoundsCalculator final
     return accumulator_->bounds();
   }
 
+  // Optionally also accumulate the bounds of every operation that
+  // contributes directly to the root layer into |accumulator|. Those
+  // are the rendering ops outside of any saveLayer and the outermost
+  // saveLayers themselves (accumulated when they are restored).
+  // Resetting the accumulator between ops yields the bounds of each
+  // individual op in the coordinate space of the DisplayList.
+  void set_root_op_accumulator(BoundsAccumulator* accumulator) {
+    root_op_accumulator_ = accumulator;
+  }
+
  private:
   // current accumulator based on saveLayer history
   BoundsAccumulator* accumulator_;
 
+  // see |set_root_op_accumulator|
+  BoundsAccumulator* root_op_accumulator_ = nullptr;
+
   // A class that abstracts the information kept for a single
   // |save| or |saveLayer|, including the root information that
   // is kept as a base set of information for the DisplayList
@@ -606,6 +640,7 @@ class DisplayListBoundsCalculator final
   static bool ComputeFilteredBounds(SkRect& rect, SkImageFilter* filter);
   bool AdjustBoundsForPaint(SkRect& bounds, int flags);
 
+  void Accumulate(const SkRect& bounds);
   void AccumulateUnbounded();
   void AccumulateRect(const SkRect& rect, int flags) {
     SkRect bounds = rect;
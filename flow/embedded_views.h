@@ -5,6 +5,7 @@
 #ifndef FLUTTER_FLOW_EMBEDDED_VIEWS_H_
 #define FLUTTER_FLOW_EMBEDDED_VIEWS_H_
 
+#include <optional>
 #include <vector>
 
 #include "flutter/flow/surface_frame.h"
@@ -304,6 +305,15 @@ class ExternalViewEmbedder {
 
   virtual std::vector<SkCanvas*> GetCurrentCanvases() = 0;
 
+  // This needs to get called after |Preroll| finishes on the layer tree, if
+  // the root canvas of the frame is provided by the embedder.
+  //
+  // Returns the area of the render target of the root canvas whose content
+  // differs from the last submitted frame, which lets the frame be painted
+  // partially. Returns an unset value if the content is unknown, in which
+  // case the whole frame is painted.
+  virtual std::optional<SkIRect> GetExistingDamage() { return std::nullopt; }
+
   // Must be called on the UI thread.
   virtual SkCanvas* CompositeEmbeddedView(int view_id) = 0;
 
@@ -107,6 +107,21 @@ size_t FrameTimingsRecorder::GetPictureCacheBytes() const {
   return picture_cache_bytes_;
 }
 
+/// Count of the draws in the frame that drew a raster cache image
+size_t FrameTimingsRecorder::GetRasterCacheHitCount() const {
+  std::scoped_lock state_lock(state_mutex_);
+  FML_DCHECK(state_ >= State::kRasterEnd);
+  return raster_cache_hit_count_;
+}
+
+/// Count of the draws in the frame of content that has a raster cache entry
+/// but no image
+size_t FrameTimingsRecorder::GetRasterCacheMissCount() const {
+  std::scoped_lock state_lock(state_mutex_);
+  FML_DCHECK(state_ >= State::kRasterEnd);
+  return raster_cache_miss_count_;
+}
+
 void FrameTimingsRecorder::RecordVsync(fml::TimePoint vsync_start,
                                        fml::TimePoint vsync_target) {
   std::scoped_lock state_lock(state_mutex_);
@@ -152,9 +167,12 @@ FrameTiming FrameTimingsRecorder::RecordRasterEnd(const RasterCache* cache) {
     layer_cache_bytes_ = cache->EstimateLayerCacheByteSize();
     picture_cache_count_ = cache->GetPictureCachedEntriesCount();
     picture_cache_bytes_ = cache->EstimatePictureCacheByteSize();
+    raster_cache_hit_count_ = cache->current_frame_report().hits;
+    raster_cache_miss_count_ = cache->current_frame_report().misses;
   } else {
     layer_cache_count_ = layer_cache_bytes_ = picture_cache_count_ =
         picture_cache_bytes_ = 0;
+    raster_cache_hit_count_ = raster_cache_miss_count_ = 0;
   }
   timing_.Set(FrameTiming::kVsyncStart, vsync_start_);
   timing_.Set(FrameTiming::kBuildStart, build_start_);
@@ -165,6 +183,8 @@ FrameTiming FrameTimingsRecorder::RecordRasterEnd(const RasterCache* cache) {
   timing_.SetFrameNumber(GetFrameNumber());
   timing_.SetRasterCacheStatistics(layer_cache_count_, layer_cache_bytes_,
                                    picture_cache_count_, picture_cache_bytes_);
+  timing_.SetRasterCacheHitStatistics(raster_cache_hit_count_,
+                                      raster_cache_miss_count_);
   return timing_;
 }
 
@@ -207,6 +227,8 @@ std::unique_ptr<FrameTimingsRecorder> FrameTimingsRecorder::CloneUntil(
     recorder->layer_cache_bytes_ = layer_cache_bytes_;
     recorder->picture_cache_count_ = picture_cache_count_;
     recorder->picture_cache_bytes_ = picture_cache_bytes_;
+    recorder->raster_cache_hit_count_ = raster_cache_hit_count_;
+    recorder->raster_cache_miss_count_ = raster_cache_miss_count_;
   }
 
   return recorder;
@@ -83,6 +83,13 @@ class FrameTimingsRecorder {
   /// Total Bytes in all picture cache entries
   size_t GetPictureCacheBytes() const;
 
+  /// Count of the draws in the frame that drew a raster cache image
+  size_t GetRasterCacheHitCount() const;
+
+  /// Count of the draws in the frame of content that has a raster cache entry
+  /// but no image
+  size_t GetRasterCacheMissCount() const;
+
   /// Records a vsync event.
   void RecordVsync(fml::TimePoint vsync_start, fml::TimePoint vsync_target);
 
@@ -136,6 +143,8 @@ class FrameTimingsRecorder {
   size_t layer_cache_bytes_;
   size_t picture_cache_count_;
   size_t picture_cache_bytes_;
+  size_t raster_cache_hit_count_;
+  size_t raster_cache_miss_count_;
 
   // Set when `RecordRasterEnd` is called. Cannot be reset once set.
   FrameTiming timing_;
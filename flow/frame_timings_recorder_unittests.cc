@@ -74,6 +74,8 @@ TEST(FrameTimingsRecorderTest, RecordRasterTimes) {
   ASSERT_EQ(recorder->GetLayerCacheBytes(), 0u);
   ASSERT_EQ(recorder->GetPictureCacheCount(), 0u);
   ASSERT_EQ(recorder->GetPictureCacheBytes(), 0u);
+  ASSERT_EQ(recorder->GetRasterCacheHitCount(), 0u);
+  ASSERT_EQ(recorder->GetRasterCacheMissCount(), 0u);
 }
 
 TEST(FrameTimingsRecorderTest, RecordRasterTimesWithCache) {
@@ -117,6 +119,10 @@ TEST(FrameTimingsRecorderTest, RecordRasterTimesWithCache) {
   ASSERT_EQ(recorder->GetLayerCacheBytes(), layer_bytes);
   ASSERT_EQ(recorder->GetPictureCacheCount(), 1u);
   ASSERT_EQ(recorder->GetPictureCacheBytes(), picture_bytes);
+  // The picture was drawn once before it was cached.
+  ASSERT_EQ(recorder->GetRasterCacheHitCount(), 0u);
+  ASSERT_EQ(recorder->GetRasterCacheMissCount(), 1u);
+  ASSERT_EQ(timing.GetRasterCacheMissCount(), 1u);
 }
 
 // Windows and Fuchsia don't allow testing with killed by signal.
@@ -306,6 +312,10 @@ TEST(FrameTimingsRecorderTest, ClonedHasSameRasterEndWithCache) {
   ASSERT_EQ(recorder->GetLayerCacheBytes(), cloned->GetLayerCacheBytes());
   ASSERT_EQ(recorder->GetPictureCacheCount(), cloned->GetPictureCacheCount());
   ASSERT_EQ(recorder->GetPictureCacheBytes(), cloned->GetPictureCacheBytes());
+  ASSERT_EQ(recorder->GetRasterCacheHitCount(),
+            cloned->GetRasterCacheHitCount());
+  ASSERT_EQ(recorder->GetRasterCacheMissCount(),
+            cloned->GetRasterCacheMissCount());
 }
 
 TEST(FrameTimingsRecorderTest, FrameNumberTraceArgIsValid) {
@@ -14,16 +14,15 @@ class BackdropFilterLayer : public ContainerLayer {
  public:
   BackdropFilterLayer(sk_sp<SkImageFilter> filter, SkBlendMode blend_mode);
 
-#ifdef FLUTTER_ENABLE_DIFF_CONTEXT
-
   void Diff(DiffContext* context, const Layer* old_layer) override;
 
-#endif  // FLUTTER_ENABLE_DIFF_CONTEXT
-
   void Preroll(PrerollContext* context, const SkMatrix& matrix) override;
 
   void Paint(PaintContext& context) const override;
 
+  // The backdrop filter reads what was drawn below the layer.
+  bool can_be_flattened() const override { return false; }
+
  private:
   sk_sp<SkImageFilter> filter_;
   SkBlendMode blend_mode_;
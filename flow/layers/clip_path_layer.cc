@@ -12,8 +12,6 @@ ClipPathLayer::ClipPathLayer(const SkPath& clip_path, Clip clip_behavior)
   FML_DCHECK(clip_behavior != Clip::none);
 }
 
-#ifdef FLUTTER_ENABLE_DIFF_CONTEXT
-
 void ClipPathLayer::Diff(DiffContext* context, const Layer* old_layer) {
   DiffContext::AutoSubtreeRestore subtree(context);
   auto* prev = static_cast<const ClipPathLayer*>(old_layer);
@@ -30,8 +28,6 @@ void ClipPathLayer::Diff(DiffContext* context, const Layer* old_layer) {
   context->SetLayerPaintRegion(this, context->CurrentSubtreeRegion());
 }
 
-#endif  // FLUTTER_ENABLE_DIFF_CONTEXT
-
 void ClipPathLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
   TRACE_EVENT0("flutter", "ClipPathLayer::Preroll");
 
@@ -54,6 +50,19 @@ void ClipPathLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
   context->cull_rect = previous_cull_rect;
 }
 
+bool ClipPathLayer::can_be_flattened() const {
+  return !UsesSaveLayer() && children_can_be_flattened();
+}
+
+void ClipPathLayer::Flatten(DisplayListBuilder& builder,
+                            const SkMatrix& matrix) const {
+  builder.save();
+  builder.clipPath(clip_path_, SkClipOp::kIntersect,
+                   clip_behavior_ != Clip::hardEdge);
+  FlattenChildren(builder, matrix);
+  builder.restore();
+}
+
 void ClipPathLayer::Paint(PaintContext& context) const {
   TRACE_EVENT0("flutter", "ClipPathLayer::Paint");
   FML_DCHECK(needs_painting(context));
@@ -12,8 +12,6 @@ ClipRectLayer::ClipRectLayer(const SkRect& clip_rect, Clip clip_behavior)
   FML_DCHECK(clip_behavior != Clip::none);
 }
 
-#ifdef FLUTTER_ENABLE_DIFF_CONTEXT
-
 void ClipRectLayer::Diff(DiffContext* context, const Layer* old_layer) {
   DiffContext::AutoSubtreeRestore subtree(context);
   auto* prev = static_cast<const ClipRectLayer*>(old_layer);
@@ -30,8 +28,6 @@ void ClipRectLayer::Diff(DiffContext* context, const Layer* old_layer) {
   context->SetLayerPaintRegion(this, context->CurrentSubtreeRegion());
 }
 
-#endif  // FLUTTER_ENABLE_DIFF_CONTEXT
-
 void ClipRectLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
   TRACE_EVENT0("flutter", "ClipRectLayer::Preroll");
 
@@ -53,6 +49,19 @@ void ClipRectLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
   context->cull_rect = previous_cull_rect;
 }
 
+bool ClipRectLayer::can_be_flattened() const {
+  return !UsesSaveLayer() && children_can_be_flattened();
+}
+
+void ClipRectLayer::Flatten(DisplayListBuilder& builder,
+                            const SkMatrix& matrix) const {
+  builder.save();
+  builder.clipRect(clip_rect_, SkClipOp::kIntersect,
+                   clip_behavior_ != Clip::hardEdge);
+  FlattenChildren(builder, matrix);
+  builder.restore();
+}
+
 void ClipRectLayer::Paint(PaintContext& context) const {
   TRACE_EVENT0("flutter", "ClipRectLayer::Paint");
   FML_DCHECK(needs_painting(context));
@@ -13,12 +13,8 @@ class ClipRectLayer : public ContainerLayer {
  public:
   ClipRectLayer(const SkRect& clip_rect, Clip clip_behavior);
 
-#ifdef FLUTTER_ENABLE_DIFF_CONTEXT
-
   void Diff(DiffContext* context, const Layer* old_layer) override;
 
-#endif  // FLUTTER_ENABLE_DIFF_CONTEXT
-
   void Preroll(PrerollContext* context, const SkMatrix& matrix) override;
   void Paint(PaintContext& context) const override;
 
@@ -26,6 +22,12 @@ class ClipRectLayer : public ContainerLayer {
     return clip_behavior_ == Clip::antiAliasWithSaveLayer;
   }
 
+  // Clips that need a saveLayer are not flattened.
+  bool can_be_flattened() const override;
+
+  void Flatten(DisplayListBuilder& builder,
+               const SkMatrix& matrix) const override;
+
  private:
   SkRect clip_rect_;
   Clip clip_behavior_;
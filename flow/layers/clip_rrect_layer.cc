@@ -12,8 +12,6 @@ ClipRRectLayer::ClipRRectLayer(const SkRRect& clip_rrect, Clip clip_behavior)
   FML_DCHECK(clip_behavior != Clip::none);
 }
 
-#ifdef FLUTTER_ENABLE_DIFF_CONTEXT
-
 void ClipRRectLayer::Diff(DiffContext* context, const Layer* old_layer) {
   DiffContext::AutoSubtreeRestore subtree(context);
   auto* prev = static_cast<const ClipRRectLayer*>(old_layer);
@@ -30,8 +28,6 @@ void ClipRRectLayer::Diff(DiffContext* context, const Layer* old_layer) {
   context->SetLayerPaintRegion(this, context->CurrentSubtreeRegion());
 }
 
-#endif  // FLUTTER_ENABLE_DIFF_CONTEXT
-
 void ClipRRectLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
   TRACE_EVENT0("flutter", "ClipRRectLayer::Preroll");
 
@@ -54,6 +50,19 @@ void ClipRRectLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
   context->cull_rect = previous_cull_rect;
 }
 
+bool ClipRRectLayer::can_be_flattened() const {
+  return !UsesSaveLayer() && children_can_be_flattened();
+}
+
+void ClipRRectLayer::Flatten(DisplayListBuilder& builder,
+                             const SkMatrix& matrix) const {
+  builder.save();
+  builder.clipRRect(clip_rrect_, SkClipOp::kIntersect,
+                    clip_behavior_ != Clip::hardEdge);
+  FlattenChildren(builder, matrix);
+  builder.restore();
+}
+
 void ClipRRectLayer::Paint(PaintContext& context) const {
   TRACE_EVENT0("flutter", "ClipRRectLayer::Paint");
   FML_DCHECK(needs_painting(context));
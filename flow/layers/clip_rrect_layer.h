@@ -13,12 +13,8 @@ class ClipRRectLayer : public ContainerLayer {
  public:
   ClipRRectLayer(const SkRRect& clip_rrect, Clip clip_behavior);
 
-#ifdef FLUTTER_ENABLE_DIFF_CONTEXT
-
   void Diff(DiffContext* context, const Layer* old_layer) override;
 
-#endif  // FLUTTER_ENABLE_DIFF_CONTEXT
-
   void Preroll(PrerollContext* context, const SkMatrix& matrix) override;
 
   void Paint(PaintContext& context) const override;
@@ -27,6 +23,12 @@ class ClipRRectLayer : public ContainerLayer {
     return clip_behavior_ == Clip::antiAliasWithSaveLayer;
   }
 
+  // Clips that need a saveLayer are not flattened.
+  bool can_be_flattened() const override;
+
+  void Flatten(DisplayListBuilder& builder,
+               const SkMatrix& matrix) const override;
+
  private:
   SkRRect clip_rrect_;
   Clip clip_behavior_;
@@ -4,13 +4,138 @@
 
 #include "flutter/flow/layers/container_layer.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <optional>
+#include <thread>
+
+#include "flutter/flow/display_list_tiled_renderer.h"
+#include "flutter/fml/synchronization/count_down_latch.h"
 
 namespace flutter {
 
-ContainerLayer::ContainerLayer() {}
+namespace {
+
+// The state of a child that is merged into the context of its parent once
+// all of the children have been prerolled.
+struct ChildPrerollState {
+  bool has_platform_view = false;
+  bool has_texture_layer = false;
+  bool surface_needs_readback = false;
+  bool preroll_can_be_reused = true;
+  std::vector<std::function<void(PrerollContext*)>> raster_cache_calls;
+};
+
+// The children of a container that are prerolled concurrently. Helper
+// tasks that only get to run after all of the children have been claimed
+// may outlive the call to |PrerollChildren|, which is why this is
+// reference counted and the helpers never touch |context| unless they
+// claim a child.
+//
+// The subtrees with platform views push onto the mutators stack of
+// |context| while the helpers run, so the helpers only read the copies of
+// the mutators stack and the cull rect that were taken before they were
+// posted.
+struct ConcurrentPrerollJob {
+  ConcurrentPrerollJob(const PrerollContext* context,
+                       const SkMatrix& matrix,
+                       std::vector<Layer*> children,
+                       std::vector<ChildPrerollState*> states)
+      : context(context),
+        mutators_stack(context->mutators_stack),
+        cull_rect(context->cull_rect),
+        matrix(matrix),
+        children(std::move(children)),
+        states(std::move(states)),
+        done(this->children.size()) {}
+
+  const PrerollContext* context;
+  const MutatorsStack mutators_stack;
+  const SkRect cull_rect;
+  const SkMatrix matrix;
+  const std::vector<Layer*> children;
+  const std::vector<ChildPrerollState*> states;
+  std::atomic_size_t next_child = 0;
+  fml::CountDownLatch done;
+};
+
+// Prerolls |layer| with a copy of |parent| whose state ends up in |state|.
+// The mutators stack and the cull rect of |parent| are not read, since they
+// change while the subtrees with platform views are prerolled.
+void PrerollChild(const PrerollContext& parent,
+                  MutatorsStack& mutators_stack,
+                  const SkRect& cull_rect,
+                  Layer* layer,
+                  const SkMatrix& matrix,
+                  ChildPrerollState* state) {
+  PrerollContext context = {
+      parent.raster_cache,
+      parent.gr_context,
+      parent.view_embedder,
+      mutators_stack,
+      parent.dst_color_space,
+      cull_rect,
+      false,
+      parent.raster_time,
+      parent.ui_time,
+      parent.texture_registry,
+      parent.checkerboard_offscreen_layers,
+      parent.frame_device_pixel_ratio};
+  context.deferred_raster_cache_calls = &state->raster_cache_calls;
+
+  layer->Preroll(&context, matrix);
+
+  state->has_platform_view = context.has_platform_view;
+  state->has_texture_layer = context.has_texture_layer;
+  state->surface_needs_readback = context.surface_needs_readback;
+  state->preroll_can_be_reused = context.preroll_can_be_reused;
+}
+
+void PrerollClaimedChildren(ConcurrentPrerollJob& job) {
+  size_t index;
+  while ((index = job.next_child.fetch_add(1)) < job.children.size()) {
+    // Only the platform views read the mutators, but every child gets a
+    // copy of them for consistency.
+    MutatorsStack mutators_stack = job.mutators_stack;
+    PrerollChild(*job.context, mutators_stack, job.cull_rect,
+                 job.children[index], job.matrix, job.states[index]);
+    job.done.CountDown();
+  }
+}
 
-#ifdef FLUTTER_ENABLE_DIFF_CONTEXT
+// The fraction of |translate| in steps of 1/kSubpixelSteps pixels, which
+// hides the rounding errors of translations by whole pixels.
+constexpr SkScalar kSubpixelSteps = 1024;
+SkScalar GetSubpixelSteps(SkScalar translate) {
+  SkScalar steps =
+      std::round((translate - std::floor(translate)) * kSubpixelSteps);
+  return steps == kSubpixelSteps ? 0 : steps;
+}
+
+// The part of the total matrix that the recording of flattened children
+// depends on. Their leaves are snapped to whole device pixels, which only
+// depends on the fraction of the translation, so canvases whose matrices
+// differ by a whole number of pixels share a recording. That is the case
+// for the screen and the surfaces of the raster cache.
+SkMatrix GetFlattenedMatrixKey(const SkMatrix& matrix) {
+  if (matrix.hasPerspective()) {
+    return matrix;
+  }
+  SkMatrix key = matrix;
+#ifndef SUPPORT_FRACTIONAL_TRANSLATION
+  key.setTranslateX(GetSubpixelSteps(matrix.getTranslateX()));
+  key.setTranslateY(GetSubpixelSteps(matrix.getTranslateY()));
+#else
+  key.setTranslateX(0);
+  key.setTranslateY(0);
+#endif
+  return key;
+}
+
+}  // namespace
+
+ContainerLayer::ContainerLayer() {}
 
 void ContainerLayer::Diff(DiffContext* context, const Layer* old_layer) {
   auto old_container = static_cast<const ContainerLayer*>(old_layer);
@@ -104,10 +229,44 @@ void ContainerLayer::DiffChildren(DiffContext* context,
   }
 }
 
-#endif  // FLUTTER_ENABLE_DIFF_CONTEXT
-
 void ContainerLayer::Add(std::shared_ptr<Layer> layer) {
   layers_.emplace_back(std::move(layer));
+  can_preroll_concurrently_ = std::nullopt;
+  children_can_be_flattened_ = std::nullopt;
+  retained_preroll_ = std::nullopt;
+  flattened_matrix_ = std::nullopt;
+  flattened_children_ = nullptr;
+}
+
+bool ContainerLayer::can_preroll_concurrently() const {
+  if (!can_preroll_concurrently_.has_value()) {
+    can_preroll_concurrently_ =
+        std::all_of(layers_.begin(), layers_.end(),
+                    [](const std::shared_ptr<Layer>& layer) {
+                      return layer->can_preroll_concurrently();
+                    });
+  }
+  return can_preroll_concurrently_.value();
+}
+
+bool ContainerLayer::can_be_flattened() const {
+  return children_can_be_flattened();
+}
+
+bool ContainerLayer::children_can_be_flattened() const {
+  if (!children_can_be_flattened_.has_value()) {
+    children_can_be_flattened_ =
+        std::all_of(layers_.begin(), layers_.end(),
+                    [](const std::shared_ptr<Layer>& layer) {
+                      return layer->can_be_flattened();
+                    });
+  }
+  return children_can_be_flattened_.value();
+}
+
+void ContainerLayer::Flatten(DisplayListBuilder& builder,
+                             const SkMatrix& matrix) const {
+  FlattenChildren(builder, matrix);
 }
 
 void ContainerLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
@@ -124,12 +283,118 @@ void ContainerLayer::Paint(PaintContext& context) const {
   PaintChildren(context);
 }
 
+ContainerLayer::RetainedPreroll::RetainedPreroll(const PrerollContext& context,
+                                                 const SkMatrix& matrix)
+    : matrix(matrix),
+      cull_rect(context.cull_rect),
+      raster_cache(context.raster_cache),
+      gr_context(context.gr_context),
+      dst_color_space(sk_ref_sp(context.dst_color_space)),
+      checkerboard_offscreen_layers(context.checkerboard_offscreen_layers),
+      frame_device_pixel_ratio(context.frame_device_pixel_ratio),
+      has_texture_layer(context.has_texture_layer) {}
+
+bool ContainerLayer::RetainedPreroll::Matches(const PrerollContext& context,
+                                              const SkMatrix& matrix) const {
+  return this->matrix == matrix && cull_rect == context.cull_rect &&
+         raster_cache == context.raster_cache &&
+         gr_context == context.gr_context &&
+         SkColorSpace::Equals(dst_color_space.get(),
+                              context.dst_color_space) &&
+         checkerboard_offscreen_layers ==
+             context.checkerboard_offscreen_layers &&
+         frame_device_pixel_ratio == context.frame_device_pixel_ratio &&
+         has_texture_layer == context.has_texture_layer;
+}
+
 void ContainerLayer::PrerollChildren(PrerollContext* context,
                                      const SkMatrix& child_matrix,
                                      SkRect* child_paint_bounds) {
   // Platform views have no children, so context->has_platform_view should
   // always be false.
   FML_DCHECK(!context->has_platform_view);
+  if (!retained_preroll_ ||
+      !retained_preroll_->Matches(*context, child_matrix)) {
+    retained_preroll_.emplace(*context, child_matrix);
+    PrerollAllChildren(context, child_matrix, child_paint_bounds);
+  } else if (!retained_preroll_->has_results) {
+    // The layer was prerolled with the same context before, so it is likely
+    // to be retained in the next frames as well.
+    PrerollAndRetainChildren(context, child_matrix, child_paint_bounds);
+  } else {
+    ReuseRetainedPreroll(context, child_paint_bounds);
+  }
+}
+
+void ContainerLayer::PrerollAndRetainChildren(PrerollContext* context,
+                                              const SkMatrix& child_matrix,
+                                              SkRect* child_paint_bounds) {
+  RetainedPreroll& retained = retained_preroll_.value();
+  retained.raster_cache_calls.clear();
+
+  // Preroll the children on their own to find out what they contribute.
+  bool preroll_could_be_reused = context->preroll_can_be_reused;
+  bool surface_needed_readback = context->surface_needs_readback;
+  auto* deferred_raster_cache_calls = context->deferred_raster_cache_calls;
+  context->preroll_can_be_reused = true;
+  context->surface_needs_readback = false;
+  context->deferred_raster_cache_calls = &retained.raster_cache_calls;
+
+  SkRect bounds = SkRect::MakeEmpty();
+  PrerollAllChildren(context, child_matrix, &bounds);
+
+  bool preroll_can_be_reused = context->preroll_can_be_reused;
+  retained.child_paint_bounds = bounds;
+  retained.child_has_texture_layer = context->has_texture_layer;
+  retained.child_needs_readback = context->surface_needs_readback;
+  context->preroll_can_be_reused =
+      preroll_could_be_reused && preroll_can_be_reused;
+  context->surface_needs_readback =
+      surface_needed_readback || retained.child_needs_readback;
+  context->deferred_raster_cache_calls = deferred_raster_cache_calls;
+
+  // The calls were deferred, so they are made now with the state of the
+  // context before the children, which is what a reuse does as well.
+  bool child_has_platform_view = context->has_platform_view;
+  context->has_platform_view = false;
+  context->has_texture_layer = retained.has_texture_layer;
+  for (const auto& call : retained.raster_cache_calls) {
+    PrepareRasterCache(context, call);
+  }
+  context->has_platform_view = child_has_platform_view;
+  context->has_texture_layer = retained.child_has_texture_layer;
+  child_paint_bounds->join(bounds);
+
+  retained.has_results = preroll_can_be_reused;
+  if (!retained.has_results) {
+    retained.raster_cache_calls.clear();
+  }
+}
+
+void ContainerLayer::ReuseRetainedPreroll(PrerollContext* context,
+                                          SkRect* child_paint_bounds) {
+  TRACE_EVENT0("flutter", "ContainerLayer::ReuseRetainedPreroll");
+  const RetainedPreroll& retained = retained_preroll_.value();
+  for (const auto& call : retained.raster_cache_calls) {
+    PrepareRasterCache(context, call);
+  }
+  child_paint_bounds->join(retained.child_paint_bounds);
+  // Subtrees with platform views are never reused.
+  context->has_platform_view = false;
+  context->has_texture_layer = retained.child_has_texture_layer;
+  context->surface_needs_readback =
+      context->surface_needs_readback || retained.child_needs_readback;
+}
+
+void ContainerLayer::PrerollAllChildren(PrerollContext* context,
+                                        const SkMatrix& child_matrix,
+                                        SkRect* child_paint_bounds) {
+  if (context->concurrent_preroll_task_runner &&
+      layers_.size() >= kMinConcurrentPrerollChildren) {
+    PrerollChildrenConcurrently(context, child_matrix, child_paint_bounds);
+    return;
+  }
+
   bool child_has_platform_view = false;
   bool child_has_texture_layer = false;
   for (auto& layer : layers_) {
@@ -152,6 +417,82 @@ void ContainerLayer::PrerollChildren(PrerollContext* context,
   set_subtree_has_platform_view(child_has_platform_view);
 }
 
+void ContainerLayer::PrerollChildrenConcurrently(
+    PrerollContext* context,
+    const SkMatrix& child_matrix,
+    SkRect* child_paint_bounds) {
+  TRACE_EVENT0("flutter", "ContainerLayer::PrerollChildrenConcurrently");
+  // The children are prerolled with contexts that have no runner, so only
+  // one level of the tree is prerolled concurrently at a time.
+  FML_DCHECK(!context->has_platform_view);
+
+  std::vector<ChildPrerollState> states(layers_.size());
+  std::vector<Layer*> concurrent_children;
+  std::vector<ChildPrerollState*> concurrent_states;
+  for (size_t i = 0; i < layers_.size(); i++) {
+    if (layers_[i]->can_preroll_concurrently()) {
+      concurrent_children.push_back(layers_[i].get());
+      concurrent_states.push_back(&states[i]);
+    }
+  }
+
+  std::shared_ptr<ConcurrentPrerollJob> job;
+  if (!concurrent_children.empty()) {
+    job = std::make_shared<ConcurrentPrerollJob>(
+        context, child_matrix, std::move(concurrent_children),
+        std::move(concurrent_states));
+    // The calling thread prerolls children as well, so it only needs help
+    // from as many workers as there are remaining cores.
+    size_t cores = std::max(std::thread::hardware_concurrency(), 1u);
+    size_t helpers = std::min(job->children.size(), cores) - 1;
+    for (size_t i = 0; i < helpers; i++) {
+      context->concurrent_preroll_task_runner->PostTask(
+          [job]() { PrerollClaimedChildren(*job); });
+    }
+  }
+
+  // The subtrees with platform views are prerolled in order on the calling
+  // thread while the workers get started.
+  for (size_t i = 0; i < layers_.size(); i++) {
+    if (!layers_[i]->can_preroll_concurrently()) {
+      PrerollChild(*context, context->mutators_stack, context->cull_rect,
+                   layers_[i].get(), child_matrix, &states[i]);
+    }
+  }
+
+  if (job) {
+    PrerollClaimedChildren(*job);
+    job->done.Wait();
+  }
+
+  // Merge the children as if they had been prerolled one after the other.
+  // The deferred raster cache calls check |has_texture_layer| again, which
+  // includes the texture layers of the earlier children at this point. If
+  // the calls of this layer are deferred as well, as they are while a
+  // retained layer prerolls its children, the calls of the children are
+  // passed on in their order.
+  bool child_has_platform_view = false;
+  for (size_t i = 0; i < layers_.size(); i++) {
+    ChildPrerollState& state = states[i];
+    context->has_platform_view = false;
+    for (auto& call : state.raster_cache_calls) {
+      PrepareRasterCache(context, std::move(call));
+    }
+    child_paint_bounds->join(layers_[i]->paint_bounds());
+    child_has_platform_view =
+        child_has_platform_view || state.has_platform_view;
+    context->has_texture_layer =
+        context->has_texture_layer || state.has_texture_layer;
+    context->surface_needs_readback =
+        context->surface_needs_readback || state.surface_needs_readback;
+    context->preroll_can_be_reused =
+        context->preroll_can_be_reused && state.preroll_can_be_reused;
+  }
+
+  context->has_platform_view = child_has_platform_view;
+  set_subtree_has_platform_view(child_has_platform_view);
+}
+
 void ContainerLayer::PaintChildren(PaintContext& context) const {
   // We can no longer call FML_DCHECK here on the needs_painting(context)
   // condition as that test is only valid for the PaintContext that
@@ -161,6 +502,9 @@ void ContainerLayer::PaintChildren(PaintContext& context) const {
 
   // Intentionally not tracing here as there should be no self-time
   // and the trace event on this common function has a small overhead.
+  if (PaintFlattenedChildren(context)) {
+    return;
+  }
   for (auto& layer : layers_) {
     if (layer->needs_painting(context)) {
       layer->Paint(context);
@@ -168,13 +512,63 @@ void ContainerLayer::PaintChildren(PaintContext& context) const {
   }
 }
 
+void ContainerLayer::FlattenChildren(DisplayListBuilder& builder,
+                                     const SkMatrix& matrix) const {
+  for (auto& layer : layers_) {
+    if (!layer->paint_bounds().isEmpty()) {
+      layer->Flatten(builder, matrix);
+    }
+  }
+}
+
+bool ContainerLayer::PaintFlattenedChildren(PaintContext& context) const {
+  if (context.inherited_opacity < SK_Scalar1 || !children_can_be_flattened()) {
+    return false;
+  }
+  SkCanvas* canvas = context.leaf_nodes_canvas;
+  const SkMatrix& matrix = canvas->getTotalMatrix();
+  const SkMatrix matrix_key = GetFlattenedMatrixKey(matrix);
+  if (flattened_matrix_ != matrix_key) {
+    // Layers that are only painted once, or whose matrix changes in every
+    // frame, are not worth recording.
+    flattened_matrix_ = matrix_key;
+    flattened_children_ = nullptr;
+    return false;
+  }
+  if (!flattened_children_) {
+    TRACE_EVENT0("flutter", "ContainerLayer::FlattenChildren");
+    SkRect child_paint_bounds = SkRect::MakeEmpty();
+    for (auto& layer : layers_) {
+      child_paint_bounds.join(layer->paint_bounds());
+    }
+    DisplayListBuilder builder(child_paint_bounds, true);
+    FlattenChildren(builder, matrix);
+    flattened_children_ = builder.Build();
+  }
+
+  if (context.tiled_raster_task_runner &&
+      DisplayListTiledRenderer::Render(flattened_children_, canvas,
+                                       *context.tiled_raster_task_runner)) {
+    return true;
+  }
+  flattened_children_->RenderTo(canvas, canvas->getLocalClipBounds());
+  return true;
+}
+
 void ContainerLayer::TryToPrepareRasterCache(PrerollContext* context,
                                              Layer* layer,
                                              const SkMatrix& matrix) {
   if (!context->has_platform_view && !context->has_texture_layer &&
       context->raster_cache &&
       SkRect::Intersects(context->cull_rect, layer->paint_bounds())) {
-    context->raster_cache->Prepare(context, layer, matrix);
+    PrepareRasterCache(
+        context, [layer, matrix](PrerollContext* cache_context) {
+          // The texture layers of the earlier siblings of a concurrently
+          // prerolled subtree are only known once the call is made.
+          if (!cache_context->has_texture_layer) {
+            cache_context->raster_cache->Prepare(cache_context, layer, matrix);
+          }
+        });
   }
 }
 
@@ -191,7 +585,6 @@ MergedContainerLayer::MergedContainerLayer() {
   ContainerLayer::Add(std::make_shared<ContainerLayer>());
 }
 
-#ifdef FLUTTER_ENABLE_DIFF_CONTEXT
 void MergedContainerLayer::DiffChildren(DiffContext* context,
                                         const ContainerLayer* old_layer) {
   if (context->IsSubtreeDirty()) {
@@ -207,7 +600,6 @@ void MergedContainerLayer::DiffChildren(DiffContext* context,
   auto layer = static_cast<const MergedContainerLayer*>(old_layer);
   GetChildContainer()->DiffChildren(context, layer->GetChildContainer());
 }
-#endif
 
 void MergedContainerLayer::Add(std::shared_ptr<Layer> layer) {
   GetChildContainer()->Add(std::move(layer));
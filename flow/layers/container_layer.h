@@ -5,6 +5,8 @@
 #ifndef FLUTTER_FLOW_LAYERS_CONTAINER_LAYER_H_
 #define FLUTTER_FLOW_LAYERS_CONTAINER_LAYER_H_
 
+#include <functional>
+#include <optional>
 #include <vector>
 
 #include "flutter/flow/layers/layer.h"
@@ -13,15 +15,15 @@ namespace flutter {
 
 class ContainerLayer : public Layer {
  public:
-  ContainerLayer();
+  // Containers with fewer children than this always preroll them on the
+  // calling thread.
+  static constexpr size_t kMinConcurrentPrerollChildren = 16;
 
-#ifdef FLUTTER_ENABLE_DIFF_CONTEXT
+  ContainerLayer();
 
   void Diff(DiffContext* context, const Layer* old_layer) override;
   void PreservePaintRegion(DiffContext* context) override;
 
-#endif  // FLUTTER_ENABLE_DIFF_CONTEXT
-
   virtual void Add(std::shared_ptr<Layer> layer);
 
   void Preroll(PrerollContext* context, const SkMatrix& matrix) override;
@@ -29,19 +31,66 @@ class ContainerLayer : public Layer {
 
   const std::vector<std::shared_ptr<Layer>>& layers() const { return layers_; }
 
-#ifdef FLUTTER_ENABLE_DIFF_CONTEXT
+  // Computed once from the children, which must not change after the
+  // layer has been prerolled.
+  bool can_preroll_concurrently() const override;
+
+  // Computed once from the children, like |can_preroll_concurrently|.
+  bool can_be_flattened() const override;
+
+  void Flatten(DisplayListBuilder& builder,
+               const SkMatrix& matrix) const override;
+
+  // The recording of the children that |PaintChildren| renders instead of
+  // painting them, if any.
+  const DisplayList* flattened_children() const {
+    return flattened_children_.get();
+  }
 
   virtual void DiffChildren(DiffContext* context,
                             const ContainerLayer* old_layer);
 
-#endif  // FLUTTER_ENABLE_DIFF_CONTEXT
-
  protected:
+  // Prerolls the children and joins their paint bounds.
+  //
+  // A retained layer, one that is part of consecutive frames, keeps the
+  // results of the Preroll of its children once they have been prerolled
+  // twice in a row with the same matrix and context. As long as it is
+  // prerolled with that matrix and context again, the children are not
+  // prerolled and the raster cache calls that they made are repeated
+  // instead. Layers that clear |PrerollContext::preroll_can_be_reused|
+  // prevent this for the containers above them.
+  //
+  // If the context has a |PrerollContext::concurrent_preroll_task_runner|
+  // and there are at least |kMinConcurrentPrerollChildren| children, the
+  // children that |can_preroll_concurrently| are prerolled on the calling
+  // thread and the workers of the runner while the others are prerolled
+  // in order on the calling thread. Every child gets a copy of the context
+  // whose state is merged into |context| afterwards in the order of the
+  // children, so the result is the same as prerolling them one by one.
   void PrerollChildren(PrerollContext* context,
                        const SkMatrix& child_matrix,
                        SkRect* child_paint_bounds);
+
+  // Paints the children that need painting.
+  //
+  // If all of the children |can_be_flattened| and the layer is painted
+  // without an inherited opacity on a canvas with the same total matrix
+  // as the last time, up to a translation by whole pixels, the children
+  // are instead recorded into one DisplayList that is kept and rendered as
+  // long as the matrix stays the same. This saves the traversal of the
+  // children and the per layer state changes for retained subtrees of
+  // transforms, clips and simple display lists.
   void PaintChildren(PaintContext& context) const;
 
+  // Whether all of the children |can_be_flattened|, which is computed once.
+  bool children_can_be_flattened() const;
+
+  // Records the children that need painting into |builder|, whose total
+  // matrix is |matrix|.
+  void FlattenChildren(DisplayListBuilder& builder,
+                       const SkMatrix& matrix) const;
+
   // Try to prepare the raster cache for a given layer.
   //
   // The raster cache would fail if either of the followings is true:
@@ -57,7 +106,53 @@ class ContainerLayer : public Layer {
                                       const SkMatrix& matrix);
 
  private:
+  // The matrix and the parts of the context that the children were last
+  // prerolled with, and the results of the Preroll that are not kept by
+  // the children themselves once they are known to be reusable.
+  struct RetainedPreroll {
+    RetainedPreroll(const PrerollContext& context, const SkMatrix& matrix);
+
+    bool Matches(const PrerollContext& context, const SkMatrix& matrix) const;
+
+    SkMatrix matrix;
+    SkRect cull_rect;
+    RasterCache* raster_cache;
+    GrDirectContext* gr_context;
+    sk_sp<SkColorSpace> dst_color_space;
+    bool checkerboard_offscreen_layers;
+    float frame_device_pixel_ratio;
+    bool has_texture_layer;
+
+    bool has_results = false;
+    SkRect child_paint_bounds = SkRect::MakeEmpty();
+    bool child_has_texture_layer = false;
+    bool child_needs_readback = false;
+    std::vector<std::function<void(PrerollContext*)>> raster_cache_calls;
+  };
+
   std::vector<std::shared_ptr<Layer>> layers_;
+  mutable std::optional<bool> can_preroll_concurrently_;
+  mutable std::optional<bool> children_can_be_flattened_;
+  // The total matrix of the canvas that the children were last painted on,
+  // without the whole pixels of its translation, and, once they have been
+  // painted with it twice in a row, the children recorded for it. Only used
+  // on the raster thread.
+  mutable std::optional<SkMatrix> flattened_matrix_;
+  mutable sk_sp<DisplayList> flattened_children_;
+  std::optional<RetainedPreroll> retained_preroll_;
+
+  void PrerollAllChildren(PrerollContext* context,
+                          const SkMatrix& child_matrix,
+                          SkRect* child_paint_bounds);
+  void PrerollAndRetainChildren(PrerollContext* context,
+                                const SkMatrix& child_matrix,
+                                SkRect* child_paint_bounds);
+  void ReuseRetainedPreroll(PrerollContext* context,
+                            SkRect* child_paint_bounds);
+  void PrerollChildrenConcurrently(PrerollContext* context,
+                                   const SkMatrix& child_matrix,
+                                   SkRect* child_paint_bounds);
+  bool PaintFlattenedChildren(PaintContext& context) const;
 
   FML_DISALLOW_COPY_AND_ASSIGN(ContainerLayer);
 };
@@ -109,10 +204,11 @@ class MergedContainerLayer : public ContainerLayer {
 
   void Add(std::shared_ptr<Layer> layer) override;
 
-#ifdef FLUTTER_ENABLE_DIFF_CONTEXT
+  // The effects of the subclasses are not recorded by |Flatten|.
+  bool can_be_flattened() const override { return false; }
+
   void DiffChildren(DiffContext* context,
                     const ContainerLayer* old_layer) override;
-#endif
 
  protected:
   /**
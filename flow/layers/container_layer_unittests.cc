@@ -4,17 +4,83 @@
 
 #include "flutter/flow/layers/container_layer.h"
 
+#include "flutter/flow/layers/clip_rect_layer.h"
+#include "flutter/flow/layers/display_list_layer.h"
+#include "flutter/flow/layers/opacity_layer.h"
+#include "flutter/flow/layers/texture_layer.h"
+#include "flutter/flow/layers/transform_layer.h"
 #include "flutter/flow/testing/diff_context_test.h"
 #include "flutter/flow/testing/layer_test.h"
 #include "flutter/flow/testing/mock_layer.h"
+#include "flutter/flow/testing/skia_gpu_object_layer_test.h"
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/macros.h"
 #include "flutter/testing/mock_canvas.h"
+#include "third_party/skia/include/core/SkSurface.h"
+#include "third_party/skia/include/effects/SkImageFilters.h"
 
 namespace flutter {
 namespace testing {
 
 using ContainerLayerTest = LayerTest;
 
+namespace {
+
+// A leaf layer that counts how often it is prerolled.
+class PrerollCountingLayer : public Layer {
+ public:
+  explicit PrerollCountingLayer(const SkRect& bounds) : bounds_(bounds) {}
+
+  void Preroll(PrerollContext* context, const SkMatrix& matrix) override {
+    preroll_count_++;
+    set_paint_bounds(bounds_);
+  }
+
+  void Paint(PaintContext& context) const override {}
+
+  int preroll_count() const { return preroll_count_; }
+
+ private:
+  SkRect bounds_;
+  int preroll_count_ = 0;
+};
+
+// A leaf layer that logs its raster cache calls and counts how often it is
+// prerolled concurrently with its siblings.
+class RasterCacheCallLoggingLayer : public Layer {
+ public:
+  RasterCacheCallLoggingLayer(size_t id, std::vector<size_t>* log)
+      : id_(id), log_(log) {}
+
+  void Preroll(PrerollContext* context, const SkMatrix& matrix) override {
+    preroll_count_++;
+    // The children that are prerolled concurrently get a context without
+    // a runner.
+    if (!context->concurrent_preroll_task_runner) {
+      concurrent_preroll_count_++;
+    }
+    size_t id = id_;
+    std::vector<size_t>* log = log_;
+    PrepareRasterCache(
+        context, [id, log](PrerollContext*) { log->push_back(id); });
+    set_paint_bounds(SkRect::MakeWH(1.0f, 1.0f));
+  }
+
+  void Paint(PaintContext& context) const override {}
+
+  int preroll_count() const { return preroll_count_; }
+
+  int concurrent_preroll_count() const { return concurrent_preroll_count_; }
+
+ private:
+  size_t id_;
+  std::vector<size_t>* log_;
+  int preroll_count_ = 0;
+  int concurrent_preroll_count_ = 0;
+};
+
+}  // namespace
+
 #ifndef NDEBUG
 TEST_F(ContainerLayerTest, LayerWithParentHasPlatformView) {
   auto layer = std::make_shared<ContainerLayer>();
@@ -251,7 +317,516 @@ TEST_F(ContainerLayerTest, MergedMultipleChildren) {
                                                child_path2, child_paint2}}}));
 }
 
-#ifdef FLUTTER_ENABLE_DIFF_CONTEXT
+TEST_F(ContainerLayerTest, ConcurrentPrerollMatchesSequentialPreroll) {
+  const size_t child_count = ContainerLayer::kMinConcurrentPrerollChildren + 4;
+  const size_t platform_view_index = 5;
+  const size_t readback_index = 12;
+  SkMatrix initial_transform = SkMatrix::Translate(-0.5f, -0.5f);
+
+  std::vector<std::shared_ptr<MockLayer>> mock_layers;
+  auto layer = std::make_shared<ContainerLayer>();
+  SkRect expected_total_bounds = SkRect::MakeEmpty();
+  for (size_t i = 0; i < child_count; i++) {
+    SkPath child_path;
+    child_path.addRect(SkRect::MakeXYWH(i * 10.0f, i * 5.0f, 8.0f, 4.0f));
+    mock_layers.push_back(std::make_shared<MockLayer>(
+        child_path, SkPaint(), i == platform_view_index, i == readback_index));
+    layer->Add(mock_layers.back());
+    expected_total_bounds.join(child_path.getBounds());
+  }
+  EXPECT_FALSE(layer->can_preroll_concurrently());
+  EXPECT_TRUE(mock_layers[0]->can_preroll_concurrently());
+
+  auto loop = fml::ConcurrentMessageLoop::Create(4);
+  auto runner = loop->GetTaskRunner();
+  preroll_context()->concurrent_preroll_task_runner = runner.get();
+  preroll_context()->mutators_stack.PushOpacity(128);
+  layer->Preroll(preroll_context(), initial_transform);
+
+  EXPECT_TRUE(preroll_context()->has_platform_view);
+  EXPECT_TRUE(preroll_context()->surface_needs_readback);
+  EXPECT_TRUE(layer->subtree_has_platform_view());
+  EXPECT_EQ(layer->paint_bounds(), expected_total_bounds);
+  for (size_t i = 0; i < child_count; i++) {
+    EXPECT_EQ(mock_layers[i]->parent_matrix(), initial_transform);
+    EXPECT_EQ(mock_layers[i]->parent_cull_rect(), kGiantRect);
+    EXPECT_EQ(mock_layers[i]->parent_mutators(),
+              preroll_context()->mutators_stack);
+    // Siblings are independent
+    EXPECT_FALSE(mock_layers[i]->parent_has_platform_view());
+  }
+}
+
+TEST_F(ContainerLayerTest, ConcurrentPrerollIgnoresMutatorsOfPlatformViews) {
+  const size_t child_count = ContainerLayer::kMinConcurrentPrerollChildren + 4;
+  const size_t platform_view_index = 3;
+  const SkPath child_path = SkPath().addRect(SkRect::MakeWH(5.0f, 5.0f));
+
+  // The platform view is prerolled on the calling thread under a transform
+  // and a clip, which push onto the mutators stack and narrow the cull rect
+  // while its siblings are prerolled on the workers.
+  std::vector<std::shared_ptr<MockLayer>> mock_layers;
+  auto layer = std::make_shared<ContainerLayer>();
+  for (size_t i = 0; i < child_count; i++) {
+    mock_layers.push_back(std::make_shared<MockLayer>(
+        child_path, SkPaint(), i == platform_view_index));
+    if (i == platform_view_index) {
+      auto transform_layer =
+          std::make_shared<TransformLayer>(SkMatrix::Translate(1.0f, 1.0f));
+      auto clip_layer = std::make_shared<ClipRectLayer>(
+          SkRect::MakeWH(2.0f, 2.0f), Clip::hardEdge);
+      clip_layer->Add(mock_layers.back());
+      transform_layer->Add(clip_layer);
+      layer->Add(transform_layer);
+    } else {
+      layer->Add(mock_layers.back());
+    }
+  }
+
+  auto loop = fml::ConcurrentMessageLoop::Create(4);
+  auto runner = loop->GetTaskRunner();
+  preroll_context()->concurrent_preroll_task_runner = runner.get();
+  preroll_context()->mutators_stack.PushOpacity(128);
+  MutatorsStack expected_mutators = preroll_context()->mutators_stack;
+  layer->Preroll(preroll_context(), SkMatrix::I());
+
+  EXPECT_TRUE(preroll_context()->has_platform_view);
+  EXPECT_EQ(preroll_context()->mutators_stack, expected_mutators);
+  EXPECT_EQ(preroll_context()->cull_rect, kGiantRect);
+  for (size_t i = 0; i < child_count; i++) {
+    if (i == platform_view_index) {
+      EXPECT_NE(mock_layers[i]->parent_mutators(), expected_mutators);
+      continue;
+    }
+    EXPECT_EQ(mock_layers[i]->parent_cull_rect(), kGiantRect);
+    EXPECT_EQ(mock_layers[i]->parent_mutators(), expected_mutators);
+  }
+}
+
+TEST_F(ContainerLayerTest, ConcurrentPrerollPreparesRasterCacheInOrder) {
+  const size_t child_count = ContainerLayer::kMinConcurrentPrerollChildren + 4;
+  const size_t texture_index = 10;
+  const SkPath child_path = SkPath().addRect(SkRect::MakeWH(5.0f, 5.0f));
+
+  std::vector<std::shared_ptr<MockLayer>> mock_layers;
+  auto layer = std::make_shared<ContainerLayer>();
+  for (size_t i = 0; i < child_count; i++) {
+    if (i == texture_index) {
+      layer->Add(std::make_shared<TextureLayer>(
+          SkPoint::Make(0.0f, 0.0f), SkSize::Make(10.0f, 10.0f), 0, false,
+          SkSamplingOptions()));
+      continue;
+    }
+    auto opacity_layer =
+        std::make_shared<OpacityLayer>(128, SkPoint::Make(0.0f, 0.0f));
+    mock_layers.push_back(std::make_shared<MockLayer>(child_path));
+    opacity_layer->Add(mock_layers.back());
+    layer->Add(opacity_layer);
+  }
+
+  use_mock_raster_cache();
+  auto loop = fml::ConcurrentMessageLoop::Create(4);
+  auto runner = loop->GetTaskRunner();
+  preroll_context()->concurrent_preroll_task_runner = runner.get();
+  layer->Preroll(preroll_context(), SkMatrix::I());
+
+  // Like a sequential preroll, only the children before the texture layer
+  // are cached.
+  EXPECT_TRUE(preroll_context()->has_texture_layer);
+  EXPECT_EQ(raster_cache()->GetLayerCachedEntriesCount(), texture_index);
+  SkCanvas cache_canvas;
+  for (size_t i = 0; i < mock_layers.size(); i++) {
+    EXPECT_EQ(raster_cache()->Draw(mock_layers[i].get(), cache_canvas),
+              i < texture_index);
+  }
+}
+
+TEST_F(ContainerLayerTest, RetainedLayerPrerollsChildrenConcurrently) {
+  const size_t child_count = ContainerLayer::kMinConcurrentPrerollChildren + 4;
+  std::vector<size_t> log;
+  std::vector<size_t> expected_log;
+  std::vector<std::shared_ptr<RasterCacheCallLoggingLayer>> children;
+  auto layer = std::make_shared<ContainerLayer>();
+  for (size_t i = 0; i < child_count; i++) {
+    children.push_back(std::make_shared<RasterCacheCallLoggingLayer>(i, &log));
+    layer->Add(children.back());
+    expected_log.push_back(i);
+  }
+
+  auto loop = fml::ConcurrentMessageLoop::Create(4);
+  auto runner = loop->GetTaskRunner();
+  preroll_context()->concurrent_preroll_task_runner = runner.get();
+  // The children are prerolled concurrently in the first frame and again
+  // while the layer retains their results in the second one. The third
+  // frame repeats their raster cache calls. The calls are made in the order
+  // of the children every time.
+  for (int frame = 0; frame < 3; frame++) {
+    log.clear();
+    layer->Preroll(preroll_context(), SkMatrix::I());
+    EXPECT_EQ(log, expected_log);
+    EXPECT_TRUE(preroll_context()->preroll_can_be_reused);
+    EXPECT_EQ(layer->paint_bounds(), SkRect::MakeWH(1.0f, 1.0f));
+  }
+  for (const auto& child : children) {
+    EXPECT_EQ(child->preroll_count(), 2);
+    EXPECT_EQ(child->concurrent_preroll_count(), 2);
+  }
+}
+
+TEST_F(ContainerLayerTest, RetainedLayerReusesPrerollOfChildren) {
+  auto child1 = std::make_shared<PrerollCountingLayer>(
+      SkRect::MakeXYWH(5.0f, 6.0f, 20.0f, 20.0f));
+  auto child2 = std::make_shared<PrerollCountingLayer>(
+      SkRect::MakeXYWH(30.0f, 6.0f, 10.0f, 20.0f));
+  auto layer = std::make_shared<ContainerLayer>();
+  layer->Add(child1);
+  layer->Add(child2);
+
+  // The results are kept once the layer has been prerolled with the same
+  // context twice.
+  for (int i = 0; i < 4; i++) {
+    layer->Preroll(preroll_context(), SkMatrix::I());
+    EXPECT_EQ(layer->paint_bounds(),
+              SkRect::MakeLTRB(5.0f, 6.0f, 40.0f, 26.0f));
+    EXPECT_FALSE(preroll_context()->has_platform_view);
+    EXPECT_TRUE(preroll_context()->preroll_can_be_reused);
+  }
+  EXPECT_EQ(child1->preroll_count(), 2);
+  EXPECT_EQ(child2->preroll_count(), 2);
+
+  // A different matrix or cull rect prerolls the children again.
+  layer->Preroll(preroll_context(), SkMatrix::Translate(5.0f, 0.0f));
+  EXPECT_EQ(child1->preroll_count(), 3);
+  preroll_context()->cull_rect = SkRect::MakeWH(100.0f, 100.0f);
+  layer->Preroll(preroll_context(), SkMatrix::Translate(5.0f, 0.0f));
+  EXPECT_EQ(child1->preroll_count(), 4);
+
+  // Adding a child forgets the results.
+  layer->Preroll(preroll_context(), SkMatrix::Translate(5.0f, 0.0f));
+  layer->Preroll(preroll_context(), SkMatrix::Translate(5.0f, 0.0f));
+  EXPECT_EQ(child1->preroll_count(), 5);
+  layer->Add(std::make_shared<PrerollCountingLayer>(
+      SkRect::MakeXYWH(0.0f, 0.0f, 1.0f, 1.0f)));
+  layer->Preroll(preroll_context(), SkMatrix::Translate(5.0f, 0.0f));
+  EXPECT_EQ(child1->preroll_count(), 6);
+  EXPECT_EQ(layer->paint_bounds(), SkRect::MakeLTRB(0.0f, 0.0f, 40.0f, 26.0f));
+}
+
+TEST_F(ContainerLayerTest, RetainedLayerReusesReadbackAndTextures) {
+  auto layer = std::make_shared<ContainerLayer>();
+  layer->Add(std::make_shared<PrerollCountingLayer>(SkRect::MakeWH(5, 5)));
+  layer->Add(std::make_shared<TextureLayer>(
+      SkPoint::Make(0.0f, 0.0f), SkSize::Make(10.0f, 10.0f), 0, false,
+      SkSamplingOptions()));
+
+  for (int i = 0; i < 3; i++) {
+    preroll_context()->has_texture_layer = false;
+    preroll_context()->surface_needs_readback = false;
+    layer->Preroll(preroll_context(), SkMatrix::I());
+    EXPECT_TRUE(preroll_context()->has_texture_layer);
+    EXPECT_FALSE(preroll_context()->surface_needs_readback);
+  }
+  preroll_context()->has_texture_layer = false;
+  preroll_context()->surface_needs_readback = true;
+  layer->Preroll(preroll_context(), SkMatrix::I());
+  EXPECT_TRUE(preroll_context()->has_texture_layer);
+  EXPECT_TRUE(preroll_context()->surface_needs_readback);
+}
+
+TEST_F(ContainerLayerTest, LayersThatObserveThePrerollPreventReuse) {
+  auto counting_layer =
+      std::make_shared<PrerollCountingLayer>(SkRect::MakeWH(5, 5));
+  auto layer = std::make_shared<ContainerLayer>();
+  layer->Add(counting_layer);
+  layer->Add(std::make_shared<MockLayer>(
+      SkPath().addRect(SkRect::MakeWH(5.0f, 5.0f))));
+
+  for (int i = 0; i < 3; i++) {
+    layer->Preroll(preroll_context(), SkMatrix::I());
+    EXPECT_FALSE(preroll_context()->preroll_can_be_reused);
+    preroll_context()->preroll_can_be_reused = true;
+  }
+  EXPECT_EQ(counting_layer->preroll_count(), 3);
+}
+
+TEST_F(ContainerLayerTest, RetainedLayerReusesPrerollOfMockLayers) {
+  const SkPath child_path = SkPath().addRect(SkRect::MakeWH(5.0f, 5.0f));
+  auto reused_child = std::make_shared<MockLayer>(child_path);
+  reused_child->set_fake_preroll_can_be_reused(true);
+  auto reused_layer = std::make_shared<ContainerLayer>();
+  reused_layer->Add(reused_child);
+  auto prerolled_child = std::make_shared<MockLayer>(child_path);
+  auto prerolled_layer = std::make_shared<ContainerLayer>();
+  prerolled_layer->Add(prerolled_child);
+
+  // The results are kept once the layers have been prerolled with the same
+  // context twice.
+  for (int i = 0; i < 2; i++) {
+    reused_layer->Preroll(preroll_context(), SkMatrix::I());
+    prerolled_layer->Preroll(preroll_context(), SkMatrix::I());
+  }
+  const MutatorsStack initial_mutators = preroll_context()->mutators_stack;
+
+  // The mutators are not part of the context that the retained layers
+  // match, so only the child that is prerolled again sees the new ones.
+  for (int i = 0; i < 2; i++) {
+    preroll_context()->mutators_stack.PushOpacity(128);
+
+    preroll_context()->preroll_can_be_reused = true;
+    reused_layer->Preroll(preroll_context(), SkMatrix::I());
+    EXPECT_TRUE(preroll_context()->preroll_can_be_reused);
+    EXPECT_EQ(reused_layer->paint_bounds(), child_path.getBounds());
+    EXPECT_EQ(reused_child->parent_mutators(), initial_mutators);
+
+    prerolled_layer->Preroll(preroll_context(), SkMatrix::I());
+    EXPECT_FALSE(preroll_context()->preroll_can_be_reused);
+    EXPECT_EQ(prerolled_layer->paint_bounds(), child_path.getBounds());
+    EXPECT_EQ(prerolled_child->parent_mutators(),
+              preroll_context()->mutators_stack);
+  }
+}
+
+TEST_F(ContainerLayerTest, RetainedLayerRepeatsRasterCacheCalls) {
+  auto child = std::make_shared<PrerollCountingLayer>(SkRect::MakeWH(5, 5));
+  auto opacity_layer =
+      std::make_shared<OpacityLayer>(128, SkPoint::Make(0.0f, 0.0f));
+  opacity_layer->Add(child);
+  auto layer = std::make_shared<ContainerLayer>();
+  layer->Add(opacity_layer);
+
+  use_mock_raster_cache();
+  SkCanvas cache_canvas;
+  // The cache evicts the entries that were not used in the last frames, so
+  // they are only kept if the calls are made while the preroll is reused.
+  for (int i = 0; i < 10; i++) {
+    layer->Preroll(preroll_context(), SkMatrix::I());
+    EXPECT_TRUE(raster_cache()->Draw(child.get(), cache_canvas));
+    raster_cache()->SweepAfterFrame();
+  }
+  EXPECT_EQ(child->preroll_count(), 2);
+  EXPECT_EQ(raster_cache()->GetLayerCachedEntriesCount(), 1u);
+}
+
+using ContainerLayerFlattenTest = SkiaGPUObjectLayerTest;
+
+static std::shared_ptr<DisplayListLayer> MakeRectLayer(
+    fml::RefPtr<SkiaUnrefQueue> unref_queue,
+    const SkPoint& offset,
+    const SkRect& rect,
+    SkColor color,
+    bool is_complex = false) {
+  DisplayListBuilder builder;
+  builder.setColor(color);
+  builder.drawRect(rect);
+  return std::make_shared<DisplayListLayer>(
+      offset, SkiaGPUObject(builder.Build(), unref_queue), is_complex, false);
+}
+
+TEST_F(ContainerLayerFlattenTest, OnlySimpleSubtreesCanBeFlattened) {
+  const SkRect rect = SkRect::MakeWH(10, 10);
+  auto clip = std::make_shared<ClipRectLayer>(rect, Clip::hardEdge);
+  clip->Add(MakeRectLayer(unref_queue(), SkPoint::Make(0, 0), rect,
+                          SK_ColorRED));
+  auto transform = std::make_shared<TransformLayer>(SkMatrix::Scale(2, 2));
+  transform->Add(clip);
+  EXPECT_TRUE(transform->can_be_flattened());
+
+  auto save_layer_clip =
+      std::make_shared<ClipRectLayer>(rect, Clip::antiAliasWithSaveLayer);
+  save_layer_clip->Add(
+      MakeRectLayer(unref_queue(), SkPoint::Make(0, 0), rect, SK_ColorRED));
+  EXPECT_FALSE(save_layer_clip->can_be_flattened());
+
+  // The raster cache may cache complex display lists.
+  auto container = std::make_shared<ContainerLayer>();
+  container->Add(
+      MakeRectLayer(unref_queue(), SkPoint::Make(0, 0), rect, SK_ColorRED));
+  container->Add(MakeRectLayer(unref_queue(), SkPoint::Make(0, 0), rect,
+                               SK_ColorRED, true));
+  EXPECT_FALSE(container->can_be_flattened());
+
+  auto opacity = std::make_shared<OpacityLayer>(128, SkPoint::Make(0, 0));
+  opacity->Add(
+      MakeRectLayer(unref_queue(), SkPoint::Make(0, 0), rect, SK_ColorRED));
+  EXPECT_FALSE(opacity->can_be_flattened());
+
+  auto mock_container = std::make_shared<ContainerLayer>();
+  mock_container->Add(std::make_shared<MockLayer>(SkPath().addRect(rect)));
+  EXPECT_FALSE(mock_container->can_be_flattened());
+}
+
+TEST_F(ContainerLayerFlattenTest, FlattenedChildrenPaintLikeTheLayers) {
+  auto clip = std::make_shared<ClipRectLayer>(SkRect::MakeWH(40, 40),
+                                              Clip::hardEdge);
+  clip->Add(MakeRectLayer(unref_queue(), SkPoint::Make(0.3f, 0.6f),
+                          SkRect::MakeWH(10, 10), SK_ColorRED));
+  clip->Add(MakeRectLayer(unref_queue(), SkPoint::Make(20.5f, 0.2f),
+                          SkRect::MakeWH(30, 10), SK_ColorBLUE));
+  auto layer =
+      std::make_shared<TransformLayer>(SkMatrix::Translate(0.4f, 0.3f));
+  layer->Add(clip);
+  layer->Preroll(preroll_context(), SkMatrix::I());
+
+  sk_sp<SkSurface> surface = SkSurface::MakeRasterN32Premul(50, 50);
+  paint_context().internal_nodes_canvas = surface->getCanvas();
+  paint_context().leaf_nodes_canvas = surface->getCanvas();
+  // The children are painted, then recorded and then replayed from the
+  // recording, which all draw the same pixels.
+  SkBitmap first_frame;
+  for (int i = 0; i < 3; i++) {
+    surface->getCanvas()->clear(SK_ColorTRANSPARENT);
+    layer->Paint(paint_context());
+
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(50, 50);
+    surface->readPixels(bitmap, 0, 0);
+    if (i == 0) {
+      first_frame = bitmap;
+      // The offsets of the display lists are snapped to whole pixels.
+      EXPECT_EQ(bitmap.getColor(1, 1), SK_ColorRED);
+      EXPECT_EQ(bitmap.getColor(10, 10), SK_ColorRED);
+      EXPECT_EQ(bitmap.getColor(11, 11), SK_ColorTRANSPARENT);
+      EXPECT_EQ(bitmap.getColor(21, 1), SK_ColorBLUE);
+      EXPECT_EQ(bitmap.getColor(40, 1), SK_ColorTRANSPARENT);
+      continue;
+    }
+    EXPECT_EQ(memcmp(bitmap.getPixels(), first_frame.getPixels(),
+                     bitmap.computeByteSize()),
+              0);
+  }
+}
+
+TEST_F(ContainerLayerFlattenTest, FlattenedChildrenPaintLikeRotatedLayers) {
+  // The leaves are only snapped to whole pixels where the rotations of the
+  // transforms cancel out, and then along the axes of the rotated canvas.
+  const SkMatrix parents[] = {
+      SkMatrix::Translate(25.4f, 5.3f) * SkMatrix::RotateDeg(90),
+      SkMatrix::Translate(25.4f, 5.3f) * SkMatrix::RotateDeg(30),
+  };
+  for (const SkMatrix& parent : parents) {
+    auto inner = std::make_shared<TransformLayer>(
+        SkMatrix::RotateDeg(-90) * SkMatrix::Scale(1.5f, 0.5f));
+    inner->Add(MakeRectLayer(unref_queue(), SkPoint::Make(0.3f, 0.6f),
+                             SkRect::MakeWH(10, 10), SK_ColorRED));
+    auto layer = std::make_shared<TransformLayer>(parent);
+    layer->Add(MakeRectLayer(unref_queue(), SkPoint::Make(2.5f, 0.2f),
+                             SkRect::MakeWH(15, 10), SK_ColorBLUE));
+    layer->Add(inner);
+    layer->Preroll(preroll_context(), SkMatrix::I());
+
+    sk_sp<SkSurface> surface = SkSurface::MakeRasterN32Premul(50, 50);
+    paint_context().internal_nodes_canvas = surface->getCanvas();
+    paint_context().leaf_nodes_canvas = surface->getCanvas();
+    // The first frame paints the layers one by one and the third one
+    // replays the recording of the second one.
+    SkBitmap frames[3];
+    for (SkBitmap& bitmap : frames) {
+      surface->getCanvas()->clear(SK_ColorTRANSPARENT);
+      layer->Paint(paint_context());
+      bitmap.allocN32Pixels(50, 50);
+      surface->readPixels(bitmap, 0, 0);
+    }
+    const SkPoint blue = parent.mapXY(10, 5);
+    EXPECT_EQ(frames[0].getColor(blue.x(), blue.y()), SK_ColorBLUE);
+    for (const SkBitmap& bitmap : frames) {
+      EXPECT_EQ(memcmp(bitmap.getPixels(), frames[0].getPixels(),
+                       bitmap.computeByteSize()),
+                0);
+    }
+  }
+}
+
+TEST_F(ContainerLayerFlattenTest, FlattenedChildrenAreSharedByPixelOffsets) {
+  auto layer =
+      std::make_shared<TransformLayer>(SkMatrix::Translate(0.4f, 0.3f));
+  layer->Add(MakeRectLayer(unref_queue(), SkPoint::Make(0.3f, 0.6f),
+                           SkRect::MakeWH(10, 10), SK_ColorRED));
+  layer->Add(MakeRectLayer(unref_queue(), SkPoint::Make(20.5f, 0.2f),
+                           SkRect::MakeWH(10, 10), SK_ColorBLUE));
+  layer->Preroll(preroll_context(), SkMatrix::I());
+
+  // Like the screen and the surface that the raster cache paints the
+  // layer into, the canvases are a whole number of pixels apart.
+  sk_sp<SkSurface> screen = SkSurface::MakeRasterN32Premul(50, 50);
+  sk_sp<SkSurface> cache = SkSurface::MakeRasterN32Premul(50, 50);
+  screen->getCanvas()->translate(5, 3);
+  cache->getCanvas()->translate(7, 10);
+  const DisplayList* recording = nullptr;
+  for (int i = 0; i < 3; i++) {
+    SkBitmap bitmaps[2];
+    for (int j = 0; j < 2; j++) {
+      SkCanvas* canvas = (j == 0 ? screen : cache)->getCanvas();
+      paint_context().internal_nodes_canvas = canvas;
+      paint_context().leaf_nodes_canvas = canvas;
+      canvas->clear(SK_ColorTRANSPARENT);
+      layer->Paint(paint_context());
+      bitmaps[j].allocN32Pixels(50, 50);
+      (j == 0 ? screen : cache)->readPixels(bitmaps[j], 0, 0);
+    }
+    // The children are recorded once and painted alike on both canvases.
+    if (i == 0) {
+      recording = layer->flattened_children();
+      EXPECT_NE(recording, nullptr);
+    }
+    EXPECT_EQ(layer->flattened_children(), recording);
+    for (int y = 0; y < 40; y++) {
+      for (int x = 0; x < 40; x++) {
+        ASSERT_EQ(bitmaps[0].getColor(x, y), bitmaps[1].getColor(x + 2, y + 7))
+            << "at " << x << ", " << y;
+      }
+    }
+  }
+}
+
+TEST_F(ContainerLayerFlattenTest, FlattenedImageFiltersAreNotTiled) {
+  // The blur of the layer crosses the edge of the tiles of the tiled
+  // renderer, which would each only see their part of the layer.
+  auto make_layer = [this]() {
+    DisplayListBuilder builder;
+    builder.setImageFilter(SkImageFilters::Blur(4, 4, nullptr));
+    builder.saveLayer(nullptr, true);
+    builder.setImageFilter(nullptr);
+    builder.setColor(SK_ColorRED);
+    builder.drawRect(SkRect::MakeLTRB(20, 240, 280, 270));
+    builder.restore();
+    auto layer =
+        std::make_shared<TransformLayer>(SkMatrix::Translate(3.0f, 2.0f));
+    layer->Add(std::make_shared<DisplayListLayer>(
+        SkPoint::Make(0, 0), SkiaGPUObject(builder.Build(), unref_queue()),
+        false, false));
+    layer->Add(MakeRectLayer(unref_queue(), SkPoint::Make(0, 0),
+                             SkRect::MakeLTRB(10, 10, 290, 20), SK_ColorBLUE));
+    layer->Preroll(preroll_context(), SkMatrix::I());
+    return layer;
+  };
+  auto expected_layer = make_layer();
+  auto tiled_layer = make_layer();
+
+  auto loop = fml::ConcurrentMessageLoop::Create(4);
+  auto runner = loop->GetTaskRunner();
+  sk_sp<SkSurface> surface = SkSurface::MakeRasterN32Premul(300, 300);
+  paint_context().internal_nodes_canvas = surface->getCanvas();
+  paint_context().leaf_nodes_canvas = surface->getCanvas();
+  // The layers are painted one by one, then recorded and then replayed
+  // from the recording.
+  for (int i = 0; i < 3; i++) {
+    SkBitmap expected;
+    SkBitmap tiled;
+    for (auto [layer, bitmap] : {std::make_pair(expected_layer, &expected),
+                                 std::make_pair(tiled_layer, &tiled)}) {
+      paint_context().tiled_raster_task_runner =
+          layer == tiled_layer ? runner.get() : nullptr;
+      surface->getCanvas()->clear(SK_ColorTRANSPARENT);
+      layer->Paint(paint_context());
+      bitmap->allocN32Pixels(300, 300);
+      surface->readPixels(*bitmap, 0, 0);
+    }
+    EXPECT_EQ(memcmp(tiled.getPixels(), expected.getPixels(),
+                     tiled.computeByteSize()),
+              0);
+  }
+  paint_context().tiled_raster_task_runner = nullptr;
+}
 
 using ContainerLayerDiffTest = DiffContextTest;
 
@@ -456,7 +1031,5 @@ TEST_F(ContainerLayerDiffTest, ReplaceLayer) {
   EXPECT_EQ(damage.frame_damage, SkIRect::MakeLTRB(200, 0, 250, 150));
 }
 
-#endif
-
 }  // namespace testing
 }  // namespace flutter
@@ -5,6 +5,7 @@
 #include "flutter/flow/layers/display_list_layer.h"
 
 #include "flutter/flow/display_list_canvas.h"
+#include "flutter/flow/display_list_tiled_renderer.h"
 
 namespace flutter {
 
@@ -17,8 +18,6 @@ DisplayListLayer::DisplayListLayer(const SkPoint& offset,
       is_complex_(is_complex),
       will_change_(will_change) {}
 
-#ifdef FLUTTER_ENABLE_DIFF_CONTEXT
-
 bool DisplayListLayer::IsReplacing(DiffContext* context,
                                    const Layer* layer) const {
   // Only return true for identical display lists; This way
@@ -81,22 +80,38 @@ bool DisplayListLayer::Compare(DiffContext::Statistics& statistics,
   return res;
 }
 
-#endif  // FLUTTER_ENABLE_DIFF_CONTEXT
-
 void DisplayListLayer::Preroll(PrerollContext* context,
                                const SkMatrix& matrix) {
   TRACE_EVENT0("flutter", "DisplayListLayer::Preroll");
 
   DisplayList* disp_list = display_list();
 
-  if (auto* cache = context->raster_cache) {
+  if (context->raster_cache) {
     TRACE_EVENT0("flutter", "DisplayListLayer::RasterCache (Preroll)");
-    cache->Prepare(context, disp_list, is_complex_, will_change_, matrix,
-                   offset_);
+    PrepareRasterCache(
+        context, [this, disp_list, matrix](PrerollContext* cache_context) {
+          cache_context->raster_cache->Prepare(cache_context, disp_list,
+                                               is_complex_, will_change_,
+                                               matrix, offset_);
+        });
   }
 
   SkRect bounds = disp_list->bounds().makeOffset(offset_.x(), offset_.y());
   set_paint_bounds(bounds);
+  set_layer_can_inherit_opacity(disp_list->can_apply_group_opacity());
+}
+
+bool DisplayListLayer::can_be_flattened() const {
+  return !RasterCache::IsDisplayListWorthRasterizing(display_list(),
+                                                     will_change_, is_complex_);
+}
+
+void DisplayListLayer::Flatten(DisplayListBuilder& builder,
+                               const SkMatrix& matrix) const {
+  builder.save();
+  TranslateFlattenedLeaf(builder, matrix, offset_);
+  builder.drawDisplayList(display_list_.skia_object());
+  builder.restore();
 }
 
 void DisplayListLayer::Paint(PaintContext& context) const {
@@ -111,13 +126,30 @@ void DisplayListLayer::Paint(PaintContext& context) const {
       context.leaf_nodes_canvas->getTotalMatrix()));
 #endif
 
-  if (context.raster_cache &&
-      context.raster_cache->Draw(*display_list(), *context.leaf_nodes_canvas)) {
-    TRACE_EVENT_INSTANT0("flutter", "raster cache hit");
+  SkScalar opacity = context.inherited_opacity;
+  if (context.raster_cache) {
+    SkPaint paint;
+    paint.setAlphaf(opacity);
+    if (context.raster_cache->Draw(*display_list(), *context.leaf_nodes_canvas,
+                                   opacity < SK_Scalar1 ? &paint : nullptr)) {
+      TRACE_EVENT_INSTANT0("flutter", "raster cache hit");
+      return;
+    }
+  }
+
+  // The tiled renderer has no way to apply an inherited opacity.
+  if (opacity >= SK_Scalar1 && context.tiled_raster_task_runner &&
+      DisplayListTiledRenderer::Render(display_list_.skia_object(),
+                                       context.leaf_nodes_canvas,
+                                       *context.tiled_raster_task_runner)) {
     return;
   }
 
-  display_list()->RenderTo(context.leaf_nodes_canvas);
+  // Only the part of a (possibly much larger, e.g. scrolled) list that
+  // falls inside the clip needs to be dispatched.
+  display_list()->RenderTo(context.leaf_nodes_canvas,
+                           context.leaf_nodes_canvas->getLocalClipBounds(),
+                           opacity);
 }
 
 }  // namespace flutter
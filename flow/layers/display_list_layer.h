@@ -24,8 +24,6 @@ class DisplayListLayer : public Layer {
     return display_list_.skia_object().get();
   }
 
-#ifdef FLUTTER_ENABLE_DIFF_CONTEXT
-
   bool IsReplacing(DiffContext* context, const Layer* layer) const override;
 
   void Diff(DiffContext* context, const Layer* old_layer) override;
@@ -34,26 +32,27 @@ class DisplayListLayer : public Layer {
     return this;
   }
 
-#endif  // FLUTTER_ENABLE_DIFF_CONTEXT
-
   void Preroll(PrerollContext* frame, const SkMatrix& matrix) override;
 
   void Paint(PaintContext& context) const override;
 
+  // Leaves that the raster cache may cache are not flattened, so that
+  // they keep being drawn from the cache.
+  bool can_be_flattened() const override;
+
+  void Flatten(DisplayListBuilder& builder,
+               const SkMatrix& matrix) const override;
+
  private:
   SkPoint offset_;
   flutter::SkiaGPUObject<DisplayList> display_list_;
   bool is_complex_ = false;
   bool will_change_ = false;
 
-#ifdef FLUTTER_ENABLE_DIFF_CONTEXT
-
   static bool Compare(DiffContext::Statistics& statistics,
                       const DisplayListLayer* l1,
                       const DisplayListLayer* l2);
 
-#endif  // FLUTTER_ENABLE_DIFF_CONTEXT
-
   FML_DISALLOW_COPY_AND_ASSIGN(DisplayListLayer);
 };
 
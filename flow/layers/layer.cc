@@ -13,7 +13,8 @@ Layer::Layer()
     : paint_bounds_(SkRect::MakeEmpty()),
       unique_id_(NextUniqueID()),
       original_layer_id_(unique_id_),
-      subtree_has_platform_view_(false) {}
+      subtree_has_platform_view_(false),
+      layer_can_inherit_opacity_(false) {}
 
 Layer::~Layer() = default;
 
@@ -28,6 +29,27 @@ uint64_t Layer::NextUniqueID() {
 
 void Layer::Preroll(PrerollContext* context, const SkMatrix& matrix) {}
 
+void Layer::TranslateFlattenedLeaf(DisplayListBuilder& builder,
+                                   const SkMatrix& matrix,
+                                   const SkPoint& offset) {
+  builder.translate(offset.x(), offset.y());
+#ifndef SUPPORT_FRACTIONAL_TRANSLATION
+  // A DisplayList cannot set the matrix, so the snapping is recorded as
+  // the translation from the total matrix to the snapped one, which is the
+  // device space snapping mapped back through the total matrix.
+  SkMatrix total = SkMatrix::Concat(
+      matrix, SkMatrix::Translate(offset.x(), offset.y()));
+  SkMatrix snapped = RasterCache::GetIntegralTransCTM(total);
+  SkMatrix inverse;
+  if (snapped != total && total.invert(&inverse)) {
+    SkVector delta =
+        inverse.mapVector(snapped.getTranslateX() - total.getTranslateX(),
+                          snapped.getTranslateY() - total.getTranslateY());
+    builder.translate(delta.x(), delta.y());
+  }
+#endif
+}
+
 Layer::AutoPrerollSaveLayerState::AutoPrerollSaveLayerState(
     PrerollContext* preroll_context,
     bool save_layer_is_active,
@@ -5,6 +5,7 @@
 #ifndef FLUTTER_FLOW_LAYERS_LAYER_H_
 #define FLUTTER_FLOW_LAYERS_LAYER_H_
 
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -17,6 +18,7 @@
 #include "flutter/fml/compiler_specific.h"
 #include "flutter/fml/logging.h"
 #include "flutter/fml/macros.h"
+#include "flutter/fml/task_runner.h"
 #include "flutter/fml/trace_event.h"
 #include "third_party/skia/include/core/SkCanvas.h"
 #include "third_party/skia/include/core/SkColor.h"
@@ -61,6 +63,26 @@ struct PrerollContext {
   // These allow us to track properties like elevation, opacity, and the
   // prescence of a texture layer during Preroll.
   bool has_texture_layer = false;
+
+  // Cleared by the layers whose Preroll has to run again in the next frame
+  // even if nothing changed, which keeps the retained containers above them
+  // from reusing the results of their Preroll.
+  // See |ContainerLayer::PrerollChildren|.
+  bool preroll_can_be_reused = true;
+
+  // When set, the children of container layers may be prerolled
+  // concurrently on the workers of this runner.
+  // See |ContainerLayer::PrerollChildren|.
+  fml::BasicTaskRunner* concurrent_preroll_task_runner = nullptr;
+
+  // Set while a child of a container layer is prerolled concurrently with
+  // its siblings. The raster cache is only used on the raster thread, so
+  // the layers of the child add their calls to it here and the calls are
+  // made in the order of the children once they have all been prerolled.
+  // Retained container layers set this as well to keep the calls of their
+  // children. See |Layer::PrepareRasterCache|.
+  std::vector<std::function<void(PrerollContext*)>>*
+      deferred_raster_cache_calls = nullptr;
 };
 
 class PictureLayer;
@@ -79,8 +101,6 @@ class Layer {
     original_layer_id_ = old_layer->original_layer_id_;
   }
 
-#ifdef FLUTTER_ENABLE_DIFF_CONTEXT
-
   // Used to establish link between old layer and new layer that replaces it.
   // If this method returns true, it is assumed that this layer replaces the old
   // layer in tree and is able to diff with it.
@@ -100,8 +120,6 @@ class Layer {
     context->SetLayerPaintRegion(this, context->GetOldLayerPaintRegion(this));
   }
 
-#endif  // FLUTTER_ENABLE_DIFF_CONTEXT
-
   virtual void Preroll(PrerollContext* context, const SkMatrix& matrix);
 
   // Used during Preroll by layers that employ a saveLayer to manage the
@@ -151,6 +169,17 @@ class Layer {
     const RasterCache* raster_cache;
     const bool checkerboard_offscreen_layers;
     const float frame_device_pixel_ratio;
+
+    // When set, leaf layers that paint into a CPU backed canvas may
+    // spread their rasterization across the workers of this runner.
+    // See |DisplayListTiledRenderer|.
+    fml::BasicTaskRunner* tiled_raster_task_runner = nullptr;
+
+    // The opacity that a parent layer (usually an OpacityLayer) asks its
+    // children to apply to their own rendering in place of a saveLayer.
+    // It is only ever less than 1 while painting a layer whose
+    // |layer_can_inherit_opacity| is true.
+    SkScalar inherited_opacity = SK_Scalar1;
   };
 
   // Calls SkCanvas::saveLayer and restores the layer upon destruction. Also
@@ -244,6 +273,15 @@ class Layer {
   // Determines if the layer has any content.
   bool is_empty() const { return paint_bounds_.isEmpty(); }
 
+  // Whether the layer can apply the |PaintContext::inherited_opacity| to
+  // its own rendering so that the parent does not need to render it into
+  // a saveLayer. This must be set by the time Preroll() returns, layers
+  // that never set it are always rendered into a saveLayer.
+  bool layer_can_inherit_opacity() const { return layer_can_inherit_opacity_; }
+  void set_layer_can_inherit_opacity(bool value) {
+    layer_can_inherit_opacity_ = value;
+  }
+
   // Determines if the Paint() method is necessary based on the properties
   // of the indicated PaintContext object.
   bool needs_painting(PaintContext& context) const {
@@ -271,8 +309,6 @@ class Layer {
 
   uint64_t unique_id() const { return unique_id_; }
 
-#ifdef FLUTTER_ENABLE_DIFF_CONTEXT
-
   virtual const PictureLayer* as_picture_layer() const { return nullptr; }
   virtual const DisplayListLayer* as_display_list_layer() const {
     return nullptr;
@@ -283,13 +319,53 @@ class Layer {
   }
   virtual const testing::MockLayer* as_mock_layer() const { return nullptr; }
 
-#endif  // FLUTTER_ENABLE_DIFF_CONTEXT
+  // Whether the Preroll of this layer and its children may run on a worker
+  // thread concurrently with its siblings, which is not the case for
+  // layers that use the |ExternalViewEmbedder| during Preroll.
+  // See |ContainerLayer::PrerollChildren|.
+  virtual bool can_preroll_concurrently() const { return true; }
+
+  // Whether the drawing of this layer and its children is nothing but
+  // transforms, clips and display lists or pictures that the raster cache
+  // would not cache, which |Flatten| can then record into a single
+  // DisplayList. See |ContainerLayer::PaintChildren|.
+  virtual bool can_be_flattened() const { return false; }
+
+  // Records what |Paint| would draw on a canvas whose total matrix is
+  // |matrix| into |builder|. Only called if |can_be_flattened|.
+  virtual void Flatten(DisplayListBuilder& builder,
+                       const SkMatrix& matrix) const {
+    FML_DCHECK(false);
+  }
+
+ protected:
+  // Calls |prepare| with |context| to prepare the raster cache, or adds it
+  // to |PrerollContext::deferred_raster_cache_calls| if that is set, in
+  // which case it is called with the context of the parent container on
+  // the raster thread. |prepare| should only use the fields of the context
+  // that are the same for the whole frame.
+  template <typename Function>
+  static void PrepareRasterCache(PrerollContext* context, Function prepare) {
+    if (context->deferred_raster_cache_calls) {
+      context->deferred_raster_cache_calls->emplace_back(std::move(prepare));
+    } else {
+      prepare(context);
+    }
+  }
+
+  // Translates |builder|, whose total matrix is |matrix|, to the |offset|
+  // of a leaf layer and snaps the translation to whole pixels like the
+  // Paint of the leaf layers does.
+  static void TranslateFlattenedLeaf(DisplayListBuilder& builder,
+                                     const SkMatrix& matrix,
+                                     const SkPoint& offset);
 
  private:
   SkRect paint_bounds_;
   uint64_t unique_id_;
   uint64_t original_layer_id_;
   bool subtree_has_platform_view_;
+  bool layer_can_inherit_opacity_;
 
   static uint64_t NextUniqueID();
 
@@ -49,6 +49,8 @@ bool LayerTree::Preroll(CompositorContext::ScopedFrame& frame,
       frame.context().texture_registry(),
       checkerboard_offscreen_layers_,
       device_pixel_ratio_};
+  context.concurrent_preroll_task_runner =
+      frame.context().preroll_task_runner().get();
 
   root_layer_->Preroll(&context, frame.root_surface_transformation());
   return context.surface_needs_readback;
@@ -83,7 +85,9 @@ void LayerTree::Paint(CompositorContext::ScopedFrame& frame,
       frame.context().texture_registry(),
       ignore_raster_cache ? nullptr : &frame.context().raster_cache(),
       checkerboard_offscreen_layers_,
-      device_pixel_ratio_};
+      device_pixel_ratio_,
+      frame.gr_context() ? nullptr
+                         : frame.context().tiled_raster_task_runner().get()};
 
   if (root_layer_->needs_painting(context)) {
     root_layer_->Paint(context);
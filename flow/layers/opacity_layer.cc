@@ -12,8 +12,6 @@ namespace flutter {
 OpacityLayer::OpacityLayer(SkAlpha alpha, const SkPoint& offset)
     : alpha_(alpha), offset_(offset) {}
 
-#ifdef FLUTTER_ENABLE_DIFF_CONTEXT
-
 void OpacityLayer::Diff(DiffContext* context, const Layer* old_layer) {
   DiffContext::AutoSubtreeRestore subtree(context);
   auto* prev = static_cast<const OpacityLayer*>(old_layer);
@@ -28,8 +26,6 @@ void OpacityLayer::Diff(DiffContext* context, const Layer* old_layer) {
   context->SetLayerPaintRegion(this, context->CurrentSubtreeRegion());
 }
 
-#endif  // FLUTTER_ENABLE_DIFF_CONTEXT
-
 void OpacityLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
   TRACE_EVENT0("flutter", "OpacityLayer::Preroll");
   FML_DCHECK(!GetChildContainer()->layers().empty());  // We can't be a leaf.
@@ -50,12 +46,24 @@ void OpacityLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
   context->mutators_stack.Pop();
   context->mutators_stack.Pop();
 
+  // Our opacity can be folded into the rendering of a single child that
+  // can inherit it, which in turn means that our own parent can fold its
+  // opacity into ours.
+  const std::vector<std::shared_ptr<Layer>>& children =
+      GetChildContainer()->layers();
+  set_layer_can_inherit_opacity(children.size() == 1 &&
+                                children[0]->layer_can_inherit_opacity());
+
   {
     set_paint_bounds(paint_bounds().makeOffset(offset_.fX, offset_.fY));
 #ifndef SUPPORT_FRACTIONAL_TRANSLATION
     child_matrix = RasterCache::GetIntegralTransCTM(child_matrix);
 #endif
-    TryToPrepareRasterCache(context, GetCacheableChild(), child_matrix);
+    // Children that inherit the opacity render just as fast without the
+    // extra copy of their contents in the cache.
+    if (!layer_can_inherit_opacity()) {
+      TryToPrepareRasterCache(context, GetCacheableChild(), child_matrix);
+    }
   }
 
   // Restore cull_rect
@@ -68,6 +76,11 @@ void OpacityLayer::Paint(PaintContext& context) const {
 
   SkPaint paint;
   paint.setAlpha(alpha_);
+  SkScalar inherited_opacity = context.inherited_opacity;
+  SkScalar opacity = paint.getAlphaf() * inherited_opacity;
+  if (inherited_opacity < SK_Scalar1) {
+    paint.setAlphaf(opacity);
+  }
 
   SkAutoCanvasRestore save(context.internal_nodes_canvas, true);
   context.internal_nodes_canvas->translate(offset_.fX, offset_.fY);
@@ -83,6 +96,15 @@ void OpacityLayer::Paint(PaintContext& context) const {
     return;
   }
 
+  if (layer_can_inherit_opacity()) {
+    // The child applies the opacity to each of the ops it renders, which
+    // is much cheaper than rendering it into a layer.
+    context.inherited_opacity = opacity;
+    PaintChildren(context);
+    context.inherited_opacity = inherited_opacity;
+    return;
+  }
+
   // Skia may clip the content with saveLayerBounds (although it's not a
   // guaranteed clip). So we have to provide a big enough saveLayerBounds. To do
   // so, we first remove the offset from paint bounds since it's already in the
@@ -98,7 +120,9 @@ void OpacityLayer::Paint(PaintContext& context) const {
 
   Layer::AutoSaveLayer save_layer =
       Layer::AutoSaveLayer::Create(context, saveLayerBounds, &paint);
+  context.inherited_opacity = SK_Scalar1;
   PaintChildren(context);
+  context.inherited_opacity = inherited_opacity;
 }
 
 }  // namespace flutter
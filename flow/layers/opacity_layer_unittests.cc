@@ -5,8 +5,10 @@
 #include "flutter/flow/layers/opacity_layer.h"
 
 #include "flutter/flow/layers/clip_rect_layer.h"
+#include "flutter/flow/layers/display_list_layer.h"
 #include "flutter/flow/testing/layer_test.h"
 #include "flutter/flow/testing/mock_layer.h"
+#include "flutter/flow/testing/skia_gpu_object_layer_test.h"
 #include "flutter/fml/macros.h"
 #include "flutter/testing/mock_canvas.h"
 
@@ -427,5 +429,93 @@ TEST_F(OpacityLayerTest, CullRectIsTransformed) {
   EXPECT_EQ(mockLayer->parent_cull_rect().fTop, -20);
 }
 
+using OpacityLayerDisplayListTest = SkiaGPUObjectLayerTest;
+
+static std::shared_ptr<DisplayListLayer> MakeDisplayListLayer(
+    fml::RefPtr<SkiaUnrefQueue> unref_queue,
+    const std::vector<SkRect>& rects) {
+  DisplayListBuilder builder;
+  builder.setColor(SK_ColorGREEN);
+  for (const SkRect& rect : rects) {
+    builder.drawRect(rect);
+  }
+  return std::make_shared<DisplayListLayer>(
+      SkPoint::Make(0, 0), SkiaGPUObject(builder.Build(), unref_queue),
+      false, false);
+}
+
+// Returns the alpha of every rect drawn to |canvas|, or an empty vector
+// if any of them was drawn into a saveLayer.
+static std::vector<SkAlpha> DrawnRectAlphas(const MockCanvas& canvas) {
+  std::vector<SkAlpha> alphas;
+  for (const MockCanvas::DrawCall& call : canvas.draw_calls()) {
+    if (std::holds_alternative<MockCanvas::SaveLayerData>(call.data)) {
+      return {};
+    }
+    if (auto* data = std::get_if<MockCanvas::DrawRectData>(&call.data)) {
+      alphas.push_back(data->paint.getAlpha());
+    }
+  }
+  return alphas;
+}
+
+TEST_F(OpacityLayerDisplayListTest, OpacityIsFoldedIntoDisplayList) {
+  auto child = MakeDisplayListLayer(
+      unref_queue(), {SkRect::MakeWH(10, 10), SkRect::MakeXYWH(20, 0, 10, 10)});
+  auto layer = std::make_shared<OpacityLayer>(128, SkPoint::Make(0, 0));
+  layer->Add(child);
+
+  layer->Preroll(preroll_context(), SkMatrix());
+  EXPECT_TRUE(child->layer_can_inherit_opacity());
+  EXPECT_TRUE(layer->layer_can_inherit_opacity());
+
+  layer->Paint(paint_context());
+  EXPECT_EQ(DrawnRectAlphas(mock_canvas()), std::vector<SkAlpha>({128, 128}));
+  EXPECT_EQ(paint_context().inherited_opacity, SK_Scalar1);
+}
+
+TEST_F(OpacityLayerDisplayListTest, NestedOpacityIsFoldedIntoDisplayList) {
+  auto child = MakeDisplayListLayer(unref_queue(), {SkRect::MakeWH(10, 10)});
+  auto inner = std::make_shared<OpacityLayer>(128, SkPoint::Make(0, 0));
+  auto outer = std::make_shared<OpacityLayer>(128, SkPoint::Make(0, 0));
+  inner->Add(child);
+  outer->Add(inner);
+
+  outer->Preroll(preroll_context(), SkMatrix());
+  EXPECT_TRUE(outer->layer_can_inherit_opacity());
+
+  outer->Paint(paint_context());
+  EXPECT_EQ(DrawnRectAlphas(mock_canvas()), std::vector<SkAlpha>({64}));
+}
+
+TEST_F(OpacityLayerDisplayListTest, OverlappingDisplayListUsesSaveLayer) {
+  auto child = MakeDisplayListLayer(
+      unref_queue(), {SkRect::MakeWH(10, 10), SkRect::MakeXYWH(5, 5, 10, 10)});
+  auto layer = std::make_shared<OpacityLayer>(128, SkPoint::Make(0, 0));
+  layer->Add(child);
+
+  layer->Preroll(preroll_context(), SkMatrix());
+  EXPECT_FALSE(child->layer_can_inherit_opacity());
+  EXPECT_FALSE(layer->layer_can_inherit_opacity());
+
+  layer->Paint(paint_context());
+  EXPECT_TRUE(DrawnRectAlphas(mock_canvas()).empty());
+}
+
+TEST_F(OpacityLayerDisplayListTest, MultipleChildrenUseSaveLayer) {
+  auto child1 = MakeDisplayListLayer(unref_queue(), {SkRect::MakeWH(10, 10)});
+  auto child2 = MakeDisplayListLayer(unref_queue(),
+                                     {SkRect::MakeXYWH(20, 0, 10, 10)});
+  auto layer = std::make_shared<OpacityLayer>(128, SkPoint::Make(0, 0));
+  layer->Add(child1);
+  layer->Add(child2);
+
+  layer->Preroll(preroll_context(), SkMatrix());
+  EXPECT_FALSE(layer->layer_can_inherit_opacity());
+
+  layer->Paint(paint_context());
+  EXPECT_TRUE(DrawnRectAlphas(mock_canvas()).empty());
+}
+
 }  // namespace testing
 }  // namespace flutter
@@ -18,8 +18,6 @@ PictureLayer::PictureLayer(const SkPoint& offset,
       is_complex_(is_complex),
       will_change_(will_change) {}
 
-#ifdef FLUTTER_ENABLE_DIFF_CONTEXT
-
 bool PictureLayer::IsReplacing(DiffContext* context, const Layer* layer) const {
   // Only return true for identical pictures; This way
   // ContainerLayer::DiffChildren can detect when a picture layer got inserted
@@ -104,23 +102,38 @@ sk_sp<SkData> PictureLayer::SerializedPicture() const {
   return cached_serialized_picture_;
 }
 
-#endif  // FLUTTER_ENABLE_DIFF_CONTEXT
-
 void PictureLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
   TRACE_EVENT0("flutter", "PictureLayer::Preroll");
 
   SkPicture* sk_picture = picture();
 
-  if (auto* cache = context->raster_cache) {
+  if (context->raster_cache) {
     TRACE_EVENT0("flutter", "PictureLayer::RasterCache (Preroll)");
-    cache->Prepare(context, sk_picture, is_complex_, will_change_, matrix,
-                   offset_);
+    PrepareRasterCache(
+        context, [this, sk_picture, matrix](PrerollContext* cache_context) {
+          cache_context->raster_cache->Prepare(cache_context, sk_picture,
+                                               is_complex_, will_change_,
+                                               matrix, offset_);
+        });
   }
 
   SkRect bounds = sk_picture->cullRect().makeOffset(offset_.x(), offset_.y());
   set_paint_bounds(bounds);
 }
 
+bool PictureLayer::can_be_flattened() const {
+  return !RasterCache::IsPictureWorthRasterizing(picture(), will_change_,
+                                                 is_complex_);
+}
+
+void PictureLayer::Flatten(DisplayListBuilder& builder,
+                           const SkMatrix& matrix) const {
+  builder.save();
+  TranslateFlattenedLeaf(builder, matrix, offset_);
+  builder.drawPicture(picture_.skia_object(), nullptr, false);
+  builder.restore();
+}
+
 void PictureLayer::Paint(PaintContext& context) const {
   TRACE_EVENT0("flutter", "PictureLayer::Paint");
   FML_DCHECK(picture_.skia_object());
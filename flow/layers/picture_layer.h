@@ -22,20 +22,23 @@ class PictureLayer : public Layer {
 
   SkPicture* picture() const { return picture_.skia_object().get(); }
 
-#ifdef FLUTTER_ENABLE_DIFF_CONTEXT
-
   bool IsReplacing(DiffContext* context, const Layer* layer) const override;
 
   void Diff(DiffContext* context, const Layer* old_layer) override;
 
   const PictureLayer* as_picture_layer() const override { return this; }
 
-#endif  // FLUTTER_ENABLE_DIFF_CONTEXT
-
   void Preroll(PrerollContext* frame, const SkMatrix& matrix) override;
 
   void Paint(PaintContext& context) const override;
 
+  // Leaves that the raster cache may cache are not flattened, so that
+  // they keep being drawn from the cache.
+  bool can_be_flattened() const override;
+
+  void Flatten(DisplayListBuilder& builder,
+               const SkMatrix& matrix) const override;
+
  private:
   SkPoint offset_;
   // Even though pictures themselves are not GPU resources, they may reference
@@ -44,16 +47,12 @@ class PictureLayer : public Layer {
   bool is_complex_ = false;
   bool will_change_ = false;
 
-#ifdef FLUTTER_ENABLE_DIFF_CONTEXT
-
   sk_sp<SkData> SerializedPicture() const;
   mutable sk_sp<SkData> cached_serialized_picture_;
   static bool Compare(DiffContext::Statistics& statistics,
                       const PictureLayer* l1,
                       const PictureLayer* l2);
 
-#endif  // FLUTTER_ENABLE_DIFF_CONTEXT
-
   FML_DISALLOW_COPY_AND_ASSIGN(PictureLayer);
 };
 
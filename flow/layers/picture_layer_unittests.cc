@@ -97,8 +97,6 @@ TEST_F(PictureLayerTest, SimplePicture) {
   EXPECT_EQ(mock_canvas().draw_calls(), expected_draw_calls);
 }
 
-#ifdef FLUTTER_ENABLE_DIFF_CONTEXT
-
 using PictureLayerDiffTest = DiffContextTest;
 
 TEST_F(PictureLayerDiffTest, SimplePicture) {
@@ -153,7 +151,5 @@ TEST_F(PictureLayerDiffTest, PictureCompare) {
   EXPECT_EQ(damage.frame_damage, SkIRect::MakeLTRB(20, 20, 70, 70));
 }
 
-#endif
-
 }  // namespace testing
 }  // namespace flutter
@@ -18,6 +18,9 @@ class PlatformViewLayer : public Layer {
   void Preroll(PrerollContext* context, const SkMatrix& matrix) override;
   void Paint(PaintContext& context) const override;
 
+  // The platform views must be prerolled in order on the raster thread.
+  bool can_preroll_concurrently() const override { return false; }
+
  private:
   SkPoint offset_;
   SkSize size_;
@@ -6,6 +6,8 @@
 
 #include <optional>
 
+#include "third_party/skia/include/core/SkM44.h"
+
 namespace flutter {
 
 TransformLayer::TransformLayer(const SkMatrix& transform)
@@ -26,8 +28,6 @@ TransformLayer::TransformLayer(const SkMatrix& transform)
   }
 }
 
-#ifdef FLUTTER_ENABLE_DIFF_CONTEXT
-
 void TransformLayer::Diff(DiffContext* context, const Layer* old_layer) {
   DiffContext::AutoSubtreeRestore subtree(context);
   auto* prev = static_cast<const TransformLayer*>(old_layer);
@@ -42,8 +42,6 @@ void TransformLayer::Diff(DiffContext* context, const Layer* old_layer) {
   context->SetLayerPaintRegion(this, context->CurrentSubtreeRegion());
 }
 
-#endif  // FLUTTER_ENABLE_DIFF_CONTEXT
-
 void TransformLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
   TRACE_EVENT0("flutter", "TransformLayer::Preroll");
 
@@ -70,6 +68,28 @@ void TransformLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
   context->mutators_stack.Pop();
 }
 
+void TransformLayer::Flatten(DisplayListBuilder& builder,
+                             const SkMatrix& matrix) const {
+  builder.save();
+  if (transform_.hasPerspective()) {
+    SkM44 m44(transform_);
+    // clang-format off
+    builder.transformFullPerspective(
+        m44.rc(0, 0), m44.rc(0, 1), m44.rc(0, 2), m44.rc(0, 3),
+        m44.rc(1, 0), m44.rc(1, 1), m44.rc(1, 2), m44.rc(1, 3),
+        m44.rc(2, 0), m44.rc(2, 1), m44.rc(2, 2), m44.rc(2, 3),
+        m44.rc(3, 0), m44.rc(3, 1), m44.rc(3, 2), m44.rc(3, 3));
+    // clang-format on
+  } else {
+    builder.transform2DAffine(transform_.getScaleX(), transform_.getSkewX(),
+                              transform_.getTranslateX(), transform_.getSkewY(),
+                              transform_.getScaleY(),
+                              transform_.getTranslateY());
+  }
+  FlattenChildren(builder, SkMatrix::Concat(matrix, transform_));
+  builder.restore();
+}
+
 void TransformLayer::Paint(PaintContext& context) const {
   TRACE_EVENT0("flutter", "TransformLayer::Paint");
   FML_DCHECK(needs_painting(context));
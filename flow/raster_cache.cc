@@ -4,12 +4,16 @@
 
 #include "flutter/flow/raster_cache.h"
 
+#include <algorithm>
+#include <limits>
 #include <vector>
 
 #include "flutter/common/constants.h"
 #include "flutter/flow/layers/layer.h"
 #include "flutter/flow/paint_utils.h"
+#include "flutter/flow/raster_cache_atlas.h"
 #include "flutter/fml/logging.h"
+#include "flutter/fml/time/time_point.h"
 #include "flutter/fml/trace_event.h"
 #include "third_party/skia/include/core/SkCanvas.h"
 #include "third_party/skia/include/core/SkImage.h"
@@ -28,21 +32,54 @@ void RasterCacheResult::draw(SkCanvas& canvas, const SkPaint* paint) const {
   SkAutoCanvasRestore auto_restore(&canvas, true);
   SkIRect bounds =
       RasterCache::GetDeviceBounds(logical_rect_, canvas.getTotalMatrix());
-  FML_DCHECK(
-      std::abs(bounds.size().width() - image_->dimensions().width()) <= 1 &&
-      std::abs(bounds.size().height() - image_->dimensions().height()) <= 1);
   canvas.resetMatrix();
-  canvas.drawImage(image_, bounds.fLeft, bounds.fTop, SkSamplingOptions(),
-                   paint);
+  if (std::abs(bounds.width() - image_->width()) <= 1 &&
+      std::abs(bounds.height() - image_->height()) <= 1) {
+    canvas.drawImage(image_, bounds.fLeft, bounds.fTop, SkSamplingOptions(),
+                     paint);
+  } else {
+    // The image was rasterized at a nearby scale, see
+    // |RasterCache::scale_tolerance|.
+    canvas.drawImageRect(image_, SkRect::Make(bounds),
+                         SkSamplingOptions(SkFilterMode::kLinear), paint);
+  }
 }
 
 RasterCache::RasterCache(size_t access_threshold,
-                         size_t picture_and_display_list_cache_limit_per_frame)
+                         size_t picture_and_display_list_cache_limit_per_frame,
+                         size_t max_bytes,
+                         int frames_to_keep)
     : access_threshold_(access_threshold),
       picture_and_display_list_cache_limit_per_frame_(
           picture_and_display_list_cache_limit_per_frame),
+      max_bytes_(max_bytes),
+      frames_to_keep_(frames_to_keep),
+      atlas_(std::make_unique<RasterCacheAtlas>()),
       checkerboard_images_(false) {}
 
+RasterCache::~RasterCache() = default;
+
+// The number of bytes of the image that caches |rect| drawn with |ctm|.
+static size_t EstimateImageBytes(const SkRect& rect, const SkMatrix& ctm) {
+  SkIRect bounds = RasterCache::GetDeviceBounds(rect, ctm);
+  return static_cast<size_t>(bounds.width()) * bounds.height() *
+         SkColorTypeBytesPerPixel(kN32_SkColorType);
+}
+
+// Whether the ops saved by caching an image of |bytes| bytes are worth
+// the memory.
+static bool IsWorthTheBytes(size_t op_count, size_t bytes, bool is_complex) {
+  // The caller knows that the content is expensive to render.
+  return is_complex || bytes <= op_count * RasterCache::kMaxBytesPerCachedOp;
+}
+
+// Layers are cached to avoid rendering their children into a saveLayer,
+// which costs about as much as rendering a picture of the same size that
+// is just worth its bytes.
+static size_t EstimateLayerCost(size_t bytes) {
+  return std::max<size_t>(bytes / RasterCache::kMaxBytesPerCachedOp, 1);
+}
+
 static bool CanRasterizeRect(const SkRect& cull_rect) {
   if (cull_rect.isEmpty()) {
     // No point in ever rasterizing an empty display list.
@@ -58,9 +95,9 @@ static bool CanRasterizeRect(const SkRect& cull_rect) {
   return true;
 }
 
-static bool IsPictureWorthRasterizing(SkPicture* picture,
-                                      bool will_change,
-                                      bool is_complex) {
+bool RasterCache::IsPictureWorthRasterizing(SkPicture* picture,
+                                            bool will_change,
+                                            bool is_complex) {
   if (will_change) {
     // If the picture is going to change in the future, there is no point in
     // doing to extra work to rasterize.
@@ -84,9 +121,9 @@ static bool IsPictureWorthRasterizing(SkPicture* picture,
   return picture->approximateOpCount() > 5;
 }
 
-static bool IsDisplayListWorthRasterizing(DisplayList* display_list,
-                                          bool will_change,
-                                          bool is_complex) {
+bool RasterCache::IsDisplayListWorthRasterizing(DisplayList* display_list,
+                                                bool will_change,
+                                                bool is_complex) {
   if (will_change) {
     // If the display list is going to change in the future, there is no point
     // in doing to extra work to rasterize.
@@ -117,10 +154,27 @@ static std::unique_ptr<RasterCacheResult> Rasterize(
     SkColorSpace* dst_color_space,
     bool checkerboard,
     const SkRect& logical_rect,
-    const std::function<void(SkCanvas*)>& draw_function) {
+    const std::function<void(SkCanvas*)>& draw_function,
+    RasterCacheAtlas* atlas = nullptr) {
   TRACE_EVENT0("flutter", "RasterCachePopulate");
   SkIRect cache_rect = RasterCache::GetDeviceBounds(logical_rect, ctm);
 
+  if (atlas) {
+    std::unique_ptr<RasterCacheResult> result = atlas->Rasterize(
+        context, dst_color_space, cache_rect.size(), logical_rect,
+        [&](SkCanvas* canvas) {
+          canvas->translate(-cache_rect.left(), -cache_rect.top());
+          canvas->concat(ctm);
+          draw_function(canvas);
+          if (checkerboard) {
+            DrawCheckerboard(canvas, logical_rect);
+          }
+        });
+    if (result) {
+      return result;
+    }
+  }
+
   const SkImageInfo image_info = SkImageInfo::MakeN32Premul(
       cache_rect.width(), cache_rect.height(), sk_ref_sp(dst_color_space));
 
@@ -153,9 +207,9 @@ std::unique_ptr<RasterCacheResult> RasterCache::RasterizePicture(
     const SkMatrix& ctm,
     SkColorSpace* dst_color_space,
     bool checkerboard) const {
-  return Rasterize(context, ctm, dst_color_space, checkerboard,
-                   picture->cullRect(),
-                   [=](SkCanvas* canvas) { canvas->drawPicture(picture); });
+  return Rasterize(
+      context, ctm, dst_color_space, checkerboard, picture->cullRect(),
+      [=](SkCanvas* canvas) { canvas->drawPicture(picture); }, atlas_.get());
 }
 
 std::unique_ptr<RasterCacheResult> RasterCache::RasterizeDisplayList(
@@ -164,20 +218,95 @@ std::unique_ptr<RasterCacheResult> RasterCache::RasterizeDisplayList(
     const SkMatrix& ctm,
     SkColorSpace* dst_color_space,
     bool checkerboard) const {
-  return Rasterize(context, ctm, dst_color_space, checkerboard,
-                   display_list->bounds(),
-                   [=](SkCanvas* canvas) { display_list->RenderTo(canvas); });
+  return Rasterize(
+      context, ctm, dst_color_space, checkerboard, display_list->bounds(),
+      [=](SkCanvas* canvas) { display_list->RenderTo(canvas); }, atlas_.get());
+}
+
+std::shared_ptr<RasterCache::PendingImage> RasterCache::RasterizeInBackground(
+    size_t bytes,
+    const SkMatrix& ctm,
+    SkColorSpace* dst_color_space,
+    const SkRect& logical_rect,
+    std::function<void(SkCanvas*)> draw_function) const {
+  auto pending = std::make_shared<PendingImage>();
+  pending->bytes = bytes;
+  // The task only references the pending image, which the cache drops if
+  // the entry goes away before the task is done.
+  background_task_runner_->PostTask(
+      [pending, ctm, color_space = sk_ref_sp(dst_color_space),
+       checkerboard = checkerboard_images_, logical_rect,
+       draw_function = std::move(draw_function)]() {
+        fml::TimePoint start = fml::TimePoint::Now();
+        std::unique_ptr<RasterCacheResult> result =
+            Rasterize(nullptr, ctm, color_space.get(), checkerboard,
+                      logical_rect, draw_function);
+        fml::TimeDelta rasterization_time = fml::TimePoint::Now() - start;
+        std::scoped_lock lock(pending->mutex);
+        pending->result = std::move(result);
+        pending->rasterization_time = rasterization_time;
+        pending->done = true;
+      });
+  return pending;
+}
+
+// Returns |matrix| without its translation, like the matrix of a key.
+static SkMatrix Untranslated(const SkMatrix& matrix) {
+  SkMatrix result = matrix;
+  result[SkMatrix::kMTransX] = 0;
+  result[SkMatrix::kMTransY] = 0;
+  return result;
+}
+
+bool RasterCache::NeedsRerasterization(Entry& entry,
+                                       const SkMatrix& ctm) const {
+  SkMatrix matrix = Untranslated(ctm);
+  if (matrix == entry.last_matrix) {
+    entry.stable_frames++;
+  } else {
+    entry.last_matrix = matrix;
+    entry.stable_frames = 1;
+  }
+  return entry.image && matrix != entry.raster_matrix &&
+         entry.stable_frames > access_threshold_;
+}
+
+void RasterCache::AdoptPendingImage(Entry& entry) const {
+  if (!entry.pending) {
+    return;
+  }
+  std::unique_ptr<RasterCacheResult> image;
+  {
+    std::scoped_lock lock(entry.pending->mutex);
+    if (!entry.pending->done) {
+      return;
+    }
+    image = std::move(entry.pending->result);
+  }
+  RecordRasterization(entry, entry.pending->rasterization_time);
+  // A failed rasterization leaves the entry without an image, so that the
+  // next |Prepare| tries again.
+  entry.pending.reset();
+  entry.image = std::move(image);
 }
 
 void RasterCache::Prepare(PrerollContext* context,
                           Layer* layer,
                           const SkMatrix& ctm) {
-  LayerRasterCacheKey cache_key(layer->unique_id(), ctm);
+  LayerRasterCacheKey cache_key(layer->unique_id(), ctm, scale_tolerance_);
   Entry& entry = layer_cache_[cache_key];
-  entry.access_count++;
-  entry.used_this_frame = true;
-  if (!entry.image) {
+  MarkUsed(entry);
+  if (!entry.image || NeedsRerasterization(entry, ctm)) {
+    size_t bytes = EstimateImageBytes(layer->paint_bounds(), ctm);
+    size_t cost = EstimateLayerCost(bytes);
+    if (!MakeRoomFor(bytes, cost)) {
+      return;
+    }
+    fml::TimePoint start = fml::TimePoint::Now();
     entry.image = RasterizeLayer(context, layer, ctm, checkerboard_images_);
+    RecordRasterization(entry, fml::TimePoint::Now() - start);
+    entry.cost = cost;
+    entry.raster_matrix = Untranslated(ctm);
   }
 }
 
@@ -209,7 +338,8 @@ std::unique_ptr<RasterCacheResult> RasterCache::RasterizeLayer(
         if (layer->needs_painting(paintContext)) {
           layer->Paint(paintContext);
         }
-      });
+      },
+      atlas_.get());
 }
 
 bool RasterCache::Prepare(PrerollContext* context,
@@ -239,25 +369,60 @@ bool RasterCache::Prepare(PrerollContext* context,
     return false;
   }
 
-  PictureRasterCacheKey cache_key(picture->uniqueID(), transformation_matrix);
+  PictureRasterCacheKey cache_key(picture->uniqueID(), transformation_matrix,
+                                  scale_tolerance_);
 
   // Creates an entry, if not present prior.
-  Entry& entry = picture_cache_[cache_key];
+  auto [it, created] = picture_cache_.try_emplace(cache_key);
+  Entry& entry = it->second;
+  if (created) {
+    entry.last_used_frame = sweep_count_;
+  }
+  AdoptPendingImage(entry);
+  bool rerasterize = NeedsRerasterization(entry, transformation_matrix);
   if (entry.access_count < access_threshold_) {
     // Frame threshold has not yet been reached.
     return false;
   }
+  // Keeps the images that earlier layers prepared in this frame from being
+  // evicted to make room for this one before they are drawn.
+  entry.last_used_frame = sweep_count_;
+  if (entry.pending) {
+    // The image is being rasterized in the background.
+    return entry.image != nullptr;
+  }
 
-  if (!entry.image) {
+  if (!entry.image || rerasterize) {
     // GetIntegralTransCTM effect for matrix which only contains scale,
     // translate, so it won't affect result of matrix decomposition and cache
     // key.
 #ifndef SUPPORT_FRACTIONAL_TRANSLATION
     transformation_matrix = GetIntegralTransCTM(transformation_matrix);
 #endif
+    size_t cost = picture->approximateOpCount();
+    size_t bytes =
+        EstimateImageBytes(picture->cullRect(), transformation_matrix);
+    if (!IsWorthTheBytes(cost, bytes, is_complex) ||
+        !MakeRoomFor(bytes, cost)) {
+      // An image rasterized at another scale still draws.
+      return entry.image != nullptr;
+    }
+    entry.cost = cost;
+    entry.raster_matrix = Untranslated(transformation_matrix);
+    if (background_task_runner_ && !context->gr_context) {
+      entry.pending = RasterizeInBackground(
+          bytes, transformation_matrix, context->dst_color_space,
+          picture->cullRect(),
+          [picture = sk_ref_sp(picture)](SkCanvas* canvas) {
+            canvas->drawPicture(picture);
+          });
+      return entry.image != nullptr;
+    }
+    fml::TimePoint start = fml::TimePoint::Now();
     entry.image =
         RasterizePicture(picture, context->gr_context, transformation_matrix,
                          context->dst_color_space, checkerboard_images_);
+    RecordRasterization(entry, fml::TimePoint::Now() - start);
     picture_cached_this_frame_++;
   }
   return true;
@@ -290,41 +455,85 @@ bool RasterCache::Prepare(PrerollContext* context,
     return false;
   }
 
-  DisplayListRasterCacheKey cache_key(display_list->unique_id(),
-                                      transformation_matrix);
+  DisplayListRasterCacheKey cache_key(display_list->content_hash(),
+                                      transformation_matrix, scale_tolerance_);
 
   // Creates an entry, if not present prior.
-  Entry& entry = display_list_cache_[cache_key];
+  auto [it, created] = display_list_cache_.try_emplace(cache_key);
+  Entry& entry = it->second;
+  if (entry.display_list.get() != display_list) {
+    if (entry.display_list && !entry.display_list->Equals(*display_list)) {
+      // The hashes collided, the entry belongs to different content.
+      entry = Entry();
+      created = true;
+    }
+    entry.display_list = sk_ref_sp(display_list);
+  }
+  if (created) {
+    entry.last_used_frame = sweep_count_;
+  }
+  AdoptPendingImage(entry);
+  bool rerasterize = NeedsRerasterization(entry, transformation_matrix);
   if (entry.access_count < access_threshold_) {
     // Frame threshold has not yet been reached.
     return false;
   }
+  // Keeps the images that earlier layers prepared in this frame from being
+  // evicted to make room for this one before they are drawn.
+  entry.last_used_frame = sweep_count_;
+  if (entry.pending) {
+    // The image is being rasterized in the background.
+    return entry.image != nullptr;
+  }
 
-  if (!entry.image) {
+  if (!entry.image || rerasterize) {
     // GetIntegralTransCTM effect for matrix which only contains scale,
     // translate, so it won't affect result of matrix decomposition and cache
     // key.
 #ifndef SUPPORT_FRACTIONAL_TRANSLATION
     transformation_matrix = GetIntegralTransCTM(transformation_matrix);
 #endif
+    size_t cost = display_list->op_count();
+    size_t bytes =
+        EstimateImageBytes(display_list->bounds(), transformation_matrix);
+    if (!IsWorthTheBytes(cost, bytes, is_complex) ||
+        !MakeRoomFor(bytes, cost)) {
+      // An image rasterized at another scale still draws.
+      return entry.image != nullptr;
+    }
+    entry.cost = cost;
+    entry.raster_matrix = Untranslated(transformation_matrix);
+    if (background_task_runner_ && !context->gr_context) {
+      entry.pending = RasterizeInBackground(
+          bytes, transformation_matrix, context->dst_color_space,
+          display_list->bounds(),
+          [display_list = sk_ref_sp(display_list)](SkCanvas* canvas) {
+            display_list->RenderTo(canvas);
+          });
+      return entry.image != nullptr;
+    }
+    fml::TimePoint start = fml::TimePoint::Now();
     entry.image = RasterizeDisplayList(
         display_list, context->gr_context, transformation_matrix,
         context->dst_color_space, checkerboard_images_);
+    RecordRasterization(entry, fml::TimePoint::Now() - start);
     display_list_cached_this_frame_++;
   }
   return true;
 }
 
 bool RasterCache::Draw(const SkPicture& picture, SkCanvas& canvas) const {
-  PictureRasterCacheKey cache_key(picture.uniqueID(), canvas.getTotalMatrix());
+  PictureRasterCacheKey cache_key(picture.uniqueID(), canvas.getTotalMatrix(),
+                                  scale_tolerance_);
   auto it = picture_cache_.find(cache_key);
   if (it == picture_cache_.end()) {
     return false;
   }
 
   Entry& entry = it->second;
-  entry.access_count++;
-  entry.used_this_frame = true;
+  MarkUsed(entry);
+  AdoptPendingImage(entry);
+  RecordDraw(entry);
 
   if (entry.image) {
     entry.image->draw(canvas, nullptr);
@@ -335,20 +544,27 @@ bool RasterCache::Draw(const SkPicture& picture, SkCanvas& canvas) const {
 }
 
 bool RasterCache::Draw(const DisplayList& display_list,
-                       SkCanvas& canvas) const {
-  DisplayListRasterCacheKey cache_key(display_list.unique_id(),
-                                      canvas.getTotalMatrix());
+                       SkCanvas& canvas,
+                       SkPaint* paint) const {
+  DisplayListRasterCacheKey cache_key(display_list.content_hash(),
+                                      canvas.getTotalMatrix(),
+                                      scale_tolerance_);
   auto it = display_list_cache_.find(cache_key);
   if (it == display_list_cache_.end()) {
     return false;
   }
 
   Entry& entry = it->second;
-  entry.access_count++;
-  entry.used_this_frame = true;
+  if (entry.display_list.get() != &display_list &&
+      !entry.display_list->Equals(display_list)) {
+    return false;
+  }
+  MarkUsed(entry);
+  AdoptPendingImage(entry);
+  RecordDraw(entry);
 
   if (entry.image) {
-    entry.image->draw(canvas, nullptr);
+    entry.image->draw(canvas, paint);
     return true;
   }
 
@@ -358,15 +574,16 @@ bool RasterCache::Draw(const DisplayList& display_list,
 bool RasterCache::Draw(const Layer* layer,
                        SkCanvas& canvas,
                        SkPaint* paint) const {
-  LayerRasterCacheKey cache_key(layer->unique_id(), canvas.getTotalMatrix());
+  LayerRasterCacheKey cache_key(layer->unique_id(), canvas.getTotalMatrix(),
+                                scale_tolerance_);
   auto it = layer_cache_.find(cache_key);
   if (it == layer_cache_.end()) {
     return false;
   }
 
   Entry& entry = it->second;
-  entry.access_count++;
-  entry.used_this_frame = true;
+  MarkUsed(entry);
+  RecordDraw(entry);
 
   if (entry.image) {
     entry.image->draw(canvas, paint);
@@ -378,18 +595,135 @@ bool RasterCache::Draw(const Layer* layer,
 
 void RasterCache::SweepAfterFrame() {
   TraceStatsToTimeline();
-  SweepOneCacheAfterFrame(picture_cache_);
-  SweepOneCacheAfterFrame(display_list_cache_);
-  SweepOneCacheAfterFrame(layer_cache_);
+  SweepOneCacheAfterFrame(picture_cache_,
+                          RasterCacheEntryReport::Source::kPicture);
+  SweepOneCacheAfterFrame(display_list_cache_,
+                          RasterCacheEntryReport::Source::kDisplayList);
+  SweepOneCacheAfterFrame(layer_cache_, RasterCacheEntryReport::Source::kLayer);
   picture_cached_this_frame_ = 0;
   display_list_cached_this_frame_ = 0;
+  last_frame_report_ = std::move(frame_report_);
   sweep_count_++;
+  frame_report_ = RasterCacheFrameReport();
+  frame_report_.frame = sweep_count_;
+  // No entry has been used in the next frame yet, so this evicts whatever
+  // it takes to get back into a budget that was lowered.
+  MakeRoomFor(0, std::numeric_limits<size_t>::max());
+  atlas_->Compact();
+}
+
+bool RasterCache::MakeRoomFor(size_t bytes, size_t cost) {
+  size_t cached_bytes = EstimateBudgetBytes();
+  if (cached_bytes + bytes <= max_bytes_) {
+    LimitAtlasPages(cached_bytes);
+    return true;
+  }
+  if (bytes > max_bytes_) {
+    return false;
+  }
+
+  std::vector<Entry*> entries;
+  CollectEvictableEntries(picture_cache_, entries);
+  CollectEvictableEntries(display_list_cache_, entries);
+  CollectEvictableEntries(layer_cache_, entries);
+  // Least recently used first, and the entries that save the least work
+  // per byte first among those that were last used in the same frame.
+  std::sort(entries.begin(), entries.end(),
+            [](const Entry* a, const Entry* b) {
+              if (a->last_used_frame != b->last_used_frame) {
+                return a->last_used_frame < b->last_used_frame;
+              }
+              return a->cost_per_byte() < b->cost_per_byte();
+            });
+
+  double cost_per_byte = bytes > 0 ? static_cast<double>(cost) / bytes
+                                   : std::numeric_limits<double>::infinity();
+  size_t needed_bytes = cached_bytes + bytes - max_bytes_;
+  size_t evicted_bytes = 0;
+  std::vector<Entry*> evicted;
+  // The number of images that would be evicted from each page of the atlas,
+  // whose memory is only freed once all of its images are gone.
+  std::unordered_map<const void*, size_t> evicted_packed_images;
+  for (Entry* entry : entries) {
+    if (evicted_bytes >= needed_bytes) {
+      break;
+    }
+    if (entry->cost_per_byte() > cost_per_byte) {
+      // Worth more than the new image.
+      continue;
+    }
+    evicted.push_back(entry);
+    const void* page = entry->image->atlas_page();
+    if (!page) {
+      evicted_bytes += entry->image->image_bytes();
+    } else if (++evicted_packed_images[page] ==
+               RasterCacheAtlas::GetImageCount(page)) {
+      evicted_bytes += RasterCacheAtlas::PageBytes();
+    }
+  }
+  if (evicted_bytes < needed_bytes) {
+    return false;
+  }
+  // Evicting the images of a page that keeps other images frees nothing.
+  evicted.erase(
+      std::remove_if(evicted.begin(), evicted.end(),
+                     [&evicted_packed_images](const Entry* entry) {
+                       const void* page = entry->image->atlas_page();
+                       return page && evicted_packed_images[page] <
+                                          RasterCacheAtlas::GetImageCount(page);
+                     }),
+      evicted.end());
+  for (Entry* entry : evicted) {
+    // The entry itself stays to keep counting its accesses.
+    entry->evicted_bytes = entry->image->image_bytes();
+    entry->image.reset();
+  }
+  atlas_->FreeEmptyPages();
+  LimitAtlasPages(cached_bytes - evicted_bytes);
+  return true;
+}
+
+void RasterCache::LimitAtlasPages(size_t budget_bytes) const {
+  size_t free_bytes = budget_bytes < max_bytes_ ? max_bytes_ - budget_bytes : 0;
+  atlas_->SetMaxPages(atlas_->page_count() +
+                      free_bytes / RasterCacheAtlas::PageBytes());
+}
+
+void RasterCache::ReportEntry(RasterCacheEntryReport::Source source,
+                              uint64_t id,
+                              Entry& entry,
+                              bool removed) {
+  bool removes_image = removed && entry.image;
+  if (entry.last_used_frame == sweep_count_ || entry.evicted_bytes > 0 ||
+      removes_image || entry.rasterization_time > fml::TimeDelta::Zero()) {
+    RasterCacheEntryReport report;
+    report.source = source;
+    report.id = id;
+    report.hits = entry.hits;
+    report.misses = entry.misses;
+    report.rasterization_time = entry.rasterization_time;
+    report.bytes = entry.image ? entry.image->image_bytes() : 0;
+    if (removes_image) {
+      report.eviction_reason = RasterCacheEntryReport::EvictionReason::kUnused;
+    } else if (entry.evicted_bytes > 0) {
+      report.eviction_reason = RasterCacheEntryReport::EvictionReason::kBudget;
+      report.bytes = entry.evicted_bytes;
+    }
+    frame_report_.entries.push_back(report);
+  }
+  entry.hits = 0;
+  entry.misses = 0;
+  entry.rasterization_time = fml::TimeDelta::Zero();
+  entry.evicted_bytes = 0;
 }
 
 void RasterCache::Clear() {
   picture_cache_.clear();
   display_list_cache_.clear();
   layer_cache_.clear();
+  // Frees all of the pages, which may belong to a context that is going
+  // away.
+  atlas_->Compact();
 }
 
 size_t RasterCache::GetCachedEntriesCount() const {
@@ -425,7 +759,9 @@ void RasterCache::TraceStatsToTimeline() const {
       "LayerCount", GetLayerCachedEntriesCount(),                          //
       "LayerMBytes", EstimateLayerCacheByteSize() / kMegaByteSizeInBytes,  //
       "PictureCount", GetPictureCachedEntriesCount(),                      //
-      "PictureMBytes", EstimatePictureCacheByteSize() / kMegaByteSizeInBytes);
+      "PictureMBytes", EstimatePictureCacheByteSize() / kMegaByteSizeInBytes,
+      "Hits", frame_report_.hits,                                          //
+      "Misses", frame_report_.misses);
 
 #endif  // !FLUTTER_RELEASE
 }
@@ -455,4 +791,38 @@ size_t RasterCache::EstimatePictureCacheByteSize() const {
   return picture_cache_bytes;
 }
 
+// The bytes of the images in |cache| that have memory of their own.
+template <typename Cache>
+static size_t SumBudgetBytes(const Cache& cache) {
+  size_t budget_bytes = 0;
+  for (const auto& item : cache) {
+    const auto& image = item.second.image;
+    if (image && !image->atlas_page()) {
+      budget_bytes += image->image_bytes();
+    }
+  }
+  return budget_bytes;
+}
+
+size_t RasterCache::EstimateBudgetBytes() const {
+  return SumBudgetBytes(picture_cache_) + SumBudgetBytes(display_list_cache_) +
+         SumBudgetBytes(layer_cache_) + atlas_->page_bytes() +
+         EstimatePendingByteSize();
+}
+
+size_t RasterCache::EstimatePendingByteSize() const {
+  size_t pending_bytes = 0;
+  for (const auto& item : picture_cache_) {
+    if (item.second.pending) {
+      pending_bytes += item.second.pending->bytes;
+    }
+  }
+  for (const auto& item : display_list_cache_) {
+    if (item.second.pending) {
+      pending_bytes += item.second.pending->bytes;
+    }
+  }
+  return pending_bytes;
+}
+
 }  // namespace flutter
@@ -5,13 +5,19 @@
 #ifndef FLUTTER_FLOW_RASTER_CACHE_H_
 #define FLUTTER_FLOW_RASTER_CACHE_H_
 
+#include <functional>
+#include <limits>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
+#include <vector>
 
 #include "flutter/flow/display_list.h"
 #include "flutter/flow/raster_cache_key.h"
 #include "flutter/fml/macros.h"
 #include "flutter/fml/memory/weak_ptr.h"
+#include "flutter/fml/task_runner.h"
+#include "flutter/fml/time/time_delta.h"
 #include "third_party/skia/include/core/SkImage.h"
 #include "third_party/skia/include/core/SkSize.h"
 
@@ -33,12 +39,68 @@ class RasterCacheResult {
     return image_ ? image_->imageInfo().computeMinByteSize() : 0;
   };
 
+  // The page of the |RasterCacheAtlas| that the image was packed into, or
+  // null if the image has memory of its own. Packed images are charged to
+  // the budget of the cache through their pages, see
+  // |RasterCache::max_bytes|.
+  virtual const void* atlas_page() const { return nullptr; }
+
  private:
   sk_sp<SkImage> image_;
   SkRect logical_rect_;
 };
 
+// The activity of one entry of the raster cache during a frame, see
+// |RasterCacheFrameReport|.
+struct RasterCacheEntryReport {
+  enum class Source {
+    kPicture,
+    kDisplayList,
+    kLayer,
+  };
+
+  enum class EvictionReason {
+    // The image was not evicted during the frame.
+    kNone,
+    // The image was evicted to make room for another one, see
+    // |RasterCache::max_bytes|.
+    kBudget,
+    // The entry was removed because it was not used for
+    // |RasterCache::frames_to_keep| frames.
+    kUnused,
+  };
+
+  Source source;
+  // The unique id of the picture or layer, or the content hash of the
+  // display list.
+  uint64_t id;
+  // The number of draws of the content that drew the image of the entry,
+  // and the number of draws that rendered the content directly.
+  size_t hits = 0;
+  size_t misses = 0;
+  // The time it took to rasterize the image of the entry, including the
+  // time spent on the background task runner.
+  fml::TimeDelta rasterization_time;
+  // The bytes of the image at the end of the frame, or of the image that
+  // was evicted.
+  size_t bytes = 0;
+  EvictionReason eviction_reason = EvictionReason::kNone;
+};
+
+// The activity of the raster cache during a frame.
+struct RasterCacheFrameReport {
+  // The |RasterCache::sweep_count| during the frame.
+  int frame = 0;
+  // The totals of all entries.
+  size_t hits = 0;
+  size_t misses = 0;
+  fml::TimeDelta rasterization_time;
+  // The entries that were used, rasterized or evicted during the frame.
+  std::vector<RasterCacheEntryReport> entries;
+};
+
 struct PrerollContext;
+class RasterCacheAtlas;
 
 class RasterCache {
  public:
@@ -48,16 +110,38 @@ class RasterCache {
   // the work across multiple frames.
   static constexpr int kDefaultPictureAndDispLayListCacheLimitPerFrame = 3;
 
+  // The default limit on the bytes used by the images in the cache.
+  static constexpr size_t kDefaultMaxBytes = 256 * 1024 * 1024;
+
+  // The default number of frames for which an entry is kept after the last
+  // frame that used it. Keeping entries for a few frames preserves the
+  // images of content that is only visible in some of the frames.
+  static constexpr int kDefaultFramesToKeep = 3;
+
+  // The number of image bytes that a picture or display list may take per
+  // op that it saves from being rendered again, see |Prepare|.
+  static constexpr size_t kMaxBytesPerCachedOp = 64 * 1024;
+
+  // The default tolerance for drawing an image that was rasterized at a
+  // different scale, see |scale_tolerance|.
+  static constexpr SkScalar kDefaultScaleTolerance = 0.1f;
+
   explicit RasterCache(size_t access_threshold = 3,
                        size_t picture_and_display_list_cache_limit_per_frame =
-                           kDefaultPictureAndDispLayListCacheLimitPerFrame);
+                           kDefaultPictureAndDispLayListCacheLimitPerFrame,
+                       size_t max_bytes = kDefaultMaxBytes,
+                       int frames_to_keep = kDefaultFramesToKeep);
 
-  virtual ~RasterCache() = default;
+  virtual ~RasterCache();
 
   /**
    * @brief Rasterize a picture object and produce a RasterCacheResult
    * to be stored in the cache.
    *
+   * Images that are no larger than |RasterCacheAtlas::kMaxPackedSize| are
+   * packed into the pages of the atlas of the cache, see |atlas|. The same
+   * applies to |RasterizeDisplayList| and |RasterizeLayer|.
+   *
    * @param picture the SkPicture object to be cached.
    * @param context the GrDirectContext used for rendering.
    * @param ctm the transformation matrix used for rendering.
@@ -110,6 +194,15 @@ class RasterCache {
     return bounds;
   }
 
+  // Whether |Prepare| would consider caching the picture or display list
+  // of a layer with these |will_change| and |is_complex| hints at all.
+  static bool IsPictureWorthRasterizing(SkPicture* picture,
+                                        bool will_change,
+                                        bool is_complex);
+  static bool IsDisplayListWorthRasterizing(DisplayList* display_list,
+                                            bool will_change,
+                                            bool is_complex);
+
   /**
    * @brief Snap the translation components of the matrix to integers.
    *
@@ -139,6 +232,11 @@ class RasterCache {
   // 2. The picture is not worth rasterizing
   // 3. The matrix is singular
   // 4. The picture is accessed too few times
+  // 5. The image would take more than |kMaxBytesPerCachedOp| bytes per op
+  //    in the picture, unless |is_complex| is set.
+  // 6. There is no room for the image in the budget, see |max_bytes|.
+  // 7. The image is being rasterized on the background task runner, see
+  //    |SetBackgroundTaskRunner|.
   bool Prepare(PrerollContext* context,
                SkPicture* picture,
                bool is_complex,
@@ -152,6 +250,8 @@ class RasterCache {
                const SkMatrix& untranslated_matrix,
                const SkPoint& offset = SkPoint());
 
+  // Rasterizes the layer once it is accessed, unless there is no room for
+  // it in the budget.
   void Prepare(PrerollContext* context, Layer* layer, const SkMatrix& ctm);
 
   // Find the raster cache for the picture and draw it to the canvas.
@@ -161,8 +261,13 @@ class RasterCache {
 
   // Find the raster cache for the display list and draw it to the canvas.
   //
+  // Additional paint can be given to change how the raster cache is drawn
+  // (e.g., draw the raster cache with some opacity).
+  //
   // Return true if it's found and drawn.
-  bool Draw(const DisplayList& display_list, SkCanvas& canvas) const;
+  bool Draw(const DisplayList& display_list,
+            SkCanvas& canvas,
+            SkPaint* paint = nullptr) const;
 
   // Find the raster cache for the layer and draw it to the canvas.
   //
@@ -216,6 +321,26 @@ class RasterCache {
    */
   int sweep_count() const { return sweep_count_; }
 
+  /**
+   * @brief The hits, misses and rasterization time of the current frame
+   * so far.
+   *
+   * The |RasterCacheFrameReport::entries| are only added when the frame is
+   * swept, see |last_frame_report|.
+   */
+  const RasterCacheFrameReport& current_frame_report() const {
+    return frame_report_;
+  }
+
+  /**
+   * @brief The report of the last frame that was swept, which attributes
+   * the activity of the cache to the pictures, display lists and layers
+   * that it was caused by.
+   */
+  const RasterCacheFrameReport& last_frame_report() const {
+    return last_frame_report_;
+  }
+
   /**
    * @brief Return the number of frames that a picture must be prepared
    * before it will be cached. If the number is 0, then no picture will
@@ -226,30 +351,227 @@ class RasterCache {
    */
   int access_threshold() const { return access_threshold_; }
 
+  /**
+   * @brief The maximum number of bytes that the images in the cache may
+   * take. The images that were packed into the pages of the |atlas| are
+   * charged through their pages, which count as a whole from when they
+   * are allocated until they are freed.
+   *
+   * A new image is only added to the cache if it fits into the budget
+   * after evicting the images of entries that were not used in the current
+   * frame. Those are evicted least recently used first, but only if they
+   * save less rasterization work per byte than the new image would.
+   * Evicting a packed image frees no memory until its page is empty, so
+   * packed images are only evicted along with all of the other images of
+   * their page. Only as many new pages are allocated as fit into the
+   * remaining budget.
+   *
+   * Lowering the budget evicts images at the end of the current frame.
+   */
+  size_t max_bytes() const { return max_bytes_; }
+  void SetMaxBytes(size_t max_bytes) { max_bytes_ = max_bytes; }
+
+  /**
+   * @brief The number of frames for which an entry is kept after the last
+   * frame in which it was used. If the number is 0, entries are removed at
+   * the end of the first frame that does not use them.
+   */
+  int frames_to_keep() const { return frames_to_keep_; }
+
+  /**
+   * @brief The atlas that holds the images of the small entries.
+   *
+   * The pages count towards |max_bytes| as a whole, including the space
+   * that is not in use.
+   */
+  const RasterCacheAtlas& atlas() const { return *atlas_; }
+
+  /**
+   * @brief The relative difference in scale at which an image may still be
+   * drawn for content that is transformed by a matrix that only scales and
+   * translates.
+   *
+   * Such matrices are bucketed by scale in the keys of the entries, see
+   * |RasterCacheKey::BucketScale|, so that the image is found and resampled
+   * while the content is being zoomed. Once the content has been drawn at
+   * the same scale for more than |access_threshold| frames, its image is
+   * rasterized again at that scale.
+   *
+   * A tolerance of 0 only draws images at the scale they were rasterized
+   * at.
+   */
+  SkScalar scale_tolerance() const { return scale_tolerance_; }
+  void SetScaleTolerance(SkScalar tolerance) { scale_tolerance_ = tolerance; }
+
+  /**
+   * @brief Rasterize the images of pictures and display lists on
+   * |task_runner| instead of in |Prepare|, or synchronously again if
+   * |task_runner| is null.
+   *
+   * The images are rendered into raster surfaces and are added to the
+   * cache by the first |Prepare| or |Draw| after they are done, so the
+   * content is drawn directly until then. This only happens on the
+   * software backend. With a |PrerollContext::gr_context| the images are
+   * still rasterized synchronously into textures, since a raster image
+   * would be uploaded into a texture of its own when it is drawn, which
+   * the byte budget does not account for, and would not render exactly
+   * like the GPU does. Background rasterizations are not limited per
+   * frame, but their images count towards |max_bytes| while they are
+   * being rasterized. Layers are always rasterized synchronously.
+   */
+  void SetBackgroundTaskRunner(
+      std::shared_ptr<fml::BasicTaskRunner> task_runner) {
+    background_task_runner_ = std::move(task_runner);
+  }
+
  private:
+  // An image that is being rasterized on |background_task_runner_|.
+  struct PendingImage {
+    std::mutex mutex;
+    // Set on the background thread once the image is rasterized, which
+    // leaves |result| null if that failed.
+    bool done = false;
+    std::unique_ptr<RasterCacheResult> result;
+    // The estimated size of the image, which is reserved in the budget.
+    size_t bytes = 0;
+    fml::TimeDelta rasterization_time;
+  };
+
   struct Entry {
-    bool used_this_frame = false;
+    // The |sweep_count_| during the frame in which the entry was last used.
+    int last_used_frame = 0;
     size_t access_count = 0;
+    // The estimated cost of rendering the content again, in ops, which is
+    // saved by drawing |image| instead.
+    size_t cost = 0;
     std::unique_ptr<RasterCacheResult> image;
+    // Set while |image| is being rasterized in the background.
+    std::shared_ptr<PendingImage> pending;
+    // The untranslated matrix that |image| was rasterized with.
+    SkMatrix raster_matrix;
+    // The untranslated matrix of the last |Prepare| and the number of
+    // consecutive calls that used it.
+    SkMatrix last_matrix;
+    size_t stable_frames = 0;
+    // The activity of the entry in the current frame, see
+    // |RasterCacheEntryReport|.
+    size_t hits = 0;
+    size_t misses = 0;
+    fml::TimeDelta rasterization_time;
+    // The bytes of the image if it was evicted to make room for another.
+    size_t evicted_bytes = 0;
+
+    double cost_per_byte() const {
+      int64_t bytes = image->image_bytes();
+      return bytes > 0 ? static_cast<double>(cost) / bytes
+                       : std::numeric_limits<double>::infinity();
+    }
+
+    // Only used by the DisplayList cache, which is keyed on the content
+    // hash of the lists. Holds the last list that was prepared for the
+    // entry, which is used to verify that lists with the same hash
+    // really have the same content. Holding on to it also keeps the
+    // objects that the list references alive so that their addresses,
+    // which are part of the hash, cannot be reused by other objects.
+    sk_sp<DisplayList> display_list;
   };
 
   template <class Cache>
-  static void SweepOneCacheAfterFrame(Cache& cache) {
-    std::vector<typename Cache::iterator> dead;
+  void SweepOneCacheAfterFrame(Cache& cache,
+                               RasterCacheEntryReport::Source source) {
+    for (auto it = cache.begin(); it != cache.end();) {
+      bool unused = sweep_count_ - it->second.last_used_frame > frames_to_keep_;
+      ReportEntry(source, it->first.id(), it->second, unused);
+      if (unused) {
+        it = cache.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
 
-    for (auto it = cache.begin(); it != cache.end(); ++it) {
-      Entry& entry = it->second;
-      if (!entry.used_this_frame) {
-        dead.push_back(it);
+  template <class Cache>
+  void CollectEvictableEntries(Cache& cache,
+                               std::vector<Entry*>& entries) const {
+    for (auto& item : cache) {
+      Entry& entry = item.second;
+      if (entry.image && entry.last_used_frame != sweep_count_) {
+        entries.push_back(&entry);
       }
-      entry.used_this_frame = false;
     }
+  }
+
+  // Evicts images until the images that remain, plus |bytes| more, fit
+  // into |max_bytes_|. Only the images of entries that were not used in
+  // this frame and that save less than |cost| ops per byte of |bytes| are
+  // evicted. Returns false, without evicting anything, if that does not
+  // make enough room.
+  bool MakeRoomFor(size_t bytes, size_t cost);
+
+  // The bytes reserved for the images that are being rasterized in the
+  // background.
+  size_t EstimatePendingByteSize() const;
+
+  // The bytes that count towards |max_bytes_|: the images that have memory
+  // of their own, the pages of |atlas_| and the pending images.
+  size_t EstimateBudgetBytes() const;
+
+  // Lets |atlas_| allocate as many new pages as fit into |max_bytes_| next
+  // to the |budget_bytes| that are taken already.
+  void LimitAtlasPages(size_t budget_bytes) const;
+
+  // Posts the rasterization of |logical_rect| drawn with |ctm| by
+  // |draw_function| to |background_task_runner_|.
+  std::shared_ptr<PendingImage> RasterizeInBackground(
+      size_t bytes,
+      const SkMatrix& ctm,
+      SkColorSpace* dst_color_space,
+      const SkRect& logical_rect,
+      std::function<void(SkCanvas*)> draw_function) const;
+
+  // Tracks the |ctm| that |entry| is prepared with in this frame and
+  // returns whether its image was rasterized with another matrix than
+  // |ctm|, which has now been used for more than |access_threshold_|
+  // frames in a row.
+  bool NeedsRerasterization(Entry& entry, const SkMatrix& ctm) const;
+
+  // Moves the image of |entry| into the cache if its background
+  // rasterization is done.
+  void AdoptPendingImage(Entry& entry) const;
+
+  // Adds the activity of |entry| in this frame to |frame_report_|, if
+  // there was any, and resets it. |removed| is set if the entry is about
+  // to be removed.
+  void ReportEntry(RasterCacheEntryReport::Source source,
+                   uint64_t id,
+                   Entry& entry,
+                   bool removed);
+
+  // Accounts for |rasterization_time| spent on the image of |entry|.
+  void RecordRasterization(Entry& entry,
+                           fml::TimeDelta rasterization_time) const {
+    entry.rasterization_time = entry.rasterization_time + rasterization_time;
+    frame_report_.rasterization_time =
+        frame_report_.rasterization_time + rasterization_time;
+  }
 
-    for (auto it : dead) {
-      cache.erase(it);
+  // Accounts for a draw of the content of |entry|, which draws its image
+  // if it has one.
+  void RecordDraw(Entry& entry) const {
+    if (entry.image) {
+      entry.hits++;
+      frame_report_.hits++;
+    } else {
+      entry.misses++;
+      frame_report_.misses++;
     }
   }
 
+  void MarkUsed(Entry& entry) const {
+    entry.access_count++;
+    entry.last_used_frame = sweep_count_;
+  }
+
   bool GenerateNewCacheInThisFrame() const {
     // Disabling caching when access_threshold is zero is historic behavior.
     return access_threshold_ != 0 &&
@@ -259,13 +581,22 @@ class RasterCache {
 
   const size_t access_threshold_;
   const size_t picture_and_display_list_cache_limit_per_frame_;
+  size_t max_bytes_;
+  const int frames_to_keep_;
+  SkScalar scale_tolerance_ = kDefaultScaleTolerance;
   size_t picture_cached_this_frame_ = 0;
   size_t display_list_cached_this_frame_ = 0;
   int sweep_count_ = 0;
+  // Holds the images of the small entries, see |RasterizePicture|. It
+  // must outlive the entries.
+  std::unique_ptr<RasterCacheAtlas> atlas_;
   mutable PictureRasterCacheKey::Map<Entry> picture_cache_;
   mutable DisplayListRasterCacheKey::Map<Entry> display_list_cache_;
   mutable LayerRasterCacheKey::Map<Entry> layer_cache_;
   bool checkerboard_images_;
+  std::shared_ptr<fml::BasicTaskRunner> background_task_runner_;
+  mutable RasterCacheFrameReport frame_report_;
+  RasterCacheFrameReport last_frame_report_;
 
   void TraceStatsToTimeline() const;
 
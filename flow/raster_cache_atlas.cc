@@ -0,0 +1,259 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/raster_cache_atlas.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "flutter/flow/raster_cache.h"
+#include "flutter/fml/logging.h"
+#include "flutter/fml/trace_event.h"
+#include "third_party/skia/include/core/SkPaint.h"
+
+namespace flutter {
+
+// A result whose image is a slot in a page of the atlas.
+class RasterCacheAtlas::AtlasResult : public RasterCacheResult {
+ public:
+  AtlasResult(RasterCacheAtlas* atlas, Slot* slot, const SkRect& logical_rect)
+      : RasterCacheResult(nullptr, logical_rect),
+        atlas_(atlas),
+        slot_(slot),
+        logical_rect_(logical_rect) {}
+
+  ~AtlasResult() override { atlas_->Free(slot_); }
+
+  void draw(SkCanvas& canvas, const SkPaint* paint) const override {
+    TRACE_EVENT0("flutter", "RasterCacheResult::draw");
+    SkAutoCanvasRestore auto_restore(&canvas, true);
+    SkIRect bounds =
+        RasterCache::GetDeviceBounds(logical_rect_, canvas.getTotalMatrix());
+    const SkIRect& rect = slot_->rect;
+    canvas.resetMatrix();
+    if (std::abs(bounds.width() - rect.width()) <= 1 &&
+        std::abs(bounds.height() - rect.height()) <= 1) {
+      canvas.drawImageRect(
+          atlas_->GetImage(slot_->page), SkRect::Make(rect),
+          SkRect::MakeXYWH(bounds.fLeft, bounds.fTop, rect.width(),
+                           rect.height()),
+          SkSamplingOptions(), paint, SkCanvas::kStrict_SrcRectConstraint);
+    } else {
+      // The image was rasterized at a nearby scale.
+      canvas.drawImageRect(atlas_->GetImage(slot_->page), SkRect::Make(rect),
+                           SkRect::Make(bounds),
+                           SkSamplingOptions(SkFilterMode::kLinear), paint,
+                           SkCanvas::kStrict_SrcRectConstraint);
+    }
+  }
+
+  SkISize image_dimensions() const override { return slot_->rect.size(); }
+
+  // Only counts the slot, not the unused space of the page.
+  int64_t image_bytes() const override {
+    return slot_->rect.size().area() *
+           SkColorTypeBytesPerPixel(kN32_SkColorType);
+  }
+
+  const void* atlas_page() const override { return slot_->page; }
+
+ private:
+  RasterCacheAtlas* atlas_;
+  Slot* slot_;
+  SkRect logical_rect_;
+};
+
+RasterCacheAtlas::RasterCacheAtlas() = default;
+
+RasterCacheAtlas::~RasterCacheAtlas() {
+  FML_DCHECK(live_area() == 0) << "Raster cache results outlived the atlas";
+}
+
+std::unique_ptr<RasterCacheResult> RasterCacheAtlas::Rasterize(
+    GrDirectContext* context,
+    SkColorSpace* dst_color_space,
+    const SkISize& size,
+    const SkRect& logical_rect,
+    const std::function<void(SkCanvas*)>& draw_function) {
+  if (size.isEmpty() || size.width() > kMaxPackedSize ||
+      size.height() > kMaxPackedSize) {
+    return nullptr;
+  }
+  Slot* slot = Allocate(context, dst_color_space, size);
+  if (!slot) {
+    return nullptr;
+  }
+  Page* page = slot->page;
+  page->image = nullptr;
+
+  SkCanvas* canvas = page->surface->getCanvas();
+  SkAutoCanvasRestore auto_restore(canvas, true);
+  canvas->clipIRect(slot->rect);
+  canvas->drawColor(SK_ColorTRANSPARENT, SkBlendMode::kSrc);
+  canvas->translate(slot->rect.left(), slot->rect.top());
+  draw_function(canvas);
+
+  return std::make_unique<AtlasResult>(this, slot, logical_rect);
+}
+
+bool RasterCacheAtlas::AllocateRect(std::vector<Shelf>& shelves,
+                                    const SkISize& size,
+                                    SkIRect* rect) {
+  int height = (size.height() + kShelfHeightGranularity - 1) /
+               kShelfHeightGranularity * kShelfHeightGranularity;
+  for (Shelf& shelf : shelves) {
+    if (shelf.height == height && shelf.right + size.width() <= kPageSize) {
+      *rect = SkIRect::MakeXYWH(shelf.right, shelf.top, size.width(),
+                                size.height());
+      shelf.right += size.width();
+      return true;
+    }
+  }
+  int top = shelves.empty() ? 0 : shelves.back().top + shelves.back().height;
+  if (top + height > kPageSize) {
+    return false;
+  }
+  shelves.push_back({top, height, size.width()});
+  *rect = SkIRect::MakeXYWH(0, top, size.width(), size.height());
+  return true;
+}
+
+RasterCacheAtlas::Slot* RasterCacheAtlas::Allocate(
+    GrDirectContext* context,
+    SkColorSpace* dst_color_space,
+    const SkISize& size) {
+  SkIRect rect;
+  Page* page = nullptr;
+  for (const std::unique_ptr<Page>& candidate : pages_) {
+    if (candidate->context == context &&
+        SkColorSpace::Equals(candidate->color_space.get(), dst_color_space) &&
+        AllocateRect(candidate->shelves, size, &rect)) {
+      page = candidate.get();
+      break;
+    }
+  }
+  if (!page) {
+    if (pages_.size() >= max_pages_) {
+      return nullptr;
+    }
+    const SkImageInfo image_info = SkImageInfo::MakeN32Premul(
+        kPageSize, kPageSize, sk_ref_sp(dst_color_space));
+    sk_sp<SkSurface> surface =
+        context ? SkSurface::MakeRenderTarget(context, SkBudgeted::kYes,
+                                              image_info)
+                : SkSurface::MakeRaster(image_info);
+    if (!surface) {
+      return nullptr;
+    }
+    auto new_page = std::make_unique<Page>();
+    new_page->context = context;
+    new_page->color_space = sk_ref_sp(dst_color_space);
+    new_page->surface = std::move(surface);
+    if (!AllocateRect(new_page->shelves, size, &rect)) {
+      return nullptr;
+    }
+    page = new_page.get();
+    pages_.push_back(std::move(new_page));
+  }
+  page->slots.push_back(std::make_unique<Slot>(Slot{page, rect}));
+  page->allocated_area += rect.size().area();
+  page->live_area += rect.size().area();
+  return page->slots.back().get();
+}
+
+const sk_sp<SkImage>& RasterCacheAtlas::GetImage(Page* page) const {
+  if (!page->image) {
+    page->image = page->surface->makeImageSnapshot();
+  }
+  return page->image;
+}
+
+void RasterCacheAtlas::Free(Slot* slot) {
+  Page* page = slot->page;
+  page->live_area -= slot->rect.size().area();
+  auto it = std::find_if(
+      page->slots.begin(), page->slots.end(),
+      [slot](const std::unique_ptr<Slot>& item) { return item.get() == slot; });
+  FML_DCHECK(it != page->slots.end());
+  page->slots.erase(it);
+}
+
+size_t RasterCacheAtlas::GetImageCount(const void* page) {
+  return static_cast<const Page*>(page)->slots.size();
+}
+
+void RasterCacheAtlas::FreeEmptyPages() {
+  pages_.erase(std::remove_if(pages_.begin(), pages_.end(),
+                              [](const std::unique_ptr<Page>& page) {
+                                return page->slots.empty();
+                              }),
+               pages_.end());
+}
+
+void RasterCacheAtlas::Compact() {
+  FreeEmptyPages();
+  for (const std::unique_ptr<Page>& page : pages_) {
+    if (page->live_area < page->allocated_area * kCompactionThreshold) {
+      Repack(page.get());
+    }
+  }
+}
+
+void RasterCacheAtlas::Repack(Page* page) {
+  TRACE_EVENT0("flutter", "RasterCacheAtlas::Repack");
+  // Packing the tallest slots first fills the shelves evenly.
+  std::vector<Slot*> slots;
+  for (const std::unique_ptr<Slot>& slot : page->slots) {
+    slots.push_back(slot.get());
+  }
+  std::sort(slots.begin(), slots.end(), [](Slot* a, Slot* b) {
+    return a->rect.height() > b->rect.height();
+  });
+  std::vector<Shelf> shelves;
+  std::vector<SkIRect> rects(slots.size());
+  for (size_t i = 0; i < slots.size(); i++) {
+    if (!AllocateRect(shelves, slots[i]->rect.size(), &rects[i])) {
+      return;
+    }
+  }
+
+  sk_sp<SkSurface> surface =
+      page->surface->makeSurface(page->surface->imageInfo());
+  if (!surface) {
+    return;
+  }
+  sk_sp<SkImage> old_image = GetImage(page);
+  SkCanvas* canvas = surface->getCanvas();
+  canvas->clear(SK_ColorTRANSPARENT);
+  SkPaint paint;
+  paint.setBlendMode(SkBlendMode::kSrc);
+  for (size_t i = 0; i < slots.size(); i++) {
+    canvas->drawImageRect(old_image, SkRect::Make(slots[i]->rect),
+                          SkRect::Make(rects[i]), SkSamplingOptions(), &paint,
+                          SkCanvas::kStrict_SrcRectConstraint);
+    slots[i]->rect = rects[i];
+  }
+  page->surface = std::move(surface);
+  page->image = nullptr;
+  page->shelves = std::move(shelves);
+  page->allocated_area = page->live_area;
+}
+
+int64_t RasterCacheAtlas::allocated_area() const {
+  int64_t area = 0;
+  for (const std::unique_ptr<Page>& page : pages_) {
+    area += page->allocated_area;
+  }
+  return area;
+}
+
+int64_t RasterCacheAtlas::live_area() const {
+  int64_t area = 0;
+  for (const std::unique_ptr<Page>& page : pages_) {
+    area += page->live_area;
+  }
+  return area;
+}
+
+}  // namespace flutter
@@ -0,0 +1,167 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FLOW_RASTER_CACHE_ATLAS_H_
+#define FLUTTER_FLOW_RASTER_CACHE_ATLAS_H_
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "flutter/fml/macros.h"
+#include "third_party/skia/include/core/SkCanvas.h"
+#include "third_party/skia/include/core/SkColorSpace.h"
+#include "third_party/skia/include/core/SkImage.h"
+#include "third_party/skia/include/core/SkRect.h"
+#include "third_party/skia/include/core/SkSurface.h"
+#include "third_party/skia/include/gpu/GrDirectContext.h"
+
+namespace flutter {
+
+class RasterCacheResult;
+
+// Packs the images of small raster cache entries into shared pages.
+//
+// Every page is a surface of |kPageSize| pixels squared that is divided
+// into shelves, rows of slots of similar height which are filled from left
+// to right. Drawing many entries from the same page lets the GPU backends
+// batch the draws and keeps the number of textures down.
+//
+// The space of a slot is only reused after its page has been compacted,
+// which happens in |Compact| once less than |kCompactionThreshold| of the
+// allocated space of the page is still in use.
+//
+// The atlas must outlive the results that it creates and is only used on
+// the raster thread.
+class RasterCacheAtlas {
+ public:
+  // The width and height of the pages.
+  static constexpr int kPageSize = 1024;
+
+  // Images that are wider or taller than this get an image of their own.
+  static constexpr int kMaxPackedSize = 256;
+
+  // The heights of the shelves are rounded up to multiples of this, so
+  // that slots of similar heights can share a shelf.
+  static constexpr int kShelfHeightGranularity = 16;
+
+  // The maximum number of pages, which limits the memory held by space
+  // that is not in use. The raster cache may allow fewer, see
+  // |SetMaxPages|.
+  static constexpr size_t kMaxPages = 4;
+
+  // A page is repacked when less than this fraction of its allocated area
+  // is in use.
+  static constexpr double kCompactionThreshold = 0.5;
+
+  RasterCacheAtlas();
+
+  ~RasterCacheAtlas();
+
+  // Packs an image of |size| pixels for |context| and |dst_color_space|
+  // into a page and calls |draw_function| with a canvas whose origin is
+  // the top left corner of the image and which is clipped to it. The
+  // returned result draws the image from the page.
+  //
+  // Returns nullptr if the image is too large to be packed or if there is
+  // no room for it in any page.
+  std::unique_ptr<RasterCacheResult> Rasterize(
+      GrDirectContext* context,
+      SkColorSpace* dst_color_space,
+      const SkISize& size,
+      const SkRect& logical_rect,
+      const std::function<void(SkCanvas*)>& draw_function);
+
+  // Repacks the pages that are mostly unused and frees the pages that are
+  // not used at all.
+  void Compact();
+
+  // Only frees the pages that are not used at all.
+  void FreeEmptyPages();
+
+  size_t page_count() const { return pages_.size(); }
+
+  // The bytes of a page, which it takes as a whole no matter how much of it
+  // is in use.
+  static int64_t PageBytes() {
+    return static_cast<int64_t>(kPageSize) * kPageSize *
+           SkColorTypeBytesPerPixel(kN32_SkColorType);
+  }
+
+  // The bytes of all of the pages.
+  int64_t page_bytes() const { return page_count() * PageBytes(); }
+
+  // The number of images in |page|, see |RasterCacheResult::atlas_page|.
+  static size_t GetImageCount(const void* page);
+
+  // Limits the number of pages, up to |kMaxPages|. Pages that exist already
+  // are kept, but no new page is allocated while there are |max_pages|.
+  void SetMaxPages(size_t max_pages) {
+    max_pages_ = std::min(max_pages, kMaxPages);
+  }
+
+  // The area of the slots that were allocated in the pages, including the
+  // slots that have been freed since their pages were last compacted.
+  int64_t allocated_area() const;
+
+  // The area of the slots that are in use.
+  int64_t live_area() const;
+
+ private:
+  class AtlasResult;
+  struct Page;
+
+  struct Slot {
+    Page* page;
+    SkIRect rect;
+  };
+
+  struct Shelf {
+    int top;
+    int height;
+    // The left edge of the free space at the end of the shelf.
+    int right;
+  };
+
+  struct Page {
+    GrDirectContext* context;
+    sk_sp<SkColorSpace> color_space;
+    sk_sp<SkSurface> surface;
+    // A snapshot of |surface|, which is taken when the page is first drawn
+    // and dropped when the page is written to again.
+    sk_sp<SkImage> image;
+    std::vector<Shelf> shelves;
+    std::vector<std::unique_ptr<Slot>> slots;
+    int64_t allocated_area = 0;
+    int64_t live_area = 0;
+  };
+
+  std::vector<std::unique_ptr<Page>> pages_;
+  size_t max_pages_ = kMaxPages;
+
+  // Finds room for |size| in the |shelves| of a page, adding a shelf
+  // below the last one if necessary.
+  static bool AllocateRect(std::vector<Shelf>& shelves,
+                           const SkISize& size,
+                           SkIRect* rect);
+
+  Slot* Allocate(GrDirectContext* context,
+                 SkColorSpace* dst_color_space,
+                 const SkISize& size);
+
+  const sk_sp<SkImage>& GetImage(Page* page) const;
+
+  void Free(Slot* slot);
+
+  // Moves the slots of |page| to the top left of a new surface. Does
+  // nothing if they do not all fit.
+  void Repack(Page* page);
+
+  FML_DISALLOW_COPY_AND_ASSIGN(RasterCacheAtlas);
+};
+
+}  // namespace flutter
+
+#endif  // FLUTTER_FLOW_RASTER_CACHE_ATLAS_H_
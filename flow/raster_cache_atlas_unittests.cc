@@ -0,0 +1,170 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/raster_cache_atlas.h"
+
+#include <vector>
+
+#include "flutter/flow/raster_cache.h"
+#include "gtest/gtest.h"
+#include "third_party/skia/include/core/SkCanvas.h"
+#include "third_party/skia/include/core/SkSurface.h"
+
+namespace flutter {
+namespace testing {
+
+namespace {
+
+// Packs an image of |size| filled with |color| into |atlas|.
+std::unique_ptr<RasterCacheResult> RasterizeColor(RasterCacheAtlas& atlas,
+                                                  const SkISize& size,
+                                                  SkColor color) {
+  return atlas.Rasterize(
+      nullptr, nullptr, size, SkRect::Make(size),
+      [color](SkCanvas* canvas) { canvas->drawColor(color); });
+}
+
+// Draws |result| at (10, 10) and returns the color of the pixels at its
+// corners, which must all be the same.
+SkColor DrawnColor(const RasterCacheResult& result) {
+  SkISize size = result.image_dimensions();
+  sk_sp<SkSurface> surface = SkSurface::MakeRasterN32Premul(
+      size.width() + 20, size.height() + 20);
+  SkCanvas* canvas = surface->getCanvas();
+  canvas->clear(SK_ColorTRANSPARENT);
+  canvas->translate(10, 10);
+  result.draw(*canvas, nullptr);
+
+  SkBitmap bitmap;
+  bitmap.allocN32Pixels(size.width() + 20, size.height() + 20);
+  surface->readPixels(bitmap, 0, 0);
+  SkColor color = bitmap.getColor(10, 10);
+  EXPECT_EQ(bitmap.getColor(9 + size.width(), 9 + size.height()), color);
+  // Nothing is drawn outside of the image.
+  EXPECT_EQ(bitmap.getColor(9, 9), SK_ColorTRANSPARENT);
+  EXPECT_EQ(bitmap.getColor(10 + size.width(), 10 + size.height()),
+            SK_ColorTRANSPARENT);
+  return color;
+}
+
+}  // namespace
+
+TEST(RasterCacheAtlas, SmallImagesShareAPage) {
+  RasterCacheAtlas atlas;
+  auto red = RasterizeColor(atlas, SkISize::Make(50, 40), SK_ColorRED);
+  auto green = RasterizeColor(atlas, SkISize::Make(60, 40), SK_ColorGREEN);
+  auto blue = RasterizeColor(atlas, SkISize::Make(30, 100), SK_ColorBLUE);
+  ASSERT_NE(red, nullptr);
+  ASSERT_NE(green, nullptr);
+  ASSERT_NE(blue, nullptr);
+  EXPECT_EQ(atlas.page_count(), 1u);
+  EXPECT_EQ(atlas.live_area(), 50 * 40 + 60 * 40 + 30 * 100);
+
+  EXPECT_EQ(red->image_dimensions(), SkISize::Make(50, 40));
+  EXPECT_EQ(red->image_bytes(), 50 * 40 * 4);
+  EXPECT_EQ(DrawnColor(*red), SK_ColorRED);
+  EXPECT_EQ(DrawnColor(*green), SK_ColorGREEN);
+  EXPECT_EQ(DrawnColor(*blue), SK_ColorBLUE);
+}
+
+TEST(RasterCacheAtlas, LargeImagesAreNotPacked) {
+  RasterCacheAtlas atlas;
+  EXPECT_EQ(RasterizeColor(atlas,
+                           SkISize::Make(RasterCacheAtlas::kMaxPackedSize + 1,
+                                         10),
+                           SK_ColorRED),
+            nullptr);
+  EXPECT_EQ(RasterizeColor(atlas, SkISize::Make(0, 10), SK_ColorRED), nullptr);
+  EXPECT_EQ(atlas.page_count(), 0u);
+}
+
+TEST(RasterCacheAtlas, PagesAreLimited) {
+  RasterCacheAtlas atlas;
+  const int size = RasterCacheAtlas::kMaxPackedSize;
+  const int per_page = (RasterCacheAtlas::kPageSize / size) *
+                       (RasterCacheAtlas::kPageSize / size);
+  std::vector<std::unique_ptr<RasterCacheResult>> results;
+  for (size_t i = 0; i < per_page * RasterCacheAtlas::kMaxPages; i++) {
+    results.push_back(
+        RasterizeColor(atlas, SkISize::Make(size, size), SK_ColorRED));
+    ASSERT_NE(results.back(), nullptr);
+  }
+  EXPECT_EQ(atlas.page_count(), RasterCacheAtlas::kMaxPages);
+  EXPECT_EQ(RasterizeColor(atlas, SkISize::Make(size, size), SK_ColorRED),
+            nullptr);
+}
+
+TEST(RasterCacheAtlas, MaxPagesOnlyLimitNewPages) {
+  RasterCacheAtlas atlas;
+  auto red = RasterizeColor(atlas, SkISize::Make(50, 50), SK_ColorRED);
+  EXPECT_EQ(atlas.page_bytes(), RasterCacheAtlas::PageBytes());
+  atlas.SetMaxPages(0);
+  // The existing page still takes new images.
+  auto green = RasterizeColor(atlas, SkISize::Make(50, 50), SK_ColorGREEN);
+  ASSERT_NE(green, nullptr);
+  EXPECT_EQ(atlas.page_count(), 1u);
+  EXPECT_EQ(RasterCacheAtlas::GetImageCount(green->atlas_page()), 2u);
+
+  RasterCacheAtlas limited_atlas;
+  limited_atlas.SetMaxPages(0);
+  EXPECT_EQ(RasterizeColor(limited_atlas, SkISize::Make(50, 50), SK_ColorRED),
+            nullptr);
+  EXPECT_EQ(limited_atlas.page_count(), 0u);
+}
+
+TEST(RasterCacheAtlas, FreedSpaceIsReclaimedByCompaction) {
+  RasterCacheAtlas atlas;
+  std::vector<std::unique_ptr<RasterCacheResult>> results;
+  for (int i = 0; i < 10; i++) {
+    results.push_back(RasterizeColor(atlas, SkISize::Make(100, 30),
+                                     i % 2 ? SK_ColorRED : SK_ColorBLUE));
+  }
+  // Keep the last image, which is the last one in its shelf.
+  for (int i = 0; i < 9; i++) {
+    results[i] = nullptr;
+  }
+  EXPECT_EQ(atlas.live_area(), 100 * 30);
+  EXPECT_EQ(atlas.allocated_area(), 10 * 100 * 30);
+
+  atlas.Compact();
+  EXPECT_EQ(atlas.page_count(), 1u);
+  EXPECT_EQ(atlas.allocated_area(), 100 * 30);
+  EXPECT_EQ(DrawnColor(*results[9]), SK_ColorRED);
+
+  // The space of the freed images is used again.
+  auto green = RasterizeColor(atlas, SkISize::Make(100, 30), SK_ColorGREEN);
+  EXPECT_EQ(DrawnColor(*green), SK_ColorGREEN);
+  EXPECT_EQ(DrawnColor(*results[9]), SK_ColorRED);
+}
+
+TEST(RasterCacheAtlas, EmptyPagesAreFreed) {
+  RasterCacheAtlas atlas;
+  auto red = RasterizeColor(atlas, SkISize::Make(50, 50), SK_ColorRED);
+  EXPECT_EQ(atlas.page_count(), 1u);
+  atlas.Compact();
+  EXPECT_EQ(atlas.page_count(), 1u);
+  red = nullptr;
+  atlas.Compact();
+  EXPECT_EQ(atlas.page_count(), 0u);
+}
+
+TEST(RasterCacheAtlas, RasterCachePacksSmallImages) {
+  RasterCache cache;
+  SkMatrix matrix = SkMatrix::I();
+  DisplayListBuilder builder(SkRect::MakeWH(100, 100));
+  builder.setColor(SK_ColorRED);
+  builder.drawRect(SkRect::MakeWH(100, 100));
+  sk_sp<DisplayList> display_list = builder.Build();
+
+  auto result = cache.RasterizeDisplayList(display_list.get(), nullptr, matrix,
+                                           nullptr, false);
+  ASSERT_NE(result, nullptr);
+  EXPECT_EQ(cache.atlas().live_area(), 100 * 100);
+  EXPECT_EQ(DrawnColor(*result), SK_ColorRED);
+  result = nullptr;
+  EXPECT_EQ(cache.atlas().live_area(), 0);
+}
+
+}  // namespace testing
+}  // namespace flutter
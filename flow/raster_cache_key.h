@@ -5,6 +5,7 @@
 #ifndef FLUTTER_FLOW_RASTER_CACHE_KEY_H_
 #define FLUTTER_FLOW_RASTER_CACHE_KEY_H_
 
+#include <cmath>
 #include <unordered_map>
 
 #include "flutter/flow/matrix_decomposition.h"
@@ -15,9 +16,32 @@ namespace flutter {
 template <typename ID>
 class RasterCacheKey {
  public:
-  RasterCacheKey(ID id, const SkMatrix& ctm) : id_(id), matrix_(ctm) {
+  // A |scale_tolerance| greater than 0 buckets the scale of matrices that
+  // only scale and translate, see |BucketScale|, so that content drawn at
+  // nearby scales shares a key.
+  RasterCacheKey(ID id, const SkMatrix& ctm, SkScalar scale_tolerance = 0)
+      : id_(id), matrix_(ctm) {
     matrix_[SkMatrix::kMTransX] = 0;
     matrix_[SkMatrix::kMTransY] = 0;
+    if (scale_tolerance > 0 && matrix_.isScaleTranslate()) {
+      matrix_[SkMatrix::kMScaleX] =
+          BucketScale(matrix_.getScaleX(), scale_tolerance);
+      matrix_[SkMatrix::kMScaleY] =
+          BucketScale(matrix_.getScaleY(), scale_tolerance);
+    }
+  }
+
+  // Rounds |scale| to the nearest power of 1 + |tolerance|, so that all of
+  // the scales in a bucket are within a factor of about 1 + |tolerance| of
+  // each other.
+  static SkScalar BucketScale(SkScalar scale, SkScalar tolerance) {
+    if (scale == 0) {
+      return 0;
+    }
+    double step = std::log1p(tolerance);
+    double bucket = std::round(std::log(std::abs(scale)) / step);
+    return std::copysign(static_cast<SkScalar>(std::exp(bucket * step)),
+                         scale);
   }
 
   ID id() const { return id_; }
@@ -46,14 +70,16 @@ class RasterCacheKey {
   //   matrix_ = ctm;
   //   matrix_[SkMatrix::kMTransX] = SkScalarFraction(ctm.getTranslateX());
   //   matrix_[SkMatrix::kMTransY] = SkScalarFraction(ctm.getTranslateY());
+  // with the scale rounded to its bucket if a tolerance was given.
   SkMatrix matrix_;
 };
 
 // The ID is the uint32_t picture uniqueID
 using PictureRasterCacheKey = RasterCacheKey<uint32_t>;
 
-// The ID is the uint32_t DisplayList uniqueID
-using DisplayListRasterCacheKey = RasterCacheKey<uint32_t>;
+// The ID is the uint64_t DisplayList content_hash so that separately
+// recorded lists with the same content share their cache entries
+using DisplayListRasterCacheKey = RasterCacheKey<uint64_t>;
 
 class Layer;
 
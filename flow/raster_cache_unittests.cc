@@ -4,12 +4,16 @@
 
 #include "flutter/flow/raster_cache.h"
 
+#include <vector>
+
+#include "flutter/flow/raster_cache_atlas.h"
 #include "flutter/flow/testing/mock_raster_cache.h"
 #include "gtest/gtest.h"
 #include "third_party/skia/include/core/SkCanvas.h"
 #include "third_party/skia/include/core/SkPaint.h"
 #include "third_party/skia/include/core/SkPicture.h"
 #include "third_party/skia/include/core/SkPictureRecorder.h"
+#include "third_party/skia/include/core/SkSurface.h"
 
 namespace flutter {
 namespace testing {
@@ -25,6 +29,37 @@ sk_sp<SkPicture> GetSamplePicture() {
   return recorder.finishRecordingAsPicture();
 }
 
+sk_sp<DisplayList> GetSampleDisplayList(SkColor color = SK_ColorRED) {
+  DisplayListBuilder builder(SkRect::MakeWH(150, 100));
+  builder.setColor(color);
+  builder.drawRect(SkRect::MakeXYWH(10, 10, 80, 80));
+  return builder.Build();
+}
+
+// The bytes of the image that caches the sample picture at identity scale.
+constexpr size_t kSampleImageBytes = 150 * 100 * 4;
+
+// A task runner that runs its tasks when asked to.
+class ManualTaskRunner : public fml::BasicTaskRunner {
+ public:
+  void PostTask(fml::UniqueClosure task) override {
+    tasks_.push_back(std::move(task));
+  }
+
+  size_t pending_task_count() const { return tasks_.size(); }
+
+  void RunPendingTasks() {
+    std::vector<fml::UniqueClosure> tasks = std::move(tasks_);
+    tasks_.clear();
+    for (const fml::UniqueClosure& task : tasks) {
+      task();
+    }
+  }
+
+ private:
+  std::vector<fml::UniqueClosure> tasks_;
+};
+
 }  // namespace
 
 TEST(RasterCache, SimpleInitialization) {
@@ -103,7 +138,9 @@ TEST(RasterCache, PictureCacheLimitPerFrameIsRespectedWhenZero) {
 
 TEST(RasterCache, SweepsRemoveUnusedFrames) {
   size_t threshold = 1;
-  flutter::RasterCache cache(threshold);
+  flutter::RasterCache cache(
+      threshold, RasterCache::kDefaultPictureAndDispLayListCacheLimitPerFrame,
+      RasterCache::kDefaultMaxBytes, 0);
 
   SkMatrix matrix = SkMatrix::I();
 
@@ -129,6 +166,42 @@ TEST(RasterCache, SweepsRemoveUnusedFrames) {
   ASSERT_FALSE(cache.Draw(*picture, dummy_canvas));
 }
 
+TEST(RasterCache, DisplayListsWithTheSameContentShareEntries) {
+  size_t threshold = 1;
+  flutter::RasterCache cache(threshold);
+
+  SkMatrix matrix = SkMatrix::I();
+
+  SkCanvas dummy_canvas;
+
+  PrerollContextHolder preroll_context_holder = GetSamplePrerollContextHolder();
+
+  auto display_list = GetSampleDisplayList();
+  ASSERT_FALSE(cache.Prepare(&preroll_context_holder.preroll_context,
+                             display_list.get(), true, false, matrix));  // 1
+  ASSERT_FALSE(cache.Draw(*display_list, dummy_canvas));
+
+  cache.SweepAfterFrame();
+
+  // The same content recorded again for the next frame.
+  auto rerecorded_display_list = GetSampleDisplayList();
+  ASSERT_NE(display_list->unique_id(), rerecorded_display_list->unique_id());
+  ASSERT_TRUE(cache.Prepare(&preroll_context_holder.preroll_context,
+                            rerecorded_display_list.get(), true, false,
+                            matrix));  // 2
+  ASSERT_TRUE(cache.Draw(*rerecorded_display_list, dummy_canvas));
+  ASSERT_TRUE(cache.Draw(*display_list, dummy_canvas));
+  ASSERT_EQ(cache.GetCachedEntriesCount(), 1u);
+
+  cache.SweepAfterFrame();
+
+  // Different content does not find the entry.
+  auto other_display_list = GetSampleDisplayList(SK_ColorBLUE);
+  ASSERT_FALSE(cache.Prepare(&preroll_context_holder.preroll_context,
+                             other_display_list.get(), true, false, matrix));
+  ASSERT_FALSE(cache.Draw(*other_display_list, dummy_canvas));
+}
+
 // Construct a cache result whose device target rectangle rounds out to be one
 // pixel wider than the cached image.  Verify that it can be drawn without
 // triggering any assertions.
@@ -163,5 +236,593 @@ TEST(RasterCache, DeviceRectRoundOut) {
   ASSERT_TRUE(cache.Draw(*picture, canvas));
 }
 
+TEST(RasterCache, EntriesAreKeptForFramesToKeep) {
+  size_t threshold = 1;
+  int frames_to_keep = 2;
+  flutter::RasterCache cache(
+      threshold, RasterCache::kDefaultPictureAndDispLayListCacheLimitPerFrame,
+      RasterCache::kDefaultMaxBytes, frames_to_keep);
+
+  SkMatrix matrix = SkMatrix::I();
+
+  auto picture = GetSamplePicture();
+
+  SkCanvas dummy_canvas;
+
+  PrerollContextHolder preroll_context_holder = GetSamplePrerollContextHolder();
+
+  ASSERT_FALSE(cache.Prepare(&preroll_context_holder.preroll_context,
+                             picture.get(), true, false, matrix));
+  ASSERT_FALSE(cache.Draw(*picture, dummy_canvas));
+  cache.SweepAfterFrame();
+  ASSERT_TRUE(cache.Prepare(&preroll_context_holder.preroll_context,
+                            picture.get(), true, false, matrix));
+  ASSERT_TRUE(cache.Draw(*picture, dummy_canvas));
+  cache.SweepAfterFrame();
+
+  // The picture is not used for |frames_to_keep| frames.
+  for (int i = 0; i < frames_to_keep; i++) {
+    cache.SweepAfterFrame();
+    ASSERT_EQ(cache.GetPictureCachedEntriesCount(), 1u);
+  }
+  ASSERT_TRUE(cache.Draw(*picture, dummy_canvas));
+  cache.SweepAfterFrame();
+
+  for (int i = 0; i <= frames_to_keep; i++) {
+    cache.SweepAfterFrame();
+  }
+  ASSERT_EQ(cache.GetPictureCachedEntriesCount(), 0u);
+  ASSERT_FALSE(cache.Draw(*picture, dummy_canvas));
+}
+
+TEST(RasterCache, LeastRecentlyUsedImagesAreEvictedToStayInBudget) {
+  size_t threshold = 1;
+  flutter::RasterCache cache(
+      threshold, RasterCache::kDefaultPictureAndDispLayListCacheLimitPerFrame,
+      kSampleImageBytes * 3 / 2);
+
+  SkMatrix matrix = SkMatrix::I();
+
+  auto picture1 = GetSamplePicture();
+  auto picture2 = GetSamplePicture();
+
+  SkCanvas dummy_canvas;
+
+  PrerollContextHolder preroll_context_holder = GetSamplePrerollContextHolder();
+
+  ASSERT_FALSE(cache.Prepare(&preroll_context_holder.preroll_context,
+                             picture1.get(), true, false, matrix));
+  ASSERT_FALSE(cache.Draw(*picture1, dummy_canvas));
+  ASSERT_FALSE(cache.Prepare(&preroll_context_holder.preroll_context,
+                             picture2.get(), true, false, matrix));
+  ASSERT_FALSE(cache.Draw(*picture2, dummy_canvas));
+  cache.SweepAfterFrame();
+
+  ASSERT_TRUE(cache.Prepare(&preroll_context_holder.preroll_context,
+                            picture1.get(), true, false, matrix));
+  ASSERT_TRUE(cache.Draw(*picture1, dummy_canvas));
+  // The image of picture1 is in use in this frame, so there is no room.
+  ASSERT_FALSE(cache.Prepare(&preroll_context_holder.preroll_context,
+                             picture2.get(), true, false, matrix));
+  ASSERT_FALSE(cache.Draw(*picture2, dummy_canvas));
+  ASSERT_EQ(cache.EstimatePictureCacheByteSize(), kSampleImageBytes);
+  cache.SweepAfterFrame();
+
+  // picture1 was not used in this frame, so its image makes room.
+  ASSERT_TRUE(cache.Prepare(&preroll_context_holder.preroll_context,
+                            picture2.get(), true, false, matrix));
+  ASSERT_TRUE(cache.Draw(*picture2, dummy_canvas));
+  ASSERT_FALSE(cache.Draw(*picture1, dummy_canvas));
+  ASSERT_EQ(cache.EstimatePictureCacheByteSize(), kSampleImageBytes);
+}
+
+TEST(RasterCache, PreparedImagesAreNotEvictedBeforeTheyAreDrawn) {
+  size_t threshold = 1;
+  flutter::RasterCache cache(
+      threshold, RasterCache::kDefaultPictureAndDispLayListCacheLimitPerFrame,
+      kSampleImageBytes * 3 / 2);
+
+  SkMatrix matrix = SkMatrix::I();
+
+  auto picture1 = GetSamplePicture();
+  auto picture2 = GetSamplePicture();
+
+  SkCanvas dummy_canvas;
+
+  PrerollContextHolder preroll_context_holder = GetSamplePrerollContextHolder();
+
+  ASSERT_FALSE(cache.Prepare(&preroll_context_holder.preroll_context,
+                             picture1.get(), true, false, matrix));
+  ASSERT_FALSE(cache.Draw(*picture1, dummy_canvas));
+  ASSERT_FALSE(cache.Prepare(&preroll_context_holder.preroll_context,
+                             picture2.get(), true, false, matrix));
+  ASSERT_FALSE(cache.Draw(*picture2, dummy_canvas));
+  cache.SweepAfterFrame();
+
+  ASSERT_TRUE(cache.Prepare(&preroll_context_holder.preroll_context,
+                            picture1.get(), true, false, matrix));
+  ASSERT_TRUE(cache.Draw(*picture1, dummy_canvas));
+  cache.SweepAfterFrame();
+
+  // Both pictures are prepared before either is drawn, as in a Preroll.
+  ASSERT_TRUE(cache.Prepare(&preroll_context_holder.preroll_context,
+                            picture1.get(), true, false, matrix));
+  ASSERT_FALSE(cache.Prepare(&preroll_context_holder.preroll_context,
+                             picture2.get(), true, false, matrix));
+  ASSERT_TRUE(cache.Draw(*picture1, dummy_canvas));
+  ASSERT_FALSE(cache.Draw(*picture2, dummy_canvas));
+}
+
+TEST(RasterCache, ImagesThatSaveMoreWorkAreNotEvicted) {
+  size_t threshold = 1;
+  flutter::RasterCache cache(
+      threshold, RasterCache::kDefaultPictureAndDispLayListCacheLimitPerFrame,
+      kSampleImageBytes * 3 / 2);
+
+  SkMatrix matrix = SkMatrix::I();
+
+  // A display list that covers the same area as the picture with many more
+  // ops.
+  DisplayListBuilder builder(SkRect::MakeWH(150, 100));
+  for (int i = 0; i < 50; i++) {
+    builder.drawRect(SkRect::MakeWH(150, 100));
+  }
+  auto display_list = builder.Build();
+  auto picture = GetSamplePicture();
+
+  SkCanvas dummy_canvas;
+
+  PrerollContextHolder preroll_context_holder = GetSamplePrerollContextHolder();
+
+  ASSERT_FALSE(cache.Prepare(&preroll_context_holder.preroll_context,
+                             display_list.get(), true, false, matrix));
+  ASSERT_FALSE(cache.Draw(*display_list, dummy_canvas));
+  ASSERT_FALSE(cache.Prepare(&preroll_context_holder.preroll_context,
+                             picture.get(), true, false, matrix));
+  ASSERT_FALSE(cache.Draw(*picture, dummy_canvas));
+  cache.SweepAfterFrame();
+
+  ASSERT_TRUE(cache.Prepare(&preroll_context_holder.preroll_context,
+                            display_list.get(), true, false, matrix));
+  ASSERT_TRUE(cache.Draw(*display_list, dummy_canvas));
+  cache.SweepAfterFrame();
+
+  // The display list was not used in this frame, but its image saves more
+  // ops per byte than the image of the picture would.
+  ASSERT_FALSE(cache.Prepare(&preroll_context_holder.preroll_context,
+                             picture.get(), true, false, matrix));
+  ASSERT_FALSE(cache.Draw(*picture, dummy_canvas));
+  ASSERT_TRUE(cache.Draw(*display_list, dummy_canvas));
+}
+
+TEST(RasterCache, ImagesMustBeWorthTheirBytes) {
+  size_t threshold = 1;
+  flutter::RasterCache cache(threshold);
+
+  // 6 ops are enough to be worth rasterizing, but not at this size.
+  DisplayListBuilder builder(SkRect::MakeWH(1000, 1000));
+  for (int i = 0; i < 6; i++) {
+    builder.drawRect(SkRect::MakeWH(1000, 1000));
+  }
+  auto display_list = builder.Build();
+  ASSERT_GT(1000u * 1000 * 4,
+            display_list->op_count() * RasterCache::kMaxBytesPerCachedOp);
+
+  SkMatrix matrix = SkMatrix::I();
+
+  SkCanvas dummy_canvas;
+
+  PrerollContextHolder preroll_context_holder = GetSamplePrerollContextHolder();
+
+  ASSERT_FALSE(cache.Prepare(&preroll_context_holder.preroll_context,
+                             display_list.get(), false, false, matrix));
+  ASSERT_FALSE(cache.Draw(*display_list, dummy_canvas));
+  cache.SweepAfterFrame();
+  ASSERT_FALSE(cache.Prepare(&preroll_context_holder.preroll_context,
+                             display_list.get(), false, false, matrix));
+  ASSERT_FALSE(cache.Draw(*display_list, dummy_canvas));
+
+  // Unless the caller knows better.
+  ASSERT_TRUE(cache.Prepare(&preroll_context_holder.preroll_context,
+                            display_list.get(), true, false, matrix));
+  ASSERT_TRUE(cache.Draw(*display_list, dummy_canvas));
+}
+
+TEST(RasterCache, LoweringMaxBytesEvictsImages) {
+  size_t threshold = 1;
+  flutter::RasterCache cache(threshold);
+
+  SkMatrix matrix = SkMatrix::I();
+
+  auto picture = GetSamplePicture();
+
+  SkCanvas dummy_canvas;
+
+  PrerollContextHolder preroll_context_holder = GetSamplePrerollContextHolder();
+
+  ASSERT_FALSE(cache.Prepare(&preroll_context_holder.preroll_context,
+                             picture.get(), true, false, matrix));
+  ASSERT_FALSE(cache.Draw(*picture, dummy_canvas));
+  cache.SweepAfterFrame();
+  ASSERT_TRUE(cache.Prepare(&preroll_context_holder.preroll_context,
+                            picture.get(), true, false, matrix));
+  ASSERT_TRUE(cache.Draw(*picture, dummy_canvas));
+  ASSERT_EQ(cache.EstimatePictureCacheByteSize(), kSampleImageBytes);
+
+  cache.SetMaxBytes(kSampleImageBytes / 2);
+  cache.SweepAfterFrame();
+  ASSERT_EQ(cache.EstimatePictureCacheByteSize(), 0u);
+  ASSERT_FALSE(cache.Draw(*picture, dummy_canvas));
+}
+
+TEST(RasterCache, AtlasPagesCountTowardsMaxBytes) {
+  size_t threshold = 1;
+  flutter::RasterCache cache(
+      threshold, RasterCache::kDefaultPictureAndDispLayListCacheLimitPerFrame,
+      RasterCacheAtlas::PageBytes() + kSampleImageBytes);
+
+  SkMatrix matrix = SkMatrix::I();
+
+  auto picture1 = GetSamplePicture();
+  auto picture2 = GetSamplePicture();
+
+  SkCanvas dummy_canvas;
+
+  PrerollContextHolder preroll_context_holder = GetSamplePrerollContextHolder();
+
+  for (int i = 0; i < 2; i++) {
+    for (const auto& picture : {picture1, picture2}) {
+      ASSERT_EQ(cache.Prepare(&preroll_context_holder.preroll_context,
+                              picture.get(), true, false, matrix),
+                i > 0);
+      ASSERT_EQ(cache.Draw(*picture, dummy_canvas), i > 0);
+    }
+    cache.SweepAfterFrame();
+  }
+  // Both images fit into the page that is charged to the budget.
+  ASSERT_EQ(cache.atlas().page_count(), 1u);
+  ASSERT_EQ(cache.EstimatePictureCacheByteSize(), 2 * kSampleImageBytes);
+
+  // The page is only freed along with all of its images.
+  ASSERT_TRUE(cache.Draw(*picture1, dummy_canvas));
+  cache.SetMaxBytes(RasterCacheAtlas::PageBytes() - 1);
+  cache.SweepAfterFrame();
+  ASSERT_EQ(cache.atlas().page_count(), 0u);
+  ASSERT_EQ(cache.EstimatePictureCacheByteSize(), 0u);
+
+  // Without room for a page, images get memory of their own.
+  ASSERT_TRUE(cache.Prepare(&preroll_context_holder.preroll_context,
+                            picture1.get(), true, false, matrix));
+  ASSERT_TRUE(cache.Draw(*picture1, dummy_canvas));
+  ASSERT_EQ(cache.atlas().page_count(), 0u);
+  ASSERT_EQ(cache.EstimatePictureCacheByteSize(), kSampleImageBytes);
+}
+
+TEST(RasterCache, ImagesAreRasterizedInTheBackground) {
+  size_t threshold = 1;
+  flutter::RasterCache cache(threshold);
+  auto task_runner = std::make_shared<ManualTaskRunner>();
+  cache.SetBackgroundTaskRunner(task_runner);
+
+  SkMatrix matrix = SkMatrix::I();
+
+  auto picture = GetSamplePicture();
+  auto display_list = GetSampleDisplayList();
+
+  SkCanvas dummy_canvas;
+
+  PrerollContextHolder preroll_context_holder = GetSamplePrerollContextHolder();
+
+  ASSERT_FALSE(cache.Prepare(&preroll_context_holder.preroll_context,
+                             picture.get(), true, false, matrix));
+  ASSERT_FALSE(cache.Draw(*picture, dummy_canvas));
+  ASSERT_FALSE(cache.Prepare(&preroll_context_holder.preroll_context,
+                             display_list.get(), true, false, matrix));
+  ASSERT_FALSE(cache.Draw(*display_list, dummy_canvas));
+  cache.SweepAfterFrame();
+
+  // The images are not available until the background tasks are done.
+  ASSERT_FALSE(cache.Prepare(&preroll_context_holder.preroll_context,
+                             picture.get(), true, false, matrix));
+  ASSERT_FALSE(cache.Draw(*picture, dummy_canvas));
+  ASSERT_FALSE(cache.Prepare(&preroll_context_holder.preroll_context,
+                             display_list.get(), true, false, matrix));
+  ASSERT_FALSE(cache.Draw(*display_list, dummy_canvas));
+  ASSERT_EQ(task_runner->pending_task_count(), 2u);
+  ASSERT_EQ(cache.EstimatePictureCacheByteSize(), 0u);
+  cache.SweepAfterFrame();
+
+  // Pending images are not rasterized again.
+  ASSERT_FALSE(cache.Prepare(&preroll_context_holder.preroll_context,
+                             picture.get(), true, false, matrix));
+  ASSERT_EQ(task_runner->pending_task_count(), 2u);
+
+  task_runner->RunPendingTasks();
+  ASSERT_TRUE(cache.Prepare(&preroll_context_holder.preroll_context,
+                            picture.get(), true, false, matrix));
+  ASSERT_TRUE(cache.Draw(*picture, dummy_canvas));
+  ASSERT_TRUE(cache.Draw(*display_list, dummy_canvas));
+  ASSERT_GT(cache.EstimatePictureCacheByteSize(), kSampleImageBytes);
+}
+
+TEST(RasterCache, PendingImagesCountTowardsMaxBytes) {
+  size_t threshold = 1;
+  flutter::RasterCache cache(
+      threshold, RasterCache::kDefaultPictureAndDispLayListCacheLimitPerFrame,
+      kSampleImageBytes * 3 / 2);
+  auto task_runner = std::make_shared<ManualTaskRunner>();
+  cache.SetBackgroundTaskRunner(task_runner);
+
+  SkMatrix matrix = SkMatrix::I();
+
+  auto picture1 = GetSamplePicture();
+  auto picture2 = GetSamplePicture();
+
+  SkCanvas dummy_canvas;
+
+  PrerollContextHolder preroll_context_holder = GetSamplePrerollContextHolder();
+
+  ASSERT_FALSE(cache.Prepare(&preroll_context_holder.preroll_context,
+                             picture1.get(), true, false, matrix));
+  ASSERT_FALSE(cache.Draw(*picture1, dummy_canvas));
+  ASSERT_FALSE(cache.Prepare(&preroll_context_holder.preroll_context,
+                             picture2.get(), true, false, matrix));
+  ASSERT_FALSE(cache.Draw(*picture2, dummy_canvas));
+  cache.SweepAfterFrame();
+
+  ASSERT_FALSE(cache.Prepare(&preroll_context_holder.preroll_context,
+                             picture1.get(), true, false, matrix));
+  ASSERT_FALSE(cache.Prepare(&preroll_context_holder.preroll_context,
+                             picture2.get(), true, false, matrix));
+  ASSERT_EQ(task_runner->pending_task_count(), 1u);
+}
+
+TEST(RasterCache, ScalesAreBucketedByTolerance) {
+  EXPECT_EQ(PictureRasterCacheKey::BucketScale(1.0f, 0.1f), 1.0f);
+  EXPECT_EQ(PictureRasterCacheKey::BucketScale(1.04f, 0.1f), 1.0f);
+  EXPECT_FLOAT_EQ(PictureRasterCacheKey::BucketScale(1.1f, 0.1f), 1.1f);
+  EXPECT_FLOAT_EQ(PictureRasterCacheKey::BucketScale(-1.1f, 0.1f), -1.1f);
+  EXPECT_EQ(PictureRasterCacheKey::BucketScale(0, 0.1f), 0);
+
+  PictureRasterCacheKey key(1, SkMatrix::Scale(1.0f, 1.0f), 0.1f);
+  PictureRasterCacheKey nearby_key(1, SkMatrix::Scale(1.04f, 1.04f), 0.1f);
+  PictureRasterCacheKey far_key(1, SkMatrix::Scale(1.2f, 1.2f), 0.1f);
+  PictureRasterCacheKey exact_key(1, SkMatrix::Scale(1.04f, 1.04f));
+  PictureRasterCacheKey::Equal equal;
+  EXPECT_TRUE(equal(key, nearby_key));
+  EXPECT_FALSE(equal(key, far_key));
+  EXPECT_FALSE(equal(key, exact_key));
+
+  // Matrices that do more than scale and translate are not bucketed.
+  SkMatrix rotation = SkMatrix::RotateDeg(45);
+  SkMatrix nearby_rotation = SkMatrix::RotateDeg(45);
+  nearby_rotation.postScale(1.04f, 1.04f);
+  EXPECT_FALSE(equal(PictureRasterCacheKey(1, rotation, 0.1f),
+                     PictureRasterCacheKey(1, nearby_rotation, 0.1f)));
+}
+
+TEST(RasterCache, ImagesAreDrawnAtNearbyScales) {
+  size_t threshold = 1;
+  flutter::RasterCache cache(threshold);
+
+  SkMatrix matrix = SkMatrix::I();
+  SkMatrix nearby_matrix = SkMatrix::Scale(1.04f, 1.04f);
+  SkMatrix far_matrix = SkMatrix::Scale(1.2f, 1.2f);
+
+  auto picture = GetSamplePicture();
+
+  PrerollContextHolder preroll_context_holder = GetSamplePrerollContextHolder();
+
+  sk_sp<SkSurface> surface = SkSurface::MakeRasterN32Premul(200, 200);
+  SkCanvas& canvas = *surface->getCanvas();
+
+  ASSERT_FALSE(cache.Prepare(&preroll_context_holder.preroll_context,
+                             picture.get(), true, false, matrix));
+  ASSERT_FALSE(cache.Draw(*picture, canvas));
+  cache.SweepAfterFrame();
+  ASSERT_TRUE(cache.Prepare(&preroll_context_holder.preroll_context,
+                            picture.get(), true, false, matrix));
+  ASSERT_TRUE(cache.Draw(*picture, canvas));
+
+  canvas.setMatrix(nearby_matrix);
+  ASSERT_TRUE(cache.Draw(*picture, canvas));
+  canvas.setMatrix(far_matrix);
+  ASSERT_FALSE(cache.Draw(*picture, canvas));
+
+  cache.SetScaleTolerance(0);
+  canvas.setMatrix(nearby_matrix);
+  ASSERT_FALSE(cache.Draw(*picture, canvas));
+}
+
+TEST(RasterCache, ImagesAreRasterizedAgainOnceTheScaleIsStable) {
+  size_t threshold = 1;
+  flutter::RasterCache cache(threshold);
+
+  SkMatrix matrix = SkMatrix::I();
+  SkMatrix nearby_matrix = SkMatrix::Scale(1.04f, 1.04f);
+
+  auto picture = GetSamplePicture();
+
+  SkCanvas dummy_canvas;
+
+  PrerollContextHolder preroll_context_holder = GetSamplePrerollContextHolder();
+
+  ASSERT_FALSE(cache.Prepare(&preroll_context_holder.preroll_context,
+                             picture.get(), true, false, matrix));
+  ASSERT_FALSE(cache.Draw(*picture, dummy_canvas));
+  cache.SweepAfterFrame();
+  ASSERT_TRUE(cache.Prepare(&preroll_context_holder.preroll_context,
+                            picture.get(), true, false, matrix));
+  ASSERT_TRUE(cache.Draw(*picture, dummy_canvas));
+  ASSERT_EQ(cache.EstimatePictureCacheByteSize(), kSampleImageBytes);
+  cache.SweepAfterFrame();
+
+  // The image that was rasterized at the identity scale is used for the
+  // first frame at the nearby scale.
+  dummy_canvas.setMatrix(nearby_matrix);
+  ASSERT_TRUE(cache.Prepare(&preroll_context_holder.preroll_context,
+                            picture.get(), true, false, nearby_matrix));
+  ASSERT_TRUE(cache.Draw(*picture, dummy_canvas));
+  ASSERT_EQ(cache.EstimatePictureCacheByteSize(), kSampleImageBytes);
+  cache.SweepAfterFrame();
+
+  // Then it is rasterized again at the nearby scale.
+  ASSERT_TRUE(cache.Prepare(&preroll_context_holder.preroll_context,
+                            picture.get(), true, false, nearby_matrix));
+  ASSERT_TRUE(cache.Draw(*picture, dummy_canvas));
+  ASSERT_GT(cache.EstimatePictureCacheByteSize(), kSampleImageBytes);
+  ASSERT_EQ(cache.GetPictureCachedEntriesCount(), 1u);
+}
+
+TEST(RasterCache, ImagesAtOtherScalesAreKeptWithoutRoomToRasterizeAgain) {
+  size_t threshold = 1;
+  flutter::RasterCache cache(
+      threshold, RasterCache::kDefaultPictureAndDispLayListCacheLimitPerFrame,
+      kSampleImageBytes * 3 / 2);
+
+  SkMatrix matrix = SkMatrix::I();
+  SkMatrix nearby_matrix = SkMatrix::Scale(1.04f, 1.04f);
+
+  auto picture = GetSamplePicture();
+
+  SkCanvas dummy_canvas;
+
+  PrerollContextHolder preroll_context_holder = GetSamplePrerollContextHolder();
+
+  ASSERT_FALSE(cache.Prepare(&preroll_context_holder.preroll_context,
+                             picture.get(), true, false, matrix));
+  ASSERT_FALSE(cache.Draw(*picture, dummy_canvas));
+  cache.SweepAfterFrame();
+  ASSERT_TRUE(cache.Prepare(&preroll_context_holder.preroll_context,
+                            picture.get(), true, false, matrix));
+  ASSERT_TRUE(cache.Draw(*picture, dummy_canvas));
+  cache.SweepAfterFrame();
+
+  // Both images do not fit, so the one at the identity scale keeps being
+  // drawn at the nearby scale.
+  dummy_canvas.setMatrix(nearby_matrix);
+  for (int i = 0; i < 3; i++) {
+    ASSERT_TRUE(cache.Prepare(&preroll_context_holder.preroll_context,
+                              picture.get(), true, false, nearby_matrix));
+    ASSERT_TRUE(cache.Draw(*picture, dummy_canvas));
+    ASSERT_EQ(cache.EstimatePictureCacheByteSize(), kSampleImageBytes);
+    cache.SweepAfterFrame();
+  }
+}
+
+TEST(RasterCache, FrameReportsAttributeHitsAndMisses) {
+  size_t threshold = 1;
+  flutter::RasterCache cache(threshold);
+
+  SkMatrix matrix = SkMatrix::I();
+
+  auto picture = GetSamplePicture();
+
+  SkCanvas dummy_canvas;
+
+  PrerollContextHolder preroll_context_holder = GetSamplePrerollContextHolder();
+
+  ASSERT_FALSE(cache.Prepare(&preroll_context_holder.preroll_context,
+                             picture.get(), true, false, matrix));
+  ASSERT_FALSE(cache.Draw(*picture, dummy_canvas));
+  ASSERT_EQ(cache.current_frame_report().misses, 1u);
+  cache.SweepAfterFrame();
+
+  const RasterCacheFrameReport& miss_report = cache.last_frame_report();
+  ASSERT_EQ(miss_report.frame, 0);
+  ASSERT_EQ(miss_report.hits, 0u);
+  ASSERT_EQ(miss_report.misses, 1u);
+  ASSERT_EQ(miss_report.entries.size(), 1u);
+  ASSERT_EQ(miss_report.entries[0].source,
+            RasterCacheEntryReport::Source::kPicture);
+  ASSERT_EQ(miss_report.entries[0].id, picture->uniqueID());
+  ASSERT_EQ(miss_report.entries[0].misses, 1u);
+  ASSERT_EQ(miss_report.entries[0].bytes, 0u);
+  ASSERT_EQ(cache.current_frame_report().misses, 0u);
+
+  ASSERT_TRUE(cache.Prepare(&preroll_context_holder.preroll_context,
+                            picture.get(), true, false, matrix));
+  ASSERT_TRUE(cache.Draw(*picture, dummy_canvas));
+  ASSERT_TRUE(cache.Draw(*picture, dummy_canvas));
+  cache.SweepAfterFrame();
+
+  const RasterCacheFrameReport& hit_report = cache.last_frame_report();
+  ASSERT_EQ(hit_report.frame, 1);
+  ASSERT_EQ(hit_report.hits, 2u);
+  ASSERT_EQ(hit_report.misses, 0u);
+  ASSERT_EQ(hit_report.entries.size(), 1u);
+  ASSERT_EQ(hit_report.entries[0].hits, 2u);
+  ASSERT_EQ(hit_report.entries[0].bytes, kSampleImageBytes);
+  ASSERT_EQ(hit_report.entries[0].rasterization_time,
+            hit_report.rasterization_time);
+  ASSERT_EQ(hit_report.entries[0].eviction_reason,
+            RasterCacheEntryReport::EvictionReason::kNone);
+
+  // Entries that are kept without being used are not reported.
+  cache.SweepAfterFrame();
+  ASSERT_TRUE(cache.last_frame_report().entries.empty());
+}
+
+TEST(RasterCache, FrameReportsRecordEvictionReasons) {
+  size_t threshold = 1;
+  int frames_to_keep = 0;
+  flutter::RasterCache cache(
+      threshold, RasterCache::kDefaultPictureAndDispLayListCacheLimitPerFrame,
+      RasterCache::kDefaultMaxBytes, frames_to_keep);
+
+  SkMatrix matrix = SkMatrix::I();
+
+  auto picture1 = GetSamplePicture();
+  auto picture2 = GetSamplePicture();
+
+  SkCanvas dummy_canvas;
+
+  PrerollContextHolder preroll_context_holder = GetSamplePrerollContextHolder();
+
+  for (int i = 0; i < 2; i++) {
+    cache.Prepare(&preroll_context_holder.preroll_context, picture1.get(),
+                  true, false, matrix);
+    cache.Draw(*picture1, dummy_canvas);
+    cache.Prepare(&preroll_context_holder.preroll_context, picture2.get(),
+                  true, false, matrix);
+    cache.Draw(*picture2, dummy_canvas);
+    cache.SweepAfterFrame();
+  }
+  ASSERT_EQ(cache.EstimatePictureCacheByteSize(), 2 * kSampleImageBytes);
+
+  // picture1 is not used in this frame, so its entry is removed.
+  ASSERT_TRUE(cache.Draw(*picture2, dummy_canvas));
+  cache.SweepAfterFrame();
+
+  const RasterCacheFrameReport& unused_report = cache.last_frame_report();
+  ASSERT_EQ(unused_report.entries.size(), 2u);
+  for (const RasterCacheEntryReport& entry : unused_report.entries) {
+    if (entry.id == picture1->uniqueID()) {
+      ASSERT_EQ(entry.eviction_reason,
+                RasterCacheEntryReport::EvictionReason::kUnused);
+      ASSERT_EQ(entry.bytes, kSampleImageBytes);
+    } else {
+      ASSERT_EQ(entry.id, picture2->uniqueID());
+      ASSERT_EQ(entry.eviction_reason,
+                RasterCacheEntryReport::EvictionReason::kNone);
+    }
+  }
+
+  // The image of picture2 is evicted at the end of this frame, which is
+  // reported with the next frame.
+  ASSERT_TRUE(cache.Draw(*picture2, dummy_canvas));
+  cache.SetMaxBytes(0);
+  cache.SweepAfterFrame();
+  ASSERT_EQ(cache.EstimatePictureCacheByteSize(), 0u);
+  cache.SweepAfterFrame();
+
+  const RasterCacheFrameReport& budget_report = cache.last_frame_report();
+  ASSERT_EQ(budget_report.entries.size(), 1u);
+  ASSERT_EQ(budget_report.entries[0].id, picture2->uniqueID());
+  ASSERT_EQ(budget_report.entries[0].eviction_reason,
+            RasterCacheEntryReport::EvictionReason::kBudget);
+  ASSERT_EQ(budget_report.entries[0].bytes, kSampleImageBytes);
+}
+
 }  // namespace testing
 }  // namespace flutter
@@ -57,6 +57,45 @@ sk_sp<SkSurface> SurfaceFrame::SkiaSurface() const {
   return surface_;
 }
 
+DamageHistory::DamageHistory() = default;
+
+DamageHistory::~DamageHistory() = default;
+
+void DamageHistory::AddFrameDamage(const SkISize& frame_size,
+                                   const std::optional<SkIRect>& frame_damage) {
+  if (frame_size != frame_size_) {
+    Reset();
+    frame_size_ = frame_size;
+  }
+  frame_damage_.push_back(frame_damage.value_or(SkIRect::MakeSize(frame_size)));
+  if (frame_damage_.size() > kMaxHistorySize) {
+    frame_damage_.pop_front();
+  }
+}
+
+std::optional<SkIRect> DamageHistory::GetExistingDamage(
+    const SkISize& frame_size,
+    size_t buffer_age) const {
+  // A framebuffer that holds the last frame misses no changes, older ones
+  // miss the changes of every frame submitted after them. Framebuffers that
+  // were painted before the oldest recorded frame are unknown.
+  if (buffer_age == 0 || buffer_age > frame_damage_.size() ||
+      frame_size != frame_size_) {
+    return std::nullopt;
+  }
+  SkIRect existing_damage = SkIRect::MakeEmpty();
+  for (auto it = frame_damage_.rbegin();
+       it != frame_damage_.rbegin() + (buffer_age - 1); ++it) {
+    existing_damage.join(*it);
+  }
+  return existing_damage;
+}
+
+void DamageHistory::Reset() {
+  frame_size_ = SkISize::MakeEmpty();
+  frame_damage_.clear();
+}
+
 bool SurfaceFrame::PerformSubmit() {
   if (submit_callback_ == nullptr) {
     return false;
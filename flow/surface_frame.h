@@ -5,7 +5,9 @@
 #ifndef FLUTTER_FLOW_SURFACE_FRAME_H_
 #define FLUTTER_FLOW_SURFACE_FRAME_H_
 
+#include <deque>
 #include <memory>
+#include <optional>
 
 #include "flutter/common/graphics/gl_context_switch.h"
 #include "flutter/fml/macros.h"
@@ -21,6 +23,32 @@ class SurfaceFrame {
   using SubmitCallback =
       std::function<bool(const SurfaceFrame& surface_frame, SkCanvas* canvas)>;
 
+  // Information about the underlying framebuffer, which the surface fills in
+  // when it acquires the frame.
+  struct FramebufferInfo {
+    // Whether the surface keeps the content of the framebuffer between
+    // frames, so that only the damaged part of a frame needs to be painted.
+    bool supports_partial_repaint = false;
+
+    // The number of frames that were submitted since the framebuffer was
+    // last painted, which is 1 if it holds the last submitted frame. 0 if
+    // the content of the framebuffer is unknown and the whole frame must be
+    // painted.
+    size_t buffer_age = 0;
+  };
+
+  // Information about the painted frame, which the rasterizer fills in
+  // before the frame is submitted.
+  struct SubmitInfo {
+    // The area of the frame that changed since the last frame. Unset if the
+    // whole frame changed.
+    std::optional<SkIRect> frame_damage;
+
+    // The area of the framebuffer that was painted. Unset if the whole
+    // framebuffer was painted.
+    std::optional<SkIRect> buffer_damage;
+  };
+
   SurfaceFrame(sk_sp<SkSurface> surface,
                bool supports_readback,
                const SubmitCallback& submit_callback);
@@ -42,10 +70,22 @@ class SurfaceFrame {
 
   bool supports_readback() { return supports_readback_; }
 
+  void set_framebuffer_info(const FramebufferInfo& framebuffer_info) {
+    framebuffer_info_ = framebuffer_info;
+  }
+  const FramebufferInfo& framebuffer_info() const { return framebuffer_info_; }
+
+  void set_submit_info(const SubmitInfo& submit_info) {
+    submit_info_ = submit_info;
+  }
+  const SubmitInfo& submit_info() const { return submit_info_; }
+
  private:
   bool submitted_ = false;
   sk_sp<SkSurface> surface_;
   bool supports_readback_;
+  FramebufferInfo framebuffer_info_;
+  SubmitInfo submit_info_;
   SubmitCallback submit_callback_;
   std::unique_ptr<GLContextResult> context_result_;
 
@@ -54,6 +94,42 @@ class SurfaceFrame {
   FML_DISALLOW_COPY_AND_ASSIGN(SurfaceFrame);
 };
 
+// Keeps the damage of the last frames that were submitted to a surface, which
+// is needed to repaint framebuffers that are older than the last frame.
+// Surfaces that cycle through several framebuffers hand out framebuffers that
+// miss the changes of all frames submitted since they were last painted.
+class DamageHistory {
+ public:
+  // The maximum number of frames whose damage is kept.
+  static constexpr size_t kMaxHistorySize = 10;
+
+  DamageHistory();
+
+  ~DamageHistory();
+
+  // Records the damage of a frame of |frame_size| that was submitted. Unset
+  // damage means that the whole frame changed.
+  void AddFrameDamage(const SkISize& frame_size,
+                      const std::optional<SkIRect>& frame_damage);
+
+  // Returns the area of a framebuffer of |buffer_age| whose content differs
+  // from the last submitted frame, or an unset value if the content of the
+  // framebuffer is unknown. See |SurfaceFrame::FramebufferInfo::buffer_age|.
+  std::optional<SkIRect> GetExistingDamage(const SkISize& frame_size,
+                                           size_t buffer_age) const;
+
+  // Forgets all frames, after which only framebuffers that are painted later
+  // on can be repainted partially.
+  void Reset();
+
+ private:
+  SkISize frame_size_ = SkISize::MakeEmpty();
+  // The damage of the submitted frames, the last frame at the back.
+  std::deque<SkIRect> frame_damage_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(DamageHistory);
+};
+
 }  // namespace flutter
 
 #endif  // FLUTTER_FLOW_SURFACE_FRAME_H_
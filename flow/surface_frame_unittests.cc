@@ -0,0 +1,78 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/flow/surface_frame.h"
+
+#include "gtest/gtest.h"
+
+namespace flutter {
+namespace testing {
+
+static const SkISize kFrameSize = SkISize::Make(100, 100);
+
+TEST(DamageHistoryTest, NewBuffersAreUnknown) {
+  DamageHistory history;
+  EXPECT_EQ(history.GetExistingDamage(kFrameSize, 0), std::nullopt);
+  EXPECT_EQ(history.GetExistingDamage(kFrameSize, 1), std::nullopt);
+
+  history.AddFrameDamage(kFrameSize, SkIRect::MakeXYWH(0, 0, 10, 10));
+  EXPECT_EQ(history.GetExistingDamage(kFrameSize, 0), std::nullopt);
+  EXPECT_EQ(history.GetExistingDamage(kFrameSize, 1), SkIRect::MakeEmpty());
+}
+
+TEST(DamageHistoryTest, OlderBuffersMissTheDamageOfLaterFrames) {
+  DamageHistory history;
+  history.AddFrameDamage(kFrameSize, SkIRect::MakeXYWH(0, 0, 10, 10));
+  history.AddFrameDamage(kFrameSize, SkIRect::MakeXYWH(20, 20, 10, 10));
+  history.AddFrameDamage(kFrameSize, SkIRect::MakeXYWH(40, 40, 10, 10));
+
+  EXPECT_EQ(history.GetExistingDamage(kFrameSize, 1), SkIRect::MakeEmpty());
+  EXPECT_EQ(history.GetExistingDamage(kFrameSize, 2),
+            SkIRect::MakeXYWH(40, 40, 10, 10));
+  EXPECT_EQ(history.GetExistingDamage(kFrameSize, 3),
+            SkIRect::MakeLTRB(20, 20, 50, 50));
+  // The buffer was painted before the first recorded frame.
+  EXPECT_EQ(history.GetExistingDamage(kFrameSize, 4), std::nullopt);
+}
+
+TEST(DamageHistoryTest, FullyDamagedFramesDamageTheWholeBuffer) {
+  DamageHistory history;
+  history.AddFrameDamage(kFrameSize, SkIRect::MakeXYWH(0, 0, 10, 10));
+  history.AddFrameDamage(kFrameSize, std::nullopt);
+  EXPECT_EQ(history.GetExistingDamage(kFrameSize, 2),
+            SkIRect::MakeSize(kFrameSize));
+}
+
+TEST(DamageHistoryTest, ResizingOrResettingForgetsFrames) {
+  DamageHistory history;
+  history.AddFrameDamage(kFrameSize, SkIRect::MakeXYWH(0, 0, 10, 10));
+  EXPECT_EQ(history.GetExistingDamage(SkISize::Make(50, 50), 1),
+            std::nullopt);
+
+  history.AddFrameDamage(SkISize::Make(50, 50), SkIRect::MakeEmpty());
+  EXPECT_EQ(history.GetExistingDamage(SkISize::Make(50, 50), 1),
+            SkIRect::MakeEmpty());
+  EXPECT_EQ(history.GetExistingDamage(SkISize::Make(50, 50), 2),
+            std::nullopt);
+
+  history.Reset();
+  EXPECT_EQ(history.GetExistingDamage(SkISize::Make(50, 50), 1),
+            std::nullopt);
+}
+
+TEST(DamageHistoryTest, HistoryIsLimited) {
+  DamageHistory history;
+  for (size_t i = 0; i < DamageHistory::kMaxHistorySize + 1; i++) {
+    history.AddFrameDamage(kFrameSize, SkIRect::MakeEmpty());
+  }
+  EXPECT_EQ(history.GetExistingDamage(kFrameSize,
+                                      DamageHistory::kMaxHistorySize),
+            SkIRect::MakeEmpty());
+  EXPECT_EQ(history.GetExistingDamage(kFrameSize,
+                                      DamageHistory::kMaxHistorySize + 1),
+            std::nullopt);
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -7,8 +7,6 @@
 namespace flutter {
 namespace testing {
 
-#ifdef FLUTTER_ENABLE_DIFF_CONTEXT
-
 DiffContextTest::DiffContextTest()
     : unref_queue_(fml::MakeRefCounted<SkiaUnrefQueue>(
           GetCurrentTaskRunner(),
@@ -66,7 +64,5 @@ std::shared_ptr<ContainerLayer> DiffContextTest::CreateContainerLayer(
   return res;
 }
 
-#endif  // FLUTTER_ENABLE_DIFF_CONTEXT
-
 }  // namespace testing
 }  // namespace flutter
@@ -12,8 +12,6 @@
 namespace flutter {
 namespace testing {
 
-#ifdef FLUTTER_ENABLE_DIFF_CONTEXT
-
 class MockLayerTree {
  public:
   explicit MockLayerTree(SkISize size = SkISize::Make(1000, 1000))
@@ -71,7 +69,5 @@ class DiffContextTest : public ThreadTest {
   fml::RefPtr<SkiaUnrefQueue> unref_queue_;
 };
 
-#endif  // FLUTTER_ENABLE_DIFF_CONTEXT
-
 }  // namespace testing
 }  // namespace flutter
@@ -16,8 +16,6 @@ MockLayer::MockLayer(SkPath path,
       fake_has_platform_view_(fake_has_platform_view),
       fake_reads_surface_(fake_reads_surface) {}
 
-#ifdef FLUTTER_ENABLE_DIFF_CONTEXT
-
 bool MockLayer::IsReplacing(DiffContext* context, const Layer* layer) const {
   // Similar to PictureLayer, only return true for identical mock layers;
   // That way ContainerLayer::DiffChildren can properly detect mock layer
@@ -33,13 +31,15 @@ void MockLayer::Diff(DiffContext* context, const Layer* old_layer) {
   context->SetLayerPaintRegion(this, context->CurrentSubtreeRegion());
 }
 
-#endif
-
 void MockLayer::Preroll(PrerollContext* context, const SkMatrix& matrix) {
   parent_mutators_ = context->mutators_stack;
   parent_matrix_ = matrix;
   parent_cull_rect_ = context->cull_rect;
   parent_has_platform_view_ = context->has_platform_view;
+  // A fake platform view is prerolled every frame like a real one.
+  if (fake_has_platform_view_ || !fake_preroll_can_be_reused_) {
+    context->preroll_can_be_reused = false;
+  }
 
   context->has_platform_view = fake_has_platform_view_;
   set_paint_bounds(fake_paint_path_.getBounds());
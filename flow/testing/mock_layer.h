@@ -29,13 +29,21 @@ class MockLayer : public Layer {
   const SkRect& parent_cull_rect() { return parent_cull_rect_; }
   bool parent_has_platform_view() { return parent_has_platform_view_; }
 
-#ifdef FLUTTER_ENABLE_DIFF_CONTEXT
+  // By default the layer keeps the retained layers above it from reusing
+  // their Preroll, so that it records the parent data every frame. When set
+  // to true, the layer lets them reuse it unless it fakes a platform view.
+  // See |PrerollContext::preroll_can_be_reused|.
+  void set_fake_preroll_can_be_reused(bool fake_preroll_can_be_reused) {
+    fake_preroll_can_be_reused_ = fake_preroll_can_be_reused;
+  }
 
   bool IsReplacing(DiffContext* context, const Layer* layer) const override;
   void Diff(DiffContext* context, const Layer* old_layer) override;
   const MockLayer* as_mock_layer() const override { return this; }
 
-#endif
+  bool can_preroll_concurrently() const override {
+    return !fake_has_platform_view_;
+  }
 
  private:
   MutatorsStack parent_mutators_;
@@ -46,6 +54,7 @@ class MockLayer : public Layer {
   bool parent_has_platform_view_ = false;
   bool fake_has_platform_view_ = false;
   bool fake_reads_surface_ = false;
+  bool fake_preroll_can_be_reused_ = false;
 
   FML_DISALLOW_COPY_AND_ASSIGN(MockLayer);
 };
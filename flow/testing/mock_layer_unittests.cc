@@ -69,6 +69,23 @@ TEST_F(MockLayerTest, FakePlatformView) {
   EXPECT_EQ(preroll_context()->has_platform_view, true);
 }
 
+TEST_F(MockLayerTest, FakePrerollCanBeReused) {
+  auto layer = std::make_shared<MockLayer>(SkPath());
+  layer->Preroll(preroll_context(), SkMatrix());
+  EXPECT_EQ(preroll_context()->preroll_can_be_reused, false);
+
+  preroll_context()->preroll_can_be_reused = true;
+  layer->set_fake_preroll_can_be_reused(true);
+  layer->Preroll(preroll_context(), SkMatrix());
+  EXPECT_EQ(preroll_context()->preroll_can_be_reused, true);
+
+  auto platform_view_layer = std::make_shared<MockLayer>(
+      SkPath(), SkPaint(), true /* fake_has_platform_view */);
+  platform_view_layer->set_fake_preroll_can_be_reused(true);
+  platform_view_layer->Preroll(preroll_context(), SkMatrix());
+  EXPECT_EQ(preroll_context()->preroll_can_be_reused, false);
+}
+
 TEST_F(MockLayerTest, SaveLayerOnLeafNodesCanvas) {
   auto layer = std::make_shared<MockLayer>(SkPath(), SkPaint(),
                                            true /* fake_has_platform_view */);
@@ -7,23 +7,55 @@
 #include <algorithm>
 
 #include "flutter/fml/thread.h"
+#include "flutter/fml/thread_local.h"
 #include "flutter/fml/trace_event.h"
 
 namespace fml {
 
+namespace {
+
+// The work-stealing worker that runs on the current thread.
+class CurrentStealingWorker {
+ public:
+  const ConcurrentMessageLoop* loop;
+  size_t index;
+
+  CurrentStealingWorker(const ConcurrentMessageLoop* loop_arg,
+                        size_t index_arg)
+      : loop(loop_arg), index(index_arg) {}
+};
+
+}  // namespace
+
+FML_THREAD_LOCAL ThreadLocalUniquePtr<CurrentStealingWorker>
+    tls_stealing_worker;
+
 std::shared_ptr<ConcurrentMessageLoop> ConcurrentMessageLoop::Create(
-    size_t worker_count) {
+    size_t worker_count,
+    Scheduling scheduling) {
   return std::shared_ptr<ConcurrentMessageLoop>{
-      new ConcurrentMessageLoop(worker_count)};
+      new ConcurrentMessageLoop(worker_count, scheduling)};
 }
 
-ConcurrentMessageLoop::ConcurrentMessageLoop(size_t worker_count)
-    : worker_count_(std::max<size_t>(worker_count, 1ul)) {
+ConcurrentMessageLoop::ConcurrentMessageLoop(size_t worker_count,
+                                             Scheduling scheduling)
+    : worker_count_(std::max<size_t>(worker_count, 1ul)),
+      scheduling_(scheduling) {
+  if (scheduling_ == Scheduling::kWorkStealing) {
+    for (size_t i = 0; i < worker_count_; ++i) {
+      stealing_workers_.push_back(std::make_unique<StealingWorker>());
+    }
+  }
+
   for (size_t i = 0; i < worker_count_; ++i) {
     workers_.emplace_back([i, this]() {
       fml::Thread::SetCurrentThreadName(
           std::string{"io.worker." + std::to_string(i + 1)});
-      WorkerMain();
+      if (scheduling_ == Scheduling::kWorkStealing) {
+        StealingWorkerMain(i);
+      } else {
+        WorkerMain();
+      }
     });
   }
 
@@ -43,15 +75,23 @@ size_t ConcurrentMessageLoop::GetWorkerCount() const {
   return worker_count_;
 }
 
-std::shared_ptr<ConcurrentTaskRunner> ConcurrentMessageLoop::GetTaskRunner() {
-  return std::make_shared<ConcurrentTaskRunner>(weak_from_this());
+std::shared_ptr<ConcurrentTaskRunner> ConcurrentMessageLoop::GetTaskRunner(
+    ConcurrentTaskPriority priority) {
+  return std::make_shared<ConcurrentTaskRunner>(weak_from_this(), priority);
 }
 
-void ConcurrentMessageLoop::PostTask(const fml::closure& task) {
+void ConcurrentMessageLoop::PostTask(fml::UniqueClosure task,
+                                     ConcurrentTaskPriority priority,
+                                     fml::TimePoint deadline) {
   if (!task) {
     return;
   }
 
+  if (scheduling_ == Scheduling::kWorkStealing) {
+    PostStealingTask(std::move(task), priority, deadline);
+    return;
+  }
+
   std::unique_lock lock(tasks_mutex_);
 
   // Don't just drop tasks on the floor in case of shutdown.
@@ -64,7 +104,7 @@ void ConcurrentMessageLoop::PostTask(const fml::closure& task) {
     return;
   }
 
-  tasks_.push(task);
+  tasks_.Push(std::move(task), priority, deadline);
 
   // Unlock the mutex before notifying the condition variable because that mutex
   // has to be acquired on the other thread anyway. Waiting in this scope till
@@ -78,17 +118,16 @@ void ConcurrentMessageLoop::WorkerMain() {
   while (true) {
     std::unique_lock lock(tasks_mutex_);
     tasks_condition_.wait(lock, [&]() {
-      return tasks_.size() > 0 || shutdown_ || HasThreadTasksLocked();
+      return !tasks_.empty() || shutdown_ || HasThreadTasksLocked();
     });
 
     // Shutdown cannot be read with the task mutex unlocked.
     bool shutdown_now = shutdown_;
-    fml::closure task;
+    fml::UniqueClosure task;
     std::vector<fml::closure> thread_tasks;
 
-    if (tasks_.size() != 0) {
-      task = tasks_.front();
-      tasks_.pop();
+    if (!tasks_.empty()) {
+      task = tasks_.Pop();
     }
 
     if (HasThreadTasksLocked()) {
@@ -117,10 +156,257 @@ void ConcurrentMessageLoop::WorkerMain() {
   }
 }
 
-void ConcurrentMessageLoop::Terminate() {
+void ConcurrentMessageLoop::PostStealingTask(fml::UniqueClosure task,
+                                             ConcurrentTaskPriority priority,
+                                             fml::TimePoint deadline) {
+  CurrentStealingWorker* current = tls_stealing_worker.get();
+  if (current && current->loop == this &&
+      priority == ConcurrentTaskPriority::kNormal &&
+      deadline == fml::TimePoint::Max()) {
+    // The other workers steal the task if this one is busy for long.
+    StealingWorker& worker = *stealing_workers_[current->index];
+    worker.tasks.Push(worker.AllocateTask(std::move(task)));
+  } else {
+    std::unique_lock lock(tasks_mutex_);
+
+    // Don't just drop tasks on the floor in case of shutdown.
+    if (shutdown_) {
+      FML_DLOG(WARNING)
+          << "Tried to post a task to shutdown concurrent message "
+             "loop. The task will be executed on the callers thread.";
+      lock.unlock();
+      task();
+      return;
+    }
+
+    tasks_.Push(std::move(task), priority, deadline);
+    injected_task_count_.fetch_add(1);
+    UpdateInjectedTaskStateLocked();
+  }
+
+  WakeStealingWorkers(false);
+}
+
+void ConcurrentMessageLoop::StealingWorkerMain(size_t index) {
+  tls_stealing_worker.reset(new CurrentStealingWorker(this, index));
+  StealingWorker& worker = *stealing_workers_[index];
+  size_t idle_spins = 0;
+  while (true) {
+    // Read before looking for tasks, so that anything that is posted
+    // while the worker looks keeps it from parking.
+    uint64_t epoch = work_epoch_.load();
+
+    if (worker.has_thread_tasks.exchange(false)) {
+      std::vector<fml::closure> thread_tasks;
+      {
+        std::scoped_lock lock(tasks_mutex_);
+        if (HasThreadTasksLocked()) {
+          thread_tasks = GetThreadTasksLocked();
+        }
+      }
+      for (const auto& thread_task : thread_tasks) {
+        thread_task();
+      }
+    }
+
+    // Tasks that were posted before the loop was terminated are all run
+    // before the workers exit. Terminating happens after those posts, so a
+    // worker that sees it before looking for tasks also sees the tasks.
+    const bool shutting_down = shutdown_;
+
+    if (StealingTask* task = FindStealingTask(index)) {
+      task->task();
+      StealingWorker::RecycleTask(task, worker);
+      idle_spins = 0;
+      continue;
+    }
+
+    if (shutting_down) {
+      break;
+    }
+
+    if (idle_spins < kIdleSpinCount) {
+      idle_spins++;
+      std::this_thread::yield();
+      continue;
+    }
+
+    ParkStealingWorker(epoch);
+    idle_spins = 0;
+    TRACE_EVENT_INSTANT0("flutter", "ConcurrentWorkerWake");
+  }
+  tls_stealing_worker.reset(nullptr);
+}
+
+ConcurrentMessageLoop::StealingTask* ConcurrentMessageLoop::FindStealingTask(
+    size_t index) {
+  StealingWorker& worker = *stealing_workers_[index];
+  if (HasUrgentInjectedTasks()) {
+    if (StealingTask* task = TakeInjectedTasks(
+            worker, ConcurrentTaskPriority::kFrameCritical)) {
+      return task;
+    }
+  }
+
+  if (StealingTask* task = worker.tasks.Pop()) {
+    return task;
+  }
+
+  if (injected_task_count_.load(std::memory_order_relaxed) > 0) {
+    if (StealingTask* task =
+            TakeInjectedTasks(worker, ConcurrentTaskPriority::kNormal)) {
+      return task;
+    }
+  }
+
+  // Starting with the next worker spreads the thieves over the victims.
+  for (size_t i = 1; i < worker_count_; ++i) {
+    StealingWorker& victim = *stealing_workers_[(index + i) % worker_count_];
+    // A steal fails without the deque being empty if another worker took
+    // the same task first.
+    while (!victim.tasks.IsEmpty()) {
+      if (StealingTask* task = victim.tasks.Steal()) {
+        return task;
+      }
+    }
+  }
+
+  if (injected_task_count_.load(std::memory_order_relaxed) > 0) {
+    return TakeInjectedTasks(worker, ConcurrentTaskPriority::kBackground);
+  }
+  return nullptr;
+}
+
+ConcurrentMessageLoop::StealingTask* ConcurrentMessageLoop::TakeInjectedTasks(
+    StealingWorker& worker,
+    ConcurrentTaskPriority lowest_priority) {
   std::scoped_lock lock(tasks_mutex_);
-  shutdown_ = true;
-  tasks_condition_.notify_all();
+  fml::UniqueClosure first = tasks_.Pop(lowest_priority);
+  if (!first) {
+    return nullptr;
+  }
+
+  size_t taken = 1;
+  if (lowest_priority != ConcurrentTaskPriority::kFrameCritical &&
+      !tasks_.HasFrameCriticalTasks() &&
+      tasks_.GetEarliestDeadline() == fml::TimePoint::Max()) {
+    // Leave a share of the tasks to each of the other workers.
+    const size_t batch_size = std::min(kMaxInjectedTaskBatch,
+                                       tasks_.size() / worker_count_ + 1);
+    for (; taken < batch_size; ++taken) {
+      fml::UniqueClosure task = tasks_.Pop(ConcurrentTaskPriority::kNormal);
+      if (!task) {
+        break;
+      }
+      worker.tasks.Push(worker.AllocateTask(std::move(task)));
+    }
+  }
+  injected_task_count_.fetch_sub(taken);
+  UpdateInjectedTaskStateLocked();
+  return worker.AllocateTask(std::move(first));
+}
+
+bool ConcurrentMessageLoop::HasUrgentInjectedTasks() const {
+  if (has_frame_critical_injected_tasks_.load(std::memory_order_relaxed)) {
+    return true;
+  }
+  // Only read the clock if there is a deadline at all.
+  const int64_t deadline =
+      earliest_injected_deadline_.load(std::memory_order_relaxed);
+  return deadline != std::numeric_limits<int64_t>::max() &&
+         deadline <= fml::TimePoint::Now().ToEpochDelta().ToNanoseconds();
+}
+
+void ConcurrentMessageLoop::UpdateInjectedTaskStateLocked() {
+  has_frame_critical_injected_tasks_.store(tasks_.HasFrameCriticalTasks(),
+                                           std::memory_order_relaxed);
+  earliest_injected_deadline_.store(
+      tasks_.GetEarliestDeadline().ToEpochDelta().ToNanoseconds(),
+      std::memory_order_relaxed);
+}
+
+void ConcurrentMessageLoop::ParkStealingWorker(uint64_t epoch) {
+  std::unique_lock lock(park_mutex_);
+  // The count is incremented before the epoch is read again and posters
+  // increment the epoch before they read the count, so either the worker
+  // sees the new epoch or the poster sees the parked worker.
+  parked_worker_count_.fetch_add(1);
+  park_condition_.wait(
+      lock, [&]() { return work_epoch_.load() != epoch || shutdown_; });
+  parked_worker_count_.fetch_sub(1);
+}
+
+void ConcurrentMessageLoop::WakeStealingWorkers(bool all) {
+  work_epoch_.fetch_add(1);
+  if (parked_worker_count_.load() == 0) {
+    return;
+  }
+
+  std::scoped_lock lock(park_mutex_);
+  if (all) {
+    park_condition_.notify_all();
+  } else {
+    park_condition_.notify_one();
+  }
+}
+
+ConcurrentMessageLoop::StealingWorker::~StealingWorker() {
+  // The workers have exited, so all of the nodes of this worker are back.
+  while (StealingTask* task = tasks.Pop()) {
+    delete task;
+  }
+  for (StealingTask* list : {free_tasks, returned_tasks.load()}) {
+    while (list) {
+      StealingTask* next = list->next;
+      delete list;
+      list = next;
+    }
+  }
+}
+
+ConcurrentMessageLoop::StealingTask*
+ConcurrentMessageLoop::StealingWorker::AllocateTask(fml::UniqueClosure task) {
+  if (!free_tasks) {
+    free_tasks = returned_tasks.exchange(nullptr, std::memory_order_acquire);
+  }
+  if (!free_tasks) {
+    return new StealingTask(std::move(task), this);
+  }
+  StealingTask* node = free_tasks;
+  free_tasks = node->next;
+  node->task = std::move(task);
+  return node;
+}
+
+void ConcurrentMessageLoop::StealingWorker::RecycleTask(
+    StealingTask* task,
+    StealingWorker& current) {
+  // Destroy the callable right away rather than when the node is reused.
+  task->task.Reset();
+  StealingWorker* owner = task->owner;
+  if (owner == &current) {
+    task->next = owner->free_tasks;
+    owner->free_tasks = task;
+    return;
+  }
+  // Nodes are only ever taken from this list all at once, so pushing them
+  // is not subject to ABA.
+  task->next = owner->returned_tasks.load(std::memory_order_relaxed);
+  while (!owner->returned_tasks.compare_exchange_weak(
+      task->next, task, std::memory_order_release,
+      std::memory_order_relaxed)) {
+  }
+}
+
+void ConcurrentMessageLoop::Terminate() {
+  {
+    std::scoped_lock lock(tasks_mutex_);
+    shutdown_ = true;
+    tasks_condition_.notify_all();
+  }
+  if (scheduling_ == Scheduling::kWorkStealing) {
+    WakeStealingWorkers(true);
+  }
 }
 
 void ConcurrentMessageLoop::PostTaskToAllWorkers(fml::closure task) {
@@ -128,11 +414,19 @@ void ConcurrentMessageLoop::PostTaskToAllWorkers(fml::closure task) {
     return;
   }
 
-  std::scoped_lock lock(tasks_mutex_);
-  for (const auto& worker_thread_id : worker_thread_ids_) {
-    thread_tasks_[worker_thread_id].emplace_back(task);
+  {
+    std::scoped_lock lock(tasks_mutex_);
+    for (const auto& worker_thread_id : worker_thread_ids_) {
+      thread_tasks_[worker_thread_id].emplace_back(task);
+    }
+    tasks_condition_.notify_all();
+  }
+  if (scheduling_ == Scheduling::kWorkStealing) {
+    for (const auto& worker : stealing_workers_) {
+      worker->has_thread_tasks = true;
+    }
+    WakeStealingWorkers(true);
   }
-  tasks_condition_.notify_all();
 }
 
 bool ConcurrentMessageLoop::HasThreadTasksLocked() const {
@@ -148,19 +442,105 @@ std::vector<fml::closure> ConcurrentMessageLoop::GetThreadTasksLocked() {
   return pending_tasks;
 }
 
+ConcurrentMessageLoop::TaskQueue::TaskQueue() = default;
+
+ConcurrentMessageLoop::TaskQueue::~TaskQueue() = default;
+
+bool ConcurrentMessageLoop::TaskQueue::RunsAfter(const Entry& a,
+                                                 const Entry& b) {
+  if (a.deadline != b.deadline) {
+    return a.deadline > b.deadline;
+  }
+  return a.order > b.order;
+}
+
+void ConcurrentMessageLoop::TaskQueue::Push(fml::UniqueClosure task,
+                                            ConcurrentTaskPriority priority,
+                                            fml::TimePoint deadline) {
+  Lane& lane = lanes_[static_cast<size_t>(priority)];
+  lane.push_back({std::move(task), deadline, next_order_++});
+  std::push_heap(lane.begin(), lane.end(), RunsAfter);
+  size_++;
+  if (deadline != fml::TimePoint::Max()) {
+    deadline_count_++;
+  }
+}
+
+fml::UniqueClosure ConcurrentMessageLoop::TaskQueue::Pop(
+    ConcurrentTaskPriority lowest_priority) {
+  if (deadline_count_ > 0) {
+    // The front of each lane has the earliest deadline of that lane.
+    const fml::TimePoint now = fml::TimePoint::Now();
+    Lane* expired = nullptr;
+    for (Lane& lane : lanes_) {
+      if (!lane.empty() && lane.front().deadline <= now &&
+          (!expired || lane.front().deadline < expired->front().deadline)) {
+        expired = &lane;
+      }
+    }
+    if (expired) {
+      return PopFrom(*expired);
+    }
+  }
+
+  const size_t lowest_lane = static_cast<size_t>(lowest_priority);
+  for (size_t i = 0; i <= lowest_lane; ++i) {
+    if (!lanes_[i].empty()) {
+      return PopFrom(lanes_[i]);
+    }
+  }
+  return nullptr;
+}
+
+bool ConcurrentMessageLoop::TaskQueue::HasFrameCriticalTasks() const {
+  return !lanes_[static_cast<size_t>(ConcurrentTaskPriority::kFrameCritical)]
+              .empty();
+}
+
+fml::TimePoint ConcurrentMessageLoop::TaskQueue::GetEarliestDeadline() const {
+  fml::TimePoint earliest = fml::TimePoint::Max();
+  if (deadline_count_ > 0) {
+    // The front of each lane has the earliest deadline of that lane.
+    for (const Lane& lane : lanes_) {
+      if (!lane.empty() && lane.front().deadline < earliest) {
+        earliest = lane.front().deadline;
+      }
+    }
+  }
+  return earliest;
+}
+
+fml::UniqueClosure ConcurrentMessageLoop::TaskQueue::PopFrom(Lane& lane) {
+  std::pop_heap(lane.begin(), lane.end(), RunsAfter);
+  Entry entry = std::move(lane.back());
+  lane.pop_back();
+  size_--;
+  if (entry.deadline != fml::TimePoint::Max()) {
+    deadline_count_--;
+  }
+  return std::move(entry.task);
+}
+
 ConcurrentTaskRunner::ConcurrentTaskRunner(
-    std::weak_ptr<ConcurrentMessageLoop> weak_loop)
-    : weak_loop_(std::move(weak_loop)) {}
+    std::weak_ptr<ConcurrentMessageLoop> weak_loop,
+    ConcurrentTaskPriority priority)
+    : weak_loop_(std::move(weak_loop)), priority_(priority) {}
 
 ConcurrentTaskRunner::~ConcurrentTaskRunner() = default;
 
-void ConcurrentTaskRunner::PostTask(const fml::closure& task) {
+void ConcurrentTaskRunner::PostTask(fml::UniqueClosure task) {
+  PostTask(std::move(task), priority_);
+}
+
+void ConcurrentTaskRunner::PostTask(fml::UniqueClosure task,
+                                    ConcurrentTaskPriority priority,
+                                    fml::TimePoint deadline) {
   if (!task) {
     return;
   }
 
   if (auto loop = weak_loop_.lock()) {
-    loop->PostTask(task);
+    loop->PostTask(std::move(task), priority, deadline);
     return;
   }
 
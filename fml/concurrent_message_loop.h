@@ -5,30 +5,70 @@
 #ifndef FLUTTER_FML_CONCURRENT_MESSAGE_LOOP_H_
 #define FLUTTER_FML_CONCURRENT_MESSAGE_LOOP_H_
 
+#include <atomic>
 #include <condition_variable>
+#include <limits>
 #include <map>
-#include <queue>
+#include <memory>
+#include <mutex>
 #include <thread>
+#include <vector>
 
 #include "flutter/fml/closure.h"
 #include "flutter/fml/macros.h"
 #include "flutter/fml/task_runner.h"
+#include "flutter/fml/time/time_point.h"
+#include "flutter/fml/unique_closure.h"
+#include "flutter/fml/work_stealing_deque.h"
 
 namespace fml {
 
 class ConcurrentTaskRunner;
 
+/**
+ * Categories of work posted to a |ConcurrentTaskRunner|. The workers run
+ * the pending tasks of a higher priority before any of a lower one, like
+ * |TaskSourceGrade| orders the task sources of the serial task queues.
+ */
+enum class ConcurrentTaskPriority {
+  /// Work that the frame which is being produced waits for, such as the
+  /// tiles of a tiled raster or the compile of a shader.
+  kFrameCritical,
+  /// The default priority.
+  kNormal,
+  /// Speculative work that no frame waits for and whose result may never
+  /// be used, such as images that are cached ahead of time.
+  kBackground,
+};
+
 class ConcurrentMessageLoop
     : public std::enable_shared_from_this<ConcurrentMessageLoop> {
  public:
+  // How the workers share the tasks that are posted to the loop.
+  enum class Scheduling {
+    // The workers wait on a single queue that all tasks are posted to.
+    kSharedQueue,
+    // Every worker has a lock-free deque that the tasks it posts itself
+    // are pushed to and that idle workers steal from. Tasks posted from
+    // other threads are injected through a queue that the workers take
+    // them from in batches. Idle workers spin for a while before they
+    // park, so tasks that are posted in bursts do not wake them up one by
+    // one. This keeps the workers from contending on a single lock when
+    // many tasks are posted from many threads.
+    kWorkStealing,
+  };
+
   static std::shared_ptr<ConcurrentMessageLoop> Create(
-      size_t worker_count = std::thread::hardware_concurrency());
+      size_t worker_count = std::thread::hardware_concurrency(),
+      Scheduling scheduling = Scheduling::kSharedQueue);
 
   ~ConcurrentMessageLoop();
 
   size_t GetWorkerCount() const;
 
-  std::shared_ptr<ConcurrentTaskRunner> GetTaskRunner();
+  // Returns a task runner that posts with |priority| unless told otherwise.
+  std::shared_ptr<ConcurrentTaskRunner> GetTaskRunner(
+      ConcurrentTaskPriority priority = ConcurrentTaskPriority::kNormal);
 
   void Terminate();
 
@@ -37,20 +77,173 @@ class ConcurrentMessageLoop
  private:
   friend ConcurrentTaskRunner;
 
-  size_t worker_count_ = 0;
+  // The pending tasks in the order in which they should run. Within a
+  // priority, the tasks with a deadline run earliest deadline first and
+  // before the tasks without one, which run in the order they were posted.
+  // Tasks whose deadline has passed run before all others.
+  class TaskQueue {
+   public:
+    TaskQueue();
+
+    ~TaskQueue();
+
+    void Push(fml::UniqueClosure task,
+              ConcurrentTaskPriority priority,
+              fml::TimePoint deadline);
+
+    // Returns the next task whose deadline has passed or whose priority is
+    // at least |lowest_priority|, or an empty closure if there is none.
+    fml::UniqueClosure Pop(
+        ConcurrentTaskPriority lowest_priority =
+            ConcurrentTaskPriority::kBackground);
+
+    bool HasFrameCriticalTasks() const;
+
+    // The earliest deadline of the tasks, or |fml::TimePoint::Max()| if
+    // none of them has a deadline.
+    fml::TimePoint GetEarliestDeadline() const;
+
+    size_t size() const { return size_; }
+
+    bool empty() const { return size_ == 0; }
+
+   private:
+    struct Entry {
+      fml::UniqueClosure task;
+      fml::TimePoint deadline;
+      uint64_t order;
+    };
+    // A min-heap of the entries of one priority.
+    using Lane = std::vector<Entry>;
+
+    static constexpr size_t kLaneCount =
+        static_cast<size_t>(ConcurrentTaskPriority::kBackground) + 1;
+
+    Lane lanes_[kLaneCount];
+    size_t size_ = 0;
+    size_t deadline_count_ = 0;
+    uint64_t next_order_ = 0;
+
+    // Orders the entries of a lane so that the heap keeps the one that
+    // should run first at the front.
+    static bool RunsAfter(const Entry& a, const Entry& b);
+
+    fml::UniqueClosure PopFrom(Lane& lane);
+
+    FML_DISALLOW_COPY_AND_ASSIGN(TaskQueue);
+  };
+
+  struct StealingWorker;
+
+  // A task in the deque of a worker. The deque holds pointers, so each task
+  // is boxed in a node that the worker which pushed it recycles once the
+  // task has run.
+  struct StealingTask {
+    StealingTask(fml::UniqueClosure task, StealingWorker* owner)
+        : task(std::move(task)), owner(owner) {}
+
+    fml::UniqueClosure task;
+    StealingWorker* const owner;
+    StealingTask* next = nullptr;
+  };
+
+  // The state of a worker when the loop uses |Scheduling::kWorkStealing|.
+  //
+  // Only the thread of a worker pushes to its deque, so the nodes of the
+  // tasks come from a pool of the worker that its thread allocates from
+  // without synchronization. The other workers return the nodes of the
+  // tasks they steal to a lock-free list that the worker takes over as a
+  // whole once its own free nodes run out. A worker thus only allocates
+  // nodes until it has as many as it had tasks in flight at once.
+  struct StealingWorker {
+    ~StealingWorker();
+
+    // Only called on the thread of the worker.
+    StealingTask* AllocateTask(fml::UniqueClosure task);
+
+    // Called on the thread of |current| once |task| has run.
+    static void RecycleTask(StealingTask* task, StealingWorker& current);
+
+    WorkStealingDeque<StealingTask> tasks;
+    // Set when |thread_tasks_| has tasks for the worker.
+    std::atomic<bool> has_thread_tasks = false;
+    // Only used on the thread of the worker.
+    StealingTask* free_tasks = nullptr;
+    // The nodes that the other workers returned.
+    std::atomic<StealingTask*> returned_tasks = nullptr;
+  };
+
+  // The most tasks a worker takes from the injection queue at once. The
+  // ones it does not run right away can be stolen by the other workers.
+  static constexpr size_t kMaxInjectedTaskBatch = 32;
+
+  // How often an idle worker looks for tasks again before it parks.
+  static constexpr size_t kIdleSpinCount = 64;
+
+  const size_t worker_count_ = 0;
+  const Scheduling scheduling_;
   std::vector<std::thread> workers_;
   std::mutex tasks_mutex_;
   std::condition_variable tasks_condition_;
-  std::queue<fml::closure> tasks_;
+  // With |Scheduling::kWorkStealing|, this is the injection queue.
+  TaskQueue tasks_;
   std::vector<std::thread::id> worker_thread_ids_;
   std::map<std::thread::id, std::vector<fml::closure>> thread_tasks_;
-  bool shutdown_ = false;
+  std::atomic<bool> shutdown_ = false;
 
-  ConcurrentMessageLoop(size_t worker_count);
+  // Only used with |Scheduling::kWorkStealing|.
+  std::vector<std::unique_ptr<StealingWorker>> stealing_workers_;
+  std::atomic<size_t> injected_task_count_ = 0;
+  // Mirror |tasks_.HasFrameCriticalTasks()| and the nanoseconds of
+  // |tasks_.GetEarliestDeadline()|, so that the workers find out whether
+  // there are urgent tasks before they run their own without taking the
+  // lock. Tasks whose deadline has not passed yet are not urgent.
+  std::atomic<bool> has_frame_critical_injected_tasks_ = false;
+  std::atomic<int64_t> earliest_injected_deadline_ =
+      std::numeric_limits<int64_t>::max();
+  // Incremented whenever there is new work for the workers, so that a
+  // worker does not park if anything was posted since it last looked.
+  std::atomic<uint64_t> work_epoch_ = 0;
+  std::atomic<size_t> parked_worker_count_ = 0;
+  std::mutex park_mutex_;
+  std::condition_variable park_condition_;
+
+  ConcurrentMessageLoop(size_t worker_count, Scheduling scheduling);
 
   void WorkerMain();
 
-  void PostTask(const fml::closure& task);
+  void StealingWorkerMain(size_t index);
+
+  void PostTask(fml::UniqueClosure task,
+                ConcurrentTaskPriority priority,
+                fml::TimePoint deadline);
+
+  void PostStealingTask(fml::UniqueClosure task,
+                        ConcurrentTaskPriority priority,
+                        fml::TimePoint deadline);
+
+  // Finds a task for the worker at |index|. The urgent tasks of the
+  // injection queue come first, then the tasks in the worker's own deque,
+  // the normal tasks of the injection queue, the tasks in the deques of the
+  // other workers and finally the background tasks.
+  StealingTask* FindStealingTask(size_t index);
+
+  // Only the deques of the workers hold normal tasks without a deadline,
+  // so only those are taken in batches.
+  StealingTask* TakeInjectedTasks(
+      StealingWorker& worker,
+      ConcurrentTaskPriority lowest_priority);
+
+  // Whether the injection queue has frame critical tasks or tasks whose
+  // deadline has passed.
+  bool HasUrgentInjectedTasks() const;
+
+  void UpdateInjectedTaskStateLocked();
+
+  // Parks the calling worker until the work epoch is no longer |epoch|.
+  void ParkStealingWorker(uint64_t epoch);
+
+  void WakeStealingWorkers(bool all);
 
   bool HasThreadTasksLocked() const;
 
@@ -61,16 +254,28 @@ class ConcurrentMessageLoop
 
 class ConcurrentTaskRunner : public BasicTaskRunner {
  public:
-  ConcurrentTaskRunner(std::weak_ptr<ConcurrentMessageLoop> weak_loop);
+  ConcurrentTaskRunner(
+      std::weak_ptr<ConcurrentMessageLoop> weak_loop,
+      ConcurrentTaskPriority priority = ConcurrentTaskPriority::kNormal);
 
   virtual ~ConcurrentTaskRunner();
 
-  void PostTask(const fml::closure& task) override;
+  // Posts |task| with the priority of this task runner.
+  void PostTask(fml::UniqueClosure task) override;
+
+  // Posts |task| with |priority|. Once |deadline| has passed, the task runs
+  // before the pending tasks of every priority whose deadline has not.
+  void PostTask(fml::UniqueClosure task,
+                ConcurrentTaskPriority priority,
+                fml::TimePoint deadline = fml::TimePoint::Max());
+
+  ConcurrentTaskPriority GetPriority() const { return priority_; }
 
  private:
   friend ConcurrentMessageLoop;
 
   std::weak_ptr<ConcurrentMessageLoop> weak_loop_;
+  const ConcurrentTaskPriority priority_;
 
   FML_DISALLOW_COPY_AND_ASSIGN(ConcurrentTaskRunner);
 };
@@ -0,0 +1,113 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/fml/concurrent_message_loop.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "flutter/benchmarking/benchmarking.h"
+#include "flutter/fml/synchronization/count_down_latch.h"
+
+namespace fml {
+namespace benchmarking {
+
+using Scheduling = ConcurrentMessageLoop::Scheduling;
+
+static constexpr size_t kWorkerCount = 8;
+
+// Keeps a task busy for a short while, like a small decode or compile.
+static void DoWork(size_t iterations) {
+  std::atomic<size_t> sink = 0;
+  for (size_t i = 0; i < iterations; i++) {
+    sink.fetch_add(i, std::memory_order_relaxed);
+  }
+}
+
+// Many threads post small tasks, like the raster, IO and UI threads do.
+static void BM_PostFromManyThreads(benchmark::State& state,  // NOLINT
+                                   Scheduling scheduling) {
+  const size_t poster_count = state.range(0);
+  const size_t tasks_per_poster = 1000;
+  auto loop = ConcurrentMessageLoop::Create(kWorkerCount, scheduling);
+  auto task_runner = loop->GetTaskRunner();
+
+  while (state.KeepRunning()) {
+    CountDownLatch tasks_done(poster_count * tasks_per_poster);
+    std::vector<std::thread> posters;
+    for (size_t i = 0; i < poster_count; i++) {
+      posters.emplace_back([&]() {
+        for (size_t j = 0; j < tasks_per_poster; j++) {
+          task_runner->PostTask([&tasks_done]() {
+            DoWork(100);
+            tasks_done.CountDown();
+          });
+        }
+      });
+    }
+    tasks_done.Wait();
+    for (auto& poster : posters) {
+      poster.join();
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * poster_count *
+                          tasks_per_poster);
+}
+
+// Tasks that split their work into subtasks, like the tiled rasterizer and
+// the concurrent preroll do, post them from the workers.
+static void BM_PostFromWorkers(benchmark::State& state,  // NOLINT
+                               Scheduling scheduling) {
+  const size_t task_count = 100;
+  const size_t subtasks_per_task = state.range(0);
+  auto loop = ConcurrentMessageLoop::Create(kWorkerCount, scheduling);
+  auto task_runner = loop->GetTaskRunner();
+
+  while (state.KeepRunning()) {
+    // The tasks count down as well, so that none of them is still posting
+    // when the loop is destroyed.
+    CountDownLatch tasks_done(task_count * (subtasks_per_task + 1));
+    for (size_t i = 0; i < task_count; i++) {
+      task_runner->PostTask([&]() {
+        for (size_t j = 0; j < subtasks_per_task; j++) {
+          task_runner->PostTask([&tasks_done]() {
+            DoWork(100);
+            tasks_done.CountDown();
+          });
+        }
+        tasks_done.CountDown();
+      });
+    }
+    tasks_done.Wait();
+  }
+  state.SetItemsProcessed(state.iterations() * task_count *
+                          subtasks_per_task);
+}
+
+BENCHMARK_CAPTURE(BM_PostFromManyThreads,
+                  SharedQueue,
+                  Scheduling::kSharedQueue)
+    ->Arg(1)
+    ->Arg(4)
+    ->Arg(16)
+    ->UseRealTime();
+BENCHMARK_CAPTURE(BM_PostFromManyThreads,
+                  WorkStealing,
+                  Scheduling::kWorkStealing)
+    ->Arg(1)
+    ->Arg(4)
+    ->Arg(16)
+    ->UseRealTime();
+BENCHMARK_CAPTURE(BM_PostFromWorkers, SharedQueue, Scheduling::kSharedQueue)
+    ->Arg(10)
+    ->Arg(100)
+    ->UseRealTime();
+BENCHMARK_CAPTURE(BM_PostFromWorkers, WorkStealing, Scheduling::kWorkStealing)
+    ->Arg(10)
+    ->Arg(100)
+    ->UseRealTime();
+
+}  // namespace benchmarking
+}  // namespace fml
@@ -5,43 +5,69 @@
 #ifndef FLUTTER_FML_DELAYED_TASK_H_
 #define FLUTTER_FML_DELAYED_TASK_H_
 
+#include <algorithm>
 #include <queue>
 
-#include "flutter/fml/closure.h"
+#include "flutter/fml/macros.h"
 #include "flutter/fml/task_source_grade.h"
 #include "flutter/fml/time/time_point.h"
+#include "flutter/fml/unique_closure.h"
 
 namespace fml {
 
 class DelayedTask {
  public:
   DelayedTask(size_t order,
-              const fml::closure& task,
+              fml::UniqueClosure task,
               fml::TimePoint target_time,
-              fml::TaskSourceGrade task_source_grade);
+              fml::TaskSourceGrade task_source_grade,
+              const void* post_site = nullptr);
 
-  DelayedTask(const DelayedTask& other);
+  DelayedTask(DelayedTask&& other);
+
+  DelayedTask& operator=(DelayedTask&& other);
 
   ~DelayedTask();
 
-  const fml::closure& GetTask() const;
+  const fml::UniqueClosure& GetTask() const;
+
+  // Moves the closure out of the task, which leaves it empty.
+  fml::UniqueClosure TakeTask();
 
   fml::TimePoint GetTargetTime() const;
 
   fml::TaskSourceGrade GetTaskSourceGrade() const;
 
+  // The return address of the call that posted the task, which
+  // |TaskQueueStats| accounts the task to.
+  const void* GetPostSite() const;
+
   bool operator>(const DelayedTask& other) const;
 
  private:
   size_t order_;
-  fml::closure task_;
+  fml::UniqueClosure task_;
   fml::TimePoint target_time_;
   fml::TaskSourceGrade task_source_grade_;
+  const void* post_site_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(DelayedTask);
 };
 
-using DelayedTaskQueue = std::priority_queue<DelayedTask,
-                                             std::deque<DelayedTask>,
-                                             std::greater<DelayedTask>>;
+// A |std::priority_queue| whose top task can be moved out as it is popped,
+// since tasks cannot be copied.
+class DelayedTaskQueue
+    : public std::priority_queue<DelayedTask,
+                                 std::deque<DelayedTask>,
+                                 std::greater<DelayedTask>> {
+ public:
+  DelayedTask Pop() {
+    std::pop_heap(c.begin(), c.end(), comp);
+    DelayedTask task = std::move(c.back());
+    c.pop_back();
+    return task;
+  }
+};
 
 }  // namespace fml
 
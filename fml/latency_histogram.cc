@@ -0,0 +1,103 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/fml/latency_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace fml {
+
+LatencyHistogram::LatencyHistogram() = default;
+
+LatencyHistogram::~LatencyHistogram() = default;
+
+size_t LatencyHistogram::GetBucketIndex(uint64_t micros) {
+  micros = std::min<uint64_t>(micros, (uint64_t{1} << kMaxMicrosBits) - 1);
+  if (micros < kSubBucketCount) {
+    return micros;
+  }
+  size_t msb = 0;
+  for (uint64_t rest = micros >> 1; rest != 0; rest >>= 1) {
+    msb++;
+  }
+  // The bits below the |kSubBucketBits| highest ones are dropped.
+  const size_t shift = msb - kSubBucketBits;
+  const size_t sub_bucket = (micros >> shift) - kSubBucketCount;
+  return (shift + 1) * kSubBucketCount + sub_bucket;
+}
+
+uint64_t LatencyHistogram::GetBucketStart(size_t index) {
+  const size_t group = index / kSubBucketCount;
+  const uint64_t sub_bucket = index % kSubBucketCount;
+  if (group == 0) {
+    return sub_bucket;
+  }
+  return (kSubBucketCount + sub_bucket) << (group - 1);
+}
+
+void LatencyHistogram::Record(fml::TimeDelta duration) {
+  const uint64_t micros = std::max<int64_t>(duration.ToMicroseconds(), 0);
+  buckets_[GetBucketIndex(micros)].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  total_micros_.fetch_add(micros, std::memory_order_relaxed);
+  uint64_t max_micros = max_micros_.load(std::memory_order_relaxed);
+  while (micros > max_micros &&
+         !max_micros_.compare_exchange_weak(max_micros, micros,
+                                            std::memory_order_relaxed)) {
+  }
+}
+
+uint64_t LatencyHistogram::GetCount() const {
+  return count_.load(std::memory_order_relaxed);
+}
+
+fml::TimeDelta LatencyHistogram::GetMax() const {
+  return fml::TimeDelta::FromMicroseconds(
+      max_micros_.load(std::memory_order_relaxed));
+}
+
+fml::TimeDelta LatencyHistogram::GetMean() const {
+  const uint64_t count = GetCount();
+  if (count == 0) {
+    return fml::TimeDelta::Zero();
+  }
+  return fml::TimeDelta::FromMicroseconds(
+      total_micros_.load(std::memory_order_relaxed) / count);
+}
+
+fml::TimeDelta LatencyHistogram::GetPercentile(double percentile) const {
+  const uint64_t count = GetCount();
+  if (count == 0) {
+    return fml::TimeDelta::Zero();
+  }
+  const uint64_t max_micros = max_micros_.load(std::memory_order_relaxed);
+  const uint64_t rank = std::clamp<uint64_t>(
+      static_cast<uint64_t>(std::ceil(percentile / 100.0 * count)), 1, count);
+  uint64_t seen = 0;
+  for (size_t i = 0; i < kBucketCount; i++) {
+    seen += buckets_[i].load(std::memory_order_relaxed);
+    if (seen >= rank) {
+      if (i + 1 == kBucketCount) {
+        return fml::TimeDelta::FromMicroseconds(max_micros);
+      }
+      const uint64_t bucket_end = GetBucketStart(i + 1) - 1;
+      return fml::TimeDelta::FromMicroseconds(
+          std::min(bucket_end, max_micros));
+    }
+  }
+  // A record raced with this read.
+  return fml::TimeDelta::FromMicroseconds(max_micros);
+}
+
+void LatencyHistogram::Reset() {
+  for (auto& bucket : buckets_) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+  count_.store(0, std::memory_order_relaxed);
+  total_micros_.store(0, std::memory_order_relaxed);
+  max_micros_.store(0, std::memory_order_relaxed);
+}
+
+}  // namespace fml
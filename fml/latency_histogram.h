@@ -0,0 +1,73 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FML_LATENCY_HISTOGRAM_H_
+#define FLUTTER_FML_LATENCY_HISTOGRAM_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "flutter/fml/macros.h"
+#include "flutter/fml/time/time_delta.h"
+
+namespace fml {
+
+// A histogram of durations with a bounded relative error, in the manner of
+// HdrHistogram. Durations are counted in microseconds. Each power of two
+// is split into |kSubBucketCount| buckets of equal width, so a percentile
+// is off by at most 1/|kSubBucketCount| of its value.
+//
+// Any thread may record and read durations. Usually one thread records,
+// but the threads of task queues that are being merged or unmerged may
+// briefly record at the same time. The counts are relaxed atomics, so a
+// read that races with a record may see the count of the duration but not
+// yet its bucket, or the other way around.
+class LatencyHistogram {
+ public:
+  static constexpr size_t kSubBucketBits = 4;
+  static constexpr size_t kSubBucketCount = 1 << kSubBucketBits;
+  // Longer durations, of more than half an hour, are counted in the last
+  // bucket.
+  static constexpr size_t kMaxMicrosBits = 31;
+  static constexpr size_t kBucketCount =
+      (kMaxMicrosBits - kSubBucketBits + 1) * kSubBucketCount;
+
+  LatencyHistogram();
+
+  ~LatencyHistogram();
+
+  void Record(fml::TimeDelta duration);
+
+  uint64_t GetCount() const;
+
+  fml::TimeDelta GetMax() const;
+
+  fml::TimeDelta GetMean() const;
+
+  // Returns the duration that |percentile| percent of the recorded
+  // durations do not exceed, rounded up to the end of its bucket.
+  fml::TimeDelta GetPercentile(double percentile) const;
+
+  void Reset();
+
+  // The index of the bucket that counts durations of |micros|.
+  static size_t GetBucketIndex(uint64_t micros);
+
+  // The shortest duration, in microseconds, that the bucket at |index|
+  // counts.
+  static uint64_t GetBucketStart(size_t index);
+
+ private:
+  std::atomic<uint64_t> buckets_[kBucketCount] = {};
+  std::atomic<uint64_t> count_ = 0;
+  std::atomic<uint64_t> total_micros_ = 0;
+  std::atomic<uint64_t> max_micros_ = 0;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(LatencyHistogram);
+};
+
+}  // namespace fml
+
+#endif  // FLUTTER_FML_LATENCY_HISTOGRAM_H_
@@ -0,0 +1,89 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/fml/latency_histogram.h"
+
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace fml {
+namespace testing {
+
+TEST(LatencyHistogramTest, BucketsCoverEveryDuration) {
+  EXPECT_EQ(LatencyHistogram::GetBucketIndex(0), 0u);
+  EXPECT_EQ(LatencyHistogram::GetBucketIndex(15), 15u);
+  EXPECT_EQ(LatencyHistogram::GetBucketIndex(16), 16u);
+  EXPECT_EQ(LatencyHistogram::GetBucketIndex(32), 32u);
+  EXPECT_EQ(LatencyHistogram::GetBucketIndex(33), 32u);
+  EXPECT_EQ(LatencyHistogram::GetBucketIndex(34), 33u);
+  EXPECT_EQ(LatencyHistogram::GetBucketIndex(UINT64_MAX),
+            LatencyHistogram::kBucketCount - 1);
+
+  for (size_t i = 0; i < LatencyHistogram::kBucketCount; i++) {
+    const uint64_t start = LatencyHistogram::GetBucketStart(i);
+    EXPECT_EQ(LatencyHistogram::GetBucketIndex(start), i);
+    if (i > 0) {
+      EXPECT_EQ(LatencyHistogram::GetBucketIndex(start - 1), i - 1);
+    }
+  }
+}
+
+TEST(LatencyHistogramTest, PercentilesAreWithinTheBucketWidth) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(histogram.GetPercentile(50), fml::TimeDelta::Zero());
+  EXPECT_EQ(histogram.GetMean(), fml::TimeDelta::Zero());
+
+  for (int64_t micros = 1; micros <= 1000; micros++) {
+    histogram.Record(fml::TimeDelta::FromMicroseconds(micros));
+  }
+  EXPECT_EQ(histogram.GetCount(), 1000u);
+  EXPECT_EQ(histogram.GetMax(), fml::TimeDelta::FromMicroseconds(1000));
+  EXPECT_EQ(histogram.GetMean(), fml::TimeDelta::FromMicroseconds(500));
+
+  for (double percentile : {1.0, 50.0, 90.0, 99.0}) {
+    const int64_t exact = static_cast<int64_t>(percentile * 10);
+    const int64_t reported =
+        histogram.GetPercentile(percentile).ToMicroseconds();
+    EXPECT_GE(reported, exact);
+    EXPECT_LE(reported, exact + exact / 16);
+  }
+  EXPECT_EQ(histogram.GetPercentile(100), histogram.GetMax());
+}
+
+TEST(LatencyHistogramTest, RecordsNegativeDurationsAsZero) {
+  LatencyHistogram histogram;
+  histogram.Record(fml::TimeDelta::FromMicroseconds(-5));
+  EXPECT_EQ(histogram.GetCount(), 1u);
+  EXPECT_EQ(histogram.GetMax(), fml::TimeDelta::Zero());
+
+  histogram.Reset();
+  EXPECT_EQ(histogram.GetCount(), 0u);
+}
+
+TEST(LatencyHistogramTest, ThreadsMayRecordAtTheSameTime) {
+  LatencyHistogram histogram;
+  constexpr int kThreadCount = 4;
+  constexpr int64_t kRecordCount = 10000;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreadCount; i++) {
+    threads.emplace_back([&histogram, i]() {
+      for (int64_t micros = 1; micros <= kRecordCount; micros++) {
+        histogram.Record(
+            fml::TimeDelta::FromMicroseconds(micros * kThreadCount - i));
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(histogram.GetCount(),
+            static_cast<uint64_t>(kThreadCount * kRecordCount));
+  EXPECT_EQ(histogram.GetMax(),
+            fml::TimeDelta::FromMicroseconds(kThreadCount * kRecordCount));
+}
+
+}  // namespace testing
+}  // namespace fml
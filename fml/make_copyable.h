@@ -53,6 +53,9 @@ class CopyableLambda {
 // Notice that the return type of MakeCopyable is rarely used directly. Instead,
 // callers typically erase the type by implicitly converting the return value
 // to an std::function.
+//
+// Tasks that are posted to an |fml::TaskRunner| are |fml::UniqueClosure|s,
+// which may be move-only, so those do not need to be wrapped.
 template <typename T>
 internal::CopyableLambda<T> MakeCopyable(T lambda) {
   return internal::CopyableLambda<T>(std::move(lambda));
@@ -54,8 +54,9 @@ MessageLoopImpl::~MessageLoopImpl() {
   task_queue_->Dispose(queue_id_);
 }
 
-void MessageLoopImpl::PostTask(const fml::closure& task,
-                               fml::TimePoint target_time) {
+void MessageLoopImpl::PostTask(fml::UniqueClosure task,
+                               fml::TimePoint target_time,
+                               const void* post_site) {
   FML_DCHECK(task != nullptr);
   FML_DCHECK(task != nullptr);
   if (terminated_) {
@@ -63,7 +64,8 @@ void MessageLoopImpl::PostTask(const fml::closure& task,
     // |task| synchronously within this function.
     return;
   }
-  task_queue_->RegisterTask(queue_id_, task, target_time);
+  task_queue_->RegisterTask(queue_id_, std::move(task), target_time,
+                            fml::TaskSourceGrade::kUnspecified, post_site);
 }
 
 void MessageLoopImpl::AddTaskObserver(intptr_t key,
@@ -121,9 +123,12 @@ void MessageLoopImpl::FlushTasks(FlushType type) {
   TRACE_EVENT0("fml", "MessageLoop::FlushTasks");
 
   const auto now = fml::TimePoint::Now();
-  fml::closure invocation;
+  // Each task starts when the one before it and its observers are done.
+  fml::TimePoint start_time = now;
+  fml::UniqueClosure invocation;
   do {
-    invocation = task_queue_->GetNextTaskToRun(queue_id_, now);
+    TaskRunInfo info;
+    invocation = task_queue_->GetNextTaskToRun(queue_id_, now, &info);
     if (!invocation) {
       break;
     }
@@ -133,6 +138,13 @@ void MessageLoopImpl::FlushTasks(FlushType type) {
     for (const auto& observer : observers) {
       observer();
     }
+    // The observers count towards the run time of the task, which takes a
+    // single clock read per task.
+    const fml::TimePoint end_time = fml::TimePoint::Now();
+    info.stats->RecordTask(info.task_source_grade, info.post_site,
+                           start_time - info.target_time,
+                           end_time - start_time);
+    start_time = end_time;
     if (type == FlushType::kSingle) {
       break;
     }
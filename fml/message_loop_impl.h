@@ -19,6 +19,7 @@
 #include "flutter/fml/message_loop.h"
 #include "flutter/fml/message_loop_task_queues.h"
 #include "flutter/fml/time/time_point.h"
+#include "flutter/fml/unique_closure.h"
 #include "flutter/fml/wakeable.h"
 
 namespace fml {
@@ -39,7 +40,11 @@ class MessageLoopImpl : public Wakeable,
 
   virtual void Terminate() = 0;
 
-  void PostTask(const fml::closure& task, fml::TimePoint target_time);
+  /// \p post_site is the return address of the call that posted the task,
+  /// which the stats of the task queue account the task to.
+  void PostTask(fml::UniqueClosure task,
+                fml::TimePoint target_time,
+                const void* post_site = nullptr);
 
   void AddTaskObserver(intptr_t key, const fml::closure& callback);
 
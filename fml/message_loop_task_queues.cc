@@ -45,6 +45,7 @@ TaskQueueEntry::TaskQueueEntry(TaskQueueId created_for_arg)
   wakeable = NULL;
   task_observers = TaskObservers();
   task_source = std::make_unique<TaskSource>(created_for);
+  stats = std::make_shared<TaskQueueStats>();
 }
 
 fml::RefPtr<MessageLoopTaskQueues> MessageLoopTaskQueues::GetInstance() {
@@ -61,14 +62,20 @@ TaskQueueId MessageLoopTaskQueues::CreateTaskQueue() {
   std::lock_guard guard(queue_mutex_);
   TaskQueueId loop_id = TaskQueueId(task_queue_id_counter_);
   ++task_queue_id_counter_;
-  queue_entries_[loop_id] = std::make_unique<TaskQueueEntry>(loop_id);
+  auto entry = std::make_unique<TaskQueueEntry>(loop_id);
+  GetEntrySlotUnlocked(loop_id).store(entry.get(), std::memory_order_release);
+  queue_entries_[loop_id] = std::move(entry);
   return loop_id;
 }
 
 MessageLoopTaskQueues::MessageLoopTaskQueues()
     : task_queue_id_counter_(0), order_(0) {}
 
-MessageLoopTaskQueues::~MessageLoopTaskQueues() = default;
+MessageLoopTaskQueues::~MessageLoopTaskQueues() {
+  for (auto& segment : entry_segments_) {
+    delete[] segment.load();
+  }
+}
 
 void MessageLoopTaskQueues::Dispose(TaskQueueId queue_id) {
   std::lock_guard guard(queue_mutex_);
@@ -76,9 +83,11 @@ void MessageLoopTaskQueues::Dispose(TaskQueueId queue_id) {
   FML_DCHECK(queue_entry->subsumed_by == _kUnmerged);
   auto& subsumed_set = queue_entry->owner_of;
   for (auto& subsumed : subsumed_set) {
+    GetEntrySlotUnlocked(subsumed).store(nullptr);
     queue_entries_.erase(subsumed);
   }
   // Erase owner queue_id at last to avoid &subsumed_set from being invalid
+  GetEntrySlotUnlocked(queue_id).store(nullptr);
   queue_entries_.erase(queue_id);
 }
 
@@ -87,6 +96,8 @@ void MessageLoopTaskQueues::DisposeTasks(TaskQueueId queue_id) {
   const auto& queue_entry = queue_entries_.at(queue_id);
   FML_DCHECK(queue_entry->subsumed_by == _kUnmerged);
   auto& subsumed_set = queue_entry->owner_of;
+  // The ready tasks are dropped on this thread as well.
+  MoveReadyTasksUnlocked(queue_id);
   queue_entry->task_source->ShutDown();
   for (auto& subsumed : subsumed_set) {
     queue_entries_.at(subsumed)->task_source->ShutDown();
@@ -100,33 +111,58 @@ TaskSourceGrade MessageLoopTaskQueues::GetCurrentTaskSourceGrade() {
 
 void MessageLoopTaskQueues::RegisterTask(
     TaskQueueId queue_id,
-    const fml::closure& task,
+    fml::UniqueClosure task,
     fml::TimePoint target_time,
-    fml::TaskSourceGrade task_source_grade) {
+    fml::TaskSourceGrade task_source_grade,
+    const void* post_site) {
+  const size_t order = order_++;
+  const fml::TimePoint now = fml::TimePoint::Now();
+  const bool is_ready = target_time <= now;
+  if (is_ready) {
+    TaskQueueEntry* entry = GetEntryForReadyTask(queue_id);
+    entry->ready_tasks.Push(
+        {order, std::move(task), target_time, task_source_grade, post_site});
+    // Only the first of the ready tasks that are posted between two runs of
+    // the loop has to wake it up.
+    if (entry->ready_tasks_wake_pending.exchange(true)) {
+      return;
+    }
+  }
+
   std::lock_guard guard(queue_mutex_);
-  size_t order = order_++;
   const auto& queue_entry = queue_entries_.at(queue_id);
-  queue_entry->task_source->RegisterTask(
-      {order, task, target_time, task_source_grade});
+  if (!is_ready) {
+    queue_entry->task_source->RegisterTask(
+        {order, std::move(task), target_time, task_source_grade, post_site});
+  }
   TaskQueueId loop_to_wake = queue_id;
   if (queue_entry->subsumed_by != _kUnmerged) {
     loop_to_wake = queue_entry->subsumed_by;
   }
+  MoveReadyTasksUnlocked(loop_to_wake);
 
   // This can happen when the secondary tasks are paused.
   if (HasPendingTasksUnlocked(loop_to_wake)) {
-    WakeUpUnlocked(loop_to_wake, GetNextWakeTimeUnlocked(loop_to_wake));
+    const fml::TimePoint wake_time = GetNextWakeTimeUnlocked(loop_to_wake);
+    WakeUpUnlocked(loop_to_wake, wake_time);
+    if (wake_time <= now) {
+      SetReadyTasksWakePendingUnlocked(loop_to_wake);
+    }
   }
 }
 
 bool MessageLoopTaskQueues::HasPendingTasks(TaskQueueId queue_id) const {
   std::lock_guard guard(queue_mutex_);
+  MoveReadyTasksUnlocked(queue_id);
   return HasPendingTasksUnlocked(queue_id);
 }
 
-fml::closure MessageLoopTaskQueues::GetNextTaskToRun(TaskQueueId queue_id,
-                                                     fml::TimePoint from_time) {
+fml::UniqueClosure MessageLoopTaskQueues::GetNextTaskToRun(
+    TaskQueueId queue_id,
+    fml::TimePoint from_time,
+    TaskRunInfo* info) {
   std::lock_guard guard(queue_mutex_);
+  MoveReadyTasksUnlocked(queue_id);
   if (!HasPendingTasksUnlocked(queue_id)) {
     return nullptr;
   }
@@ -135,18 +171,29 @@ fml::closure MessageLoopTaskQueues::GetNextTaskToRun(TaskQueueId queue_id,
   if (!HasPendingTasksUnlocked(queue_id)) {
     WakeUpUnlocked(queue_id, fml::TimePoint::Max());
   } else {
-    WakeUpUnlocked(queue_id, GetNextWakeTimeUnlocked(queue_id));
+    const fml::TimePoint wake_time = GetNextWakeTimeUnlocked(queue_id);
+    WakeUpUnlocked(queue_id, wake_time);
+    if (wake_time <= from_time) {
+      SetReadyTasksWakePendingUnlocked(queue_id);
+    }
   }
 
   if (top.task.GetTargetTime() > from_time) {
     return nullptr;
   }
-  fml::closure invocation = top.task.GetTask();
-  queue_entries_.at(top.task_queue_id)
-      ->task_source->PopTask(top.task.GetTaskSourceGrade());
+  // Popping the task destroys the one that |top| refers to.
+  const auto task_source_grade = top.task.GetTaskSourceGrade();
+  const auto& top_entry = queue_entries_.at(top.task_queue_id);
+  if (info) {
+    info->stats = top_entry->stats;
+    info->task_source_grade = task_source_grade;
+    info->target_time = top.task.GetTargetTime();
+    info->post_site = top.task.GetPostSite();
+  }
+  fml::UniqueClosure invocation =
+      top_entry->task_source->PopTask(task_source_grade).TakeTask();
   {
     std::scoped_lock creation(creation_mutex_);
-    const auto task_source_grade = top.task.GetTaskSourceGrade();
     tls_task_source_grade.reset(new TaskSourceGradeHolder{task_source_grade});
   }
   return invocation;
@@ -159,8 +206,86 @@ void MessageLoopTaskQueues::WakeUpUnlocked(TaskQueueId queue_id,
   }
 }
 
+void MessageLoopTaskQueues::MoveReadyTasksUnlocked(
+    TaskQueueId queue_id) const {
+  auto move_ready_tasks = [](TaskQueueEntry& entry) {
+    // Cleared first, so that a task that is posted while the tasks are moved
+    // is either moved as well or wakes up the loop again.
+    entry.ready_tasks_wake_pending = false;
+    while (std::optional<DelayedTask> task = entry.ready_tasks.Pop()) {
+      entry.task_source->RegisterTask(std::move(*task));
+    }
+  };
+  const auto& entry = queue_entries_.at(queue_id);
+  move_ready_tasks(*entry);
+  for (auto& subsumed : entry->owner_of) {
+    move_ready_tasks(*queue_entries_.at(subsumed));
+  }
+}
+
+void MessageLoopTaskQueues::SetReadyTasksWakePendingUnlocked(
+    TaskQueueId queue_id) const {
+  const auto& entry = queue_entries_.at(queue_id);
+  entry->ready_tasks_wake_pending = true;
+  for (auto& subsumed : entry->owner_of) {
+    queue_entries_.at(subsumed)->ready_tasks_wake_pending = true;
+  }
+}
+
+void MessageLoopTaskQueues::GetEntrySlotIndex(TaskQueueId queue_id,
+                                              size_t& segment,
+                                              size_t& index) {
+  size_t segment_start = 0;
+  size_t segment_size = kFirstEntrySegmentSize;
+  segment = 0;
+  while (queue_id >= segment_start + segment_size) {
+    segment_start += segment_size;
+    segment_size *= 2;
+    segment++;
+  }
+  FML_CHECK(segment < kMaxEntrySegments);
+  index = queue_id - segment_start;
+}
+
+std::atomic<TaskQueueEntry*>& MessageLoopTaskQueues::GetEntrySlotUnlocked(
+    TaskQueueId queue_id) {
+  size_t segment, index;
+  GetEntrySlotIndex(queue_id, segment, index);
+  std::atomic<TaskQueueEntry*>* slots = entry_segments_[segment].load();
+  if (!slots) {
+    slots = new std::atomic<TaskQueueEntry*>[kFirstEntrySegmentSize
+                                             << segment]();
+    entry_segments_[segment].store(slots, std::memory_order_release);
+  }
+  return slots[index];
+}
+
+TaskQueueEntry* MessageLoopTaskQueues::GetEntryForReadyTask(
+    TaskQueueId queue_id) const {
+  size_t segment, index;
+  GetEntrySlotIndex(queue_id, segment, index);
+  std::atomic<TaskQueueEntry*>* slots =
+      entry_segments_[segment].load(std::memory_order_acquire);
+  TaskQueueEntry* entry =
+      slots ? slots[index].load(std::memory_order_acquire) : nullptr;
+  FML_CHECK(entry) << "Posted a task to task queue " << queue_id
+                   << ", which does not exist.";
+  return entry;
+}
+
+std::shared_ptr<TaskQueueStats> MessageLoopTaskQueues::GetStats(
+    TaskQueueId queue_id) const {
+  std::lock_guard guard(queue_mutex_);
+  const auto it = queue_entries_.find(queue_id);
+  if (it == queue_entries_.end()) {
+    return nullptr;
+  }
+  return it->second->stats;
+}
+
 size_t MessageLoopTaskQueues::GetNumPendingTasks(TaskQueueId queue_id) const {
   std::lock_guard guard(queue_mutex_);
+  MoveReadyTasksUnlocked(queue_id);
   const auto& queue_entry = queue_entries_.at(queue_id);
   if (queue_entry->subsumed_by != _kUnmerged) {
     return 0;
@@ -265,6 +390,7 @@ bool MessageLoopTaskQueues::Merge(TaskQueueId owner, TaskQueueId subsumed) {
   // All checking is OK, set merged state.
   owner_entry->owner_of.insert(subsumed);
   subsumed_entry->subsumed_by = owner;
+  MoveReadyTasksUnlocked(owner);
 
   if (HasPendingTasksUnlocked(owner)) {
     WakeUpUnlocked(owner, GetNextWakeTimeUnlocked(owner));
@@ -302,6 +428,7 @@ bool MessageLoopTaskQueues::Unmerge(TaskQueueId owner, TaskQueueId subsumed) {
     return false;
   }
 
+  MoveReadyTasksUnlocked(owner);
   queue_entries_.at(subsumed)->subsumed_by = _kUnmerged;
   owner_entry->owner_of.erase(subsumed);
 
@@ -340,6 +467,7 @@ void MessageLoopTaskQueues::PauseSecondarySource(TaskQueueId queue_id) {
 void MessageLoopTaskQueues::ResumeSecondarySource(TaskQueueId queue_id) {
   std::lock_guard guard(queue_mutex_);
   queue_entries_.at(queue_id)->task_source->ResumeSecondary();
+  MoveReadyTasksUnlocked(queue_id);
   // Schedule a wake as needed.
   if (HasPendingTasksUnlocked(queue_id)) {
     WakeUpUnlocked(queue_id, GetNextWakeTimeUnlocked(queue_id));
@@ -5,6 +5,7 @@
 #ifndef FLUTTER_FML_MESSAGE_LOOP_TASK_QUEUES_H_
 #define FLUTTER_FML_MESSAGE_LOOP_TASK_QUEUES_H_
 
+#include <atomic>
 #include <map>
 #include <mutex>
 #include <set>
@@ -14,9 +15,12 @@
 #include "flutter/fml/delayed_task.h"
 #include "flutter/fml/macros.h"
 #include "flutter/fml/memory/ref_counted.h"
+#include "flutter/fml/mpsc_queue.h"
 #include "flutter/fml/synchronization/shared_mutex.h"
 #include "flutter/fml/task_queue_id.h"
+#include "flutter/fml/task_queue_stats.h"
 #include "flutter/fml/task_source.h"
+#include "flutter/fml/unique_closure.h"
 #include "flutter/fml/wakeable.h"
 
 namespace fml {
@@ -45,6 +49,23 @@ class TaskQueueEntry {
 
   TaskQueueId created_for;
 
+  /// The tasks that were ready to run when they were registered. They are
+  /// posted without taking the lock of the task queues and are moved to
+  /// |task_source| before the pending tasks are looked at. The nodes of the
+  /// tasks that were moved are handed back to the posts, see |MpscQueue|, so
+  /// posting a ready task does not allocate once the loop is warmed up.
+  MpscQueue<DelayedTask> ready_tasks;
+
+  /// Set while the loop that runs the tasks of this TaskQueue is known to run
+  /// again soon and to move |ready_tasks| to |task_source| when it does, so
+  /// that posting more ready tasks does not need to wake it up.
+  std::atomic<bool> ready_tasks_wake_pending = false;
+
+  /// The stats of the tasks that were posted to this TaskQueue. They are
+  /// shared with the loops that run the tasks, which record them without
+  /// taking the lock of the task queues.
+  std::shared_ptr<TaskQueueStats> stats;
+
   explicit TaskQueueEntry(TaskQueueId created_for);
 
  private:
@@ -56,6 +77,17 @@ enum class FlushType {
   kAll,
 };
 
+/// What \p fml::MessageLoopTaskQueues::GetNextTaskToRun knows of the task it
+/// returns, so that the loop can record the task in the stats of its queue
+/// once it has run.
+struct TaskRunInfo {
+  /// The stats of the queue the task was posted to.
+  std::shared_ptr<TaskQueueStats> stats;
+  TaskSourceGrade task_source_grade = TaskSourceGrade::kUnspecified;
+  fml::TimePoint target_time;
+  const void* post_site = nullptr;
+};
+
 /// A singleton container for all tasks and observers associated with all
 /// fml::MessageLoops.
 ///
@@ -78,19 +110,28 @@ class MessageLoopTaskQueues
   // Tasks methods.
 
   void RegisterTask(TaskQueueId queue_id,
-                    const fml::closure& task,
+                    fml::UniqueClosure task,
                     fml::TimePoint target_time,
                     fml::TaskSourceGrade task_source_grade =
-                        fml::TaskSourceGrade::kUnspecified);
+                        fml::TaskSourceGrade::kUnspecified,
+                    const void* post_site = nullptr);
 
   bool HasPendingTasks(TaskQueueId queue_id) const;
 
-  fml::closure GetNextTaskToRun(TaskQueueId queue_id, fml::TimePoint from_time);
+  /// Returns the next task to run at \p from_time, if any, and describes it
+  /// in \p info unless that is null.
+  fml::UniqueClosure GetNextTaskToRun(TaskQueueId queue_id,
+                                      fml::TimePoint from_time,
+                                      TaskRunInfo* info = nullptr);
 
   size_t GetNumPendingTasks(TaskQueueId queue_id) const;
 
   static TaskSourceGrade GetCurrentTaskSourceGrade();
 
+  /// Returns the stats of the tasks that were posted to \p queue_id, or null
+  /// if the queue has been disposed of.
+  std::shared_ptr<TaskQueueStats> GetStats(TaskQueueId queue_id) const;
+
   // Observers methods.
 
   void AddTaskObserver(TaskQueueId queue_id,
@@ -146,6 +187,20 @@ class MessageLoopTaskQueues
 
   void WakeUpUnlocked(TaskQueueId queue_id, fml::TimePoint time) const;
 
+  // Moves the ready tasks of |queue_id| and of the queues it owns to their
+  // task sources. Every method that looks at the pending tasks does so
+  // first.
+  void MoveReadyTasksUnlocked(TaskQueueId queue_id) const;
+
+  // Called once the loop of |queue_id| has been woken up to run its pending
+  // tasks right away. It moves the ready tasks that are posted until then
+  // when it runs, so they do not need to wake it up.
+  void SetReadyTasksWakePendingUnlocked(TaskQueueId queue_id) const;
+
+  // Returns the entry of |queue_id| without taking |queue_mutex_|. The
+  // queue must not be disposed of while the entry is used.
+  TaskQueueEntry* GetEntryForReadyTask(TaskQueueId queue_id) const;
+
   bool HasPendingTasksUnlocked(TaskQueueId queue_id) const;
 
   TaskSource::TopTask PeekNextTaskUnlocked(TaskQueueId owner) const;
@@ -160,6 +215,24 @@ class MessageLoopTaskQueues
 
   size_t task_queue_id_counter_;
 
+  // The entries by the id of their queue, for |GetEntryForReadyTask|. Segment
+  // |i| has |kFirstEntrySegmentSize << i| slots. The segments are allocated
+  // with |queue_mutex_| held and are not moved or freed until the task queues
+  // are destroyed, so the slots can be read without it.
+  static constexpr size_t kFirstEntrySegmentSize = 64;
+  static constexpr size_t kMaxEntrySegments = 48;
+  std::atomic<std::atomic<TaskQueueEntry*>*>
+      entry_segments_[kMaxEntrySegments] = {};
+
+  // Finds the |segment| of the slot of |queue_id| and its |index| in it.
+  static void GetEntrySlotIndex(TaskQueueId queue_id,
+                                size_t& segment,
+                                size_t& index);
+
+  // Allocates the segment of the slot if needed, so |queue_mutex_| must be
+  // held.
+  std::atomic<TaskQueueEntry*>& GetEntrySlotUnlocked(TaskQueueId queue_id);
+
   std::atomic_int order_;
 
   FML_FRIEND_MAKE_REF_COUNTED(MessageLoopTaskQueues);
@@ -44,7 +44,7 @@ static void BM_RegisterAndGetTasks(benchmark::State& state) {  // NOLINT
         const auto now = fml::TimePoint::Now();
         int num_invocations = 0;
         for (;;) {
-          fml::closure invocation =
+          fml::UniqueClosure invocation =
               task_queue->GetNextTaskToRun(TaskQueueId(task_runner_id), now);
           if (!invocation) {
             break;
@@ -64,7 +64,49 @@ static void BM_RegisterAndGetTasks(benchmark::State& state) {  // NOLINT
   }
 }
 
+// Many threads post tasks that are ready to run to one queue, like the
+// platform and UI threads do, while the thread of the queue runs them.
+static void BM_RegisterReadyTasksFromManyThreads(  // NOLINT
+    benchmark::State& state) {
+  const size_t num_posters = state.range(0);
+  const size_t num_tasks_per_poster = 1000;
+  auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
+  const auto queue_id = task_queue->CreateTaskQueue();
+
+  while (state.KeepRunning()) {
+    std::vector<std::thread> posters;
+    for (size_t i = 0; i < num_posters; i++) {
+      posters.emplace_back([&task_queue, queue_id]() {
+        for (size_t j = 0; j < num_tasks_per_poster; j++) {
+          task_queue->RegisterTask(
+              queue_id, [] {}, fml::TimePoint::Now());
+        }
+      });
+    }
+    size_t num_invocations = 0;
+    while (num_invocations < num_posters * num_tasks_per_poster) {
+      fml::UniqueClosure invocation =
+          task_queue->GetNextTaskToRun(queue_id, fml::TimePoint::Now());
+      if (invocation) {
+        invocation();
+        num_invocations++;
+      }
+    }
+    for (auto& poster : posters) {
+      poster.join();
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * num_posters *
+                          num_tasks_per_poster);
+  task_queue->Dispose(queue_id);
+}
+
 BENCHMARK(BM_RegisterAndGetTasks);
+BENCHMARK(BM_RegisterReadyTasksFromManyThreads)
+    ->Arg(1)
+    ->Arg(4)
+    ->Arg(8)
+    ->UseRealTime();
 
 }  // namespace benchmarking
 }  // namespace fml
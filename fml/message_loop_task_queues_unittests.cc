@@ -8,7 +8,9 @@
 
 #include <algorithm>
 #include <cstdlib>
+#include <memory>
 #include <thread>
+#include <vector>
 
 #include "flutter/fml/synchronization/count_down_latch.h"
 #include "flutter/fml/synchronization/waitable_event.h"
@@ -108,7 +110,7 @@ TEST(MessageLoopTaskQueue, PreserveTaskOrdering) {
   const auto now = ChronoTicksSinceEpoch();
   int expected_value = 1;
   while (true) {
-    fml::closure invocation = task_queue->GetNextTaskToRun(queue_id, now);
+    fml::UniqueClosure invocation = task_queue->GetNextTaskToRun(queue_id, now);
     if (!invocation) {
       break;
     }
@@ -118,6 +120,67 @@ TEST(MessageLoopTaskQueue, PreserveTaskOrdering) {
   }
 }
 
+TEST(MessageLoopTaskQueue, RunsMoveOnlyTasks) {
+  auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
+  auto queue_id = task_queue->CreateTaskQueue();
+  auto value = std::make_shared<int>(0);
+  const auto now = ChronoTicksSinceEpoch();
+
+  // The first task is ready and the second one is moved through the heap of
+  // the task source along with the tasks that are posted for later.
+  std::vector<int> ran;
+  for (int i = 0; i < 2; i++) {
+    task_queue->RegisterTask(
+        queue_id,
+        [&ran, unique = std::make_unique<int>(i), value]() {
+          ran.push_back(*unique);
+        },
+        i == 0 ? now : now + fml::TimeDelta::FromMilliseconds(1));
+  }
+  for (int i = 2; i < 10; i++) {
+    task_queue->RegisterTask(
+        queue_id, [value]() {}, now + fml::TimeDelta::FromSeconds(i));
+  }
+  EXPECT_EQ(value.use_count(), 11);
+
+  const auto later = now + fml::TimeDelta::FromMilliseconds(1);
+  while (fml::UniqueClosure invocation =
+             task_queue->GetNextTaskToRun(queue_id, later)) {
+    invocation();
+  }
+  EXPECT_EQ(ran, std::vector<int>({0, 1}));
+  EXPECT_EQ(value.use_count(), 9);
+
+  task_queue->DisposeTasks(queue_id);
+  EXPECT_EQ(value.use_count(), 1);
+}
+
+TEST(MessageLoopTaskQueue, DescribesTheTaskToRun) {
+  auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
+  auto platform_queue = task_queue->CreateTaskQueue();
+  auto raster_queue = task_queue->CreateTaskQueue();
+  ASSERT_TRUE(task_queue->Merge(platform_queue, raster_queue));
+
+  int post_site = 0;
+  const auto time = ChronoTicksSinceEpoch();
+  task_queue->RegisterTask(
+      raster_queue, []() {}, time, fml::TaskSourceGrade::kUserInteraction,
+      &post_site);
+
+  // The task runs on the platform queue but is accounted to the raster one.
+  TaskRunInfo info;
+  fml::UniqueClosure invocation =
+      task_queue->GetNextTaskToRun(platform_queue, time, &info);
+  ASSERT_TRUE(invocation);
+  EXPECT_EQ(info.stats, task_queue->GetStats(raster_queue));
+  EXPECT_NE(info.stats, task_queue->GetStats(platform_queue));
+  EXPECT_EQ(info.task_source_grade, fml::TaskSourceGrade::kUserInteraction);
+  EXPECT_EQ(info.target_time, time);
+  EXPECT_EQ(info.post_site, &post_site);
+
+  ASSERT_TRUE(task_queue->Unmerge(platform_queue, raster_queue));
+}
+
 TEST(MessageLoopTaskQueue, RegisterTasksOnMergedQueuesPreserveTaskOrdering) {
   auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
   auto platform_queue = task_queue->CreateTaskQueue();
@@ -148,7 +211,8 @@ TEST(MessageLoopTaskQueue, RegisterTasksOnMergedQueuesPreserveTaskOrdering) {
   // "test_val = 1" in platform_queue
   // "test_val = 2" in raster2_queue
   while (true) {
-    fml::closure invocation = task_queue->GetNextTaskToRun(platform_queue, now);
+    fml::UniqueClosure invocation =
+        task_queue->GetNextTaskToRun(platform_queue, now);
     if (!invocation) {
       break;
     }
@@ -191,7 +255,8 @@ TEST(MessageLoopTaskQueue, UnmergeRespectTheOriginalTaskOrderingInQueues) {
   // "test_val = 1" in platform_queue
   // "test_val = 2" in raster_queue (running on platform)
   for (int i = 0; i < 3; i++) {
-    fml::closure invocation = task_queue->GetNextTaskToRun(platform_queue, now);
+    fml::UniqueClosure invocation =
+        task_queue->GetNextTaskToRun(platform_queue, now);
     ASSERT_FALSE(!invocation);
     invocation();
     ASSERT_TRUE(test_val == i);
@@ -210,7 +275,8 @@ TEST(MessageLoopTaskQueue, UnmergeRespectTheOriginalTaskOrderingInQueues) {
   // platform_queue has 1 task left: "test_val = 4"
   {
     ASSERT_TRUE(task_queue->GetNumPendingTasks(platform_queue) == 1);
-    fml::closure invocation = task_queue->GetNextTaskToRun(platform_queue, now);
+    fml::UniqueClosure invocation =
+        task_queue->GetNextTaskToRun(platform_queue, now);
     ASSERT_FALSE(!invocation);
     invocation();
     ASSERT_TRUE(test_val == 4);
@@ -220,14 +286,16 @@ TEST(MessageLoopTaskQueue, UnmergeRespectTheOriginalTaskOrderingInQueues) {
   // raster_queue has 2 tasks left: "test_val = 3" and "test_val = 5"
   {
     ASSERT_TRUE(task_queue->GetNumPendingTasks(raster_queue) == 2);
-    fml::closure invocation = task_queue->GetNextTaskToRun(raster_queue, now);
+    fml::UniqueClosure invocation =
+        task_queue->GetNextTaskToRun(raster_queue, now);
     ASSERT_FALSE(!invocation);
     invocation();
     ASSERT_TRUE(test_val == 3);
   }
   {
     ASSERT_TRUE(task_queue->GetNumPendingTasks(raster_queue) == 1);
-    fml::closure invocation = task_queue->GetNextTaskToRun(raster_queue, now);
+    fml::UniqueClosure invocation =
+        task_queue->GetNextTaskToRun(raster_queue, now);
     ASSERT_FALSE(!invocation);
     invocation();
     ASSERT_TRUE(test_val == 5);
@@ -450,5 +518,120 @@ TEST(MessageLoopTaskQueue, RegisterTaskWakesUpOwnerQueue) {
   ASSERT_EQ(time1, wakes[2]);
 }
 
+TEST(MessageLoopTaskQueue, WakesUpOnceForReadyTasksPostedBetweenRuns) {
+  auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
+  auto queue_id = task_queue->CreateTaskQueue();
+  int num_wakes = 0;
+  task_queue->SetWakeable(
+      queue_id, new TestWakeable(
+                    [&num_wakes](fml::TimePoint wake_time) { ++num_wakes; }));
+
+  for (int i = 0; i < 3; i++) {
+    task_queue->RegisterTask(
+        queue_id, []() {}, fml::TimePoint::Now());
+  }
+  ASSERT_EQ(num_wakes, 1);
+  ASSERT_EQ(task_queue->GetNumPendingTasks(queue_id), 3u);
+
+  // The queue was looked at, so the next ready task wakes it up again.
+  task_queue->RegisterTask(
+      queue_id, []() {}, fml::TimePoint::Now());
+  ASSERT_EQ(num_wakes, 2);
+  ASSERT_EQ(task_queue->GetNumPendingTasks(queue_id), 4u);
+}
+
+TEST(MessageLoopTaskQueue, ReadyTasksOfSubsumedQueueWakeUpOwnerQueue) {
+  auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
+  auto platform_queue = task_queue->CreateTaskQueue();
+  auto raster_queue = task_queue->CreateTaskQueue();
+  int num_wakes = 0;
+  task_queue->SetWakeable(platform_queue,
+                          new TestWakeable([&num_wakes](fml::TimePoint) {
+                            ++num_wakes;
+                          }));
+  task_queue->SetWakeable(raster_queue,
+                          new TestWakeable([](fml::TimePoint wake_time) {
+                            // The raster queue is owned by the platform queue.
+                            ASSERT_FALSE(true);
+                          }));
+  task_queue->Merge(platform_queue, raster_queue);
+
+  int test_val = 0;
+  task_queue->RegisterTask(
+      raster_queue, [&test_val]() { test_val = 1; }, fml::TimePoint::Now());
+  task_queue->RegisterTask(
+      raster_queue, [&test_val]() { test_val = 2; }, fml::TimePoint::Now());
+  ASSERT_EQ(num_wakes, 1);
+
+  const auto now = fml::TimePoint::Now();
+  for (int expected_value = 1; expected_value <= 2; expected_value++) {
+    fml::UniqueClosure invocation =
+        task_queue->GetNextTaskToRun(platform_queue, now);
+    ASSERT_TRUE(invocation);
+    invocation();
+    ASSERT_EQ(test_val, expected_value);
+  }
+}
+
+TEST(MessageLoopTaskQueue, ReadyTasksOfPausedSecondarySourceWakeUpOnResume) {
+  auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
+  auto queue_id = task_queue->CreateTaskQueue();
+  int num_wakes = 0;
+  task_queue->SetWakeable(
+      queue_id, new TestWakeable(
+                    [&num_wakes](fml::TimePoint wake_time) { ++num_wakes; }));
+
+  task_queue->PauseSecondarySource(queue_id);
+  for (int i = 0; i < 2; i++) {
+    task_queue->RegisterTask(
+        queue_id, []() {}, fml::TimePoint::Now(),
+        fml::TaskSourceGrade::kDartMicroTasks);
+  }
+  ASSERT_EQ(num_wakes, 0);
+  ASSERT_FALSE(task_queue->HasPendingTasks(queue_id));
+
+  task_queue->ResumeSecondarySource(queue_id);
+  ASSERT_EQ(num_wakes, 1);
+  ASSERT_EQ(task_queue->GetNumPendingTasks(queue_id), 2u);
+}
+
+TEST(MessageLoopTaskQueue, ReadyTasksPostedConcurrentlyRunInPostOrder) {
+  auto task_queue = fml::MessageLoopTaskQueues::GetInstance();
+  auto queue_id = task_queue->CreateTaskQueue();
+  constexpr size_t kThreadCount = 4;
+  constexpr size_t kThreadTaskCount = 1000;
+
+  // Only the thread that runs the tasks touches |last_run|.
+  std::vector<size_t> last_run(kThreadCount, 0);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < kThreadCount; i++) {
+    threads.emplace_back([&, i]() {
+      for (size_t j = 1; j <= kThreadTaskCount; j++) {
+        task_queue->RegisterTask(
+            queue_id,
+            [&last_run, i, j]() {
+              ASSERT_EQ(last_run[i] + 1, j);
+              last_run[i] = j;
+            },
+            fml::TimePoint::Now());
+      }
+    });
+  }
+
+  size_t num_runs = 0;
+  while (num_runs < kThreadCount * kThreadTaskCount) {
+    fml::UniqueClosure invocation =
+        task_queue->GetNextTaskToRun(queue_id, fml::TimePoint::Now());
+    if (invocation) {
+      invocation();
+      num_runs++;
+    }
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_FALSE(task_queue->HasPendingTasks(queue_id));
+}
+
 }  // namespace testing
 }  // namespace fml
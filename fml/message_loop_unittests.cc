@@ -6,8 +6,10 @@
 
 #include "flutter/fml/message_loop.h"
 
+#include <atomic>
 #include <iostream>
 #include <thread>
+#include <vector>
 
 #include "flutter/fml/build_config.h"
 #include "flutter/fml/concurrent_message_loop.h"
@@ -317,3 +319,215 @@ TEST(MessageLoop, CanCreateConcurrentMessageLoop) {
   latch.Wait();
   ASSERT_GE(thread_ids.size(), 1u);
 }
+
+TEST(MessageLoop, WorkStealingConcurrentMessageLoopRunsAllTasks) {
+  auto loop = fml::ConcurrentMessageLoop::Create(
+      4, fml::ConcurrentMessageLoop::Scheduling::kWorkStealing);
+  auto task_runner = loop->GetTaskRunner();
+  const size_t kPosterCount = 4;
+  const size_t kTasksPerPoster = 100;
+  // Every task posts a subtask from the worker that runs it.
+  fml::CountDownLatch latch(kPosterCount * kTasksPerPoster * 2);
+  std::vector<std::thread> posters;
+  for (size_t i = 0; i < kPosterCount; ++i) {
+    posters.emplace_back([&]() {
+      for (size_t j = 0; j < kTasksPerPoster; ++j) {
+        task_runner->PostTask([&]() {
+          task_runner->PostTask([&]() { latch.CountDown(); });
+          latch.CountDown();
+        });
+      }
+    });
+  }
+  for (auto& poster : posters) {
+    poster.join();
+  }
+  latch.Wait();
+}
+
+TEST(MessageLoop, WorkStealingConcurrentMessageLoopStealsWorkerTasks) {
+  auto loop = fml::ConcurrentMessageLoop::Create(
+      4, fml::ConcurrentMessageLoop::Scheduling::kWorkStealing);
+  auto task_runner = loop->GetTaskRunner();
+  const size_t kCount = 4;
+  fml::CountDownLatch latch(kCount + 1);
+  std::mutex thread_ids_mutex;
+  std::set<std::thread::id> thread_ids;
+  task_runner->PostTask([&]() {
+    for (size_t i = 0; i < kCount; ++i) {
+      task_runner->PostTask([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        std::scoped_lock lock(thread_ids_mutex);
+        thread_ids.insert(std::this_thread::get_id());
+        latch.CountDown();
+      });
+    }
+    latch.CountDown();
+  });
+  latch.Wait();
+  // The tasks were all pushed to the deque of one worker.
+  ASSERT_GT(thread_ids.size(), 1u);
+}
+
+TEST(MessageLoop, WorkStealingConcurrentMessageLoopDestroysTasksThatRan) {
+  // Signals |event| when the task that holds it is destroyed.
+  struct DestructionSignal {
+    explicit DestructionSignal(fml::AutoResetWaitableEvent* event)
+        : event(event) {}
+    DestructionSignal(DestructionSignal&& other) noexcept
+        : event(other.event) {
+      other.event = nullptr;
+    }
+    ~DestructionSignal() {
+      if (event) {
+        event->Signal();
+      }
+    }
+    fml::AutoResetWaitableEvent* event;
+  };
+
+  auto loop = fml::ConcurrentMessageLoop::Create(
+      2, fml::ConcurrentMessageLoop::Scheduling::kWorkStealing);
+  auto task_runner = loop->GetTaskRunner();
+  fml::AutoResetWaitableEvent destroyed;
+  task_runner->PostTask([&]() {
+    // This task is pushed to the deque of the worker. The node it is boxed
+    // in is kept for the next task, but the task itself is not.
+    task_runner->PostTask([signal = DestructionSignal(&destroyed)]() {});
+  });
+  ASSERT_FALSE(destroyed.WaitWithTimeout(fml::TimeDelta::FromSeconds(10)));
+}
+
+TEST(MessageLoop, WorkStealingConcurrentMessageLoopRunsTasksOnAllWorkers) {
+  auto loop = fml::ConcurrentMessageLoop::Create(
+      4, fml::ConcurrentMessageLoop::Scheduling::kWorkStealing);
+  fml::CountDownLatch latch(loop->GetWorkerCount());
+  std::mutex thread_ids_mutex;
+  std::set<std::thread::id> thread_ids;
+  loop->PostTaskToAllWorkers([&]() {
+    std::scoped_lock lock(thread_ids_mutex);
+    thread_ids.insert(std::this_thread::get_id());
+    latch.CountDown();
+  });
+  latch.Wait();
+  ASSERT_EQ(thread_ids.size(), loop->GetWorkerCount());
+}
+
+TEST(MessageLoop, WorkStealingConcurrentMessageLoopRunsPendingTasksOnExit) {
+  std::atomic<size_t> count = 0;
+  auto loop = fml::ConcurrentMessageLoop::Create(
+      2, fml::ConcurrentMessageLoop::Scheduling::kWorkStealing);
+  auto task_runner = loop->GetTaskRunner();
+  for (size_t i = 0; i < 100; ++i) {
+    task_runner->PostTask([&count]() { count++; });
+  }
+  loop = nullptr;
+  ASSERT_EQ(count, 100u);
+}
+
+// Posts |tasks| while the only worker of |loop| is busy and returns the
+// indices of the tasks in the order in which they ran.
+static std::vector<size_t> RunWhileWorkerIsBusy(
+    const std::shared_ptr<fml::ConcurrentMessageLoop>& loop,
+    const std::vector<std::pair<fml::ConcurrentTaskPriority, fml::TimePoint>>&
+        tasks) {
+  auto task_runner = loop->GetTaskRunner();
+  fml::AutoResetWaitableEvent busy;
+  fml::AutoResetWaitableEvent release;
+  task_runner->PostTask([&]() {
+    busy.Signal();
+    release.Wait();
+  });
+  busy.Wait();
+
+  std::mutex order_mutex;
+  std::vector<size_t> order;
+  fml::CountDownLatch latch(tasks.size());
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    task_runner->PostTask(
+        [&, i]() {
+          std::scoped_lock lock(order_mutex);
+          order.push_back(i);
+          latch.CountDown();
+        },
+        tasks[i].first, tasks[i].second);
+  }
+  release.Signal();
+  latch.Wait();
+  return order;
+}
+
+TEST(MessageLoop, ConcurrentMessageLoopRunsHigherPrioritiesFirst) {
+  using Priority = fml::ConcurrentTaskPriority;
+  const fml::TimePoint kNoDeadline = fml::TimePoint::Max();
+  for (auto scheduling :
+       {fml::ConcurrentMessageLoop::Scheduling::kSharedQueue,
+        fml::ConcurrentMessageLoop::Scheduling::kWorkStealing}) {
+    auto order = RunWhileWorkerIsBusy(
+        fml::ConcurrentMessageLoop::Create(1, scheduling),
+        {{Priority::kBackground, kNoDeadline},
+         {Priority::kNormal, kNoDeadline},
+         {Priority::kFrameCritical, kNoDeadline}});
+    ASSERT_EQ(order, (std::vector<size_t>{2, 1, 0}));
+  }
+}
+
+TEST(MessageLoop, ConcurrentMessageLoopRunsTasksPastTheirDeadlineFirst) {
+  using Priority = fml::ConcurrentTaskPriority;
+  const fml::TimePoint kNoDeadline = fml::TimePoint::Max();
+  const fml::TimePoint kLater =
+      fml::TimePoint::Now() + fml::TimeDelta::FromSeconds(100);
+  for (auto scheduling :
+       {fml::ConcurrentMessageLoop::Scheduling::kSharedQueue,
+        fml::ConcurrentMessageLoop::Scheduling::kWorkStealing}) {
+    auto order = RunWhileWorkerIsBusy(
+        fml::ConcurrentMessageLoop::Create(1, scheduling),
+        {{Priority::kFrameCritical, kNoDeadline},
+         {Priority::kNormal, kNoDeadline},
+         {Priority::kNormal, kLater},
+         {Priority::kBackground, fml::TimePoint::Now()}});
+    // Within a priority, tasks with a deadline run first.
+    ASSERT_EQ(order, (std::vector<size_t>{3, 0, 2, 1}));
+  }
+}
+
+TEST(MessageLoop, WorkStealingConcurrentMessageLoopRunsExpiredTasksFirst) {
+  auto loop = fml::ConcurrentMessageLoop::Create(
+      1, fml::ConcurrentMessageLoop::Scheduling::kWorkStealing);
+  auto task_runner = loop->GetTaskRunner();
+  const fml::TimePoint soon =
+      fml::TimePoint::Now() + fml::TimeDelta::FromMilliseconds(20);
+  const fml::TimePoint later =
+      fml::TimePoint::Now() + fml::TimeDelta::FromSeconds(100);
+
+  std::mutex order_mutex;
+  std::vector<std::string> order;
+  fml::CountDownLatch latch(5);
+  auto record = [&](std::string name) {
+    return [&, name]() {
+      std::scoped_lock lock(order_mutex);
+      order.push_back(name);
+      latch.CountDown();
+    };
+  };
+  fml::AutoResetWaitableEvent posted;
+  task_runner->PostTask([&]() {
+    posted.Wait();
+    // The worker pushes these to its own deque. Only the task whose
+    // deadline has passed once they are pushed runs before them.
+    for (size_t i = 0; i < 3; ++i) {
+      task_runner->PostTask(record("own"));
+    }
+    while (fml::TimePoint::Now() <= soon) {
+      std::this_thread::yield();
+    }
+  });
+  task_runner->PostTask(record("later"),
+                        fml::ConcurrentTaskPriority::kBackground, later);
+  task_runner->PostTask(record("soon"),
+                        fml::ConcurrentTaskPriority::kBackground, soon);
+  posted.Signal();
+  latch.Wait();
+  ASSERT_EQ(order, (std::vector<std::string>{"soon", "own", "own", "own",
+                                             "later"}));
+}
@@ -0,0 +1,124 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FML_MPSC_QUEUE_H_
+#define FLUTTER_FML_MPSC_QUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <optional>
+#include <utility>
+
+#include "flutter/fml/macros.h"
+
+namespace fml {
+
+// A lock-free queue that any number of threads push to and that one thread
+// at a time pops from, in the order in which the pushes took place.
+//
+// This is the queue of Vyukov ("Non-intrusive MPSC node-based queue"),
+// whose head is a stub node. A push that is still in progress hides the
+// values that were pushed after it, so |Pop| may return nothing while later
+// pushes have returned already.
+//
+// The nodes that are done with are handed back to the pushes through a
+// ring of slots, which the thread that pops fills and the pushes take from
+// in turn. A slot only ever goes from holding a node to being empty while
+// the thread that pops does not look, so the ring needs no lock and is
+// free of the ABA problem of a shared free list. As long as fewer than
+// |kFreeNodeSlots| values are queued at a time, pushes stop allocating
+// once every slot has been filled once.
+template <typename T>
+class MpscQueue {
+ public:
+  static constexpr size_t kFreeNodeSlots = 64;
+
+  MpscQueue() : head_(new Node), tail_(head_) {}
+
+  ~MpscQueue() {
+    while (Pop()) {
+    }
+    delete head_;
+    for (std::atomic<Node*>& slot : free_nodes_) {
+      delete slot.load(std::memory_order_relaxed);
+    }
+  }
+
+  // Called by any thread.
+  void Push(T value) {
+    Node* node = AllocateNode();
+    node->value.emplace(std::move(value));
+    Node* previous = tail_.exchange(node, std::memory_order_acq_rel);
+    previous->next.store(node, std::memory_order_seq_cst);
+  }
+
+  // Only called by one thread at a time. Returns the value that was pushed
+  // first, or nothing if the queue is empty.
+  std::optional<T> Pop() {
+    Node* next = head_->next.load(std::memory_order_seq_cst);
+    if (!next) {
+      return std::nullopt;
+    }
+    std::optional<T> value = std::move(next->value);
+    next->value.reset();
+    RecycleNode(head_);
+    head_ = next;
+    return value;
+  }
+
+  // The number of nodes that the pushes had to allocate so far.
+  size_t allocated_nodes() const {
+    return allocated_nodes_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct Node {
+    std::atomic<Node*> next = nullptr;
+    std::optional<T> value;
+  };
+
+  // Only used by the thread that pops. This is the stub node, whose value
+  // has been popped already.
+  Node* head_;
+  std::atomic<Node*> tail_;
+
+  std::atomic<Node*> free_nodes_[kFreeNodeSlots] = {};
+  // The slot that the next push takes a node from.
+  std::atomic_size_t next_free_node_ = 0;
+  // The slot that the thread that pops fills next.
+  size_t next_recycled_node_ = 0;
+  std::atomic_size_t allocated_nodes_ = 0;
+
+  Node* AllocateNode() {
+    size_t slot = next_free_node_.fetch_add(1, std::memory_order_relaxed) %
+                  kFreeNodeSlots;
+    Node* node =
+        free_nodes_[slot].exchange(nullptr, std::memory_order_acquire);
+    if (!node) {
+      allocated_nodes_.fetch_add(1, std::memory_order_relaxed);
+      return new Node;
+    }
+    node->next.store(nullptr, std::memory_order_relaxed);
+    return node;
+  }
+
+  // Only called by the thread that pops.
+  void RecycleNode(Node* node) {
+    std::atomic<Node*>& slot = free_nodes_[next_recycled_node_];
+    next_recycled_node_ = (next_recycled_node_ + 1) % kFreeNodeSlots;
+    // Only this thread fills the slots, so an empty slot stays empty until
+    // it is filled here.
+    if (slot.load(std::memory_order_relaxed)) {
+      delete node;
+      return;
+    }
+    slot.store(node, std::memory_order_release);
+  }
+
+  FML_DISALLOW_COPY_AND_ASSIGN(MpscQueue);
+};
+
+}  // namespace fml
+
+#endif  // FLUTTER_FML_MPSC_QUEUE_H_
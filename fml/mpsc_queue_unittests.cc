@@ -0,0 +1,96 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/fml/mpsc_queue.h"
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace fml {
+namespace testing {
+
+TEST(MpscQueueTest, PopsInPushOrder) {
+  MpscQueue<int> queue;
+  EXPECT_EQ(queue.Pop(), std::nullopt);
+  for (int i = 0; i < 3; i++) {
+    queue.Push(i);
+  }
+  EXPECT_EQ(queue.Pop(), 0);
+  queue.Push(3);
+  EXPECT_EQ(queue.Pop(), 1);
+  EXPECT_EQ(queue.Pop(), 2);
+  EXPECT_EQ(queue.Pop(), 3);
+  EXPECT_EQ(queue.Pop(), std::nullopt);
+}
+
+TEST(MpscQueueTest, DestroysTheValuesThatWereNotPopped) {
+  auto value = std::make_shared<int>(0);
+  {
+    MpscQueue<std::shared_ptr<int>> queue;
+    queue.Push(value);
+    queue.Push(value);
+    EXPECT_EQ(value.use_count(), 3);
+    EXPECT_EQ(queue.Pop(), value);
+    EXPECT_EQ(value.use_count(), 2);
+  }
+  EXPECT_EQ(value.use_count(), 1);
+}
+
+TEST(MpscQueueTest, PushesReuseThePoppedNodes) {
+  MpscQueue<std::unique_ptr<int>> queue;
+  // Every slot of the ring is filled once, after which the pushes take the
+  // nodes that were popped as long as fewer values than there are slots
+  // are queued at a time.
+  for (size_t i = 0; i < 2 * MpscQueue<int>::kFreeNodeSlots; i++) {
+    queue.Push(std::make_unique<int>(i));
+    queue.Push(std::make_unique<int>(i));
+    EXPECT_EQ(*queue.Pop().value(), static_cast<int>(i));
+    EXPECT_EQ(*queue.Pop().value(), static_cast<int>(i));
+  }
+  const size_t allocated_nodes = queue.allocated_nodes();
+  EXPECT_LE(allocated_nodes, MpscQueue<int>::kFreeNodeSlots + 2);
+  for (size_t i = 0; i < 10 * MpscQueue<int>::kFreeNodeSlots; i++) {
+    for (size_t j = 0; j < 10; j++) {
+      queue.Push(std::make_unique<int>(j));
+    }
+    for (size_t j = 0; j < 10; j++) {
+      EXPECT_EQ(*queue.Pop().value(), static_cast<int>(j));
+    }
+  }
+  EXPECT_EQ(queue.allocated_nodes(), allocated_nodes);
+  EXPECT_EQ(queue.Pop(), std::nullopt);
+}
+
+TEST(MpscQueueTest, ValuesOfEachProducerArePoppedInOrder) {
+  const size_t kProducerCount = 4;
+  const size_t kValueCount = 100000;
+  MpscQueue<std::pair<size_t, size_t>> queue;
+
+  std::vector<std::thread> producers;
+  for (size_t i = 0; i < kProducerCount; i++) {
+    producers.emplace_back([&queue, i]() {
+      for (size_t j = 0; j < kValueCount; j++) {
+        queue.Push({i, j});
+      }
+    });
+  }
+  std::vector<size_t> popped(kProducerCount, 0);
+  for (size_t count = 0; count < kProducerCount * kValueCount;) {
+    if (auto value = queue.Pop()) {
+      ASSERT_EQ(value->second, popped[value->first]);
+      popped[value->first]++;
+      count++;
+    }
+  }
+  for (std::thread& producer : producers) {
+    producer.join();
+  }
+  EXPECT_EQ(queue.Pop(), std::nullopt);
+}
+
+}  // namespace testing
+}  // namespace fml
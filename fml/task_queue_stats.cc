@@ -0,0 +1,95 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/fml/task_queue_stats.h"
+
+#include <algorithm>
+#include <sstream>
+
+#include "flutter/fml/build_config.h"
+
+#if !defined(OS_WIN)
+#include <dlfcn.h>
+#endif
+
+namespace fml {
+
+TaskQueueStats::TaskQueueStats() = default;
+
+TaskQueueStats::~TaskQueueStats() = default;
+
+void TaskQueueStats::RecordTask(TaskSourceGrade task_source_grade,
+                                const void* post_site,
+                                fml::TimeDelta queue_delay,
+                                fml::TimeDelta run_time) {
+  const size_t grade = static_cast<size_t>(task_source_grade);
+  queue_delays_[grade].Record(queue_delay);
+  run_times_[grade].Record(run_time);
+
+#if !FLUTTER_RELEASE
+  std::scoped_lock lock(post_sites_mutex_);
+  PostSite& site = post_sites_[post_site];
+  site.address = post_site;
+  site.task_count++;
+  site.total_run_time = site.total_run_time + run_time;
+  site.max_run_time = std::max(site.max_run_time, run_time);
+#endif  // !FLUTTER_RELEASE
+}
+
+const LatencyHistogram& TaskQueueStats::GetQueueDelay(
+    TaskSourceGrade task_source_grade) const {
+  return queue_delays_[static_cast<size_t>(task_source_grade)];
+}
+
+const LatencyHistogram& TaskQueueStats::GetRunTime(
+    TaskSourceGrade task_source_grade) const {
+  return run_times_[static_cast<size_t>(task_source_grade)];
+}
+
+std::vector<TaskQueueStats::PostSite> TaskQueueStats::GetSlowestPostSites(
+    size_t count) const {
+  std::vector<PostSite> sites;
+  {
+    std::scoped_lock lock(post_sites_mutex_);
+    sites.reserve(post_sites_.size());
+    for (const auto& site : post_sites_) {
+      sites.push_back(site.second);
+    }
+  }
+  count = std::min(count, sites.size());
+  std::partial_sort(sites.begin(), sites.begin() + count, sites.end(),
+                    [](const PostSite& a, const PostSite& b) {
+                      if (a.max_run_time != b.max_run_time) {
+                        return a.max_run_time > b.max_run_time;
+                      }
+                      return a.total_run_time > b.total_run_time;
+                    });
+  sites.resize(count);
+  return sites;
+}
+
+std::string TaskQueueStats::DescribePostSite(const void* address) {
+  if (address == nullptr) {
+    return "unknown";
+  }
+  std::stringstream stream;
+#if !defined(OS_WIN)
+  Dl_info info;
+  if (::dladdr(address, &info) != 0 && info.dli_fname != nullptr) {
+    std::string module = info.dli_fname;
+    const size_t slash = module.find_last_of('/');
+    if (slash != std::string::npos) {
+      module = module.substr(slash + 1);
+    }
+    stream << module << "+0x" << std::hex
+           << (reinterpret_cast<uintptr_t>(address) -
+               reinterpret_cast<uintptr_t>(info.dli_fbase));
+    return stream.str();
+  }
+#endif
+  stream << address;
+  return stream.str();
+}
+
+}  // namespace fml
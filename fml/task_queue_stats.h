@@ -0,0 +1,85 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FML_TASK_QUEUE_STATS_H_
+#define FLUTTER_FML_TASK_QUEUE_STATS_H_
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "flutter/fml/latency_histogram.h"
+#include "flutter/fml/macros.h"
+#include "flutter/fml/task_source_grade.h"
+#include "flutter/fml/time/time_delta.h"
+
+namespace fml {
+
+/// How long the tasks that were posted to one task queue waited to run and
+/// how long they ran, by fml::TaskSourceGrade, and which post sites posted the
+/// tasks that ran the longest.
+///
+/// The queue delay of a task is measured from its target time, which is when
+/// it was posted unless it was posted for later, to when it started to run.
+/// The run time of a task includes the task observers that run after it,
+/// such as the Dart microtasks that it scheduled. Tasks are accounted to the
+/// queue they were posted to, even if the queue is merged into another one
+/// and its tasks run on the thread of that one.
+///
+/// The post sites are only accounted in non-release builds, where the
+/// service protocol reports them, so that release builds do not take a lock
+/// for every task.
+class TaskQueueStats {
+ public:
+  /// The tasks that were posted from one place.
+  struct PostSite {
+    /// The return address of the call that posted the tasks, or null if the
+    /// tasks were registered with the task queues directly.
+    const void* address = nullptr;
+    uint64_t task_count = 0;
+    fml::TimeDelta total_run_time;
+    fml::TimeDelta max_run_time;
+  };
+
+  TaskQueueStats();
+
+  ~TaskQueueStats();
+
+  /// Called by the thread that ran the task, once it has returned.
+  void RecordTask(TaskSourceGrade task_source_grade,
+                  const void* post_site,
+                  fml::TimeDelta queue_delay,
+                  fml::TimeDelta run_time);
+
+  const LatencyHistogram& GetQueueDelay(
+      TaskSourceGrade task_source_grade) const;
+
+  const LatencyHistogram& GetRunTime(TaskSourceGrade task_source_grade) const;
+
+  /// Returns up to |count| post sites ordered by the longest run time of
+  /// their tasks, longest first. Always empty in release builds.
+  std::vector<PostSite> GetSlowestPostSites(size_t count) const;
+
+  /// Describes |address| as the module it is in and the offset into it, so
+  /// that it can be symbolized with the symbols of that module.
+  static std::string DescribePostSite(const void* address);
+
+ private:
+  static constexpr size_t kTaskSourceGradeCount =
+      static_cast<size_t>(TaskSourceGrade::kUnspecified) + 1;
+
+  LatencyHistogram queue_delays_[kTaskSourceGradeCount];
+  LatencyHistogram run_times_[kTaskSourceGradeCount];
+
+  mutable std::mutex post_sites_mutex_;
+  std::unordered_map<const void*, PostSite> post_sites_;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(TaskQueueStats);
+};
+
+}  // namespace fml
+
+#endif  // FLUTTER_FML_TASK_QUEUE_STATS_H_
@@ -0,0 +1,72 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/fml/task_queue_stats.h"
+
+#include "gtest/gtest.h"
+
+namespace fml {
+namespace testing {
+
+TEST(TaskQueueStatsTest, RecordsByTaskSourceGrade) {
+  TaskQueueStats stats;
+  stats.RecordTask(TaskSourceGrade::kUserInteraction, nullptr,
+                   fml::TimeDelta::FromMicroseconds(10),
+                   fml::TimeDelta::FromMicroseconds(100));
+  stats.RecordTask(TaskSourceGrade::kUnspecified, nullptr,
+                   fml::TimeDelta::FromMicroseconds(20),
+                   fml::TimeDelta::FromMicroseconds(200));
+  stats.RecordTask(TaskSourceGrade::kUnspecified, nullptr,
+                   fml::TimeDelta::FromMicroseconds(30),
+                   fml::TimeDelta::FromMicroseconds(300));
+
+  EXPECT_EQ(stats.GetQueueDelay(TaskSourceGrade::kUserInteraction).GetCount(),
+            1u);
+  EXPECT_EQ(stats.GetRunTime(TaskSourceGrade::kUserInteraction).GetMax(),
+            fml::TimeDelta::FromMicroseconds(100));
+  EXPECT_EQ(stats.GetQueueDelay(TaskSourceGrade::kDartMicroTasks).GetCount(),
+            0u);
+  EXPECT_EQ(stats.GetQueueDelay(TaskSourceGrade::kUnspecified).GetMax(),
+            fml::TimeDelta::FromMicroseconds(30));
+  EXPECT_EQ(stats.GetRunTime(TaskSourceGrade::kUnspecified).GetCount(), 2u);
+}
+
+#if !FLUTTER_RELEASE
+TEST(TaskQueueStatsTest, OrdersPostSitesByLongestRunTime) {
+  TaskQueueStats stats;
+  int sites[3];
+  auto record = [&stats](const void* site, int64_t run_time_micros) {
+    stats.RecordTask(TaskSourceGrade::kUnspecified, site,
+                     fml::TimeDelta::Zero(),
+                     fml::TimeDelta::FromMicroseconds(run_time_micros));
+  };
+  record(&sites[0], 5);
+  record(&sites[0], 5);
+  record(&sites[1], 50);
+  record(&sites[2], 10);
+  record(&sites[2], 1);
+
+  std::vector<TaskQueueStats::PostSite> slowest =
+      stats.GetSlowestPostSites(2);
+  ASSERT_EQ(slowest.size(), 2u);
+  EXPECT_EQ(slowest[0].address, &sites[1]);
+  EXPECT_EQ(slowest[0].task_count, 1u);
+  EXPECT_EQ(slowest[1].address, &sites[2]);
+  EXPECT_EQ(slowest[1].task_count, 2u);
+  EXPECT_EQ(slowest[1].total_run_time, fml::TimeDelta::FromMicroseconds(11));
+  EXPECT_EQ(slowest[1].max_run_time, fml::TimeDelta::FromMicroseconds(10));
+
+  EXPECT_EQ(stats.GetSlowestPostSites(10).size(), 3u);
+}
+#endif  // !FLUTTER_RELEASE
+
+TEST(TaskQueueStatsTest, DescribesPostSites) {
+  EXPECT_EQ(TaskQueueStats::DescribePostSite(nullptr), "unknown");
+  const void* site = reinterpret_cast<const void*>(
+      &TaskQueueStats::DescribePostSite);
+  EXPECT_FALSE(TaskQueueStats::DescribePostSite(site).empty());
+}
+
+}  // namespace testing
+}  // namespace fml
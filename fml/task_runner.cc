@@ -21,18 +21,24 @@ TaskRunner::TaskRunner(fml::RefPtr<MessageLoopImpl> loop)
 
 TaskRunner::~TaskRunner() = default;
 
-void TaskRunner::PostTask(const fml::closure& task) {
-  loop_->PostTask(task, fml::TimePoint::Now());
+// The tasks are accounted to the code that called into the task runner, so
+// the post site is the return address of these calls rather than of the call
+// into the loop.
+
+void TaskRunner::PostTask(fml::UniqueClosure task) {
+  loop_->PostTask(std::move(task), fml::TimePoint::Now(),
+                  __builtin_return_address(0));
 }
 
-void TaskRunner::PostTaskForTime(const fml::closure& task,
+void TaskRunner::PostTaskForTime(fml::UniqueClosure task,
                                  fml::TimePoint target_time) {
-  loop_->PostTask(task, target_time);
+  loop_->PostTask(std::move(task), target_time, __builtin_return_address(0));
 }
 
-void TaskRunner::PostDelayedTask(const fml::closure& task,
+void TaskRunner::PostDelayedTask(fml::UniqueClosure task,
                                  fml::TimeDelta delay) {
-  loop_->PostTask(task, fml::TimePoint::Now() + delay);
+  loop_->PostTask(std::move(task), fml::TimePoint::Now() + delay,
+                  __builtin_return_address(0));
 }
 
 TaskQueueId TaskRunner::GetTaskQueueId() {
@@ -40,6 +46,14 @@ TaskQueueId TaskRunner::GetTaskQueueId() {
   return loop_->GetTaskQueueId();
 }
 
+std::shared_ptr<TaskQueueStats> TaskRunner::GetTaskQueueStats() {
+  if (!loop_) {
+    return nullptr;
+  }
+  return MessageLoopTaskQueues::GetInstance()->GetStats(
+      loop_->GetTaskQueueId());
+}
+
 bool TaskRunner::RunsTasksOnCurrentThread() {
   if (!fml::MessageLoop::IsInitializedForCurrentThread()) {
     return false;
@@ -53,7 +67,7 @@ bool TaskRunner::RunsTasksOnCurrentThread() {
 }
 
 void TaskRunner::RunNowOrPostTask(fml::RefPtr<fml::TaskRunner> runner,
-                                  const fml::closure& task) {
+                                  fml::UniqueClosure task) {
   FML_DCHECK(runner);
   if (runner->RunsTasksOnCurrentThread()) {
     task();
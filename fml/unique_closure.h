@@ -0,0 +1,165 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FML_UNIQUE_CLOSURE_H_
+#define FLUTTER_FML_UNIQUE_CLOSURE_H_
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "flutter/fml/logging.h"
+#include "flutter/fml/macros.h"
+
+namespace fml {
+
+// A move-only |fml::closure| for the tasks that are posted to the message
+// loops.
+//
+// Callables of up to |kInlineSize| bytes, which covers lambdas that capture
+// a handful of pointers, strings or |fml::closure|s, are stored inline, so
+// posting one makes no heap allocation. Larger callables are moved to the
+// heap once. Unlike |fml::closure|, the callable does not have to be
+// copyable, so a lambda that captures a |std::unique_ptr| or a
+// |std::promise| can be posted without |fml::MakeCopyable|.
+class UniqueClosure {
+ public:
+  static constexpr size_t kInlineSize = 7 * sizeof(void*);
+
+  // Whether a callable of type |F| is stored without a heap allocation.
+  //
+  // Move constructors that are not marked noexcept, like the one of
+  // |fml::RefPtr|, do not keep a callable out of the inline storage since
+  // the engine is built without exceptions.
+  template <typename F>
+  static constexpr bool StoresInline() {
+    return sizeof(F) <= kInlineSize && alignof(F) <= alignof(void*);
+  }
+
+  UniqueClosure() = default;
+
+  UniqueClosure(std::nullptr_t) {}  // NOLINT(google-explicit-constructor)
+
+  template <typename F,
+            typename Callable = std::decay_t<F>,
+            typename = std::enable_if_t<
+                !std::is_same_v<Callable, UniqueClosure> &&
+                std::is_invocable_r_v<void, Callable&>>>
+  UniqueClosure(F&& callable) {  // NOLINT(google-explicit-constructor)
+    if (IsNull(callable)) {
+      return;
+    }
+    if constexpr (StoresInline<Callable>()) {
+      new (storage_) Callable(std::forward<F>(callable));
+      ops_ = &InlineOps<Callable>::kOps;
+    } else {
+      new (storage_) Callable*(new Callable(std::forward<F>(callable)));
+      ops_ = &HeapOps<Callable>::kOps;
+    }
+  }
+
+  UniqueClosure(UniqueClosure&& other) noexcept { MoveFrom(other); }
+
+  UniqueClosure& operator=(UniqueClosure&& other) noexcept {
+    if (this != &other) {
+      Reset();
+      MoveFrom(other);
+    }
+    return *this;
+  }
+
+  UniqueClosure& operator=(std::nullptr_t) {
+    Reset();
+    return *this;
+  }
+
+  ~UniqueClosure() { Reset(); }
+
+  explicit operator bool() const { return ops_ != nullptr; }
+
+  bool operator==(std::nullptr_t) const { return ops_ == nullptr; }
+
+  bool operator!=(std::nullptr_t) const { return ops_ != nullptr; }
+
+  // Like |std::function|, a closure may be called more than once and
+  // through a const reference, even if the callable mutates its state.
+  void operator()() const {
+    FML_DCHECK(ops_) << "Called an empty closure.";
+    ops_->invoke(storage_);
+  }
+
+  // Destroys the callable.
+  void Reset() {
+    if (ops_) {
+      ops_->destroy(storage_);
+      ops_ = nullptr;
+    }
+  }
+
+ private:
+  struct Ops {
+    void (*invoke)(void* storage);
+    // Move constructs the callable in |to| and destroys the one in |from|.
+    void (*relocate)(void* from, void* to);
+    void (*destroy)(void* storage);
+  };
+
+  template <typename F>
+  struct InlineOps {
+    static F* Get(void* storage) {
+      return std::launder(reinterpret_cast<F*>(storage));
+    }
+    static void Invoke(void* storage) { (*Get(storage))(); }
+    static void Relocate(void* from, void* to) {
+      new (to) F(std::move(*Get(from)));
+      Get(from)->~F();
+    }
+    static void Destroy(void* storage) { Get(storage)->~F(); }
+    static constexpr Ops kOps = {&Invoke, &Relocate, &Destroy};
+  };
+
+  template <typename F>
+  struct HeapOps {
+    static F*& Get(void* storage) {
+      return *std::launder(reinterpret_cast<F**>(storage));
+    }
+    static void Invoke(void* storage) { (*Get(storage))(); }
+    static void Relocate(void* from, void* to) {
+      new (to) F*(Get(from));
+    }
+    static void Destroy(void* storage) { delete Get(storage); }
+    static constexpr Ops kOps = {&Invoke, &Relocate, &Destroy};
+  };
+
+  // An empty |fml::closure| or function pointer makes an empty closure, so
+  // that the checks of the message loops for empty tasks still apply.
+  template <typename F>
+  static bool IsNull(const F& callable) {
+    if constexpr (std::is_pointer_v<F> ||
+                  std::is_same_v<F, std::function<void()>>) {
+      return !callable;
+    } else {
+      return false;
+    }
+  }
+
+  void MoveFrom(UniqueClosure& other) {
+    if (other.ops_) {
+      other.ops_->relocate(other.storage_, storage_);
+      ops_ = other.ops_;
+      other.ops_ = nullptr;
+    }
+  }
+
+  alignas(void*) mutable unsigned char storage_[kInlineSize];
+  const Ops* ops_ = nullptr;
+
+  FML_DISALLOW_COPY_AND_ASSIGN(UniqueClosure);
+};
+
+}  // namespace fml
+
+#endif  // FLUTTER_FML_UNIQUE_CLOSURE_H_
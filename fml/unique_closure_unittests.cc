@@ -0,0 +1,104 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/fml/unique_closure.h"
+
+#include <array>
+#include <memory>
+#include <string>
+
+#include "flutter/fml/closure.h"
+#include "flutter/fml/memory/ref_counted.h"
+#include "flutter/fml/memory/ref_ptr.h"
+#include "gtest/gtest.h"
+
+namespace fml {
+namespace testing {
+
+namespace {
+class RefCountedObject : public RefCountedThreadSafe<RefCountedObject> {};
+}  // namespace
+
+TEST(UniqueClosureTest, StoresCommonTasksInline) {
+  static_assert(sizeof(UniqueClosure) == 8 * sizeof(void*));
+
+  auto capture_pointers = [a = 1, b = std::make_shared<int>(2),
+                           c = std::string("three")]() {};
+  static_assert(UniqueClosure::StoresInline<decltype(capture_pointers)>());
+  static_assert(UniqueClosure::StoresInline<fml::closure>());
+  auto capture_unique = [value = std::make_unique<int>(1)]() {};
+  static_assert(UniqueClosure::StoresInline<decltype(capture_unique)>());
+  auto capture_ref_ptr = [object = fml::RefPtr<RefCountedObject>(),
+                          closure = fml::closure()]() {};
+  static_assert(UniqueClosure::StoresInline<decltype(capture_ref_ptr)>());
+  auto capture_array = [array = std::array<void*, 16>()]() {};
+  static_assert(!UniqueClosure::StoresInline<decltype(capture_array)>());
+}
+
+TEST(UniqueClosureTest, CallsTheCallable) {
+  int count = 0;
+  UniqueClosure closure([&count]() { count++; });
+  ASSERT_TRUE(closure);
+  closure();
+  closure();
+  EXPECT_EQ(count, 2);
+
+  std::array<int, 32> values = {};
+  UniqueClosure large([&count, values]() { count += values.size(); });
+  large();
+  EXPECT_EQ(count, 34);
+}
+
+TEST(UniqueClosureTest, MovesMoveOnlyCallables) {
+  auto value = std::make_unique<int>(7);
+  int seen = 0;
+  UniqueClosure closure(
+      [value = std::move(value), &seen]() { seen = *value; });
+  UniqueClosure moved(std::move(closure));
+  EXPECT_FALSE(closure);  // NOLINT(bugprone-use-after-move)
+  UniqueClosure assigned;
+  assigned = std::move(moved);
+  assigned();
+  EXPECT_EQ(seen, 7);
+}
+
+TEST(UniqueClosureTest, DestroysTheCallableExactlyOnce) {
+  auto inline_value = std::make_shared<int>(0);
+  auto heap_value = std::make_shared<int>(0);
+  {
+    UniqueClosure inline_closure([inline_value]() {});
+    UniqueClosure heap_closure(
+        [heap_value, array = std::array<void*, 16>()]() {});
+    EXPECT_EQ(inline_value.use_count(), 2);
+    EXPECT_EQ(heap_value.use_count(), 2);
+
+    UniqueClosure moved_inline(std::move(inline_closure));
+    UniqueClosure moved_heap(std::move(heap_closure));
+    EXPECT_EQ(inline_value.use_count(), 2);
+    EXPECT_EQ(heap_value.use_count(), 2);
+
+    moved_inline = nullptr;
+    EXPECT_EQ(inline_value.use_count(), 1);
+  }
+  EXPECT_EQ(heap_value.use_count(), 1);
+}
+
+TEST(UniqueClosureTest, EmptyClosuresStayEmpty) {
+  EXPECT_EQ(UniqueClosure(), nullptr);
+  EXPECT_EQ(UniqueClosure(nullptr), nullptr);
+  EXPECT_EQ(UniqueClosure(fml::closure()), nullptr);
+  void (*function)() = nullptr;
+  EXPECT_EQ(UniqueClosure(function), nullptr);
+
+  int count = 0;
+  fml::closure closure = [&count]() { count++; };
+  UniqueClosure unique_closure(closure);
+  EXPECT_NE(unique_closure, nullptr);
+  unique_closure();
+  closure();
+  EXPECT_EQ(count, 2);
+}
+
+}  // namespace testing
+}  // namespace fml
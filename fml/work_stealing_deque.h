@@ -0,0 +1,143 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FLUTTER_FML_WORK_STEALING_DEQUE_H_
+#define FLUTTER_FML_WORK_STEALING_DEQUE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "flutter/fml/logging.h"
+#include "flutter/fml/macros.h"
+
+namespace fml {
+
+// A lock-free deque of pointers that one thread, the owner, pushes to and
+// pops from at the bottom while any other thread may steal from the top.
+//
+// This is the deque of Chase and Lev ("Dynamic Circular Work-Stealing
+// Deque", SPAA 2005) with the memory orderings of Le et al. ("Correct and
+// Efficient Work-Stealing for Weak Memory Models", PPoPP 2013), except
+// that the fences are folded into sequentially consistent loads and stores,
+// which ThreadSanitizer understands.
+//
+// The buffer grows when it is full. The buffers it outgrew are kept until
+// the deque is destroyed since a thief may still be reading from them.
+//
+// The deque does not own the items. It must be empty when it is destroyed.
+template <typename T>
+class WorkStealingDeque {
+ public:
+  static constexpr size_t kDefaultCapacity = 64;
+
+  explicit WorkStealingDeque(size_t capacity = kDefaultCapacity)
+      : top_(0), bottom_(0) {
+    FML_DCHECK(capacity > 0 && (capacity & (capacity - 1)) == 0)
+        << "The capacity must be a power of two.";
+    buffers_.push_back(std::make_unique<Buffer>(capacity));
+    buffer_.store(buffers_.back().get(), std::memory_order_relaxed);
+  }
+
+  ~WorkStealingDeque() { FML_DCHECK(IsEmpty()); }
+
+  // Only called by the owner.
+  void Push(T* item) {
+    int64_t bottom = bottom_.load(std::memory_order_relaxed);
+    int64_t top = top_.load(std::memory_order_acquire);
+    Buffer* buffer = buffer_.load(std::memory_order_relaxed);
+    if (bottom - top > static_cast<int64_t>(buffer->capacity) - 1) {
+      buffer = Grow(buffer, top, bottom);
+    }
+    buffer->Put(bottom, item);
+    bottom_.store(bottom + 1, std::memory_order_release);
+  }
+
+  // Only called by the owner. Returns the item that was pushed last, or
+  // nullptr if the deque is empty.
+  T* Pop() {
+    int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+    Buffer* buffer = buffer_.load(std::memory_order_relaxed);
+    bottom_.store(bottom, std::memory_order_seq_cst);
+    int64_t top = top_.load(std::memory_order_seq_cst);
+    if (top > bottom) {
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    T* item = buffer->Get(bottom);
+    if (top == bottom) {
+      // This is the last item, which a thief may be stealing as well.
+      if (!top_.compare_exchange_strong(top, top + 1,
+                                        std::memory_order_seq_cst,
+                                        std::memory_order_relaxed)) {
+        item = nullptr;
+      }
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return item;
+  }
+
+  // Called by any thread. Returns the item that was pushed first, or
+  // nullptr if the deque is empty or another thread took that item first.
+  T* Steal() {
+    int64_t top = top_.load(std::memory_order_seq_cst);
+    int64_t bottom = bottom_.load(std::memory_order_seq_cst);
+    if (top >= bottom) {
+      return nullptr;
+    }
+    Buffer* buffer = buffer_.load(std::memory_order_acquire);
+    T* item = buffer->Get(top);
+    if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed)) {
+      return nullptr;
+    }
+    return item;
+  }
+
+  // Whether the deque looked empty at some point during the call.
+  bool IsEmpty() const {
+    return bottom_.load(std::memory_order_relaxed) <=
+           top_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct Buffer {
+    explicit Buffer(size_t capacity)
+        : capacity(capacity), items(new std::atomic<T*>[capacity]) {}
+
+    T* Get(int64_t index) const {
+      return items[index & (capacity - 1)].load(std::memory_order_relaxed);
+    }
+
+    void Put(int64_t index, T* item) {
+      items[index & (capacity - 1)].store(item, std::memory_order_relaxed);
+    }
+
+    const size_t capacity;
+    std::unique_ptr<std::atomic<T*>[]> items;
+  };
+
+  std::atomic<int64_t> top_;
+  std::atomic<int64_t> bottom_;
+  std::atomic<Buffer*> buffer_;
+  // Only used by the owner.
+  std::vector<std::unique_ptr<Buffer>> buffers_;
+
+  Buffer* Grow(Buffer* buffer, int64_t top, int64_t bottom) {
+    auto grown = std::make_unique<Buffer>(buffer->capacity * 2);
+    for (int64_t i = top; i < bottom; i++) {
+      grown->Put(i, buffer->Get(i));
+    }
+    buffers_.push_back(std::move(grown));
+    buffer_.store(buffers_.back().get(), std::memory_order_release);
+    return buffers_.back().get();
+  }
+
+  FML_DISALLOW_COPY_AND_ASSIGN(WorkStealingDeque);
+};
+
+}  // namespace fml
+
+#endif  // FLUTTER_FML_WORK_STEALING_DEQUE_H_
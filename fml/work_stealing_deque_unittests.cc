@@ -0,0 +1,101 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/fml/work_stealing_deque.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace fml {
+namespace testing {
+
+TEST(WorkStealingDequeTest, OwnerPopsNewestFirst) {
+  int items[3] = {0, 1, 2};
+  WorkStealingDeque<int> deque;
+  EXPECT_TRUE(deque.IsEmpty());
+  EXPECT_EQ(deque.Pop(), nullptr);
+  for (int& item : items) {
+    deque.Push(&item);
+  }
+  EXPECT_FALSE(deque.IsEmpty());
+  EXPECT_EQ(deque.Pop(), &items[2]);
+  EXPECT_EQ(deque.Pop(), &items[1]);
+  EXPECT_EQ(deque.Pop(), &items[0]);
+  EXPECT_EQ(deque.Pop(), nullptr);
+  EXPECT_TRUE(deque.IsEmpty());
+}
+
+TEST(WorkStealingDequeTest, ThievesStealOldestFirst) {
+  int items[3] = {0, 1, 2};
+  WorkStealingDeque<int> deque;
+  EXPECT_EQ(deque.Steal(), nullptr);
+  for (int& item : items) {
+    deque.Push(&item);
+  }
+  EXPECT_EQ(deque.Steal(), &items[0]);
+  EXPECT_EQ(deque.Pop(), &items[2]);
+  EXPECT_EQ(deque.Steal(), &items[1]);
+  EXPECT_EQ(deque.Steal(), nullptr);
+  EXPECT_EQ(deque.Pop(), nullptr);
+}
+
+TEST(WorkStealingDequeTest, GrowsWhenFull) {
+  std::vector<int> items(100);
+  WorkStealingDeque<int> deque(4);
+  for (int& item : items) {
+    deque.Push(&item);
+  }
+  EXPECT_EQ(deque.Steal(), &items[0]);
+  for (size_t i = items.size() - 1; i > 0; i--) {
+    EXPECT_EQ(deque.Pop(), &items[i]);
+  }
+  EXPECT_TRUE(deque.IsEmpty());
+}
+
+TEST(WorkStealingDequeTest, EveryItemIsTakenOnce) {
+  const size_t kItemCount = 100000;
+  const size_t kThiefCount = 4;
+  std::vector<std::atomic<int>> taken(kItemCount);
+  std::vector<int> items(kItemCount);
+  WorkStealingDeque<int> deque;
+  std::atomic<bool> done = false;
+
+  auto take = [&](int* item) { taken[item - items.data()]++; };
+  std::vector<std::thread> thieves;
+  for (size_t i = 0; i < kThiefCount; i++) {
+    thieves.emplace_back([&]() {
+      while (!done || !deque.IsEmpty()) {
+        if (int* item = deque.Steal()) {
+          take(item);
+        }
+      }
+    });
+  }
+  // The owner pops some of the items while the thieves steal the others.
+  for (size_t i = 0; i < kItemCount; i++) {
+    deque.Push(&items[i]);
+    if (i % 3 == 0) {
+      if (int* item = deque.Pop()) {
+        take(item);
+      }
+    }
+  }
+  while (int* item = deque.Pop()) {
+    take(item);
+  }
+  done = true;
+  for (std::thread& thief : thieves) {
+    thief.join();
+  }
+
+  for (size_t i = 0; i < kItemCount; i++) {
+    ASSERT_EQ(taken[i], 1) << "Item " << i;
+  }
+}
+
+}  // namespace testing
+}  // namespace fml
@@ -4,6 +4,7 @@
 
 #include "flutter/lib/ui/painting/picture_recorder.h"
 
+#include "flutter/flow/display_list_optimizer.h"
 #include "flutter/lib/ui/painting/canvas.h"
 #include "flutter/lib/ui/painting/picture.h"
 #include "third_party/tonic/converter/dart_converter.h"
@@ -41,7 +42,11 @@ PictureRecorder::~PictureRecorder() {}
 SkCanvas* PictureRecorder::BeginRecording(SkRect bounds) {
   bool enable_display_list = UIDartState::Current()->enable_display_list();
   if (enable_display_list) {
-    display_list_recorder_ = sk_make_sp<DisplayListCanvasRecorder>(bounds);
+    display_list_recorder_ =
+        sk_make_sp<DisplayListCanvasRecorder>(bounds, /*prepare_rtree=*/true);
+    display_list_storage_pool_ = DisplayListStoragePool::ForCurrentThread();
+    display_list_recorder_->builder()->SetStoragePool(
+        display_list_storage_pool_, display_list_storage_pool_->GetSizeHint());
     return display_list_recorder_.get();
   } else {
     return picture_recorder_.beginRecording(bounds, &rtree_factory_);
@@ -56,10 +61,13 @@ fml::RefPtr<Picture> PictureRecorder::endRecording(Dart_Handle dart_picture) {
   fml::RefPtr<Picture> picture;
 
   if (display_list_recorder_) {
-    picture = Picture::Create(
-        dart_picture,
-        UIDartState::CreateGPUObject(display_list_recorder_->Build()));
+    sk_sp<DisplayList> recorded = display_list_recorder_->Build();
+    display_list_storage_pool_->RecordSize(recorded->bytes());
+    sk_sp<DisplayList> display_list = DisplayListOptimizer::Optimize(recorded);
+    picture = Picture::Create(dart_picture,
+                              UIDartState::CreateGPUObject(display_list));
     display_list_recorder_ = nullptr;
+    display_list_storage_pool_ = nullptr;
   } else {
     picture = Picture::Create(
         dart_picture, UIDartState::CreateGPUObject(
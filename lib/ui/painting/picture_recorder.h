@@ -44,6 +44,7 @@ class PictureRecorder : public RefCountedDartWrappable<PictureRecorder> {
   SkPictureRecorder picture_recorder_;
 
   sk_sp<DisplayListCanvasRecorder> display_list_recorder_;
+  std::shared_ptr<DisplayListStoragePool> display_list_storage_pool_;
 
   fml::RefPtr<Canvas> canvas_;
 };
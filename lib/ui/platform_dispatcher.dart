@@ -1193,6 +1193,13 @@ enum _FrameTimingInfo {
   /// The number of bytes used to cache pictures during the frame.
   pictureCacheBytes,
 
+  /// The number of draws during the frame that used a raster cache image.
+  rasterCacheHitCount,
+
+  /// The number of draws during the frame of content that had a raster cache
+  /// entry but no image yet.
+  rasterCacheMissCount,
+
   /// The frame number of the frame.
   frameNumber,
 }
@@ -1228,6 +1235,8 @@ class FrameTiming {
     int layerCacheBytes = 0,
     int pictureCacheCount = 0,
     int pictureCacheBytes = 0,
+    int rasterCacheHitCount = 0,
+    int rasterCacheMissCount = 0,
     int frameNumber = -1,
   }) {
     return FrameTiming._(<int>[
@@ -1241,6 +1250,8 @@ class FrameTiming {
       layerCacheBytes,
       pictureCacheCount,
       pictureCacheBytes,
+      rasterCacheHitCount,
+      rasterCacheMissCount,
       frameNumber,
     ]);
   }
@@ -1332,6 +1343,23 @@ class FrameTiming {
   /// See also [layerCacheCount], [layerCacheBytes], [pictureCacheCount] and [pictureCacheBytes].
   double get pictureCacheMegabytes => pictureCacheBytes / 1024.0 / 1024.0;
 
+  /// The number of times the raster cache provided the image of a picture or
+  /// layer during the frame.
+  ///
+  /// See also [rasterCacheMissCount].
+  int get rasterCacheHitCount => _rawInfo(_FrameTimingInfo.rasterCacheHitCount);
+
+  /// The number of times a picture or layer was rendered during the frame
+  /// although the raster cache had an entry for it, because the entry had no
+  /// image yet or its image was evicted.
+  ///
+  /// A rising count points at content that the raster cache keeps
+  /// rasterizing or evicting. The `_flutter.getRasterCacheReport` service
+  /// extension attributes the misses to the pictures and layers.
+  ///
+  /// See also [rasterCacheHitCount].
+  int get rasterCacheMissCount => _rawInfo(_FrameTimingInfo.rasterCacheMissCount);
+
   /// The frame key associated with this frame measurement.
   int get frameNumber => _data.last;
 
@@ -1349,6 +1377,8 @@ class FrameTiming {
         'layerCacheBytes: $layerCacheBytes, '
         'pictureCacheCount: $pictureCacheCount, '
         'pictureCacheBytes: $pictureCacheBytes, '
+        'rasterCacheHitCount: $rasterCacheHitCount, '
+        'rasterCacheMissCount: $rasterCacheMissCount, '
         'frameNumber: ${_data.last})';
   }
 }
@@ -212,6 +212,8 @@ enum _FrameTimingInfo {
   layerCacheBytes,
   pictureCacheCount,
   pictureCacheBytes,
+  rasterCacheHitCount,
+  rasterCacheMissCount,
   frameNumber,
 }
 
@@ -227,6 +229,8 @@ class FrameTiming {
     int layerCacheBytes = 0,
     int pictureCacheCount = 0,
     int pictureCacheBytes = 0,
+    int rasterCacheHitCount = 0,
+    int rasterCacheMissCount = 0,
     int frameNumber = 1,
   }) {
     return FrameTiming._(<int>[
@@ -240,6 +244,8 @@ class FrameTiming {
       layerCacheBytes,
       pictureCacheCount,
       pictureCacheBytes,
+      rasterCacheHitCount,
+      rasterCacheMissCount,
       frameNumber,
     ]);
   }
@@ -278,6 +284,10 @@ class FrameTiming {
 
   double get pictureCacheMegabytes => pictureCacheBytes / 1024.0 / 1024.0;
 
+  int get rasterCacheHitCount => _rawInfo(_FrameTimingInfo.rasterCacheHitCount);
+
+  int get rasterCacheMissCount => _rawInfo(_FrameTimingInfo.rasterCacheMissCount);
+
   int get frameNumber => _data.last;
 
   final List<int> _data;  // some elements in microseconds, some in bytes, some are counts
@@ -294,6 +304,8 @@ class FrameTiming {
         'layerCacheBytes: $layerCacheBytes, '
         'pictureCacheCount: $pictureCacheCount, '
         'pictureCacheBytes: $pictureCacheBytes, '
+        'rasterCacheHitCount: $rasterCacheHitCount, '
+        'rasterCacheMissCount: $rasterCacheMissCount, '
         'frameNumber: ${_data.last})';
   }
 }
@@ -45,5 +45,7 @@ Future<void> runFrameTimingsTest() async {
     expect(timing.layerCacheBytes, equals(0));
     expect(timing.pictureCacheCount, equals(0));
     expect(timing.pictureCacheBytes, equals(0));
+    expect(timing.rasterCacheHitCount, equals(0));
+    expect(timing.rasterCacheMissCount, equals(0));
   }
 }
@@ -8,6 +8,7 @@
 
 #include <mutex>
 #include <sstream>
+#include <thread>
 #include <vector>
 
 #include "flutter/common/settings.h"
@@ -271,9 +272,16 @@ size_t DartVM::GetVMLaunchCount() {
 DartVM::DartVM(std::shared_ptr<const DartVMData> vm_data,
                std::shared_ptr<IsolateNameServer> isolate_name_server)
     : settings_(vm_data->GetSettings()),
-      concurrent_message_loop_(fml::ConcurrentMessageLoop::Create()),
+      concurrent_message_loop_(fml::ConcurrentMessageLoop::Create(
+          std::thread::hardware_concurrency(),
+          settings_.enable_work_stealing_workers
+              ? fml::ConcurrentMessageLoop::Scheduling::kWorkStealing
+              : fml::ConcurrentMessageLoop::Scheduling::kSharedQueue)),
       skia_concurrent_executor_(
-          [runner = concurrent_message_loop_->GetTaskRunner()](
+          // Skia posts the compiles of the shaders that a frame is waiting
+          // for.
+          [runner = concurrent_message_loop_->GetTaskRunner(
+               fml::ConcurrentTaskPriority::kFrameCritical)](
               fml::closure work) { runner->PostTask(work); }),
       vm_data_(vm_data),
       isolate_name_server_(std::move(isolate_name_server)),
@@ -504,8 +512,9 @@ std::shared_ptr<IsolateNameServer> DartVM::GetIsolateNameServer() const {
 }
 
 std::shared_ptr<fml::ConcurrentTaskRunner>
-DartVM::GetConcurrentWorkerTaskRunner() const {
-  return concurrent_message_loop_->GetTaskRunner();
+DartVM::GetConcurrentWorkerTaskRunner(
+    fml::ConcurrentTaskPriority priority) const {
+  return concurrent_message_loop_->GetTaskRunner(priority);
 }
 
 std::shared_ptr<fml::ConcurrentMessageLoop> DartVM::GetConcurrentMessageLoop() {
@@ -11,6 +11,7 @@
 #include "flutter/common/settings.h"
 #include "flutter/fml/build_config.h"
 #include "flutter/fml/closure.h"
+#include "flutter/fml/concurrent_message_loop.h"
 #include "flutter/fml/macros.h"
 #include "flutter/fml/memory/ref_counted.h"
 #include "flutter/fml/memory/ref_ptr.h"
@@ -142,10 +143,14 @@ class DartVM {
   ///             Dart VM lifecycle for the lifecycle of the concurrent worker
   ///             pool as well.
   ///
+  /// @param[in]  priority  The priority that the returned task runner posts
+  ///                       its tasks with by default.
+  ///
   /// @return     The task runner for the concurrent worker thread pool.
   ///
-  std::shared_ptr<fml::ConcurrentTaskRunner> GetConcurrentWorkerTaskRunner()
-      const;
+  std::shared_ptr<fml::ConcurrentTaskRunner> GetConcurrentWorkerTaskRunner(
+      fml::ConcurrentTaskPriority priority =
+          fml::ConcurrentTaskPriority::kNormal) const;
 
   //----------------------------------------------------------------------------
   /// @brief      The concurrent message loop hosts threads that are used by the
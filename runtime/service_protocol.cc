@@ -37,6 +37,10 @@ const std::string_view ServiceProtocol::kGetSkSLsExtensionName =
 const std::string_view
     ServiceProtocol::kEstimateRasterCacheMemoryExtensionName =
         "_flutter.estimateRasterCacheMemory";
+const std::string_view ServiceProtocol::kGetRasterCacheReportExtensionName =
+    "_flutter.getRasterCacheReport";
+const std::string_view ServiceProtocol::kGetTaskQueueStatsExtensionName =
+    "_flutter.getTaskQueueStats";
 
 static constexpr std::string_view kViewIdPrefx = "_flutterView/";
 static constexpr std::string_view kListViewsExtensionName =
@@ -56,6 +60,8 @@ ServiceProtocol::ServiceProtocol()
           kGetDisplayRefreshRateExtensionName,
           kGetSkSLsExtensionName,
           kEstimateRasterCacheMemoryExtensionName,
+          kGetRasterCacheReportExtensionName,
+          kGetTaskQueueStatsExtensionName,
       }),
       handlers_mutex_(fml::SharedMutex::Create()) {}
 
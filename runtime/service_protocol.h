@@ -29,6 +29,8 @@ class ServiceProtocol {
   static const std::string_view kGetDisplayRefreshRateExtensionName;
   static const std::string_view kGetSkSLsExtensionName;
   static const std::string_view kEstimateRasterCacheMemoryExtensionName;
+  static const std::string_view kGetRasterCacheReportExtensionName;
+  static const std::string_view kGetTaskQueueStatsExtensionName;
 
   class Handler {
    public:
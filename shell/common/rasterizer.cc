@@ -35,6 +35,21 @@ Rasterizer::Rasterizer(Delegate& delegate)
       user_override_resource_cache_bytes_(false),
       weak_factory_(this) {
   FML_DCHECK(compositor_context_);
+  compositor_context_->set_tiled_raster_task_runner(
+      delegate.GetTiledRasterTaskRunner());
+  size_t raster_cache_max_bytes = delegate.GetRasterCacheMaxBytes();
+  if (raster_cache_max_bytes > 0) {
+    compositor_context_->raster_cache().SetMaxBytes(raster_cache_max_bytes);
+  }
+  std::optional<float> raster_cache_scale_tolerance =
+      delegate.GetRasterCacheScaleTolerance();
+  if (raster_cache_scale_tolerance.has_value()) {
+    compositor_context_->raster_cache().SetScaleTolerance(
+        raster_cache_scale_tolerance.value());
+  }
+  compositor_context_->raster_cache().SetBackgroundTaskRunner(
+      delegate.GetRasterCacheTaskRunner());
+  compositor_context_->set_preroll_task_runner(delegate.GetPrerollTaskRunner());
 }
 
 Rasterizer::~Rasterizer() = default;
@@ -50,6 +65,7 @@ fml::TaskRunnerAffineWeakPtr<SnapshotDelegate> Rasterizer::GetSnapshotDelegate()
 
 void Rasterizer::Setup(std::unique_ptr<Surface> surface) {
   surface_ = std::move(surface);
+  damage_history_.Reset();
 
   if (max_cache_bytes_.has_value()) {
     SetResourceCacheMaxBytes(max_cache_bytes_.value(),
@@ -537,18 +553,49 @@ RasterStatus Rasterizer::DrawToSurfaceUnsafe(
       raster_thread_merger_           // thread merger
   );
   if (compositor_frame) {
-    RasterStatus raster_status = compositor_frame->Raster(layer_tree, false);
+    std::unique_ptr<FrameDamage> damage;
+    if (delegate_.IsPartialRepaintEnabled()) {
+      // Every frame is diffed so that the next frame can be diffed against
+      // it, even if this one has to be painted completely.
+      damage = std::make_unique<FrameDamage>();
+      damage->SetPreviousLayerTree(last_layer_tree_.get());
+      // Embedders that provide the root canvas report the damage of its
+      // target themselves. Other embedders may paint parts of the frame into
+      // overlays, which are always painted completely.
+      if (!external_view_embedder_ &&
+          frame->framebuffer_info().supports_partial_repaint) {
+        damage->SetExistingDamage(damage_history_.GetExistingDamage(
+            layer_tree.frame_size(), frame->framebuffer_info().buffer_age));
+      }
+    }
+
+    RasterStatus raster_status =
+        compositor_frame->Raster(layer_tree, false, damage.get());
     if (raster_status == RasterStatus::kFailed ||
         raster_status == RasterStatus::kSkipAndRetry) {
       return raster_status;
     }
+    if (damage) {
+      SurfaceFrame::SubmitInfo submit_info;
+      submit_info.frame_damage = damage->GetFrameDamage();
+      submit_info.buffer_damage = damage->GetBufferDamage();
+      frame->set_submit_info(submit_info);
+    }
     if (external_view_embedder_ &&
         (!raster_thread_merger_ || raster_thread_merger_->IsMerged())) {
       FML_DCHECK(!frame->IsSubmitted());
       external_view_embedder_->SubmitFrame(surface_->GetContext(),
                                            std::move(frame));
     } else {
-      frame->Submit();
+      bool submitted = frame->Submit();
+      // Framebuffers that are older than the last frame miss the damage of
+      // the frames that were submitted since.
+      if (damage && submitted && raster_status == RasterStatus::kSuccess) {
+        damage_history_.AddFrameDamage(layer_tree.frame_size(),
+                                       damage->GetFrameDamage());
+      } else {
+        damage_history_.Reset();
+      }
     }
 
     frame_timings_recorder.RecordRasterEnd(
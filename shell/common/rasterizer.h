@@ -95,6 +95,47 @@ class Rasterizer final : public SnapshotDelegate {
     /// is critical that GPU operations are not processed.
     virtual std::shared_ptr<const fml::SyncSwitch> GetIsGpuDisabledSyncSwitch()
         const = 0;
+
+    /// The task runner used to rasterize frames in tiles on multiple threads
+    /// when the surface is rendered by the Skia software backend, or null if
+    /// that is disabled.
+    ///
+    /// See: `Settings::enable_tiled_software_rendering`.
+    virtual std::shared_ptr<fml::ConcurrentTaskRunner>
+    GetTiledRasterTaskRunner() const = 0;
+
+    /// The maximum number of bytes that the images in the raster cache may
+    /// take, or 0 to use the default limit of the raster cache.
+    ///
+    /// See: `Settings::raster_cache_max_bytes`.
+    virtual size_t GetRasterCacheMaxBytes() const = 0;
+
+    /// The scale tolerance of the raster cache, or unset to use the default
+    /// tolerance of the raster cache.
+    ///
+    /// See: `Settings::raster_cache_scale_tolerance`.
+    virtual std::optional<float> GetRasterCacheScaleTolerance() const = 0;
+
+    /// The task runner used to rasterize the images of the raster cache in
+    /// the background, or null if they are rasterized on the raster thread.
+    ///
+    /// See: `Settings::enable_background_raster_cache`.
+    virtual std::shared_ptr<fml::ConcurrentTaskRunner>
+    GetRasterCacheTaskRunner() const = 0;
+
+    /// Whether frames are diffed against the previous frame so that only
+    /// the part of the frame that changed is repainted.
+    ///
+    /// See: `Settings::enable_partial_repaint`.
+    virtual bool IsPartialRepaintEnabled() const = 0;
+
+    /// The task runner used to preroll the children of container layers
+    /// concurrently, or null if layer trees are prerolled on the raster
+    /// thread only.
+    ///
+    /// See: `Settings::enable_concurrent_preroll`.
+    virtual std::shared_ptr<fml::ConcurrentTaskRunner> GetPrerollTaskRunner()
+        const = 0;
   };
 
   //----------------------------------------------------------------------------
@@ -454,6 +495,8 @@ class Rasterizer final : public SnapshotDelegate {
   std::unique_ptr<flutter::CompositorContext> compositor_context_;
   // This is the last successfully rasterized layer tree.
   std::unique_ptr<flutter::LayerTree> last_layer_tree_;
+  // The damage of the last frames that were submitted to |surface_|.
+  DamageHistory damage_history_;
   // Set when we need attempt to rasterize the layer tree again. This layer_tree
   // has not successfully rasterized. This can happen due to the change in the
   // thread configuration. This will be inserted to the front of the pipeline.
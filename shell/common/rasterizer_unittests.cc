@@ -32,6 +32,15 @@ class MockDelegate : public Rasterizer::Delegate {
                      const fml::RefPtr<fml::RasterThreadMerger>());
   MOCK_CONST_METHOD0(GetIsGpuDisabledSyncSwitch,
                      std::shared_ptr<const fml::SyncSwitch>());
+  MOCK_CONST_METHOD0(GetTiledRasterTaskRunner,
+                     std::shared_ptr<fml::ConcurrentTaskRunner>());
+  MOCK_CONST_METHOD0(GetRasterCacheMaxBytes, size_t());
+  MOCK_CONST_METHOD0(GetRasterCacheScaleTolerance, std::optional<float>());
+  MOCK_CONST_METHOD0(GetRasterCacheTaskRunner,
+                     std::shared_ptr<fml::ConcurrentTaskRunner>());
+  MOCK_CONST_METHOD0(IsPartialRepaintEnabled, bool());
+  MOCK_CONST_METHOD0(GetPrerollTaskRunner,
+                     std::shared_ptr<fml::ConcurrentTaskRunner>());
   MOCK_METHOD0(CreateSnapshotSurface, std::unique_ptr<Surface>());
 };
 
@@ -80,6 +89,21 @@ TEST(RasterizerTest, create) {
   EXPECT_TRUE(rasterizer != nullptr);
 }
 
+TEST(RasterizerTest, usesTheRasterCacheScaleToleranceOfTheDelegate) {
+  MockDelegate delegate;
+  EXPECT_CALL(delegate, GetRasterCacheScaleTolerance())
+      .WillOnce(Return(std::optional<float>()));
+  auto rasterizer = std::make_unique<Rasterizer>(delegate);
+  EXPECT_EQ(rasterizer->compositor_context()->raster_cache().scale_tolerance(),
+            RasterCache::kDefaultScaleTolerance);
+
+  EXPECT_CALL(delegate, GetRasterCacheScaleTolerance())
+      .WillOnce(Return(std::optional<float>(0)));
+  rasterizer = std::make_unique<Rasterizer>(delegate);
+  EXPECT_EQ(rasterizer->compositor_context()->raster_cache().scale_tolerance(),
+            0);
+}
+
 static std::unique_ptr<FrameTimingsRecorder> CreateFinishedBuildRecorder() {
   std::unique_ptr<FrameTimingsRecorder> recorder =
       std::make_unique<FrameTimingsRecorder>();
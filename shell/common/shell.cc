@@ -5,12 +5,14 @@
 #define RAPIDJSON_HAS_STDSTRING 1
 #include "flutter/shell/common/shell.h"
 
+#include <algorithm>
 #include <memory>
 #include <sstream>
 #include <vector>
 
 #include "flutter/assets/directory_asset_bundle.h"
 #include "flutter/common/graphics/persistent_cache.h"
+#include "flutter/flow/display_list_storage_pool.h"
 #include "flutter/fml/base32.h"
 #include "flutter/fml/file.h"
 #include "flutter/fml/icu_util.h"
@@ -19,6 +21,7 @@
 #include "flutter/fml/make_copyable.h"
 #include "flutter/fml/message_loop.h"
 #include "flutter/fml/paths.h"
+#include "flutter/fml/task_queue_stats.h"
 #include "flutter/fml/trace_event.h"
 #include "flutter/fml/unique_fd.h"
 #include "flutter/runtime/dart_vm.h"
@@ -423,6 +426,16 @@ Shell::Shell(DartVMRef vm,
           task_runners_.GetRasterTaskRunner(),
           std::bind(&Shell::OnServiceProtocolEstimateRasterCacheMemory, this,
                     std::placeholders::_1, std::placeholders::_2)};
+  service_protocol_handlers_
+      [ServiceProtocol::kGetRasterCacheReportExtensionName] = {
+          task_runners_.GetRasterTaskRunner(),
+          std::bind(&Shell::OnServiceProtocolGetRasterCacheReport, this,
+                    std::placeholders::_1, std::placeholders::_2)};
+  service_protocol_handlers_
+      [ServiceProtocol::kGetTaskQueueStatsExtensionName] = {
+          task_runners_.GetIOTaskRunner(),
+          std::bind(&Shell::OnServiceProtocolGetTaskQueueStats, this,
+                    std::placeholders::_1, std::placeholders::_2)};
 }
 
 Shell::~Shell() {
@@ -525,6 +538,8 @@ void Shell::NotifyLowMemoryWarning() const {
   // DartVMRef, we can be certain that this is a safe spot to assume a VM is
   // running.
   ::Dart_NotifyLowMemory();
+  // The free blocks of the pools are held for DisplayLists of later frames.
+  DisplayListStoragePool::PurgeAll();
 
   task_runners_.GetRasterTaskRunner()->PostTask(
       [rasterizer = rasterizer_->GetWeakPtr(), trace_id = trace_id]() {
@@ -1395,6 +1410,8 @@ void Shell::OnFrameRasterized(const FrameTiming& timing) {
   unreported_timings_.push_back(timing.GetLayerCacheBytes());
   unreported_timings_.push_back(timing.GetPictureCacheCount());
   unreported_timings_.push_back(timing.GetPictureCacheBytes());
+  unreported_timings_.push_back(timing.GetRasterCacheHitCount());
+  unreported_timings_.push_back(timing.GetRasterCacheMissCount());
   unreported_timings_.push_back(timing.GetFrameNumber());
   FML_DCHECK(unreported_timings_.size() ==
              old_count + FrameTiming::kStatisticsCount);
@@ -1448,6 +1465,50 @@ fml::Milliseconds Shell::GetFrameBudget() {
   }
 }
 
+// |Rasterizer::Delegate|
+std::shared_ptr<fml::ConcurrentTaskRunner> Shell::GetTiledRasterTaskRunner()
+    const {
+  if (!settings_.enable_tiled_software_rendering) {
+    return nullptr;
+  }
+  return vm_->GetConcurrentWorkerTaskRunner(
+      fml::ConcurrentTaskPriority::kFrameCritical);
+}
+
+// |Rasterizer::Delegate|
+size_t Shell::GetRasterCacheMaxBytes() const {
+  return settings_.raster_cache_max_bytes;
+}
+
+// |Rasterizer::Delegate|
+std::optional<float> Shell::GetRasterCacheScaleTolerance() const {
+  return settings_.raster_cache_scale_tolerance;
+}
+
+// |Rasterizer::Delegate|
+std::shared_ptr<fml::ConcurrentTaskRunner> Shell::GetRasterCacheTaskRunner()
+    const {
+  if (!settings_.enable_background_raster_cache) {
+    return nullptr;
+  }
+  return vm_->GetConcurrentWorkerTaskRunner(
+      fml::ConcurrentTaskPriority::kBackground);
+}
+
+// |Rasterizer::Delegate|
+bool Shell::IsPartialRepaintEnabled() const {
+  return settings_.enable_partial_repaint;
+}
+
+// |Rasterizer::Delegate|
+std::shared_ptr<fml::ConcurrentTaskRunner> Shell::GetPrerollTaskRunner() const {
+  if (!settings_.enable_concurrent_preroll) {
+    return nullptr;
+  }
+  return vm_->GetConcurrentWorkerTaskRunner(
+      fml::ConcurrentTaskPriority::kFrameCritical);
+}
+
 fml::TimePoint Shell::GetLatestFrameTargetTime() const {
   std::scoped_lock time_recorder_lock(time_recorder_mutex_);
   FML_CHECK(latest_frame_target_time_.has_value())
@@ -1723,6 +1784,186 @@ bool Shell::OnServiceProtocolEstimateRasterCacheMemory(
   return true;
 }
 
+static const char* RasterCacheSourceName(
+    RasterCacheEntryReport::Source source) {
+  switch (source) {
+    case RasterCacheEntryReport::Source::kPicture:
+      return "picture";
+    case RasterCacheEntryReport::Source::kDisplayList:
+      return "displayList";
+    case RasterCacheEntryReport::Source::kLayer:
+      return "layer";
+  }
+  FML_UNREACHABLE();
+}
+
+static const char* RasterCacheEvictionReasonName(
+    RasterCacheEntryReport::EvictionReason reason) {
+  switch (reason) {
+    case RasterCacheEntryReport::EvictionReason::kNone:
+      return "none";
+    case RasterCacheEntryReport::EvictionReason::kBudget:
+      return "budget";
+    case RasterCacheEntryReport::EvictionReason::kUnused:
+      return "unused";
+  }
+  FML_UNREACHABLE();
+}
+
+bool Shell::OnServiceProtocolGetRasterCacheReport(
+    const ServiceProtocol::Handler::ServiceProtocolMap& params,
+    rapidjson::Document* response) {
+  FML_DCHECK(task_runners_.GetRasterTaskRunner()->RunsTasksOnCurrentThread());
+  const RasterCacheFrameReport& report =
+      rasterizer_->compositor_context()->raster_cache().last_frame_report();
+  auto& allocator = response->GetAllocator();
+  response->SetObject();
+  response->AddMember("type", "RasterCacheReport", allocator);
+  response->AddMember("frame", report.frame, allocator);
+  response->AddMember<uint64_t>("hits", report.hits, allocator);
+  response->AddMember<uint64_t>("misses", report.misses, allocator);
+  response->AddMember<int64_t>("rasterizationMicros",
+                               report.rasterization_time.ToMicroseconds(),
+                               allocator);
+  rapidjson::Value entries(rapidjson::kArrayType);
+  for (const RasterCacheEntryReport& entry : report.entries) {
+    rapidjson::Value entry_json(rapidjson::kObjectType);
+    entry_json.AddMember(
+        "source", rapidjson::StringRef(RasterCacheSourceName(entry.source)),
+        allocator);
+    // The ids are 64 bit hashes for display lists, which do not survive
+    // being parsed as JSON numbers in every client.
+    entry_json.AddMember(
+        "id", rapidjson::Value(std::to_string(entry.id).c_str(), allocator),
+        allocator);
+    entry_json.AddMember<uint64_t>("hits", entry.hits, allocator);
+    entry_json.AddMember<uint64_t>("misses", entry.misses, allocator);
+    entry_json.AddMember<int64_t>("rasterizationMicros",
+                                  entry.rasterization_time.ToMicroseconds(),
+                                  allocator);
+    entry_json.AddMember<uint64_t>("bytes", entry.bytes, allocator);
+    entry_json.AddMember("evictionReason",
+                         rapidjson::StringRef(RasterCacheEvictionReasonName(
+                             entry.eviction_reason)),
+                         allocator);
+    entries.PushBack(entry_json, allocator);
+  }
+  response->AddMember("entries", entries, allocator);
+  return true;
+}
+
+static const char* TaskSourceGradeName(fml::TaskSourceGrade grade) {
+  switch (grade) {
+    case fml::TaskSourceGrade::kUserInteraction:
+      return "userInteraction";
+    case fml::TaskSourceGrade::kDartMicroTasks:
+      return "dartMicroTasks";
+    case fml::TaskSourceGrade::kUnspecified:
+      return "unspecified";
+  }
+  FML_UNREACHABLE();
+}
+
+static void AddLatencyHistogramMember(
+    rapidjson::Value& object,
+    const char* name,
+    const fml::LatencyHistogram& histogram,
+    rapidjson::Document::AllocatorType& allocator) {
+  rapidjson::Value json(rapidjson::kObjectType);
+  json.AddMember<int64_t>("p50", histogram.GetPercentile(50).ToMicroseconds(),
+                          allocator);
+  json.AddMember<int64_t>("p90", histogram.GetPercentile(90).ToMicroseconds(),
+                          allocator);
+  json.AddMember<int64_t>("p99", histogram.GetPercentile(99).ToMicroseconds(),
+                          allocator);
+  json.AddMember<int64_t>("max", histogram.GetMax().ToMicroseconds(),
+                          allocator);
+  json.AddMember<int64_t>("mean", histogram.GetMean().ToMicroseconds(),
+                          allocator);
+  object.AddMember(rapidjson::StringRef(name), json, allocator);
+}
+
+bool Shell::OnServiceProtocolGetTaskQueueStats(
+    const ServiceProtocol::Handler::ServiceProtocolMap& params,
+    rapidjson::Document* response) {
+  FML_DCHECK(task_runners_.GetIOTaskRunner()->RunsTasksOnCurrentThread());
+  // At most this many post sites are reported for each queue.
+  constexpr size_t kMaxPostSites = 10;
+  const std::pair<const char*, fml::RefPtr<fml::TaskRunner>> task_runners[] = {
+      {"platform", task_runners_.GetPlatformTaskRunner()},
+      {"ui", task_runners_.GetUITaskRunner()},
+      {"raster", task_runners_.GetRasterTaskRunner()},
+      {"io", task_runners_.GetIOTaskRunner()},
+  };
+  const fml::TaskSourceGrade grades[] = {
+      fml::TaskSourceGrade::kUserInteraction,
+      fml::TaskSourceGrade::kDartMicroTasks,
+      fml::TaskSourceGrade::kUnspecified,
+  };
+
+  auto& allocator = response->GetAllocator();
+  response->SetObject();
+  response->AddMember("type", "TaskQueueStats", allocator);
+  rapidjson::Value queues(rapidjson::kArrayType);
+  std::vector<std::shared_ptr<fml::TaskQueueStats>> reported;
+  for (const auto& [name, task_runner] : task_runners) {
+    // Task runners that the embedder provides do not keep stats, and task
+    // runners that share a thread are reported once, by the first name.
+    std::shared_ptr<fml::TaskQueueStats> stats =
+        task_runner ? task_runner->GetTaskQueueStats() : nullptr;
+    if (!stats || std::find(reported.begin(), reported.end(), stats) !=
+                      reported.end()) {
+      continue;
+    }
+    reported.push_back(stats);
+
+    rapidjson::Value queue(rapidjson::kObjectType);
+    queue.AddMember("name", rapidjson::StringRef(name), allocator);
+    rapidjson::Value sources(rapidjson::kArrayType);
+    for (fml::TaskSourceGrade grade : grades) {
+      const fml::LatencyHistogram& queue_delay = stats->GetQueueDelay(grade);
+      if (queue_delay.GetCount() == 0) {
+        continue;
+      }
+      rapidjson::Value source(rapidjson::kObjectType);
+      source.AddMember("taskSource",
+                       rapidjson::StringRef(TaskSourceGradeName(grade)),
+                       allocator);
+      source.AddMember<uint64_t>("taskCount", queue_delay.GetCount(),
+                                 allocator);
+      AddLatencyHistogramMember(source, "queueDelayMicros", queue_delay,
+                                allocator);
+      AddLatencyHistogramMember(source, "runTimeMicros",
+                                stats->GetRunTime(grade), allocator);
+      sources.PushBack(source, allocator);
+    }
+    queue.AddMember("taskSources", sources, allocator);
+
+    rapidjson::Value post_sites(rapidjson::kArrayType);
+    for (const auto& site : stats->GetSlowestPostSites(kMaxPostSites)) {
+      rapidjson::Value site_json(rapidjson::kObjectType);
+      site_json.AddMember(
+          "postSite",
+          rapidjson::Value(
+              fml::TaskQueueStats::DescribePostSite(site.address).c_str(),
+              allocator),
+          allocator);
+      site_json.AddMember<uint64_t>("taskCount", site.task_count, allocator);
+      site_json.AddMember<int64_t>("maxRunTimeMicros",
+                                   site.max_run_time.ToMicroseconds(),
+                                   allocator);
+      site_json.AddMember<int64_t>("totalRunTimeMicros",
+                                   site.total_run_time.ToMicroseconds(),
+                                   allocator);
+      post_sites.PushBack(site_json, allocator);
+    }
+    queue.AddMember("slowestPostSites", post_sites, allocator);
+    queues.PushBack(queue, allocator);
+  }
+  response->AddMember("taskQueues", queues, allocator);
+  return true;
+}
+
 // Service protocol handler
 bool Shell::OnServiceProtocolSetAssetBundlePath(
     const ServiceProtocol::Handler::ServiceProtocolMap& params,
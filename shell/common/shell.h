@@ -620,6 +620,27 @@ class Shell final : public PlatformView::Delegate,
   // |Rasterizer::Delegate|
   fml::TimePoint GetLatestFrameTargetTime() const override;
 
+  // |Rasterizer::Delegate|
+  std::shared_ptr<fml::ConcurrentTaskRunner> GetTiledRasterTaskRunner()
+      const override;
+
+  // |Rasterizer::Delegate|
+  size_t GetRasterCacheMaxBytes() const override;
+
+  // |Rasterizer::Delegate|
+  std::optional<float> GetRasterCacheScaleTolerance() const override;
+
+  // |Rasterizer::Delegate|
+  std::shared_ptr<fml::ConcurrentTaskRunner> GetRasterCacheTaskRunner()
+      const override;
+
+  // |Rasterizer::Delegate|
+  bool IsPartialRepaintEnabled() const override;
+
+  // |Rasterizer::Delegate|
+  std::shared_ptr<fml::ConcurrentTaskRunner> GetPrerollTaskRunner()
+      const override;
+
   // |ServiceProtocol::Handler|
   fml::RefPtr<fml::TaskRunner> GetServiceProtocolHandlerTaskRunner(
       std::string_view method) const override;
@@ -676,6 +697,23 @@ class Shell final : public PlatformView::Delegate,
       const ServiceProtocol::Handler::ServiceProtocolMap& params,
       rapidjson::Document* response);
 
+  // Service protocol handler
+  //
+  // Returns the raster cache report of the last frame, see
+  // |RasterCache::last_frame_report|.
+  bool OnServiceProtocolGetRasterCacheReport(
+      const ServiceProtocol::Handler::ServiceProtocolMap& params,
+      rapidjson::Document* response);
+
+  // Service protocol handler
+  //
+  // Returns the queue delay and run time percentiles of the tasks of each
+  // task runner, and the places that posted the tasks that ran the longest,
+  // see |fml::TaskQueueStats|.
+  bool OnServiceProtocolGetTaskQueueStats(
+      const ServiceProtocol::Handler::ServiceProtocolMap& params,
+      rapidjson::Document* response);
+
   // Creates an asset bundle from the original settings asset path or
   // directory.
   std::unique_ptr<DirectoryAssetBundle> RestoreOriginalAssetResolver();
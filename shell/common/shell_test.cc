@@ -262,6 +262,12 @@ void ShellTest::OnServiceProtocol(
           case ServiceProtocolEnum::kEstimateRasterCacheMemory:
             shell->OnServiceProtocolEstimateRasterCacheMemory(params, response);
             break;
+          case ServiceProtocolEnum::kGetRasterCacheReport:
+            shell->OnServiceProtocolGetRasterCacheReport(params, response);
+            break;
+          case ServiceProtocolEnum::kGetTaskQueueStats:
+            shell->OnServiceProtocolGetTaskQueueStats(params, response);
+            break;
           case ServiceProtocolEnum::kSetAssetBundlePath:
             shell->OnServiceProtocolSetAssetBundlePath(params, response);
             break;
@@ -99,6 +99,8 @@ class ShellTest : public FixtureTest {
   enum ServiceProtocolEnum {
     kGetSkSLs,
     kEstimateRasterCacheMemory,
+    kGetRasterCacheReport,
+    kGetTaskQueueStats,
     kSetAssetBundlePath,
     kRunInView,
   };
@@ -2236,6 +2236,124 @@ TEST_F(ShellTest, OnServiceProtocolEstimateRasterCacheMemoryWorks) {
   DestroyShell(std::move(shell));
 }
 
+TEST_F(ShellTest, OnServiceProtocolGetRasterCacheReportWorks) {
+  Settings settings = CreateSettingsForFixture();
+  std::unique_ptr<Shell> shell = CreateShell(settings);
+
+  sk_sp<SkPicture> picture = MakeSizedPicture(10, 10);
+
+  // Draw the picture until it is cached, which happens in the frame after
+  // it has been drawn for the access threshold (default to 3) frames.
+  std::promise<bool> rasterized;
+  shell->GetTaskRunners().GetRasterTaskRunner()->PostTask(
+      [&shell, &rasterized, &picture] {
+        auto* compositor_context = shell->GetRasterizer()->compositor_context();
+        auto& raster_cache = compositor_context->raster_cache();
+
+        Stopwatch raster_time;
+        Stopwatch ui_time;
+        MutatorsStack mutators_stack;
+        TextureRegistry texture_registry;
+        PrerollContext preroll_context = {
+            nullptr,                 /* raster_cache */
+            nullptr,                 /* gr_context */
+            nullptr,                 /* external_view_embedder */
+            mutators_stack, nullptr, /* color_space */
+            kGiantRect,              /* cull_rect */
+            false,                   /* layer reads from surface */
+            raster_time,    ui_time, texture_registry,
+            false, /* checkerboard_offscreen_layers */
+            1.0f,  /* frame_device_pixel_ratio */
+            false, /* has_platform_view */
+        };
+
+        SkCanvas dummy_canvas;
+        for (int i = 0; i < 4; i += 1) {
+          raster_cache.Prepare(&preroll_context, picture.get(), true, false,
+                               SkMatrix::I());
+          raster_cache.Draw(*picture, dummy_canvas);
+          raster_cache.SweepAfterFrame();
+        }
+        rasterized.set_value(true);
+      });
+  rasterized.get_future().wait();
+
+  ServiceProtocol::Handler::ServiceProtocolMap empty_params;
+  rapidjson::Document document;
+  OnServiceProtocol(
+      shell.get(), ServiceProtocolEnum::kGetRasterCacheReport,
+      shell->GetTaskRunners().GetRasterTaskRunner(), empty_params, &document);
+  ASSERT_TRUE(document.IsObject());
+  EXPECT_STREQ(document["type"].GetString(), "RasterCacheReport");
+  EXPECT_EQ(document["frame"].GetInt(), 3);
+  EXPECT_EQ(document["hits"].GetUint64(), 1u);
+  EXPECT_EQ(document["misses"].GetUint64(), 0u);
+  const rapidjson::Value& entries = document["entries"];
+  ASSERT_TRUE(entries.IsArray());
+  ASSERT_EQ(entries.Size(), 1u);
+  const rapidjson::Value& entry = entries[0];
+  EXPECT_STREQ(entry["source"].GetString(), "picture");
+  EXPECT_EQ(entry["id"].GetString(), std::to_string(picture->uniqueID()));
+  EXPECT_EQ(entry["hits"].GetUint64(), 1u);
+  EXPECT_EQ(entry["misses"].GetUint64(), 0u);
+  EXPECT_GE(entry["rasterizationMicros"].GetInt64(), 0);
+  EXPECT_EQ(entry["bytes"].GetUint64(), 400u);
+  EXPECT_STREQ(entry["evictionReason"].GetString(), "none");
+
+  DestroyShell(std::move(shell));
+}
+
+TEST_F(ShellTest, OnServiceProtocolGetTaskQueueStatsWorks) {
+  Settings settings = CreateSettingsForFixture();
+  std::unique_ptr<Shell> shell = CreateShell(settings);
+
+  fml::CountDownLatch latch(3);
+  for (int i = 0; i < 3; i++) {
+    shell->GetTaskRunners().GetRasterTaskRunner()->PostTask(
+        [&latch]() { latch.CountDown(); });
+  }
+  latch.Wait();
+
+  ServiceProtocol::Handler::ServiceProtocolMap empty_params;
+  rapidjson::Document document;
+  OnServiceProtocol(
+      shell.get(), ServiceProtocolEnum::kGetTaskQueueStats,
+      shell->GetTaskRunners().GetIOTaskRunner(), empty_params, &document);
+  ASSERT_TRUE(document.IsObject());
+  EXPECT_STREQ(document["type"].GetString(), "TaskQueueStats");
+  const rapidjson::Value& queues = document["taskQueues"];
+  ASSERT_TRUE(queues.IsArray());
+  ASSERT_EQ(queues.Size(), 4u);
+
+  const rapidjson::Value* raster = nullptr;
+  for (const rapidjson::Value& queue : queues.GetArray()) {
+    if (std::string(queue["name"].GetString()) == "raster") {
+      raster = &queue;
+    }
+  }
+  ASSERT_NE(raster, nullptr);
+  const rapidjson::Value& sources = (*raster)["taskSources"];
+  ASSERT_TRUE(sources.IsArray());
+  ASSERT_GE(sources.Size(), 1u);
+  const rapidjson::Value& source = sources[0];
+  EXPECT_STREQ(source["taskSource"].GetString(), "unspecified");
+  EXPECT_GE(source["taskCount"].GetUint64(), 3u);
+  const rapidjson::Value& run_time = source["runTimeMicros"];
+  EXPECT_LE(run_time["p50"].GetInt64(), run_time["p99"].GetInt64());
+  EXPECT_LE(run_time["p99"].GetInt64(), run_time["max"].GetInt64());
+  EXPECT_GE(source["queueDelayMicros"]["mean"].GetInt64(), 0);
+
+  const rapidjson::Value& post_sites = (*raster)["slowestPostSites"];
+  ASSERT_TRUE(post_sites.IsArray());
+#if !FLUTTER_RELEASE
+  ASSERT_GE(post_sites.Size(), 1u);
+  EXPECT_STRNE(post_sites[0]["postSite"].GetString(), "");
+  EXPECT_GE(post_sites[0]["taskCount"].GetUint64(), 1u);
+#endif  // !FLUTTER_RELEASE
+
+  DestroyShell(std::move(shell));
+}
+
 TEST_F(ShellTest, DiscardLayerTreeOnResize) {
   auto settings = CreateSettingsForFixture();
 
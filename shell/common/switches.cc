@@ -290,6 +290,21 @@ Settings SettingsFromCommandLine(const fml::CommandLine& command_line) {
   settings.enable_software_rendering =
       command_line.HasOption(FlagForSwitch(Switch::EnableSoftwareRendering));
 
+  settings.enable_tiled_software_rendering = command_line.HasOption(
+      FlagForSwitch(Switch::EnableTiledSoftwareRendering));
+
+  settings.enable_background_raster_cache = command_line.HasOption(
+      FlagForSwitch(Switch::EnableBackgroundRasterCache));
+
+  settings.enable_partial_repaint =
+      command_line.HasOption(FlagForSwitch(Switch::EnablePartialRepaint));
+
+  settings.enable_concurrent_preroll =
+      command_line.HasOption(FlagForSwitch(Switch::EnableConcurrentPreroll));
+
+  settings.enable_work_stealing_workers =
+      command_line.HasOption(FlagForSwitch(Switch::EnableWorkStealingWorkers));
+
   settings.endless_trace_buffer =
       command_line.HasOption(FlagForSwitch(Switch::EndlessTraceBuffer));
 
@@ -441,6 +456,23 @@ Settings SettingsFromCommandLine(const fml::CommandLine& command_line) {
                                 &old_gen_heap_size);
     settings.old_gen_heap_size = std::stoi(old_gen_heap_size);
   }
+
+  if (command_line.HasOption(FlagForSwitch(Switch::RasterCacheMaxBytes))) {
+    std::string raster_cache_max_bytes;
+    command_line.GetOptionValue(FlagForSwitch(Switch::RasterCacheMaxBytes),
+                                &raster_cache_max_bytes);
+    settings.raster_cache_max_bytes = std::stoull(raster_cache_max_bytes);
+  }
+
+  if (command_line.HasOption(
+          FlagForSwitch(Switch::RasterCacheScaleTolerance))) {
+    std::string raster_cache_scale_tolerance;
+    command_line.GetOptionValue(
+        FlagForSwitch(Switch::RasterCacheScaleTolerance),
+        &raster_cache_scale_tolerance);
+    settings.raster_cache_scale_tolerance =
+        std::stof(raster_cache_scale_tolerance);
+  }
   return settings;
 }
 
@@ -101,6 +101,31 @@ DEF_SWITCH(EnableSoftwareRendering,
            "Enable rendering using the Skia software backend. This is useful "
            "when testing Flutter on emulators. By default, Flutter will "
            "attempt to either use OpenGL, Metal, or Vulkan.")
+DEF_SWITCH(EnableTiledSoftwareRendering,
+           "enable-tiled-software-rendering",
+           "When rendering using the Skia software backend, split each frame "
+           "into tiles that are rasterized concurrently on the worker "
+           "threads instead of rasterizing the whole frame on the raster "
+           "thread.")
+DEF_SWITCH(EnableBackgroundRasterCache,
+           "enable-background-raster-cache",
+           "Rasterize the images of the raster cache on the worker threads "
+           "instead of on the raster thread when rendering with the software "
+           "backend. Content is drawn directly until its image is ready, "
+           "which may take a few frames.")
+DEF_SWITCH(EnablePartialRepaint,
+           "enable-partial-repaint",
+           "Only repaint the part of each frame that changed since the "
+           "previous frame, on surfaces that keep the content of their "
+           "framebuffer between frames.")
+DEF_SWITCH(EnableConcurrentPreroll,
+           "enable-concurrent-preroll",
+           "Preroll the children of layers that have many children on the "
+           "worker threads as well as on the raster thread.")
+DEF_SWITCH(EnableWorkStealingWorkers,
+           "enable-work-stealing-workers",
+           "Give every concurrent worker thread a queue of its own that the "
+           "other workers steal tasks from when they are idle.")
 DEF_SWITCH(SkiaDeterministicRendering,
            "skia-deterministic-rendering",
            "Skips the call to SkGraphics::Init(), thus avoiding swapping out "
@@ -203,6 +228,16 @@ DEF_SWITCH(
 DEF_SWITCH(OldGenHeapSize,
            "old-gen-heap-size",
            "The size limit in megabytes for the Dart VM old gen heap space.")
+DEF_SWITCH(RasterCacheMaxBytes,
+           "raster-cache-max-bytes",
+           "The maximum number of bytes that the images in the raster cache "
+           "may take. Defaults to a limit chosen by the raster cache.")
+DEF_SWITCH(RasterCacheScaleTolerance,
+           "raster-cache-scale-tolerance",
+           "The relative difference in scale at which the raster cache still "
+           "draws an image that was rasterized at another scale, such as 0.1 "
+           "for 10%. 0 only draws images at the scale they were rasterized "
+           "at. Defaults to a tolerance chosen by the raster cache.")
 DEF_SWITCH(EnableSkParagraph,
            "enable-skparagraph",
            "Selects the SkParagraph implementation of the text layout engine.")
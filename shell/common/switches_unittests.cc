@@ -46,5 +46,34 @@ TEST(SwitchesTest, SkiaTraceAllowlistFlag) {
 #endif
 }
 
+TEST(SwitchesTest, RasterCacheMaxBytes) {
+  fml::CommandLine command_line =
+      fml::CommandLineFromInitializerList({"command"});
+  Settings settings = SettingsFromCommandLine(command_line);
+  EXPECT_EQ(settings.raster_cache_max_bytes, 0u);
+
+  command_line = fml::CommandLineFromInitializerList(
+      {"command", "--raster-cache-max-bytes=67108864"});
+  settings = SettingsFromCommandLine(command_line);
+  EXPECT_EQ(settings.raster_cache_max_bytes, 67108864u);
+}
+
+TEST(SwitchesTest, RasterCacheScaleTolerance) {
+  fml::CommandLine command_line =
+      fml::CommandLineFromInitializerList({"command"});
+  Settings settings = SettingsFromCommandLine(command_line);
+  EXPECT_FALSE(settings.raster_cache_scale_tolerance.has_value());
+
+  command_line = fml::CommandLineFromInitializerList(
+      {"command", "--raster-cache-scale-tolerance=0"});
+  settings = SettingsFromCommandLine(command_line);
+  EXPECT_EQ(settings.raster_cache_scale_tolerance, 0.0f);
+
+  command_line = fml::CommandLineFromInitializerList(
+      {"command", "--raster-cache-scale-tolerance=0.25"});
+  settings = SettingsFromCommandLine(command_line);
+  EXPECT_EQ(settings.raster_cache_scale_tolerance, 0.25f);
+}
+
 }  // namespace testing
 }  // namespace flutter
@@ -56,6 +56,17 @@ std::unique_ptr<SurfaceFrame> GPUSurfaceSoftware::AcquireFrame(
   SkCanvas* canvas = backing_store->getCanvas();
   canvas->resetMatrix();
 
+  // The content of a backing store is kept until it is painted again, so a
+  // backing store that is handed out again still holds the last frame.
+  SurfaceFrame::FramebufferInfo framebuffer_info;
+  framebuffer_info.supports_partial_repaint = true;
+  if (backing_store->uniqueID() == last_presented_backing_store_id_) {
+    framebuffer_info.buffer_age = 1;
+  }
+  // Until this frame is presented, the content of the backing store is
+  // unknown.
+  last_presented_backing_store_id_ = SK_InvalidUniqueID;
+
   SurfaceFrame::SubmitCallback on_submit =
       [self = weak_factory_.GetWeakPtr()](const SurfaceFrame& surface_frame,
                                           SkCanvas* canvas) -> bool {
@@ -66,10 +77,17 @@ std::unique_ptr<SurfaceFrame> GPUSurfaceSoftware::AcquireFrame(
 
     canvas->flush();
 
-    return self->delegate_->PresentBackingStore(surface_frame.SkiaSurface());
+    if (!self->delegate_->PresentBackingStore(surface_frame.SkiaSurface())) {
+      return false;
+    }
+    self->last_presented_backing_store_id_ =
+        surface_frame.SkiaSurface()->uniqueID();
+    return true;
   };
 
-  return std::make_unique<SurfaceFrame>(backing_store, true, on_submit);
+  auto frame = std::make_unique<SurfaceFrame>(backing_store, true, on_submit);
+  frame->set_framebuffer_info(framebuffer_info);
+  return frame;
 }
 
 // |Surface|
@@ -38,6 +38,9 @@ class GPUSurfaceSoftware : public Surface {
   // hack to make avoid allocating resources for the root surface when an
   // external view embedder is present.
   const bool render_to_surface_;
+  // The unique ID of the backing store that the last frame was presented
+  // from, or |SK_InvalidUniqueID| if its content is unknown.
+  uint32_t last_presented_backing_store_id_ = SK_InvalidUniqueID;
   fml::TaskRunnerAffineWeakPtrFactory<GPUSurfaceSoftware> weak_factory_;
 
   FML_DISALLOW_COPY_AND_ASSIGN(GPUSurfaceSoftware);
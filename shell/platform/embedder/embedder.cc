@@ -10,6 +10,7 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "flutter/fml/build_config.h"
@@ -43,6 +44,7 @@ extern const intptr_t kPlatformStrongDillSize;
 #include "flutter/fml/make_copyable.h"
 #include "flutter/fml/message_loop.h"
 #include "flutter/fml/paths.h"
+#include "flutter/fml/task_queue_stats.h"
 #include "flutter/fml/trace_event.h"
 #include "flutter/shell/common/rasterizer.h"
 #include "flutter/shell/common/switches.h"
@@ -692,6 +694,8 @@ InferExternalViewEmbedderFromArgs(const FlutterCompositor* compositor) {
       SAFE_ACCESS(compositor, present_layers_callback, nullptr);
   bool avoid_backing_store_cache =
       SAFE_ACCESS(compositor, avoid_backing_store_cache, false);
+  size_t backing_store_buffer_count =
+      SAFE_ACCESS(compositor, backing_store_buffer_count, 1);
 
   // Make sure the required callbacks are present
   if (!c_create_callback || !c_collect_callback || !c_present_callback) {
@@ -718,8 +722,8 @@ InferExternalViewEmbedderFromArgs(const FlutterCompositor* compositor) {
       };
 
   return {std::make_unique<flutter::EmbedderExternalViewEmbedder>(
-              avoid_backing_store_cache, create_render_target_callback,
-              present_callback),
+              avoid_backing_store_cache, backing_store_buffer_count,
+              create_render_target_callback, present_callback),
           false};
 }
 
@@ -970,6 +974,8 @@ FlutterEngineResult FlutterEngineInitialize(size_t version,
   settings.assets_path = args->assets_path;
   settings.leak_vm = !SAFE_ACCESS(args, shutdown_dart_vm_when_done, false);
   settings.old_gen_heap_size = SAFE_ACCESS(args, dart_old_gen_heap_size, -1);
+  settings.raster_cache_max_bytes =
+      SAFE_ACCESS(args, raster_cache_max_bytes, 0);
 
   if (!flutter::DartVM::IsRunningPrecompiledCode()) {
     // Verify the assets path contains Dart 2 kernel assets.
@@ -2224,6 +2230,81 @@ FlutterEngineResult FlutterEnginePostCallbackOnAllNativeThreads(
                                   "tasks to all threads.");
 }
 
+FlutterEngineResult FlutterEngineGetTaskQueueStats(
+    FLUTTER_API_SYMBOL(FlutterEngine) raw_engine,
+    FlutterEngineTaskQueueStatsCallback callback,
+    void* user_data) {
+  auto engine = reinterpret_cast<flutter::EmbedderEngine*>(raw_engine);
+  if (engine == nullptr || !engine->IsValid()) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments, "Engine was invalid.");
+  }
+
+  if (callback == nullptr) {
+    return LOG_EMBEDDER_ERROR(kInvalidArguments,
+                              "Invalid task queue stats callback.");
+  }
+
+  const flutter::TaskRunners& task_runners = engine->GetTaskRunners();
+  const std::pair<FlutterEngineTaskQueue, fml::RefPtr<fml::TaskRunner>>
+      task_queues[] = {
+          {kFlutterEngineTaskQueuePlatform,
+           task_runners.GetPlatformTaskRunner()},
+          {kFlutterEngineTaskQueueRender, task_runners.GetRasterTaskRunner()},
+          {kFlutterEngineTaskQueueUI, task_runners.GetUITaskRunner()},
+          {kFlutterEngineTaskQueueIO, task_runners.GetIOTaskRunner()},
+      };
+  const std::pair<FlutterEngineTaskSource, fml::TaskSourceGrade>
+      task_sources[] = {
+          {kFlutterEngineTaskSourceUserInteraction,
+           fml::TaskSourceGrade::kUserInteraction},
+          {kFlutterEngineTaskSourceDartMicroTasks,
+           fml::TaskSourceGrade::kDartMicroTasks},
+          {kFlutterEngineTaskSourceUnspecified,
+           fml::TaskSourceGrade::kUnspecified},
+      };
+  auto to_nanos = [](fml::TimeDelta delta) -> uint64_t {
+    return delta.ToNanoseconds();
+  };
+
+  std::set<std::shared_ptr<fml::TaskQueueStats>> reported;
+  for (const auto& [task_queue, task_runner] : task_queues) {
+    // Embedder provided task runners do not keep stats.
+    std::shared_ptr<fml::TaskQueueStats> stats =
+        task_runner ? task_runner->GetTaskQueueStats() : nullptr;
+    if (!stats || !reported.insert(stats).second) {
+      continue;
+    }
+    for (const auto& [task_source, grade] : task_sources) {
+      const fml::LatencyHistogram& queue_delay = stats->GetQueueDelay(grade);
+      const fml::LatencyHistogram& run_time = stats->GetRunTime(grade);
+      if (queue_delay.GetCount() == 0) {
+        continue;
+      }
+      FlutterEngineTaskQueueStats task_queue_stats = {};
+      task_queue_stats.struct_size = sizeof(FlutterEngineTaskQueueStats);
+      task_queue_stats.task_queue = task_queue;
+      task_queue_stats.task_source = task_source;
+      task_queue_stats.task_count = queue_delay.GetCount();
+      task_queue_stats.queue_delay_p50_nanos =
+          to_nanos(queue_delay.GetPercentile(50));
+      task_queue_stats.queue_delay_p90_nanos =
+          to_nanos(queue_delay.GetPercentile(90));
+      task_queue_stats.queue_delay_p99_nanos =
+          to_nanos(queue_delay.GetPercentile(99));
+      task_queue_stats.queue_delay_max_nanos = to_nanos(queue_delay.GetMax());
+      task_queue_stats.run_time_p50_nanos =
+          to_nanos(run_time.GetPercentile(50));
+      task_queue_stats.run_time_p90_nanos =
+          to_nanos(run_time.GetPercentile(90));
+      task_queue_stats.run_time_p99_nanos =
+          to_nanos(run_time.GetPercentile(99));
+      task_queue_stats.run_time_max_nanos = to_nanos(run_time.GetMax());
+      callback(&task_queue_stats, user_data);
+    }
+  }
+  return kSuccess;
+}
+
 namespace {
 static bool ValidDisplayConfiguration(const FlutterEngineDisplay* displays,
                                       size_t display_count) {
@@ -2329,6 +2410,7 @@ FlutterEngineResult FlutterEngineGetProcAddresses(
   SET_PROC(PostCallbackOnAllNativeThreads,
            FlutterEnginePostCallbackOnAllNativeThreads);
   SET_PROC(NotifyDisplayUpdate, FlutterEngineNotifyDisplayUpdate);
+  SET_PROC(GetTaskQueueStats, FlutterEngineGetTaskQueueStats);
 #undef SET_PROC
 
   return kSuccess;
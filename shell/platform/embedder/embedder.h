@@ -1105,6 +1105,13 @@ typedef struct {
   FlutterPoint offset;
   /// The size of the layer (in physical pixels).
   FlutterSize size;
+  /// The area of the backing store (in physical pixels) that was rendered
+  /// into for this frame. The rest of the backing store holds the same
+  /// contents as when it was last presented. This is only set for backing
+  /// store layers when the engine runs with partial repaint enabled, which
+  /// requires the embedder to keep the contents of the backing stores it hands
+  /// out. If null, the whole backing store was rendered into.
+  const FlutterRect* damage;
 } FlutterLayer;
 
 typedef bool (*FlutterBackingStoreCreateCallback)(
@@ -1144,6 +1151,14 @@ typedef struct {
   FlutterLayersPresentCallback present_layers_callback;
   /// Avoid caching backing stores provided by this compositor.
   bool avoid_backing_store_cache;
+  /// The number of backing stores that the engine caches for each layer and
+  /// renders into in turn, for compositors that still read the backing store
+  /// of a presented layer while the engine renders the next frames. Values of
+  /// 0 and 1 render every frame into the same backing store. When partial
+  /// repaint is enabled, the engine keeps track of the frames that each
+  /// backing store missed and only repaints what changed since. Ignored if
+  /// `avoid_backing_store_cache` is set.
+  size_t backing_store_buffer_count;
 } FlutterCompositor;
 
 typedef struct {
@@ -1314,6 +1329,57 @@ typedef enum {
 typedef void (*FlutterNativeThreadCallback)(FlutterNativeThreadType type,
                                             void* user_data);
 
+/// The task queue of an engine managed thread, as reported by
+/// `FlutterEngineGetTaskQueueStats`.
+typedef enum {
+  kFlutterEngineTaskQueuePlatform,
+  kFlutterEngineTaskQueueRender,
+  kFlutterEngineTaskQueueUI,
+  kFlutterEngineTaskQueueIO,
+} FlutterEngineTaskQueue;
+
+/// The kind of the tasks whose stats are reported by
+/// `FlutterEngineGetTaskQueueStats`.
+typedef enum {
+  /// Tasks that handle input from the user, such as pointer events.
+  kFlutterEngineTaskSourceUserInteraction,
+  /// Tasks that run Dart microtasks.
+  kFlutterEngineTaskSourceDartMicroTasks,
+  /// All other tasks.
+  kFlutterEngineTaskSourceUnspecified,
+} FlutterEngineTaskSource;
+
+/// How long the tasks of one kind that were posted to one task queue waited
+/// to run and how long they ran, since the queue was created. The
+/// percentiles are accurate to within 1/16th of their value.
+typedef struct {
+  /// The size of this struct. Must be sizeof(FlutterEngineTaskQueueStats).
+  size_t struct_size;
+  FlutterEngineTaskQueue task_queue;
+  FlutterEngineTaskSource task_source;
+  /// The number of tasks that have run.
+  uint64_t task_count;
+  /// How long the tasks waited to run after the time they were posted for,
+  /// in nanoseconds.
+  uint64_t queue_delay_p50_nanos;
+  uint64_t queue_delay_p90_nanos;
+  uint64_t queue_delay_p99_nanos;
+  uint64_t queue_delay_max_nanos;
+  /// How long the tasks ran, including the task observers that run after
+  /// each task, such as the Dart microtasks it scheduled, in nanoseconds.
+  uint64_t run_time_p50_nanos;
+  uint64_t run_time_p90_nanos;
+  uint64_t run_time_p99_nanos;
+  uint64_t run_time_max_nanos;
+} FlutterEngineTaskQueueStats;
+
+/// A callback made by the engine in response to
+/// `FlutterEngineGetTaskQueueStats` for each kind of task that has run on
+/// each task queue. The stats are only valid for the duration of the call.
+typedef void (*FlutterEngineTaskQueueStatsCallback)(
+    const FlutterEngineTaskQueueStats* stats,
+    void* user_data);
+
 /// AOT data source type.
 typedef enum {
   kFlutterEngineAOTDataSourceTypeElfPath
@@ -1577,6 +1643,13 @@ typedef struct {
   // or component name to embedder's logger. This string will be passed to to
   // callbacks on `log_message_callback`. Defaults to "flutter" if unspecified.
   const char* log_tag;
+
+  /// The maximum number of bytes that the images in the raster cache may
+  /// take. Images that were not used recently are evicted to stay within
+  /// the limit, and new images that do not fit are not cached. Embedders
+  /// driving high resolution displays can use this to cap the memory used
+  /// by the raster cache. A value of 0 selects the default limit.
+  size_t raster_cache_max_bytes;
 } FlutterProjectArgs;
 
 #ifndef FLUTTER_ENGINE_NO_PROTOTYPES
@@ -2239,6 +2312,30 @@ FlutterEngineResult FlutterEngineNotifyDisplayUpdate(
     const FlutterEngineDisplay* displays,
     size_t display_count);
 
+//------------------------------------------------------------------------------
+/// @brief      Reports how long the tasks on the task queues of the engine
+///             managed threads waited to run and how long they ran. The
+///             callback is invoked on the calling thread, before this call
+///             returns, once for each task queue and kind of task that has
+///             run tasks. Task runners that are provided by the embedder
+///             (via `FlutterCustomTaskRunners`) are not reported.
+///
+///             The places that posted the slowest tasks are only available via
+///             the `_flutter.getTaskQueueStats` service protocol extension.
+///
+/// @param[in]  engine     A running engine instance.
+/// @param[in]  callback   The callback that is invoked with the stats.
+/// @param[in]  user_data  A baton passed by the engine to the callback. This
+///                        baton is not interpreted by the engine in any way.
+///
+/// @return     The result of the call.
+///
+FLUTTER_EXPORT
+FlutterEngineResult FlutterEngineGetTaskQueueStats(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    FlutterEngineTaskQueueStatsCallback callback,
+    void* user_data);
+
 #endif  // !FLUTTER_ENGINE_NO_PROTOTYPES
 
 // Typedefs for the function pointers in FlutterEngineProcTable.
@@ -2355,6 +2452,10 @@ typedef FlutterEngineResult (*FlutterEngineNotifyDisplayUpdateFnPtr)(
     FlutterEngineDisplaysUpdateType update_type,
     const FlutterEngineDisplay* displays,
     size_t display_count);
+typedef FlutterEngineResult (*FlutterEngineGetTaskQueueStatsFnPtr)(
+    FLUTTER_API_SYMBOL(FlutterEngine) engine,
+    FlutterEngineTaskQueueStatsCallback callback,
+    void* user_data);
 
 /// Function-pointer-based versions of the APIs above.
 typedef struct {
@@ -2399,6 +2500,7 @@ typedef struct {
   FlutterEnginePostCallbackOnAllNativeThreadsFnPtr
       PostCallbackOnAllNativeThreads;
   FlutterEngineNotifyDisplayUpdateFnPtr NotifyDisplayUpdate;
+  FlutterEngineGetTaskQueueStatsFnPtr GetTaskQueueStats;
 } FlutterEngineProcTable;
 
 //------------------------------------------------------------------------------
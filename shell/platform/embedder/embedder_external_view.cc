@@ -71,7 +71,8 @@ const EmbeddedViewParams* EmbedderExternalView::GetEmbeddedViewParams() const {
   return embedded_view_params_.get();
 }
 
-bool EmbedderExternalView::Render(const EmbedderRenderTarget& render_target) {
+bool EmbedderExternalView::Render(const EmbedderRenderTarget& render_target,
+                                  const std::optional<SkIRect>& damage) {
   TRACE_EVENT0("flutter", "EmbedderExternalView::Render");
 
   FML_DCHECK(HasEngineRenderedContents())
@@ -96,8 +97,13 @@ bool EmbedderExternalView::Render(const EmbedderRenderTarget& render_target) {
     return false;
   }
 
+  SkAutoCanvasRestore auto_restore(canvas, true);
   canvas->setMatrix(surface_transformation_);
-  canvas->clear(SK_ColorTRANSPARENT);
+  if (damage) {
+    canvas->clipIRect(*damage);
+  } else {
+    canvas->clear(SK_ColorTRANSPARENT);
+  }
   canvas->drawPicture(picture);
   canvas->flush();
 
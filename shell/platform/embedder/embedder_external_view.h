@@ -108,7 +108,11 @@ class EmbedderExternalView {
 
   SkISize GetRenderSurfaceSize() const;
 
-  bool Render(const EmbedderRenderTarget& render_target);
+  // Renders the contents of the view into |render_target|. If |damage| is
+  // set, only that part of the frame is rendered and the rest of the render
+  // target keeps the contents it already has.
+  bool Render(const EmbedderRenderTarget& render_target,
+              const std::optional<SkIRect>& damage = std::nullopt);
 
  private:
   const SkISize render_surface_size_;
@@ -14,11 +14,13 @@ namespace flutter {
 
 EmbedderExternalViewEmbedder::EmbedderExternalViewEmbedder(
     bool avoid_backing_store_cache,
+    size_t backing_store_buffer_count,
     const CreateRenderTargetCallback& create_render_target_callback,
     const PresentCallback& present_callback)
     : avoid_backing_store_cache_(avoid_backing_store_cache),
       create_render_target_callback_(create_render_target_callback),
-      present_callback_(present_callback) {
+      present_callback_(present_callback),
+      render_target_cache_(backing_store_buffer_count) {
   FML_DCHECK(create_render_target_callback_);
   FML_DCHECK(present_callback_);
 }
@@ -38,9 +40,17 @@ SkMatrix EmbedderExternalViewEmbedder::GetSurfaceTransformation() const {
   return surface_transformation_callback_();
 }
 
+void EmbedderExternalViewEmbedder::ForgetRenderedFrames() {
+  // The render targets of the views that were rendered into are gone, so the
+  // ages of the remaining ones are unknown.
+  render_target_cache_.ClearAllRenderTargetsInCache();
+  damage_history_.Reset();
+}
+
 void EmbedderExternalViewEmbedder::Reset() {
   pending_views_.clear();
   composition_order_.clear();
+  pending_partial_repaint_ = false;
 }
 
 // |ExternalViewEmbedder|
@@ -96,6 +106,23 @@ SkCanvas* EmbedderExternalViewEmbedder::GetRootCanvas() {
   return found->second->GetCanvas();
 }
 
+// |ExternalViewEmbedder|
+std::optional<SkIRect> EmbedderExternalViewEmbedder::GetExistingDamage() {
+  // The contents of frames with platform views are split across several
+  // views, so only frames that consist of the root view can be repainted
+  // partially.
+  pending_partial_repaint_ = false;
+  if (pending_views_.size() != 1 ||
+      pending_surface_transformation_ != last_surface_transformation_) {
+    return std::nullopt;
+  }
+  const auto& root_view = *pending_views_.begin()->second;
+  auto existing_damage = damage_history_.GetExistingDamage(
+      pending_frame_size_, render_target_cache_.GetBufferAge(root_view));
+  pending_partial_repaint_ = existing_damage.has_value();
+  return existing_damage;
+}
+
 // |ExternalViewEmbedder|
 std::vector<SkCanvas*> EmbedderExternalViewEmbedder::GetCurrentCanvases() {
   std::vector<SkCanvas*> canvases;
@@ -136,6 +163,13 @@ static FlutterBackingStoreConfig MakeBackingStoreConfig(
 void EmbedderExternalViewEmbedder::SubmitFrame(
     GrDirectContext* context,
     std::unique_ptr<SurfaceFrame> frame) {
+  // The part of the root view that was painted, if the rest of it is already
+  // in the render target of the last frame.
+  std::optional<SkIRect> root_view_damage;
+  if (pending_partial_repaint_) {
+    root_view_damage = frame->submit_info().buffer_damage;
+  }
+
   auto [matched_render_targets, pending_keys] =
       render_target_cache_.GetExistingTargetsInCache(pending_views_);
 
@@ -152,7 +186,7 @@ void EmbedderExternalViewEmbedder::SubmitFrame(
   //
   // @warning: Embedder may trample on our OpenGL context here.
   auto deferred_cleanup_render_targets =
-      render_target_cache_.ClearAllRenderTargetsInCache();
+      render_target_cache_.ClearUnusedRenderTargetsInCache();
 
   for (const auto& pending_key : pending_keys) {
     const auto& external_view = pending_views_.at(pending_key);
@@ -187,6 +221,7 @@ void EmbedderExternalViewEmbedder::SubmitFrame(
 
     if (!render_target) {
       FML_LOG(ERROR) << "Embedder did not return a valid render target.";
+      ForgetRenderedFrames();
       return;
     }
     matched_render_targets[pending_key] = std::move(render_target);
@@ -202,10 +237,13 @@ void EmbedderExternalViewEmbedder::SubmitFrame(
   // Scribble embedder provide render targets. The order in which we scribble
   // into the buffers is irrelevant to the presentation order.
   for (const auto& render_target : matched_render_targets) {
-    if (!pending_views_.at(render_target.first)
-             ->Render(*render_target.second)) {
+    const auto& external_view = pending_views_.at(render_target.first);
+    if (!external_view->Render(*render_target.second,
+                               external_view->IsRootView() ? root_view_damage
+                                                           : std::nullopt)) {
       FML_LOG(ERROR)
           << "Could not render into the embedder supplied render target.";
+      ForgetRenderedFrames();
       return;
     }
   }
@@ -246,7 +284,8 @@ void EmbedderExternalViewEmbedder::SubmitFrame(
       if (external_view->HasEngineRenderedContents()) {
         const auto& exteral_render_target = matched_render_targets.at(view_id);
         presented_layers.PushBackingStoreLayer(
-            exteral_render_target->GetBackingStore());
+            exteral_render_target->GetBackingStore(),
+            external_view->IsRootView() ? root_view_damage : std::nullopt);
       }
     }
 
@@ -270,6 +309,17 @@ void EmbedderExternalViewEmbedder::SubmitFrame(
     }
   }
 
+  if (pending_views_.size() == 1) {
+    if (pending_surface_transformation_ != last_surface_transformation_) {
+      damage_history_.Reset();
+      last_surface_transformation_ = pending_surface_transformation_;
+    }
+    damage_history_.AddFrameDamage(pending_frame_size_,
+                                   frame->submit_info().frame_damage);
+  } else {
+    damage_history_.Reset();
+  }
+
   frame->Submit();
 }
 
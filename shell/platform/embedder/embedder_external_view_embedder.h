@@ -44,6 +44,10 @@ class EmbedderExternalViewEmbedder final : public ExternalViewEmbedder {
   ///                                      will beinvoked every frame for every
   ///                                      engine composited layer. The result
   ///                                      will not cached.
+  /// @param[in] backing_store_buffer_count
+  ///                                     The number of render targets that are
+  ///                                     cached for each layer and rendered
+  ///                                     into in turn.
   ///
   /// @param[in]  create_render_target_callback
   ///                                     The render target callback used to
@@ -55,6 +59,7 @@ class EmbedderExternalViewEmbedder final : public ExternalViewEmbedder {
   ///
   EmbedderExternalViewEmbedder(
       bool avoid_backing_store_cache,
+      size_t backing_store_buffer_count,
       const CreateRenderTargetCallback& create_render_target_callback,
       const PresentCallback& present_callback);
 
@@ -103,6 +108,9 @@ class EmbedderExternalViewEmbedder final : public ExternalViewEmbedder {
   // |ExternalViewEmbedder|
   SkCanvas* GetRootCanvas() override;
 
+  // |ExternalViewEmbedder|
+  std::optional<SkIRect> GetExistingDamage() override;
+
  private:
   const bool avoid_backing_store_cache_;
   const CreateRenderTargetCallback create_render_target_callback_;
@@ -114,9 +122,20 @@ class EmbedderExternalViewEmbedder final : public ExternalViewEmbedder {
   EmbedderExternalView::PendingViews pending_views_;
   std::vector<EmbedderExternalView::ViewIdentifier> composition_order_;
   EmbedderRenderTargetCache render_target_cache_;
+  // The damage of the last frames that only had the root view and used the
+  // same surface transformation, which are the frames whose render targets
+  // can be repainted partially.
+  DamageHistory damage_history_;
+  SkMatrix last_surface_transformation_;
+  // Whether the pending frame only renders its damage into a render target
+  // that holds an earlier frame.
+  bool pending_partial_repaint_ = false;
 
   void Reset();
 
+  // Drops all cached render targets after a frame failed to render.
+  void ForgetRenderedFrames();
+
   SkMatrix GetSurfaceTransformation() const;
 
   FML_DISALLOW_COPY_AND_ASSIGN(EmbedderExternalViewEmbedder);
@@ -17,7 +17,9 @@ EmbedderLayers::EmbedderLayers(SkISize frame_size,
 
 EmbedderLayers::~EmbedderLayers() = default;
 
-void EmbedderLayers::PushBackingStoreLayer(const FlutterBackingStore* store) {
+void EmbedderLayers::PushBackingStoreLayer(
+    const FlutterBackingStore* store,
+    const std::optional<SkIRect>& damage) {
   FlutterLayer layer = {};
 
   layer.struct_size = sizeof(FlutterLayer);
@@ -35,6 +37,21 @@ void EmbedderLayers::PushBackingStoreLayer(const FlutterBackingStore* store) {
   layer.size.width = transformed_layer_bounds.width();
   layer.size.height = transformed_layer_bounds.height();
 
+  if (damage) {
+    // The backing store is rendered into with the root surface
+    // transformation.
+    const SkIRect transformed_damage =
+        root_surface_transformation_.mapRect(SkRect::Make(*damage))
+            .roundOut();
+    FlutterRect rect = {};
+    rect.left = transformed_damage.left();
+    rect.top = transformed_damage.top();
+    rect.right = transformed_damage.right();
+    rect.bottom = transformed_damage.bottom();
+    damage_referenced_.push_back(std::make_unique<FlutterRect>(rect));
+    layer.damage = damage_referenced_.back().get();
+  }
+
   presented_layers_.push_back(layer);
 }
 
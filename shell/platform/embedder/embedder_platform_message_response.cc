@@ -4,8 +4,6 @@
 
 #include "flutter/shell/platform/embedder/embedder_platform_message_response.h"
 
-#include "flutter/fml/make_copyable.h"
-
 namespace flutter {
 
 EmbedderPlatformMessageResponse::EmbedderPlatformMessageResponse(
@@ -23,10 +21,9 @@ void EmbedderPlatformMessageResponse::Complete(
     return;
   }
 
-  runner_->PostTask(
-      fml::MakeCopyable([data = std::move(data), callback = callback_]() {
-        callback(data->GetMapping(), data->GetSize());
-      }));
+  runner_->PostTask([data = std::move(data), callback = callback_]() {
+    callback(data->GetMapping(), data->GetSize());
+  });
 }
 
 // |PlatformMessageResponse|
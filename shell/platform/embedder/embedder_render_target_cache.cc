@@ -4,9 +4,12 @@
 
 #include "flutter/shell/platform/embedder/embedder_render_target_cache.h"
 
+#include <algorithm>
+
 namespace flutter {
 
-EmbedderRenderTargetCache::EmbedderRenderTargetCache() = default;
+EmbedderRenderTargetCache::EmbedderRenderTargetCache(size_t buffer_count)
+    : buffer_count_(std::max<size_t>(buffer_count, 1)) {}
 
 EmbedderRenderTargetCache::~EmbedderRenderTargetCache() = default;
 
@@ -16,37 +19,55 @@ EmbedderRenderTargetCache::GetExistingTargetsInCache(
     const EmbedderExternalView::PendingViews& pending_views) {
   RenderTargets resolved_render_targets;
   EmbedderExternalView::ViewIdentifierSet unmatched_identifiers;
+  pending_descriptors_.clear();
 
   for (const auto& view : pending_views) {
     const auto& external_view = view.second;
     if (!external_view->HasEngineRenderedContents()) {
       continue;
     }
-    auto& compatible_targets =
-        cached_render_targets_[external_view->CreateRenderTargetDescriptor()];
-    if (compatible_targets.size() == 0) {
+    const auto descriptor = external_view->CreateRenderTargetDescriptor();
+    pending_descriptors_.insert(descriptor);
+    auto& compatible_targets = cached_render_targets_[descriptor];
+    if (compatible_targets.size() < buffer_count_) {
       unmatched_identifiers.insert(view.first);
     } else {
       std::unique_ptr<EmbedderRenderTarget> target =
-          std::move(compatible_targets.top());
-      compatible_targets.pop();
+          std::move(compatible_targets.front());
+      compatible_targets.pop_front();
       resolved_render_targets[view.first] = std::move(target);
     }
   }
   return {std::move(resolved_render_targets), std::move(unmatched_identifiers)};
 }
 
+std::set<std::unique_ptr<EmbedderRenderTarget>>
+EmbedderRenderTargetCache::ClearUnusedRenderTargetsInCache() {
+  std::set<std::unique_ptr<EmbedderRenderTarget>> cleared_targets;
+  for (auto it = cached_render_targets_.begin();
+       it != cached_render_targets_.end();) {
+    if (pending_descriptors_.count(it->first) != 0) {
+      ++it;
+      continue;
+    }
+    for (auto& target : it->second) {
+      cleared_targets.emplace(std::move(target));
+    }
+    it = cached_render_targets_.erase(it);
+  }
+  return cleared_targets;
+}
+
 std::set<std::unique_ptr<EmbedderRenderTarget>>
 EmbedderRenderTargetCache::ClearAllRenderTargetsInCache() {
   std::set<std::unique_ptr<EmbedderRenderTarget>> cleared_targets;
   for (auto& targets : cached_render_targets_) {
-    auto& targets_stack = targets.second;
-    while (!targets_stack.empty()) {
-      cleared_targets.emplace(std::move(targets_stack.top()));
-      targets_stack.pop();
+    for (auto& target : targets.second) {
+      cleared_targets.emplace(std::move(target));
     }
   }
   cached_render_targets_.clear();
+  pending_descriptors_.clear();
   return cleared_targets;
 }
 
@@ -59,7 +80,19 @@ void EmbedderRenderTargetCache::CacheRenderTarget(
   auto surface = target->GetRenderSurface();
   auto desc = EmbedderExternalView::RenderTargetDescriptor{
       view_identifier, SkISize::Make(surface->width(), surface->height())};
-  cached_render_targets_[desc].push(std::move(target));
+  cached_render_targets_[desc].push_back(std::move(target));
+}
+
+size_t EmbedderRenderTargetCache::GetBufferAge(
+    const EmbedderExternalView& view) const {
+  auto found =
+      cached_render_targets_.find(view.CreateRenderTargetDescriptor());
+  if (found == cached_render_targets_.end() ||
+      found->second.size() < buffer_count_) {
+    return 0;
+  }
+  // One render target of the view is rendered into every frame.
+  return found->second.size();
 }
 
 size_t EmbedderRenderTargetCache::GetCachedTargetsCount() const {
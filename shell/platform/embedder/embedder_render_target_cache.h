@@ -5,10 +5,11 @@
 #ifndef FLUTTER_SHELL_PLATFORM_EMBEDDER_EMBEDDER_RENDER_TARGET_CACHE_H_
 #define FLUTTER_SHELL_PLATFORM_EMBEDDER_EMBEDDER_RENDER_TARGET_CACHE_H_
 
+#include <deque>
 #include <set>
-#include <stack>
 #include <tuple>
 #include <unordered_map>
+#include <unordered_set>
 
 #include "flutter/fml/macros.h"
 #include "flutter/shell/platform/embedder/embedder_external_view.h"
@@ -19,9 +20,16 @@ namespace flutter {
 /// @brief      A cache used to reference render targets that are owned by the
 ///             embedder but needed by th engine to render a frame.
 ///
+///             The cache keeps up to `buffer_count` render targets for each
+///             view and hands them out in turn, so that the embedder can
+///             still present a render target while the next frames are
+///             rendered into the others. The cache tracks the age of the
+///             render targets, which allows a render target to be repainted
+///             partially.
+///
 class EmbedderRenderTargetCache {
  public:
-  EmbedderRenderTargetCache();
+  explicit EmbedderRenderTargetCache(size_t buffer_count = 1);
 
   ~EmbedderRenderTargetCache();
 
@@ -31,26 +39,63 @@ class EmbedderRenderTargetCache {
                          EmbedderExternalView::ViewIdentifier::Hash,
                          EmbedderExternalView::ViewIdentifier::Equal>;
 
+  //----------------------------------------------------------------------------
+  /// @brief      Takes the render targets for the pending views out of the
+  ///             cache. A view only gets a cached render target once all of
+  ///             its `buffer_count` render targets have been created.
+  ///
+  /// @return     The render targets that were found and the identifiers of
+  ///             the views that need a new render target.
+  ///
   std::pair<RenderTargets, EmbedderExternalView::ViewIdentifierSet>
   GetExistingTargetsInCache(
       const EmbedderExternalView::PendingViews& pending_views);
 
+  //----------------------------------------------------------------------------
+  /// @brief      Removes the render targets of the views that were not
+  ///             pending in the last call to `GetExistingTargetsInCache`.
+  ///
+  std::set<std::unique_ptr<EmbedderRenderTarget>>
+  ClearUnusedRenderTargetsInCache();
+
   std::set<std::unique_ptr<EmbedderRenderTarget>>
   ClearAllRenderTargetsInCache();
 
+  //----------------------------------------------------------------------------
+  /// @brief      Caches a render target that a frame was rendered into. The
+  ///             render targets of a view must be cached in the order in
+  ///             which frames are rendered into them.
+  ///
   void CacheRenderTarget(EmbedderExternalView::ViewIdentifier view_identifier,
                          std::unique_ptr<EmbedderRenderTarget> target);
 
+  //----------------------------------------------------------------------------
+  /// @brief      The number of frames that were rendered for `view` since
+  ///             the render target that `GetExistingTargetsInCache` will hand
+  ///             out for it was last rendered into, or 0 if the view will get
+  ///             a new render target.
+  ///
+  size_t GetBufferAge(const EmbedderExternalView& view) const;
+
   size_t GetCachedTargetsCount() const;
 
  private:
+  using RenderTargetDescriptorSet =
+      std::unordered_set<EmbedderExternalView::RenderTargetDescriptor,
+                         EmbedderExternalView::RenderTargetDescriptor::Hash,
+                         EmbedderExternalView::RenderTargetDescriptor::Equal>;
+
+  // The render targets of each view, the least recently rendered into at the
+  // front.
   using CachedRenderTargets =
       std::unordered_map<EmbedderExternalView::RenderTargetDescriptor,
-                         std::stack<std::unique_ptr<EmbedderRenderTarget>>,
+                         std::deque<std::unique_ptr<EmbedderRenderTarget>>,
                          EmbedderExternalView::RenderTargetDescriptor::Hash,
                          EmbedderExternalView::RenderTargetDescriptor::Equal>;
 
+  const size_t buffer_count_;
   CachedRenderTargets cached_render_targets_;
+  RenderTargetDescriptorSet pending_descriptors_;
 
   FML_DISALLOW_COPY_AND_ASSIGN(EmbedderRenderTargetCache);
 };
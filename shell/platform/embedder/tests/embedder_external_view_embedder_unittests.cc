@@ -0,0 +1,170 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/platform/embedder/embedder_external_view_embedder.h"
+
+#include <optional>
+#include <vector>
+
+#include "flutter/shell/platform/embedder/embedder_render_target.h"
+#include "gtest/gtest.h"
+#include "third_party/skia/include/core/SkSurface.h"
+
+namespace flutter {
+namespace testing {
+
+namespace {
+
+// Renders frames that only have the root view through an
+// |EmbedderExternalViewEmbedder| and records what is presented.
+class PartialRepaintEmbedder {
+ public:
+  explicit PartialRepaintEmbedder(size_t backing_store_buffer_count)
+      : view_embedder_(
+            false, backing_store_buffer_count,
+            [this](GrDirectContext* context,
+                   const FlutterBackingStoreConfig& config) {
+              return CreateRenderTarget(config);
+            },
+            [this](const std::vector<const FlutterLayer*>& layers) {
+              return Present(layers);
+            }) {}
+
+  // Renders a frame in which |frame_damage| changed, and returns the damage
+  // that the view embedder reported for its render target.
+  std::optional<SkIRect> RenderFrame(
+      const std::optional<SkIRect>& frame_damage) {
+    ExternalViewEmbedder& embedder = view_embedder_;
+    embedder.BeginFrame(kFrameSize, nullptr, 1.0, nullptr);
+    embedder.GetRootCanvas()->drawRect(SkRect::MakeWH(10, 10), SkPaint());
+    std::optional<SkIRect> existing_damage = embedder.GetExistingDamage();
+
+    // Like the rasterizer, paint the changes of this frame and the ones the
+    // render target misses.
+    SurfaceFrame::SubmitInfo submit_info;
+    submit_info.frame_damage = frame_damage;
+    if (existing_damage && frame_damage) {
+      SkIRect buffer_damage = *existing_damage;
+      buffer_damage.join(*frame_damage);
+      submit_info.buffer_damage = buffer_damage;
+    }
+    auto frame = std::make_unique<SurfaceFrame>(
+        nullptr, false,
+        [](const SurfaceFrame& surface_frame, SkCanvas* canvas) {
+          return true;
+        });
+    frame->set_submit_info(submit_info);
+    embedder.SubmitFrame(nullptr, std::move(frame));
+    return existing_damage;
+  }
+
+  size_t created_render_targets() const { return created_render_targets_; }
+
+  const std::vector<size_t>& presented_render_targets() const {
+    return presented_render_targets_;
+  }
+
+  const std::vector<std::optional<SkIRect>>& presented_damage() const {
+    return presented_damage_;
+  }
+
+ private:
+  static constexpr SkISize kFrameSize = SkISize::Make(100, 100);
+
+  EmbedderExternalViewEmbedder view_embedder_;
+  size_t created_render_targets_ = 0;
+  std::vector<size_t> presented_render_targets_;
+  std::vector<std::optional<SkIRect>> presented_damage_;
+
+  std::unique_ptr<EmbedderRenderTarget> CreateRenderTarget(
+      const FlutterBackingStoreConfig& config) {
+    FlutterBackingStore backing_store = {};
+    backing_store.struct_size = sizeof(backing_store);
+    backing_store.type = kFlutterBackingStoreTypeSoftware;
+    backing_store.user_data =
+        reinterpret_cast<void*>(created_render_targets_++);
+    return std::make_unique<EmbedderRenderTarget>(
+        backing_store,
+        SkSurface::MakeRasterN32Premul(config.size.width, config.size.height),
+        []() {});
+  }
+
+  bool Present(const std::vector<const FlutterLayer*>& layers) {
+    EXPECT_EQ(layers.size(), 1u);
+    const FlutterLayer* layer = layers.front();
+    EXPECT_EQ(layer->type, kFlutterLayerContentTypeBackingStore);
+    presented_render_targets_.push_back(
+        reinterpret_cast<size_t>(layer->backing_store->user_data));
+    if (layer->damage == nullptr) {
+      presented_damage_.push_back(std::nullopt);
+    } else {
+      presented_damage_.push_back(SkIRect::MakeLTRB(
+          layer->damage->left, layer->damage->top, layer->damage->right,
+          layer->damage->bottom));
+    }
+    return true;
+  }
+
+  FML_DISALLOW_COPY_AND_ASSIGN(PartialRepaintEmbedder);
+};
+
+}  // namespace
+
+TEST(EmbedderExternalViewEmbedderTest, ReportsTheDamageOfEachBackingStore) {
+  PartialRepaintEmbedder embedder(2);
+
+  // The first frames get new backing stores, which are rendered completely.
+  EXPECT_EQ(embedder.RenderFrame(std::nullopt), std::nullopt);
+  EXPECT_EQ(embedder.RenderFrame(std::nullopt), std::nullopt);
+  EXPECT_EQ(embedder.created_render_targets(), 2u);
+
+  // The first backing store misses the second frame, which changed
+  // completely.
+  EXPECT_EQ(embedder.RenderFrame(SkIRect::MakeLTRB(10, 10, 20, 20)),
+            SkIRect::MakeWH(100, 100));
+  // From then on, each backing store misses the changes of the frame that was
+  // rendered into the other one.
+  EXPECT_EQ(embedder.RenderFrame(SkIRect::MakeLTRB(50, 50, 60, 60)),
+            SkIRect::MakeLTRB(10, 10, 20, 20));
+  EXPECT_EQ(embedder.RenderFrame(SkIRect::MakeLTRB(0, 0, 5, 5)),
+            SkIRect::MakeLTRB(50, 50, 60, 60));
+  EXPECT_EQ(embedder.created_render_targets(), 2u);
+
+  EXPECT_EQ(embedder.presented_render_targets(),
+            std::vector<size_t>({0, 1, 0, 1, 0}));
+  const std::vector<std::optional<SkIRect>> expected_damage = {
+      std::nullopt,
+      std::nullopt,
+      SkIRect::MakeWH(100, 100),
+      SkIRect::MakeLTRB(10, 10, 60, 60),
+      SkIRect::MakeLTRB(0, 0, 60, 60),
+  };
+  EXPECT_EQ(embedder.presented_damage(), expected_damage);
+}
+
+TEST(EmbedderExternalViewEmbedderTest, FramesWithoutDamageAreRenderedFully) {
+  PartialRepaintEmbedder embedder(1);
+
+  EXPECT_EQ(embedder.RenderFrame(std::nullopt), std::nullopt);
+  // A single backing store holds the last frame.
+  EXPECT_EQ(embedder.RenderFrame(SkIRect::MakeLTRB(10, 10, 20, 20)),
+            SkIRect::MakeEmpty());
+  // Without the damage of a frame, the whole backing store is rendered into
+  // even though its contents are known.
+  EXPECT_EQ(embedder.RenderFrame(std::nullopt), SkIRect::MakeEmpty());
+  EXPECT_EQ(embedder.RenderFrame(SkIRect::MakeLTRB(0, 0, 5, 5)),
+            SkIRect::MakeEmpty());
+  EXPECT_EQ(embedder.created_render_targets(), 1u);
+
+  const std::vector<std::optional<SkIRect>> expected_damage = {
+      std::nullopt,
+      SkIRect::MakeLTRB(10, 10, 20, 20),
+      std::nullopt,
+      SkIRect::MakeLTRB(0, 0, 5, 5),
+  };
+  EXPECT_EQ(embedder.presented_damage(), expected_damage);
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -0,0 +1,137 @@
+// Copyright 2013 The Flutter Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "flutter/shell/platform/embedder/embedder_render_target_cache.h"
+
+#include "flutter/shell/platform/embedder/embedder_render_target.h"
+#include "gtest/gtest.h"
+#include "third_party/skia/include/core/SkSurface.h"
+
+namespace flutter {
+namespace testing {
+
+static std::unique_ptr<EmbedderRenderTarget> CreateRenderTarget(
+    const SkISize& size,
+    size_t id) {
+  FlutterBackingStore backing_store = {};
+  backing_store.struct_size = sizeof(backing_store);
+  backing_store.type = kFlutterBackingStoreTypeSoftware;
+  backing_store.user_data = reinterpret_cast<void*>(id);
+  return std::make_unique<EmbedderRenderTarget>(
+      backing_store,
+      SkSurface::MakeRasterN32Premul(size.width(), size.height()), []() {});
+}
+
+static size_t GetRenderTargetId(const EmbedderRenderTarget& target) {
+  return reinterpret_cast<size_t>(target.GetBackingStore()->user_data);
+}
+
+static void AddView(EmbedderExternalView::PendingViews& views,
+                    const SkISize& size,
+                    EmbedderExternalView::ViewIdentifier view_identifier) {
+  auto view = std::make_unique<EmbedderExternalView>(size, SkMatrix{},
+                                                     view_identifier, nullptr);
+  // Views without contents are not rendered into render targets.
+  view->GetCanvas()->drawRect(SkRect::MakeWH(10, 10), SkPaint());
+  views[view_identifier] = std::move(view);
+}
+
+TEST(EmbedderRenderTargetCacheTest, HandsOutEveryBufferInTurn) {
+  const SkISize size = SkISize::Make(100, 100);
+  const EmbedderExternalView::ViewIdentifier root_view;
+  for (size_t buffer_count = 1; buffer_count <= 3; buffer_count++) {
+    EmbedderRenderTargetCache cache(buffer_count);
+    size_t created_targets = 0;
+    for (size_t frame = 0; frame < 3 * buffer_count; frame++) {
+      EmbedderExternalView::PendingViews views;
+      AddView(views, size, root_view);
+
+      // Until every buffer has been created the view gets a new render target
+      // whose contents are unknown. After that, it gets the render target
+      // that was rendered into |buffer_count| frames ago.
+      const bool all_buffers_created = frame >= buffer_count;
+      EXPECT_EQ(cache.GetBufferAge(*views.at(root_view)),
+                all_buffers_created ? buffer_count : 0u);
+
+      auto [targets, unmatched] = cache.GetExistingTargetsInCache(views);
+      std::unique_ptr<EmbedderRenderTarget> target;
+      if (all_buffers_created) {
+        ASSERT_EQ(targets.size(), 1u);
+        EXPECT_TRUE(unmatched.empty());
+        target = std::move(targets.at(root_view));
+      } else {
+        EXPECT_TRUE(targets.empty());
+        ASSERT_EQ(unmatched.size(), 1u);
+        target = CreateRenderTarget(size, created_targets++);
+      }
+      EXPECT_EQ(GetRenderTargetId(*target), frame % buffer_count);
+
+      EXPECT_TRUE(cache.ClearUnusedRenderTargetsInCache().empty());
+      cache.CacheRenderTarget(root_view, std::move(target));
+    }
+    EXPECT_EQ(created_targets, buffer_count);
+    EXPECT_EQ(cache.GetCachedTargetsCount(), buffer_count);
+  }
+}
+
+TEST(EmbedderRenderTargetCacheTest, ClearsTheBuffersOfViewsThatAreNotPending) {
+  const SkISize size = SkISize::Make(100, 100);
+  const EmbedderExternalView::ViewIdentifier root_view;
+  const EmbedderExternalView::ViewIdentifier platform_view(1);
+  EmbedderRenderTargetCache cache(2);
+  for (size_t id = 0; id < 2; id++) {
+    cache.CacheRenderTarget(root_view, CreateRenderTarget(size, id));
+    cache.CacheRenderTarget(platform_view, CreateRenderTarget(size, 2 + id));
+  }
+  ASSERT_EQ(cache.GetCachedTargetsCount(), 4u);
+
+  // The platform view is gone, so both of its render targets are cleared.
+  {
+    EmbedderExternalView::PendingViews views;
+    AddView(views, size, root_view);
+    auto [targets, unmatched] = cache.GetExistingTargetsInCache(views);
+    ASSERT_EQ(targets.size(), 1u);
+    EXPECT_EQ(GetRenderTargetId(*targets.at(root_view)), 0u);
+    EXPECT_TRUE(unmatched.empty());
+
+    auto cleared = cache.ClearUnusedRenderTargetsInCache();
+    ASSERT_EQ(cleared.size(), 2u);
+    for (const auto& target : cleared) {
+      EXPECT_GE(GetRenderTargetId(*target), 2u);
+    }
+    EXPECT_EQ(cache.GetCachedTargetsCount(), 1u);
+    cache.CacheRenderTarget(root_view, std::move(targets.at(root_view)));
+  }
+
+  // The root view was resized, so its render targets no longer fit.
+  {
+    EmbedderExternalView::PendingViews views;
+    AddView(views, SkISize::Make(200, 100), root_view);
+    EXPECT_EQ(cache.GetBufferAge(*views.at(root_view)), 0u);
+    auto [targets, unmatched] = cache.GetExistingTargetsInCache(views);
+    EXPECT_TRUE(targets.empty());
+    EXPECT_EQ(unmatched.size(), 1u);
+    EXPECT_EQ(cache.ClearUnusedRenderTargetsInCache().size(), 2u);
+    EXPECT_EQ(cache.GetCachedTargetsCount(), 0u);
+  }
+}
+
+TEST(EmbedderRenderTargetCacheTest, ClearingAllBuffersResetsTheBufferAge) {
+  const SkISize size = SkISize::Make(100, 100);
+  const EmbedderExternalView::ViewIdentifier root_view;
+  EmbedderRenderTargetCache cache(2);
+  cache.CacheRenderTarget(root_view, CreateRenderTarget(size, 0));
+  cache.CacheRenderTarget(root_view, CreateRenderTarget(size, 1));
+
+  EmbedderExternalView::PendingViews views;
+  AddView(views, size, root_view);
+  EXPECT_EQ(cache.GetBufferAge(*views.at(root_view)), 2u);
+
+  EXPECT_EQ(cache.ClearAllRenderTargetsInCache().size(), 2u);
+  EXPECT_EQ(cache.GetBufferAge(*views.at(root_view)), 0u);
+  EXPECT_EQ(cache.GetCachedTargetsCount(), 0u);
+}
+
+}  // namespace testing
+}  // namespace flutter
@@ -1041,6 +1041,56 @@ TEST_F(EmbedderTest, CanSendLowMemoryNotification) {
   ASSERT_EQ(FlutterEngineNotifyLowMemoryWarning(engine.get()), kSuccess);
 }
 
+TEST_F(EmbedderTest, CanGetTaskQueueStats) {
+  auto& context = GetEmbedderContext(EmbedderTestContextType::kSoftwareContext);
+
+  EmbedderConfigBuilder builder(context);
+  builder.SetSoftwareRendererConfig();
+
+  auto engine = builder.LaunchEngine();
+
+  ASSERT_TRUE(engine.is_valid());
+
+  struct Captures {
+    std::vector<FlutterEngineTaskQueueStats> stats;
+  };
+  Captures captures;
+
+  // The tasks that set up the engine have run on the UI thread and been
+  // recorded by the time a task posted after them runs.
+  FlutterEngineResult result = kInternalInconsistency;
+  fml::AutoResetWaitableEvent latch;
+  ToEmbedderEngine(engine.get())
+      ->GetTaskRunners()
+      .GetUITaskRunner()
+      ->PostTask([&]() {
+        result = FlutterEngineGetTaskQueueStats(
+            engine.get(),
+            [](const FlutterEngineTaskQueueStats* stats, void* baton) {
+              reinterpret_cast<Captures*>(baton)->stats.push_back(*stats);
+            },
+            &captures);
+        latch.Signal();
+      });
+  latch.Wait();
+  ASSERT_EQ(result, kSuccess);
+
+  bool reported_ui = false;
+  for (const FlutterEngineTaskQueueStats& stats : captures.stats) {
+    ASSERT_EQ(stats.struct_size, sizeof(FlutterEngineTaskQueueStats));
+    ASSERT_GT(stats.task_count, 0u);
+    ASSERT_LE(stats.queue_delay_p50_nanos, stats.queue_delay_p99_nanos);
+    ASSERT_LE(stats.queue_delay_p99_nanos, stats.queue_delay_max_nanos);
+    ASSERT_LE(stats.run_time_p50_nanos, stats.run_time_p99_nanos);
+    ASSERT_LE(stats.run_time_p99_nanos, stats.run_time_max_nanos);
+    reported_ui |= stats.task_queue == kFlutterEngineTaskQueueUI;
+  }
+  ASSERT_TRUE(reported_ui);
+
+  ASSERT_EQ(FlutterEngineGetTaskQueueStats(engine.get(), nullptr, nullptr),
+            kInvalidArguments);
+}
+
 TEST_F(EmbedderTest, CanPostTaskToAllNativeThreads) {
   UniqueEngine engine;
   size_t worker_count = 0;
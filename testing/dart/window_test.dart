@@ -39,6 +39,8 @@ void main() {
             'layerCacheBytes: 0, '
             'pictureCacheCount: 0, '
             'pictureCacheBytes: 0, '
+            'rasterCacheHitCount: 0, '
+            'rasterCacheMissCount: 0, '
             'frameNumber: 23)');
   });
 
@@ -54,6 +56,8 @@ void main() {
       layerCacheBytes: 200000,
       pictureCacheCount: 3,
       pictureCacheBytes: 300000,
+      rasterCacheHitCount: 12,
+      rasterCacheMissCount: 2,
       frameNumber: 29,
     );
     expect(timing.toString(),
@@ -65,6 +69,8 @@ void main() {
             'layerCacheBytes: 200000, '
             'pictureCacheCount: 3, '
             'pictureCacheBytes: 300000, '
+            'rasterCacheHitCount: 12, '
+            'rasterCacheMissCount: 2, '
             'frameNumber: 29)');
   });
 